@@ -0,0 +1,71 @@
+/**
+ * Benchmark for the C/C++ syntax highlighter.
+ *
+ * Generates a synthetic 100k-line C file and compares a full re-highlight
+ * against the incremental line-state highlighter for typical edits.
+ *
+ * Usage: node scripts/bench-syntax-highlighter.js [lineCount]
+ */
+
+const { performance } = require('perf_hooks');
+const { applySyntaxHighlight, IncrementalHighlighter } = require('../src/renderer/utils/syntaxHighlighter');
+
+const lineCount = parseInt(process.argv[2], 10) || 100000;
+
+function generateSource(count) {
+  const templates = [
+    '#include <stdio.h>',
+    '/* Block comment describing the next function',
+    ' * spanning a few lines */',
+    'static int compute_%(int value, const char *name) {',
+    '  int local_% = value * 0x1F + 42u; // trailing comment',
+    '  if (local_% > MAX_VALUE) return printf("%s: %d\\n", name, local_%);',
+    '  const char *raw = R"delim(raw string % )delim";',
+    '  return local_%;',
+    '}',
+    ''
+  ];
+  const lines = [];
+  for (let i = 0; lines.length < count; i++) {
+    for (const t of templates) {
+      if (lines.length >= count) break;
+      lines.push(t.replace(/%/g, String(i)));
+    }
+  }
+  return lines;
+}
+
+function time(label, fn, iterations = 1) {
+  const start = performance.now();
+  let result;
+  for (let i = 0; i < iterations; i++) result = fn(i);
+  const ms = (performance.now() - start) / iterations;
+  console.log(`${label.padEnd(48)} ${ms.toFixed(3).padStart(10)} ms`);
+  return result;
+}
+
+const lines = generateSource(lineCount);
+const code = lines.join('\n');
+console.log(`Source: ${lineCount} lines, ${(code.length / 1024 / 1024).toFixed(2)} MB\n`);
+
+time('full applySyntaxHighlight', () => applySyntaxHighlight(code, 'C'), 3);
+
+const highlighter = new IncrementalHighlighter('C');
+time('incremental: initial load', () => highlighter.update(code));
+time('incremental: getHtml (join cached lines)', () => highlighter.getHtml(), 3);
+
+const middle = Math.floor(lineCount / 2);
+const edited = lines.slice();
+const stats = time('incremental: single-character edit (avg of 20)', (i) => {
+  edited[middle] = lines[middle] + ' '.repeat(i + 1);
+  return highlighter.update(edited.join('\n'));
+}, 20);
+console.log(`  re-tokenized lines: ${stats.retokenizedLines}`);
+
+edited[middle] = '/* unterminated';
+const open = time('incremental: open a block comment', () => highlighter.update(edited.join('\n')));
+console.log(`  re-tokenized lines: ${open.retokenizedLines}`);
+
+edited[middle] = lines[middle];
+const close = time('incremental: close it again', () => highlighter.update(edited.join('\n')));
+console.log(`  re-tokenized lines: ${close.retokenizedLines}`);
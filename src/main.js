@@ -16,8 +16,21 @@ const { spawn } = require('child_process');
 // Import IPC handlers
 const { setupFileHandlers } = require('./main/ipc/fileHandlers');
 const { setupEditorHandlers } = require('./main/ipc/editorHandlers');
-const { setupCtraceHandlers } = require('./main/ipc/ctraceHandlers');
+const { setupCtraceHandlers, runCtrace } = require('./main/ipc/ctraceHandlers');
 const { setupAssistantHandlers } = require('./main/ipc/assistantHandlers');
+const { setupLogHandlers, flushLogs } = require('./main/ipc/logHandlers');
+const { setupMetricsHandlers } = require('./main/ipc/metricsHandlers');
+const { setupSarifHandlers } = require('./main/ipc/sarifHandlers');
+const { setupExportHandlers } = require('./main/ipc/exportHandlers');
+const { setupSessionHandlers } = require('./main/ipc/sessionHandlers');
+const { consoleSink } = require('./main/utils/logger');
+const { parseHeadlessArgs, runHeadless } = require('./main/headless');
+
+// `--headless --analyze <dir>`: batch analysis for CI, no window
+const headlessOptions = parseHeadlessArgs(process.argv);
+if (headlessOptions) {
+  app.disableHardwareAcceleration();
+}
 
 /**
  * Creates and configures the main application window.
@@ -608,15 +621,45 @@ function setupWindowControls(window) {
 // Global reference to main window
 let mainWindow;
 
+// Write buffered log lines before exiting
+let logsFlushed = false;
+app.on('will-quit', (event) => {
+  if (logsFlushed) return;
+  event.preventDefault();
+  flushLogs().finally(() => {
+    logsFlushed = true;
+    app.quit();
+  });
+});
+
 app.whenReady().then(async () => {
+  if (headlessOptions) {
+    if (app.dock) app.dock.hide();
+    setupLogHandlers(path.join(app.getPath('userData'), 'logs', 'ctrace-gui.log'));
+    // stdout carries the report when --out is not given
+    consoleSink.setLevel('error');
+    const exitCode = await runHeadless(headlessOptions, runCtrace, path.join(app.getPath('userData'), 'analysis-history.json'));
+    await flushLogs();
+    app.exit(exitCode);
+    return;
+  }
+
   // Create window first
   mainWindow = createWindow();
   
+  // Log to userData/logs; packaged builds only print warnings and errors
+  setupLogHandlers(path.join(app.getPath('userData'), 'logs', 'ctrace-gui.log'));
+  if (app.isPackaged) consoleSink.setLevel('warn');
+  
   // Setup IPC handlers
   setupFileHandlers(mainWindow);
   setupEditorHandlers();
   setupCtraceHandlers();
   setupAssistantHandlers(mainWindow);
+  setupMetricsHandlers(mainWindow);
+  setupSarifHandlers(mainWindow);
+  setupExportHandlers(mainWindow);
+  setupSessionHandlers();
   setupWindowControls(mainWindow);
   
   // Check WSL status on Windows after window is ready
@@ -70,13 +70,22 @@ class AnthropicProvider extends BaseProvider {
     // Anthropic uses a different format - system prompt is separate
     const systemPrompt = options.systemPrompt || 'You are a helpful coding assistant.';
 
+    // Replay earlier turns; the last one carries a cache breakpoint so the
+    // system prompt and the whole history are read from the prompt cache
+    const messages = (options.history || []).map(turn => ({ role: turn.role, content: turn.content }));
+    if (messages.length > 0) {
+      const last = messages[messages.length - 1];
+      last.content = [{ type: 'text', text: last.content, cache_control: { type: 'ephemeral' } }];
+    }
+    messages.push({ role: 'user', content: message });
+
     const body = JSON.stringify({
       model: this.model,
       max_tokens: options.maxTokens || 2000,
-      system: systemPrompt,
-      messages: [
-        { role: 'user', content: message }
+      system: [
+        { type: 'text', text: systemPrompt, cache_control: { type: 'ephemeral' } }
       ],
+      messages: messages,
       temperature: options.temperature !== undefined ? options.temperature : 0.7
     });
 
@@ -103,7 +112,7 @@ class AnthropicProvider extends BaseProvider {
           try {
             const parsed = JSON.parse(data);
             if (parsed.content && parsed.content[0] && parsed.content[0].text) {
-              resolve({ success: true, reply: parsed.content[0].text });
+              resolve({ success: true, reply: parsed.content[0].text, usage: parsed.usage });
             } else if (parsed.error) {
               resolve({ success: false, error: parsed.error.message || 'API error' });
             } else {
@@ -115,6 +124,8 @@ class AnthropicProvider extends BaseProvider {
         });
       });
 
+      this.attachRequestHooks(req, options, resolve);
+
       req.on('error', (err) => {
         resolve({ success: false, error: 'API request failed: ' + err.message });
       });
@@ -67,13 +67,47 @@ class BaseProvider {
    * Send a chat message to the LLM
    * @abstract
    * @param {string} message - User message
-   * @param {Object} options - Additional options (systemPrompt, temperature, etc.)
+   * @param {Object} options - Additional options (systemPrompt, temperature, maxTokens,
+   *   history: earlier [{ role, content }] turns oldest first, cacheKey: prompt cache routing hint,
+   *   signal: AbortSignal cancelling the request, onFirstByte: called when the response starts,
+   *   onResponse: called with the HTTP status code and headers)
    * @returns {Promise<Object>} { success: boolean, reply?: string, error?: string }
    */
   async chat(message, options = {}) {
     throw new Error('chat() must be implemented by provider');
   }
 
+  /**
+   * Attach routing hooks to an outgoing HTTP request: options.onFirstByte is
+   * called when the response starts, options.onResponse receives its status
+   * code and headers, and aborting options.signal destroys the request and
+   * resolves it as cancelled
+   * @param {http.ClientRequest} req - Outgoing request
+   * @param {Object} options - Chat options passed to chat()
+   * @param {Function} resolve - Resolver of the chat() promise
+   */
+  attachRequestHooks(req, options, resolve) {
+    if (options.onFirstByte || options.onResponse) {
+      req.once('response', (res) => {
+        if (options.onFirstByte) options.onFirstByte();
+        if (options.onResponse) options.onResponse(res.statusCode, res.headers);
+      });
+    }
+    const signal = options.signal;
+    if (!signal) return;
+
+    const abort = () => {
+      req.destroy();
+      resolve({ success: false, error: 'Request cancelled', cancelled: true });
+    };
+    if (signal.aborted) {
+      abort();
+      return;
+    }
+    signal.addEventListener('abort', abort, { once: true });
+    req.once('close', () => signal.removeEventListener('abort', abort));
+  }
+
   /**
    * Test provider connection
    * @returns {Promise<Object>} { success: boolean, error?: string }
@@ -0,0 +1,336 @@
+/**
+ * @fileoverview Bulk "explain all diagnostics" pipeline
+ *
+ * Packs grouped ctrace diagnostics (rule -> function -> findings) into
+ * batched prompts, runs them with bounded concurrency behind a per-provider
+ * token bucket, retries rate-limited and failed requests with jittered
+ * exponential backoff (honoring retry-after), and reports each explanation
+ * as soon as its batch completes.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+const { estimateTokens } = require('./ConversationManager');
+
+/** Findings and prompt tokens packed into one request at most */
+const DEFAULT_BATCH_SIZE = 6;
+const DEFAULT_BATCH_TOKENS = 1500;
+
+/** Retry policy for rate limits, server errors and network failures */
+const DEFAULT_MAX_RETRIES = 4;
+const BASE_BACKOFF_MS = 1000;
+const MAX_BACKOFF_MS = 60000;
+
+/** Characters kept from each diagnostic message in the prompt */
+const MAX_MESSAGE_CHARS = 600;
+
+const SEVERITY_ORDER = { ERROR: 0, WARNING: 1, INFO: 2 };
+
+/**
+ * Token bucket limiting the tokens sent to a provider per minute
+ */
+class TokenBucket {
+  /**
+   * @param {number} tokensPerMinute - Sustained rate (also the burst capacity)
+   */
+  constructor(tokensPerMinute) {
+    this.capacity = tokensPerMinute;
+    this.tokens = tokensPerMinute;
+    this.refillPerMs = tokensPerMinute / 60000;
+    this.updatedAt = Date.now();
+    this.blockedUntil = 0;
+  }
+
+  /**
+   * Change the rate, keeping the current fill level within the new capacity
+   * @param {number} tokensPerMinute - New rate
+   */
+  setRate(tokensPerMinute) {
+    this.refill();
+    this.capacity = tokensPerMinute;
+    this.refillPerMs = tokensPerMinute / 60000;
+    this.tokens = Math.min(this.tokens, tokensPerMinute);
+  }
+
+  /**
+   * Add the tokens accumulated since the last update
+   * @private
+   */
+  refill() {
+    const now = Date.now();
+    this.tokens = Math.min(this.capacity, this.tokens + (now - this.updatedAt) * this.refillPerMs);
+    this.updatedAt = now;
+  }
+
+  /**
+   * Wait until `amount` tokens are available and take them
+   * @param {number} amount - Tokens needed (capped at the capacity)
+   * @param {Function} sleep - Delay function (ms) => Promise
+   * @returns {Promise<void>}
+   */
+  async take(amount, sleep) {
+    const needed = Math.min(amount, this.capacity);
+    for (;;) {
+      const blockedFor = this.blockedUntil - Date.now();
+      if (blockedFor > 0) {
+        await sleep(blockedFor);
+        continue;
+      }
+      this.refill();
+      if (this.tokens >= needed) {
+        this.tokens -= needed;
+        return;
+      }
+      await sleep(Math.ceil((needed - this.tokens) / this.refillPerMs));
+    }
+  }
+
+  /**
+   * Stop handing out tokens for a while, e.g. after a 429
+   * @param {number} ms - Pause length
+   */
+  pause(ms) {
+    this.blockedUntil = Math.max(this.blockedUntil, Date.now() + ms);
+    this.refill();
+    this.tokens = 0;
+  }
+}
+
+/**
+ * Parse a retry-after header value
+ * @param {string|number|undefined} value - Seconds or an HTTP date
+ * @returns {number|null} Delay in milliseconds
+ */
+function parseRetryAfter(value) {
+  if (value === undefined || value === null || value === '') return null;
+  const seconds = Number(value);
+  if (Number.isFinite(seconds)) return Math.max(0, seconds * 1000);
+  const date = Date.parse(value);
+  return Number.isNaN(date) ? null : Math.max(0, date - Date.now());
+}
+
+/**
+ * Delay before a retry: the server's retry-after when given, otherwise
+ * exponential backoff, both with jitter so workers do not retry in lockstep
+ * @param {number} attempt - Retry number, starting at 0
+ * @param {number|null} retryAfterMs - Server-provided delay
+ * @returns {number} Delay in milliseconds
+ */
+function backoffDelay(attempt, retryAfterMs) {
+  if (retryAfterMs !== null && retryAfterMs !== undefined) {
+    return retryAfterMs + Math.random() * Math.min(1000, retryAfterMs * 0.1 + 100);
+  }
+  const ceiling = Math.min(MAX_BACKOFF_MS, BASE_BACKOFF_MS * Math.pow(2, attempt));
+  return ceiling / 2 + Math.random() * ceiling / 2;
+}
+
+/**
+ * Pack grouped diagnostics into request batches. Each batch holds findings
+ * of a single rule, keeping a function's findings together, most severe
+ * rules first.
+ * @param {Object} groups - Output of DiagnosticsManager.groupDiagnostics
+ * @param {Object} options - { batchSize, batchTokens }
+ * @returns {Array<Object>} [{ ruleId, severity, items: [{ id, function, line, severity, message }] }]
+ */
+function packBatches(groups, options = {}) {
+  const batchSize = options.batchSize || DEFAULT_BATCH_SIZE;
+  const batchTokens = options.batchTokens || DEFAULT_BATCH_TOKENS;
+  const rules = Object.values(groups || {}).sort((a, b) =>
+    (SEVERITY_ORDER[a.severity] ?? 3) - (SEVERITY_ORDER[b.severity] ?? 3) || b.totalCount - a.totalCount);
+
+  const batches = [];
+  for (const rule of rules) {
+    let batch = null;
+    let tokens = 0;
+    for (const [funcName, diagnostics] of Object.entries(rule.functions || {})) {
+      for (const diag of diagnostics) {
+        const message = String((diag.details && diag.details.message) || '').slice(0, MAX_MESSAGE_CHARS);
+        const item = {
+          id: String(diag.id),
+          function: funcName,
+          line: diag.location ? diag.location.startLine : null,
+          severity: diag.severity,
+          message
+        };
+        const itemTokens = estimateTokens(message) + 20;
+        if (!batch || batch.items.length >= batchSize || (batch.items.length > 0 && tokens + itemTokens > batchTokens)) {
+          batch = { ruleId: rule.ruleId, severity: rule.severity, items: [] };
+          batches.push(batch);
+          tokens = 0;
+        }
+        batch.items.push(item);
+        tokens += itemTokens;
+      }
+    }
+  }
+  return batches;
+}
+
+/**
+ * Build the prompt for one batch
+ * @param {Object} batch - Batch from packBatches
+ * @returns {string} Prompt
+ */
+function buildBatchPrompt(batch) {
+  const findings = batch.items.map(item => [
+    `### ${item.id}`,
+    `Function: ${item.function}${item.line ? `, line ${item.line}` : ''}`,
+    `Severity: ${item.severity}`,
+    `Message: ${item.message.replace(/\s+/g, ' ').trim()}`
+  ].join('\n')).join('\n\n');
+
+  return `Explain each of the following ctrace static analysis findings (rule ${batch.ruleId}). ` +
+    'For every finding, start a section with its heading line exactly as given (### <id>), ' +
+    'then explain in a few sentences what the problem is and how to fix it.\n\n' + findings;
+}
+
+/**
+ * Split a batch reply into per-finding explanations
+ * @param {string} reply - Model reply
+ * @param {Object} batch - Batch the reply answers
+ * @returns {Map<string, string>} finding id -> explanation
+ */
+function parseBatchReply(reply, batch) {
+  const ids = new Set(batch.items.map(item => item.id));
+  const explanations = new Map();
+  const sections = String(reply || '').split(/^#{2,4}\s*/m);
+
+  for (const section of sections) {
+    const newline = section.indexOf('\n');
+    const heading = (newline === -1 ? section : section.slice(0, newline)).replace(/[`*:]/g, '').trim();
+    const id = heading.split(/\s+/)[0];
+    if (ids.has(id) && !explanations.has(id)) {
+      const text = newline === -1 ? '' : section.slice(newline + 1).trim();
+      if (text) explanations.set(id, text);
+    }
+  }
+
+  // The model ignored the format: show the whole answer on every finding
+  if (explanations.size === 0 && reply && reply.trim()) {
+    for (const id of ids) explanations.set(id, reply.trim());
+  }
+  return explanations;
+}
+
+/**
+ * Runs batches against a provider with bounded concurrency and retries
+ */
+class BulkExplainer {
+  /**
+   * @param {Object} options
+   * @param {Function} options.send - async (prompt) => { success, reply, error, status, retryAfterMs, retryable }
+   * @param {TokenBucket} [options.bucket] - Provider token bucket (none for local models)
+   * @param {number} [options.concurrency] - Requests in flight at most
+   * @param {number} [options.maxRetries] - Retries per batch
+   * @param {number} [options.outputTokens] - Expected reply tokens, charged to the bucket
+   * @param {Function} [options.onResult] - Called with [{ id, explanation } | { id, error }] per batch
+   * @param {Function} [options.sleep] - Delay function, replaceable in tests
+   */
+  constructor(options) {
+    this.send = options.send;
+    this.bucket = options.bucket || null;
+    this.concurrency = Math.max(1, options.concurrency || 1);
+    this.maxRetries = options.maxRetries !== undefined ? options.maxRetries : DEFAULT_MAX_RETRIES;
+    this.outputTokens = options.outputTokens || 500;
+    this.onResult = options.onResult || (() => {});
+    this.sleep = options.sleep || (ms => new Promise(resolve => setTimeout(resolve, ms)));
+    this.cancelled = false;
+    this.stats = { requests: 0, retries: 0, rateLimited: 0 };
+  }
+
+  /**
+   * Stop starting new batches; batches in flight finish normally
+   */
+  cancel() {
+    this.cancelled = true;
+  }
+
+  /**
+   * Explain every batch
+   * @param {Array<Object>} batches - Batches from packBatches
+   * @returns {Promise<Object>} { explained, failed, cancelled, elapsedMs, requests, retries, rateLimited }
+   */
+  async run(batches) {
+    const started = Date.now();
+    const queue = batches.slice();
+    let explained = 0;
+    let failed = 0;
+
+    const worker = async () => {
+      while (queue.length > 0 && !this.cancelled) {
+        const batch = queue.shift();
+        const results = await this.explainBatch(batch);
+        for (const result of results) {
+          if (result.error) failed++;
+          else explained++;
+        }
+        this.onResult(results, batch);
+      }
+    };
+
+    await Promise.all(Array.from({ length: Math.min(this.concurrency, queue.length) }, worker));
+    return { explained, failed, cancelled: this.cancelled, elapsedMs: Date.now() - started, ...this.stats };
+  }
+
+  /**
+   * Send one batch, retrying transient failures
+   * @param {Object} batch - Batch to explain
+   * @returns {Promise<Array<Object>>} Per-finding results
+   * @private
+   */
+  async explainBatch(batch) {
+    const prompt = buildBatchPrompt(batch);
+    const cost = estimateTokens(prompt) + this.outputTokens;
+    let lastError = 'Unknown error';
+
+    for (let attempt = 0; attempt <= this.maxRetries; attempt++) {
+      if (this.cancelled) {
+        lastError = 'Cancelled';
+        break;
+      }
+      if (this.bucket) await this.bucket.take(cost, this.sleep);
+
+      this.stats.requests++;
+      let result;
+      try {
+        result = await this.send(prompt);
+      } catch (error) {
+        result = { success: false, error: error.message };
+      }
+
+      if (result && result.success) {
+        const explanations = parseBatchReply(result.reply, batch);
+        return batch.items.map(item => explanations.has(item.id)
+          ? { id: item.id, explanation: explanations.get(item.id) }
+          : { id: item.id, error: 'No explanation returned for this finding' });
+      }
+
+      lastError = (result && result.error) || lastError;
+      const status = result && result.status;
+      const retryable = status === 429 || status >= 500 || Boolean(result && result.retryable);
+      if (!retryable || attempt === this.maxRetries) break;
+
+      const delay = backoffDelay(attempt, result.retryAfterMs);
+      this.stats.retries++;
+      if (status === 429) {
+        this.stats.rateLimited++;
+        // Every worker shares the provider's limit, so all of them wait
+        if (this.bucket) this.bucket.pause(delay);
+      }
+      await this.sleep(delay);
+    }
+
+    return batch.items.map(item => ({ id: item.id, error: lastError }));
+  }
+}
+
+module.exports = {
+  BulkExplainer,
+  TokenBucket,
+  packBatches,
+  buildBatchPrompt,
+  parseBatchReply,
+  parseRetryAfter,
+  backoffDelay
+};
@@ -0,0 +1,190 @@
+/**
+ * @fileoverview Token-budgeted conversation memory for the assistant
+ *
+ * Keeps the recent turns of each provider's conversation and replays them
+ * with every request, within a rolling token budget. When the history grows
+ * past the budget, the oldest turns are folded into a short extractive
+ * summary that is appended to the system prompt. Folding happens in chunks
+ * (down to a low-water mark) so the system prompt and the retained turns form
+ * a prefix that stays byte-identical across several requests, which is what
+ * provider prompt caching keys on.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+/** Approximate characters per token for budget estimates */
+const CHARS_PER_TOKEN = 4;
+
+/** History budgets (in tokens) used when the config does not set one */
+const DEFAULT_BUDGETS = {
+  anthropic: 12000,
+  openai: 12000,
+  deepseek: 12000,
+  groq: 6000,
+  perplexity: 6000,
+  generic: 6000,
+  ollama: 3000
+};
+const FALLBACK_BUDGET = 4000;
+
+/** After a fold the history is trimmed down to this fraction of the budget */
+const LOW_WATER_RATIO = 0.6;
+
+/** Share of the budget the running summary may use */
+const SUMMARY_RATIO = 0.15;
+
+/** Maximum characters kept from each side of a folded turn */
+const SUMMARY_SNIPPET_CHARS = 160;
+
+/**
+ * Estimate the token count of a text
+ * @param {string} text - Text to measure
+ * @returns {number} Estimated tokens
+ */
+function estimateTokens(text) {
+  return text ? Math.ceil(text.length / CHARS_PER_TOKEN) : 0;
+}
+
+/**
+ * Shorten a message to its first sentence or line, without code blocks
+ * @param {string} text - Message text
+ * @returns {string} Snippet
+ */
+function snippet(text) {
+  const plain = (text || '')
+    .replace(/```[\s\S]*?(```|$)/g, ' [code] ')
+    .replace(/\s+/g, ' ')
+    .trim();
+  const sentenceEnd = plain.search(/[.?!](\s|$)/);
+  const first = sentenceEnd > 0 ? plain.slice(0, sentenceEnd + 1) : plain;
+  return first.length > SUMMARY_SNIPPET_CHARS ? first.slice(0, SUMMARY_SNIPPET_CHARS - 1) + '…' : first;
+}
+
+/**
+ * Conversation memory keyed by provider
+ */
+class ConversationManager {
+  constructor() {
+    /** @type {Map<string, {turns: Array<Object>, summary: Array<string>}>} */
+    this.conversations = new Map();
+  }
+
+  /**
+   * Derive the conversation key for a chat request
+   * @param {string} provider - 'ollama', 'external' or 'local'
+   * @param {Object} config - Assistant configuration
+   * @returns {string} Conversation key
+   */
+  static keyFor(provider, config = {}) {
+    return provider === 'external' ? `external:${config.providerId || 'openai'}` : provider;
+  }
+
+  /**
+   * Resolve the history token budget for a conversation
+   * @param {string} key - Conversation key
+   * @param {Object} config - Assistant configuration (historyTokenBudget overrides the default)
+   * @returns {number} Budget in tokens
+   */
+  getBudget(key, config = {}) {
+    const configured = parseInt(config.historyTokenBudget, 10);
+    if (configured > 0) return configured;
+    const providerId = key.startsWith('external:') ? key.slice('external:'.length) : key;
+    return DEFAULT_BUDGETS[providerId] || FALLBACK_BUDGET;
+  }
+
+  /**
+   * Get or create a conversation
+   * @param {string} key - Conversation key
+   * @returns {Object} Conversation state
+   * @private
+   */
+  get(key) {
+    let conversation = this.conversations.get(key);
+    if (!conversation) {
+      conversation = { turns: [], summary: [] };
+      this.conversations.set(key, conversation);
+    }
+    return conversation;
+  }
+
+  /**
+   * Build the context to send with a new user message. Providers send the
+   * history, oldest first, between the system prompt and the new message,
+   * so each request extends the previous request's prefix and stays
+   * cacheable server-side.
+   * @param {string} key - Conversation key
+   * @param {string} systemPrompt - Base system prompt
+   * @param {Object} config - Assistant configuration
+   * @returns {Object} { systemPrompt, history } where history is [{ role, content }] oldest first
+   */
+  buildContext(key, systemPrompt, config = {}) {
+    const conversation = this.get(key);
+    this.fold(conversation, this.getBudget(key, config));
+
+    const history = [];
+    for (const turn of conversation.turns) {
+      history.push({ role: 'user', content: turn.user });
+      history.push({ role: 'assistant', content: turn.assistant });
+    }
+
+    let prompt = systemPrompt || '';
+    if (conversation.summary.length > 0) {
+      prompt += `${prompt ? '\n\n' : ''}Summary of earlier conversation:\n${conversation.summary.join('\n')}`;
+    }
+
+    return { systemPrompt: prompt || undefined, history };
+  }
+
+  /**
+   * Record a completed exchange
+   * @param {string} key - Conversation key
+   * @param {string} userMessage - Message that was sent
+   * @param {string} reply - Assistant reply
+   */
+  recordTurn(key, userMessage, reply) {
+    const turn = { user: userMessage, assistant: reply };
+    turn.tokens = estimateTokens(turn.user) + estimateTokens(turn.assistant);
+    this.get(key).turns.push(turn);
+  }
+
+  /**
+   * Fold the oldest turns into the summary once the history exceeds the budget
+   * @param {Object} conversation - Conversation state
+   * @param {number} budget - Budget in tokens
+   * @private
+   */
+  fold(conversation, budget) {
+    let total = conversation.turns.reduce((sum, turn) => sum + turn.tokens, 0);
+    if (total <= budget) return;
+
+    const lowWater = budget * LOW_WATER_RATIO;
+    // Always keep the latest turn verbatim, even if it alone exceeds the budget
+    while (total > lowWater && conversation.turns.length > 1) {
+      const turn = conversation.turns.shift();
+      total -= turn.tokens;
+      conversation.summary.push(`- User asked: ${snippet(turn.user)} Assistant: ${snippet(turn.assistant)}`);
+    }
+
+    const summaryBudget = budget * SUMMARY_RATIO;
+    let summaryTokens = conversation.summary.reduce((sum, line) => sum + estimateTokens(line), 0);
+    while (summaryTokens > summaryBudget && conversation.summary.length > 0) {
+      summaryTokens -= estimateTokens(conversation.summary.shift());
+    }
+  }
+
+  /**
+   * Forget a conversation, or all of them
+   * @param {string} [key] - Conversation key; omitted clears everything
+   */
+  clear(key) {
+    if (key) {
+      this.conversations.delete(key);
+    } else {
+      this.conversations.clear();
+    }
+  }
+}
+
+module.exports = ConversationManager;
+module.exports.estimateTokens = estimateTokens;
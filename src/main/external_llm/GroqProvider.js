@@ -63,6 +63,7 @@ class GroqProvider extends BaseProvider {
     // Add system prompt
     const systemPrompt = options.systemPrompt || 'You are a helpful coding assistant.';
     messages.push({ role: 'system', content: systemPrompt });
+    messages.push(...(options.history || []));
     messages.push({ role: 'user', content: message });
 
     const body = JSON.stringify({
@@ -105,6 +106,8 @@ class GroqProvider extends BaseProvider {
         });
       });
 
+      this.attachRequestHooks(req, options, resolve);
+
       req.on('error', (err) => {
         resolve({ success: false, error: 'API request failed: ' + err.message });
       });
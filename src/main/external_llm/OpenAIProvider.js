@@ -73,14 +73,20 @@ class OpenAIProvider extends BaseProvider {
     // Add system prompt
     const systemPrompt = options.systemPrompt || 'You are a helpful coding assistant.';
     messages.push({ role: 'system', content: systemPrompt });
+    messages.push(...(options.history || []));
     messages.push({ role: 'user', content: message });
 
-    const body = JSON.stringify({
+    const payload = {
       model: this.model,
       messages: messages,
       temperature: options.temperature !== undefined ? options.temperature : 0.7,
       max_tokens: options.maxTokens || 2000
-    });
+    };
+    // Routes requests sharing a prefix to the same cache
+    if (options.cacheKey) {
+      payload.prompt_cache_key = options.cacheKey;
+    }
+    const body = JSON.stringify(payload);
 
     return new Promise((resolve) => {
       const url = new URL(this.endpoint);
@@ -104,7 +110,7 @@ class OpenAIProvider extends BaseProvider {
           try {
             const parsed = JSON.parse(data);
             if (parsed.choices && parsed.choices[0] && parsed.choices[0].message) {
-              resolve({ success: true, reply: parsed.choices[0].message.content });
+              resolve({ success: true, reply: parsed.choices[0].message.content, usage: parsed.usage });
             } else if (parsed.error) {
               resolve({ success: false, error: parsed.error.message || 'API error' });
             } else {
@@ -116,6 +122,8 @@ class OpenAIProvider extends BaseProvider {
         });
       });
 
+      this.attachRequestHooks(req, options, resolve);
+
       req.on('error', (err) => {
         resolve({ success: false, error: 'API request failed: ' + err.message });
       });
@@ -65,6 +65,7 @@ class PerplexityProvider extends BaseProvider {
     // Add system prompt
     const systemPrompt = options.systemPrompt || 'You are a helpful coding assistant with access to current information.';
     messages.push({ role: 'system', content: systemPrompt });
+    messages.push(...(options.history || []));
     messages.push({ role: 'user', content: message });
 
     const body = JSON.stringify({
@@ -107,6 +108,8 @@ class PerplexityProvider extends BaseProvider {
         });
       });
 
+      this.attachRequestHooks(req, options, resolve);
+
       req.on('error', (err) => {
         resolve({ success: false, error: 'API request failed: ' + err.message });
       });
@@ -0,0 +1,291 @@
+/**
+ * @fileoverview Latency-aware routing across external providers
+ *
+ * Tracks time to first byte, total latency and error rate of every provider
+ * as exponentially weighted moving averages, routes each request to the
+ * provider expected to answer fastest, and hedges: when the primary has not
+ * started responding within a percentile of its recent first-byte times, the
+ * same request is sent to the next provider. The first successful answer
+ * wins and the other request is aborted; the loser's elapsed time is
+ * recorded as a lower bound on its latency, so a primary that keeps losing
+ * the hedge is still measured and eventually demoted.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+/** Weight of the newest sample in the moving averages */
+const EWMA_ALPHA = 0.3;
+
+/** Recent first-byte times kept per provider for the hedge percentile */
+const TTFT_WINDOW = 50;
+
+/** Samples needed before percentiles and rankings are trusted */
+const MIN_SAMPLES = 5;
+
+/** Hedge delay used until a provider has enough samples */
+const DEFAULT_HEDGE_DELAY_MS = 3000;
+
+/** Lower bound for the hedge delay so fast providers are not hedged constantly */
+const MIN_HEDGE_DELAY_MS = 150;
+
+const DEFAULT_HEDGE_PERCENTILE = 0.95;
+
+/**
+ * Update an exponentially weighted moving average
+ * @param {number|null} average - Current average (null when empty)
+ * @param {number} sample - New sample
+ * @returns {number} Updated average
+ */
+function ewma(average, sample) {
+  return average === null ? sample : average + EWMA_ALPHA * (sample - average);
+}
+
+/**
+ * Routes chat requests across providers using observed latency
+ */
+class ProviderRouter {
+  /**
+   * @param {Object} registry - Provider registry with createProvider(id, config)
+   */
+  constructor(registry) {
+    this.registry = registry;
+    /** @type {Map<string, Object>} stats key -> latency statistics */
+    this.stats = new Map();
+  }
+
+  /**
+   * Identify a provider configuration for statistics
+   * @param {Object} candidate - { id, config }
+   * @returns {string} Stats key such as "openai gpt-4"
+   */
+  static keyFor(candidate) {
+    const config = candidate.config || {};
+    return [candidate.id, config.model, config.endpoint].filter(Boolean).join(' ');
+  }
+
+  /**
+   * Get or create the statistics for a provider
+   * @param {string} key - Stats key
+   * @returns {Object} { ttftMs, totalMs, errorRate, requests, errors, censored, hedges, wins, ttftSamples }
+   */
+  getStats(key) {
+    let stats = this.stats.get(key);
+    if (!stats) {
+      stats = { ttftMs: null, totalMs: null, errorRate: 0, requests: 0, errors: 0, censored: 0, hedges: 0, wins: 0, ttftSamples: [] };
+      this.stats.set(key, stats);
+    }
+    return stats;
+  }
+
+  /**
+   * Record the outcome of a request
+   * @param {string} key - Stats key
+   * @param {Object} sample - { ttftMs, totalMs, error, censored }. A censored sample
+   *   comes from a cancelled request: totalMs is the time until cancellation, a lower
+   *   bound on the real latency, and ttftMs is set only if the first byte arrived
+   */
+  record(key, { ttftMs, totalMs, error, censored }) {
+    const stats = this.getStats(key);
+    stats.requests++;
+    stats.errorRate = stats.requests === 1 ? (error ? 1 : 0) : ewma(stats.errorRate, error ? 1 : 0);
+    if (error) {
+      stats.errors++;
+      return;
+    }
+    if (censored) {
+      // The request would have taken at least this long; never pull the average down
+      stats.censored++;
+      totalMs = Math.max(totalMs, stats.totalMs === null ? 0 : stats.totalMs);
+    }
+    if (typeof ttftMs === 'number') {
+      stats.ttftMs = ewma(stats.ttftMs, ttftMs);
+      stats.ttftSamples.push(ttftMs);
+      if (stats.ttftSamples.length > TTFT_WINDOW) stats.ttftSamples.shift();
+    }
+    stats.totalMs = ewma(stats.totalMs, totalMs);
+  }
+
+  /**
+   * Snapshot of all statistics, without the raw samples
+   * @returns {Object} stats key -> summary
+   */
+  getSummary() {
+    const summary = {};
+    for (const [key, { ttftSamples, ...stats }] of this.stats) {
+      summary[key] = { ...stats, hedgeDelayMs: this.hedgeDelay(key) };
+    }
+    return summary;
+  }
+
+  /**
+   * How long to wait for the primary's first byte before hedging
+   * @param {string} key - Stats key of the primary
+   * @param {Object} config - Config (hedgePercentile, hedgeDelayMs used until enough samples)
+   * @returns {number} Delay in milliseconds
+   */
+  hedgeDelay(key, config = {}) {
+    const samples = this.getStats(key).ttftSamples;
+    if (samples.length < MIN_SAMPLES) {
+      return parseInt(config.hedgeDelayMs, 10) || DEFAULT_HEDGE_DELAY_MS;
+    }
+    const percentile = parseFloat(config.hedgePercentile) || DEFAULT_HEDGE_PERCENTILE;
+    const sorted = samples.slice().sort((a, b) => a - b);
+    const index = Math.min(sorted.length - 1, Math.max(0, Math.ceil(percentile * sorted.length) - 1));
+    return Math.max(MIN_HEDGE_DELAY_MS, Math.round(sorted[index]));
+  }
+
+  /**
+   * Order candidates so the one expected to answer fastest goes first.
+   * The configured primary is kept until its own statistics show another
+   * measured provider is faster once errors are accounted for.
+   * @param {Array<Object>} candidates - [{ id, config }] in configured order
+   * @returns {Array<Object>} Reordered candidates
+   */
+  rank(candidates) {
+    const expected = (candidate) => {
+      const stats = this.getStats(ProviderRouter.keyFor(candidate));
+      if (stats.requests < MIN_SAMPLES || stats.totalMs === null) return null;
+      // Each failure costs roughly another attempt
+      return stats.totalMs / Math.max(0.05, 1 - stats.errorRate);
+    };
+
+    const primaryCost = expected(candidates[0]);
+    if (primaryCost === null) return candidates;
+
+    let best = 0;
+    let bestCost = primaryCost;
+    candidates.forEach((candidate, index) => {
+      const cost = expected(candidate);
+      if (cost !== null && cost < bestCost) {
+        best = index;
+        bestCost = cost;
+      }
+    });
+    if (best === 0) return candidates;
+    return [candidates[best], ...candidates.filter((_, index) => index !== best)];
+  }
+
+  /**
+   * Send a chat request, hedging to the next candidate when the first is slow
+   * @param {Array<Object>} candidates - [{ id, config }] primary first
+   * @param {string} message - User message
+   * @param {Object} options - Chat options passed to the providers
+   * @param {Object} config - Routing config (hedging: false disables hedging)
+   * @returns {Promise<Object>} Provider result with providerId, providerKey (stats key
+   *   of the provider that answered) and hedged
+   */
+  chat(candidates, message, options = {}, config = {}) {
+    const [primary, secondary] = this.rank(candidates);
+    const hedge = secondary && config.hedging !== false ? secondary : null;
+
+    return new Promise((resolve) => {
+      const attempts = [];
+      let settled = false;
+      let timer = null;
+      let failures = 0;
+
+      const finish = (result, winner) => {
+        settled = true;
+        clearTimeout(timer);
+        for (const attempt of attempts) {
+          if (attempt !== winner) attempt.cancel();
+        }
+        resolve({
+          ...result,
+          providerId: winner ? winner.candidate.id : undefined,
+          providerKey: winner ? ProviderRouter.keyFor(winner.candidate) : undefined,
+          hedged: attempts.length > 1
+        });
+      };
+
+      const launch = (candidate) => {
+        const attempt = this.attempt(candidate, message, options, () => {
+          // The primary started answering in time: no hedge needed
+          if (attempts.length === 1) clearTimeout(timer);
+        });
+        attempts.push(attempt);
+        attempt.promise.then((result) => {
+          if (settled) return;
+          if (result.success) {
+            if (attempts.length > 1) this.getStats(ProviderRouter.keyFor(candidate)).wins++;
+            finish(result, attempt);
+            return;
+          }
+          failures++;
+          if (hedge && attempts.length === 1) {
+            // Fail over at once instead of waiting for the hedge deadline
+            launchHedge();
+          } else if (failures === attempts.length) {
+            finish(result, null);
+          }
+        });
+      };
+
+      const launchHedge = () => {
+        clearTimeout(timer);
+        if (settled || attempts.length > 1) return;
+        this.getStats(ProviderRouter.keyFor(primary)).hedges++;
+        launch(hedge);
+      };
+
+      launch(primary);
+      if (hedge) {
+        timer = setTimeout(launchHedge, this.hedgeDelay(ProviderRouter.keyFor(primary), config));
+      }
+    });
+  }
+
+  /**
+   * Start one provider request and record its latency
+   * @param {Object} candidate - { id, config }
+   * @param {string} message - User message
+   * @param {Object} options - Chat options
+   * @param {Function} onFirstByte - Called when the response starts
+   * @returns {Object} { candidate, promise, cancel }
+   * @private
+   */
+  attempt(candidate, message, options, onFirstByte) {
+    const controller = new AbortController();
+    const key = ProviderRouter.keyFor(candidate);
+    const started = Date.now();
+    let ttftMs = null;
+
+    const promise = (async () => {
+      try {
+        const provider = this.registry.createProvider(candidate.id, candidate.config);
+        const validation = provider.validateConfig(candidate.config);
+        if (!validation.valid) {
+          return { success: false, error: 'Configuration error: ' + validation.errors.join(', ') };
+        }
+
+        const result = await provider.chat(message, {
+          ...options,
+          signal: controller.signal,
+          onFirstByte: () => {
+            ttftMs = Date.now() - started;
+            onFirstByte();
+          }
+        });
+        const totalMs = Date.now() - started;
+        if (result.cancelled) {
+          this.record(key, { ttftMs, totalMs, censored: true });
+        } else {
+          this.record(key, { ttftMs: ttftMs === null ? totalMs : ttftMs, totalMs, error: !result.success });
+        }
+        return result;
+      } catch (error) {
+        if (controller.signal.aborted) {
+          this.record(key, { ttftMs, totalMs: Date.now() - started, censored: true });
+          return { success: false, error: 'Request cancelled', cancelled: true };
+        }
+        this.record(key, { error: true });
+        return { success: false, error: error.message || 'Provider error' };
+      }
+    })();
+
+    return { candidate, promise, cancel: () => controller.abort() };
+  }
+}
+
+module.exports = ProviderRouter;
@@ -0,0 +1,215 @@
+/**
+ * @fileoverview Response cache for assistant requests
+ *
+ * Caches successful assistant replies under a hash of everything that
+ * determines the answer (provider, model, sampling settings, system prompt,
+ * message and the conversation/retrieval context), bounded by entry count and age. Identical
+ * requests issued while one is still running share that call instead of
+ * starting another. The cache can optionally be persisted to a JSON file so
+ * answers survive a restart.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+const crypto = require('crypto');
+const fs = require('fs').promises;
+
+/** Defaults used when the assistant config does not override them */
+const DEFAULT_MAX_ENTRIES = 200;
+const DEFAULT_TTL_MS = 60 * 60 * 1000;
+
+/** Delay before writing the cache file after a change */
+const SAVE_DELAY_MS = 2000;
+
+/**
+ * Hash a value into a hex digest
+ * @param {*} value - Any JSON-serializable value
+ * @returns {string} SHA-256 hex digest
+ */
+function hash(value) {
+  return crypto.createHash('sha256').update(JSON.stringify(value)).digest('hex');
+}
+
+/**
+ * LRU response cache with in-flight request coalescing
+ */
+class ResponseCache {
+  /**
+   * @param {Object} options - { maxEntries, ttlMs, filePath }
+   */
+  constructor(options = {}) {
+    this.maxEntries = options.maxEntries || DEFAULT_MAX_ENTRIES;
+    this.ttlMs = options.ttlMs || DEFAULT_TTL_MS;
+    this.filePath = options.filePath || null;
+    /** @type {Map<string, {reply: string, createdAt: number}>} in LRU order, oldest first */
+    this.entries = new Map();
+    /** @type {Map<string, Promise<Object>>} */
+    this.inflight = new Map();
+    this.saveTimer = null;
+    this.stats = { hits: 0, misses: 0, coalesced: 0 };
+  }
+
+  /**
+   * Build a cache key for a request
+   * @param {Object} parts - { provider, model, temperature, maxTokens, systemPrompt, message, context }
+   * @returns {string} Cache key
+   */
+  static keyFor({ provider, model, temperature, maxTokens, systemPrompt, message, context }) {
+    return hash([
+      provider || '', model || '', temperature === undefined ? null : temperature, maxTokens === undefined ? null : maxTokens,
+      systemPrompt || '', message || '', hash(context === undefined ? null : context)
+    ]);
+  }
+
+  /**
+   * Apply size/TTL settings from the assistant config
+   * @param {Object} config - Assistant configuration (responseCacheSize, responseCacheTtlMinutes)
+   */
+  configure(config = {}) {
+    const size = parseInt(config.responseCacheSize, 10);
+    const ttlMinutes = parseFloat(config.responseCacheTtlMinutes);
+    if (size > 0) this.maxEntries = size;
+    if (ttlMinutes > 0) this.ttlMs = ttlMinutes * 60 * 1000;
+    this.evict();
+  }
+
+  /**
+   * Look up a fresh cached reply
+   * @param {string} key - Cache key
+   * @returns {Object|null} Cached entry { reply, createdAt } or null
+   */
+  get(key) {
+    const entry = this.entries.get(key);
+    if (!entry) return null;
+    if (Date.now() - entry.createdAt > this.ttlMs) {
+      this.entries.delete(key);
+      return null;
+    }
+    // Refresh the LRU position
+    this.entries.delete(key);
+    this.entries.set(key, entry);
+    return entry;
+  }
+
+  /**
+   * Store a reply
+   * @param {string} key - Cache key
+   * @param {string} reply - Assistant reply
+   */
+  set(key, reply) {
+    this.entries.delete(key);
+    this.entries.set(key, { reply, createdAt: Date.now() });
+    this.evict();
+    this.scheduleSave();
+  }
+
+  /**
+   * Drop expired entries and the least recently used ones beyond the size bound
+   * @private
+   */
+  evict() {
+    const now = Date.now();
+    for (const [key, entry] of this.entries) {
+      if (now - entry.createdAt > this.ttlMs) this.entries.delete(key);
+    }
+    while (this.entries.size > this.maxEntries) {
+      this.entries.delete(this.entries.keys().next().value);
+    }
+  }
+
+  /**
+   * Return a cached reply, join an identical in-flight request, or run a new one.
+   * Only successful results are cached, and not those marked cacheable: false;
+   * every result is returned to all waiters.
+   * @param {string} key - Cache key
+   * @param {Function} fetcher - Async function returning { success, reply, error }
+   * @returns {Promise<Object>} Result, with cached: true when served from cache
+   */
+  async run(key, fetcher) {
+    const entry = this.get(key);
+    if (entry) {
+      this.stats.hits++;
+      return { success: true, reply: entry.reply, cached: true };
+    }
+
+    const pending = this.inflight.get(key);
+    if (pending) {
+      this.stats.coalesced++;
+      return pending;
+    }
+
+    this.stats.misses++;
+    const request = (async () => {
+      try {
+        const result = await fetcher();
+        if (result && result.success && result.cacheable !== false && typeof result.reply === 'string') {
+          this.set(key, result.reply);
+        }
+        return result;
+      } finally {
+        this.inflight.delete(key);
+      }
+    })();
+    this.inflight.set(key, request);
+    return request;
+  }
+
+  /**
+   * Forget every cached reply (in-flight requests are left running)
+   */
+  clear() {
+    this.entries.clear();
+    this.scheduleSave();
+  }
+
+  /**
+   * Load persisted entries, keeping only fresh ones
+   * @param {string} filePath - Cache file
+   * @returns {Promise<number>} Number of entries loaded
+   */
+  async load(filePath) {
+    this.filePath = filePath;
+    try {
+      const saved = JSON.parse(await fs.readFile(filePath, 'utf8'));
+      for (const [key, entry] of saved.entries || []) {
+        if (entry && typeof entry.reply === 'string' && typeof entry.createdAt === 'number') {
+          this.entries.set(key, entry);
+        }
+      }
+      this.evict();
+    } catch (error) {
+      if (error.code !== 'ENOENT') {
+        console.warn('Ignoring unreadable response cache:', error.message);
+      }
+    }
+    return this.entries.size;
+  }
+
+  /**
+   * Write the cache file shortly after a change, batching bursts of writes
+   * @private
+   */
+  scheduleSave() {
+    if (!this.filePath || this.saveTimer) return;
+    this.saveTimer = setTimeout(() => {
+      this.saveTimer = null;
+      this.save().catch(error => console.warn('Failed to save response cache:', error.message));
+    }, SAVE_DELAY_MS);
+    if (this.saveTimer.unref) this.saveTimer.unref();
+  }
+
+  /**
+   * Write the cache file now
+   * @returns {Promise<void>}
+   */
+  async save() {
+    if (!this.filePath) return;
+    this.evict();
+    const tmpPath = `${this.filePath}.tmp`;
+    await fs.writeFile(tmpPath, JSON.stringify({ version: 1, entries: Array.from(this.entries) }), 'utf8');
+    await fs.rename(tmpPath, this.filePath);
+  }
+}
+
+module.exports = ResponseCache;
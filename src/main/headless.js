@@ -0,0 +1,383 @@
+/**
+ * @fileoverview Headless batch analysis for CI
+ *
+ * `ctrace-gui --headless --analyze <dir> [--jobs N] [--out report.json]
+ * [--fail-on error|warning|never] [-- <ctrace args>]` analyzes every C/C++
+ * translation unit under a directory without creating a window. Each file
+ * goes through the same runCtrace orchestration as the GUI (binary
+ * resolution, socket IPC, WSL bridge on Windows), N files at a time, and
+ * the results are written as one JSON report.
+ *
+ * With --batch-size N (N > 1), small files are packed into multi-input
+ * invocations (see batchPlanner) so process startup is paid once per
+ * batch. It is off by default: inputs a batch's output does not mention
+ * are run again on their own.
+ *
+ * With --changed-since <ref>, one `git diff` picks the translation units
+ * touched by the change (directly or through a changed header) and only
+ * diagnostics in functions overlapping a changed hunk are reported.
+ *
+ * Without ctrace arguments the GUI's defaults are used (stack analyzer,
+ * SARIF output). Output that is neither JSON nor SARIF counts as a failed
+ * file, so a misconfigured run cannot pass as clean.
+ *
+ * Exit codes: 0 clean, 1 findings at or above --fail-on, 2 a file could
+ * not be analyzed or its output not parsed, 64 bad command line.
+ *
+ * Also runs under plain Node: `node src/main/headless.js --analyze <dir>`.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+const fs = require('fs').promises;
+const os = require('os');
+const path = require('path');
+const { collectSourceFiles } = require('./utils/codeIndex');
+const { SarifMerger, isSarifLog } = require('../shared/sarifMerger');
+const { getChangedHunks, affectedTranslationUnits, HunkFilter } = require('./utils/gitDiff');
+const { AnalysisCostModel, BatchPlanner, demultiplex, confirmedInputs } = require('./utils/batchPlanner');
+
+/** Extensions analyzed on their own; headers are covered by their includers */
+const TRANSLATION_UNITS = new Set(['.c', '.cc', '.cpp', '.cxx']);
+
+/** Exit codes */
+const EXIT_OK = 0;
+const EXIT_FINDINGS = 1;
+const EXIT_FAILED = 2;
+const EXIT_USAGE = 64;
+
+/** Severities that fail the run for each --fail-on level */
+const FAILING_SEVERITIES = {
+  error: ['ERROR'],
+  warning: ['ERROR', 'WARNING'],
+  never: []
+};
+
+/** ctrace arguments used when none follow `--`; the GUI's defaults */
+const DEFAULT_CTRACE_ARGS = ['--invoke=ctrace_stack_analyzer', '--sarif-format'];
+
+const USAGE = 'Usage: ctrace-gui --headless --analyze <dir> [--jobs N] [--batch-size N] [--out report.json] [--fail-on error|warning|never] [--changed-since <ref>] [-- <ctrace args>]';
+
+/**
+ * Parse headless options from the command line
+ * @param {Array<string>} argv - process.argv
+ * @returns {Object|null} Options, null when --headless is absent; { error } when invalid
+ */
+function parseHeadlessArgs(argv) {
+  const separator = argv.indexOf('--');
+  const own = separator === -1 ? argv : argv.slice(0, separator);
+  if (!own.includes('--headless') && !own.includes('--analyze')) return null;
+
+  const options = {
+    root: null,
+    jobs: os.cpus().length,
+    batchSize: 1,
+    out: null,
+    failOn: 'error',
+    changedSince: null,
+    ctraceArgs: separator === -1 || separator === argv.length - 1 ? DEFAULT_CTRACE_ARGS : argv.slice(separator + 1)
+  };
+  const valueOf = (flag) => {
+    const index = own.indexOf(flag);
+    return index === -1 ? undefined : own[index + 1];
+  };
+
+  options.root = valueOf('--analyze') || null;
+  if (!options.root) return { error: 'Missing --analyze <dir>' };
+  if (valueOf('--jobs') !== undefined) {
+    options.jobs = parseInt(valueOf('--jobs'), 10);
+    if (!(options.jobs >= 1)) return { error: '--jobs must be a positive number' };
+  }
+  if (valueOf('--batch-size') !== undefined) {
+    options.batchSize = parseInt(valueOf('--batch-size'), 10);
+    if (!(options.batchSize >= 1)) return { error: '--batch-size must be a positive number' };
+  }
+  options.out = valueOf('--out') || null;
+  if (own.includes('--changed-since')) {
+    options.changedSince = valueOf('--changed-since');
+    if (!options.changedSince || options.changedSince.startsWith('-')) return { error: 'Missing --changed-since <ref>' };
+  }
+  if (valueOf('--fail-on') !== undefined) {
+    options.failOn = valueOf('--fail-on');
+    if (!FAILING_SEVERITIES[options.failOn]) return { error: `Unknown --fail-on level: ${options.failOn}` };
+  }
+  return options;
+}
+
+/**
+ * Path as seen by the ctrace binary, which runs in WSL on Windows
+ * @param {string} filePath - Local path
+ * @returns {string} Path to pass to --input
+ */
+function toCtracePath(filePath) {
+  if (os.platform() !== 'win32') return filePath;
+  return filePath.replace(/\\/g, '/').replace(/^([A-Z]):/i, (match, drive) => `/mnt/${drive.toLowerCase()}`);
+}
+
+/**
+ * Interpret the output of one run
+ * @param {string} output - ctrace output
+ * @returns {Object} { meta, functions, diagnostics } for JSON or SARIF, { output } otherwise
+ */
+function parseAnalysisOutput(output) {
+  let data;
+  try {
+    data = JSON.parse(output);
+  } catch (error) {
+    return { meta: null, functions: [], diagnostics: [], output };
+  }
+  if (isSarifLog(data)) {
+    const merger = new SarifMerger();
+    merger.addDocument(data);
+    data = merger.finish();
+  }
+  return { meta: data.meta || null, functions: data.functions || [], diagnostics: data.diagnostics || [] };
+}
+
+/**
+ * Run one ctrace invocation over one or more inputs
+ * @param {Function} runCtrace - Analysis runner
+ * @param {Array<Object>} batch - { ctracePath } of the inputs
+ * @param {Array<string>} ctraceArgs - Extra arguments
+ * @returns {Promise<Object>} { success, output, error }
+ */
+async function invoke(runCtrace, batch, ctraceArgs) {
+  try {
+    return await runCtrace([`--input=${batch.map(input => input.ctracePath).join(',')}`, ...ctraceArgs]);
+  } catch (rejection) {
+    // runCtrace rejects with { success: false, error } for socket and spawn failures
+    return { success: false, error: (rejection && (rejection.error || rejection.message)) || String(rejection) };
+  }
+}
+
+/**
+ * Analyze a directory
+ * @param {Object} options - From parseHeadlessArgs
+ * @param {Object} deps
+ * @param {Function} deps.runCtrace - (args) => Promise<{ success, output, error }>
+ * @param {Function} [deps.onFileDone] - (fileResult, done, total) => void
+ * @param {Function} [deps.getChangedHunks] - (root, ref) => Promise<Map>, for --changed-since
+ * @param {AnalysisCostModel} [deps.costModel] - Timing history of earlier runs
+ * @returns {Promise<Object>} Report
+ */
+async function runBatch(options, deps) {
+  const startedAt = Date.now();
+  const root = path.resolve(options.root);
+  const found = [];
+  await collectSourceFiles(root, found, 0);
+  const sources = found.filter(file => TRANSLATION_UNITS.has(path.extname(file).toLowerCase())).sort();
+
+  let files = sources;
+  let hunkFilter = null;
+  let scope = null;
+  if (options.changedSince) {
+    let hunks;
+    try {
+      hunks = await (deps.getChangedHunks || getChangedHunks)(root, options.changedSince);
+    } catch (error) {
+      throw new Error(`Cannot determine changes since ${options.changedSince}: ${error.message}`);
+    }
+    files = await affectedTranslationUnits(hunks, sources);
+    hunkFilter = new HunkFilter(hunks);
+    scope = { changedSince: options.changedSince, changedFiles: hunks.size, sources: sources.length };
+  }
+
+  const inputs = await Promise.all(files.map(async (file) => {
+    let size = 0;
+    try {
+      size = (await fs.stat(file)).size;
+    } catch (error) {
+      // Still analyzed; ctrace reports the problem for that file
+    }
+    return { path: file, size, ctracePath: toCtracePath(file) };
+  }));
+  const model = deps.costModel || new AnalysisCostModel();
+  const planner = new BatchPlanner(inputs, model, { jobs: options.jobs, maxFiles: options.batchSize });
+  const results = [];
+  let invocations = 0;
+
+  /**
+   * Record the result of one file
+   * @param {Object} input - Planner input
+   * @param {Object} outcome - { analysis }, or { error, output? } when it failed or could not be parsed
+   * @param {number} durationMs - Time spent on the file
+   * @param {number} batchSize - Files in its invocation
+   */
+  const record = async (input, outcome, durationMs, batchSize) => {
+    const entry = { file: path.relative(root, input.path), durationMs, batchSize, success: !outcome.error };
+    if (outcome.analysis) {
+      const { functions, ...analysis } = outcome.analysis;
+      if (hunkFilter) {
+        const kept = await hunkFilter.filter({ functions, diagnostics: analysis.diagnostics }, input.path);
+        entry.outsideChanges = analysis.diagnostics.length - kept.length;
+        analysis.diagnostics = kept;
+      }
+      Object.assign(entry, analysis);
+    } else {
+      entry.error = outcome.error;
+      if (outcome.output !== undefined) {
+        entry.unparsed = true;
+        entry.output = outcome.output;
+      }
+    }
+    results.push(entry);
+    if (deps.onFileDone) deps.onFileDone(entry, results.length, inputs.length);
+  };
+
+  const lane = async () => {
+    let batch;
+    while ((batch = planner.next()) !== null) {
+      invocations++;
+      const started = Date.now();
+      const result = await invoke(deps.runCtrace, batch, options.ctraceArgs);
+      const durationMs = Date.now() - started;
+      const analysis = result.success ? parseAnalysisOutput(result.output || '') : null;
+
+      if (batch.length === 1) {
+        if (analysis) model.observe(batch, durationMs);
+        let outcome = { analysis };
+        if (!analysis) {
+          outcome = { error: result.error || 'Unknown error' };
+        } else if (analysis.output !== undefined) {
+          outcome = { error: 'ctrace output is neither JSON nor SARIF', output: analysis.output };
+        }
+        await record(batch[0], outcome, durationMs, 1);
+      } else if (!analysis || analysis.output !== undefined) {
+        // A failed batch is retried file by file so one bad input does not
+        // fail the rest; output that cannot be split per file means this
+        // ctrace does not take several inputs, so stop batching
+        if (analysis) planner.disableBatching();
+        planner.requeue(batch);
+      } else {
+        const times = model.observe(batch, durationMs);
+        // Inputs missing from the output may not have been analyzed at all
+        const confirmed = confirmedInputs(analysis, batch);
+        const accepted = batch.filter((input, i) => confirmed[i]);
+        planner.requeue(batch.filter((input, i) => !confirmed[i]));
+        const parts = demultiplex(analysis, accepted);
+        for (let i = 0; i < accepted.length; i++) {
+          await record(accepted[i], { analysis: parts[i] }, Math.round(times[batch.indexOf(accepted[i])]), batch.length);
+        }
+      }
+    }
+  };
+  await Promise.all(Array.from({ length: Math.min(options.jobs, inputs.length) }, lane));
+  results.sort((a, b) => (a.file < b.file ? -1 : a.file > b.file ? 1 : 0));
+
+  const bySeverity = {};
+  let diagnostics = 0;
+  for (const entry of results) {
+    for (const diag of entry.diagnostics || []) {
+      bySeverity[diag.severity] = (bySeverity[diag.severity] || 0) + 1;
+      diagnostics++;
+    }
+  }
+  return {
+    root,
+    jobs: options.jobs,
+    ...(scope && { scope }),
+    startedAt: new Date(startedAt).toISOString(),
+    durationMs: Date.now() - startedAt,
+    summary: {
+      files: results.length,
+      invocations,
+      failed: results.filter(entry => !entry.success).length,
+      unparsed: results.filter(entry => entry.unparsed).length,
+      diagnostics,
+      bySeverity
+    },
+    files: results
+  };
+}
+
+/**
+ * @param {Object} report - From runBatch
+ * @param {string} failOn - 'error', 'warning' or 'never'
+ * @returns {number} Process exit code
+ */
+function exitCodeFor(report, failOn) {
+  if (report.summary.failed > 0) return EXIT_FAILED;
+  const failing = FAILING_SEVERITIES[failOn] || [];
+  return failing.some(severity => report.summary.bySeverity[severity] > 0) ? EXIT_FINDINGS : EXIT_OK;
+}
+
+/**
+ * Run headless analysis and report on stdout/stderr
+ * @param {Object} options - From parseHeadlessArgs
+ * @param {Function} runCtrace - Analysis runner
+ * @param {string} [historyPath] - File keeping analysis timings between runs
+ * @returns {Promise<number>} Exit code
+ */
+async function runHeadless(options, runCtrace, historyPath) {
+  if (options.error) {
+    process.stderr.write(`${options.error}\n${USAGE}\n`);
+    return EXIT_USAGE;
+  }
+  try {
+    const stat = await fs.stat(options.root);
+    if (!stat.isDirectory()) throw new Error('not a directory');
+  } catch (error) {
+    process.stderr.write(`Cannot analyze ${options.root}: ${error.message}\n`);
+    return EXIT_USAGE;
+  }
+
+  const costModel = new AnalysisCostModel();
+  if (historyPath) await costModel.load(historyPath);
+
+  let report;
+  try {
+    report = await runBatch(options, {
+      runCtrace,
+      costModel,
+      onFileDone: (entry, done, total) => {
+        const status = entry.success ? `${(entry.diagnostics || []).length} diagnostics` : `FAILED: ${entry.error}`;
+        process.stderr.write(`[${done}/${total}] ${entry.file}: ${status} (${entry.durationMs} ms)\n`);
+      }
+    });
+  } catch (error) {
+    process.stderr.write(`Headless analysis failed: ${error.message}\n`);
+    return EXIT_FAILED;
+  }
+  try {
+    await costModel.save();
+  } catch (error) {
+    process.stderr.write(`Cannot save analysis history: ${error.message}\n`);
+  }
+  const json = JSON.stringify(report, null, 2);
+  if (options.out) {
+    try {
+      await fs.writeFile(options.out, json);
+    } catch (error) {
+      // Exit code 1 means findings; a lost report is a failed run
+      process.stderr.write(`Cannot write report to ${options.out}: ${error.message}\n`);
+      return EXIT_FAILED;
+    }
+  } else {
+    process.stdout.write(`${json}\n`);
+  }
+
+  const { summary } = report;
+  if (report.scope) {
+    process.stderr.write(`${report.scope.changedFiles} files changed since ${report.scope.changedSince}; ` +
+      `${summary.files} of ${report.scope.sources} translation units affected\n`);
+  }
+  const severities = Object.entries(summary.bySeverity).map(([severity, count]) => `${count} ${severity}`).join(', ');
+  process.stderr.write(`Analyzed ${summary.files} files in ${report.durationMs} ms with ${options.jobs} jobs ` +
+    `(${summary.invocations} ctrace runs): ` +
+    `${summary.failed} failed (${summary.unparsed} unparsed), ${summary.diagnostics} diagnostics${severities ? ` (${severities})` : ''}\n`);
+  return exitCodeFor(report, options.failOn);
+}
+
+module.exports = { parseHeadlessArgs, parseAnalysisOutput, runBatch, exitCodeFor, runHeadless, USAGE, DEFAULT_CTRACE_ARGS };
+
+if (require.main === module) {
+  require('./utils/logger').consoleSink.setLevel('error');
+  const { runCtrace } = require('./ipc/ctraceHandlers');
+  runHeadless(parseHeadlessArgs(process.argv) || { error: 'Missing --analyze <dir>' }, runCtrace)
+    .then(code => process.exit(code))
+    .catch(error => {
+      process.stderr.write(`Headless analysis failed: ${error.message}\n`);
+      process.exit(EXIT_FAILED);
+    });
+}
@@ -8,15 +8,62 @@
  * @version 1.0.0
  */
 
-const { ipcMain } = require('electron');
+const electron = require('electron');
+const { ipcMain } = electron;
+const path = require('path');
 const https = require('https');
 const http = require('http');
 const providerRegistry = require('../external_llm/ProviderRegistry');
+const ConversationManager = require('../external_llm/ConversationManager');
+const ResponseCache = require('../external_llm/ResponseCache');
+const ProviderRouter = require('../external_llm/ProviderRouter');
+const { BulkExplainer, TokenBucket, packBatches, parseRetryAfter } = require('../external_llm/BulkExplainer');
+const codeIndex = require('../utils/codeIndex');
+const SequencePool = require('../utils/SequencePool');
+const { resolveCpuSettings, toContextOptions, runAutotune, ProfileStore } = require('../utils/inferenceTuning');
+const os = require('os');
+const log = require('../utils/logger').getLogger('assistant');
 
-// Local GGUF state
+// Multi-turn memory for every provider; local requests replay it into
+// whichever pooled context sequence serves them
+const conversations = new ConversationManager();
+
+// Replies keyed by provider, model, prompt and context; identical
+// concurrent requests share one provider call
+const responseCache = new ResponseCache();
+let responseCacheLoaded = false;
+
+// Latency statistics and hedging across the configured external providers
+const providerRouter = new ProviderRouter(providerRegistry);
+
+// Bulk explanation jobs by id, and token buckets shared by all jobs of a provider
+const explainJobs = new Map();
+const explainBuckets = new Map();
+const DEFAULT_TOKENS_PER_MINUTE = 40000;
+const DEFAULT_BULK_CONCURRENCY = { external: 4, ollama: 2 };
+
+// Persistent connections to Ollama so chat, preload and model listing skip
+// the TCP (and TLS) handshake after the first request
+const ollamaAgents = {
+  'http:': new http.Agent({ keepAlive: true, maxSockets: 4 }),
+  'https:': new https.Agent({ keepAlive: true, maxSockets: 4 })
+};
+const DEFAULT_OLLAMA_MODEL = 'llama2';
+const DEFAULT_OLLAMA_KEEP_ALIVE = '30m';
+
+// Preloads in progress, keyed by host and model
+const ollamaPreloads = new Map();
+
+// Local GGUF state: { model, context, pool } with one pooled sequence per parallel request
 let localLLM = null;
 let loadedModelPath = null;
 let loadedGpuLayers = null;
+// Sequences, context size and CPU settings the model was loaded with
+let loadedSignature = null;
+// Autotuned CPU settings per model file (created once userData is known)
+let profileStore = null;
+// Load in progress, shared by requests that arrive while the model loads
+let localLoading = null;
 
 /**
  * Setup IPC handlers for assistant chat
@@ -25,18 +72,52 @@ let loadedGpuLayers = null;
 function setupAssistantHandlers(mainWindow) {
   /**
    * Handle assistant chat request
-   * Input: { provider, message, config }
+   * Input: { provider, message, config, diagnostics, diagnosticsFile }
    * config contains: provider-specific configuration
+   * diagnostics: ctrace diagnostics matching the question, picked by the results panel
    */
-  ipcMain.handle('assistant-chat', async (event, { provider, message, config }) => {
+  ipcMain.handle('assistant-chat', async (event, { provider, message, config, diagnostics, diagnosticsFile }) => {
     try {
-      if (provider === 'ollama') {
-        return await handleOllamaChat(message, config);
-      } else if (provider === 'external') {
-        // Use modular provider system for external APIs
-        return await handleModularProvider(message, config);
-      } else if (provider === 'local') {
-        return await handleLocalChat(message, config);
+      // Workspace code and diagnostics retrieved for this question only;
+      // the conversation memory keeps the plain message
+      const prompt = await withRetrievedContext(message, config, diagnostics, diagnosticsFile);
+      await prepareResponseCache(config);
+
+      if (provider === 'ollama' || provider === 'external' || provider === 'local') {
+        const key = ConversationManager.keyFor(provider, config);
+        const context = conversations.buildContext(key, config.systemPrompt, config);
+        context.cacheKey = `ctrace-${key}`;
+
+        const result = await withResponseCache(config, cacheKeyParts(provider, config, {
+          systemPrompt: context.systemPrompt,
+          message: prompt,
+          context: context.history
+        }), async () => {
+          let reply;
+          if (provider === 'ollama') {
+            reply = await handleOllamaChat(prompt, config, context);
+          } else if (provider === 'local') {
+            reply = await handleLocalChat(prompt, config, { ...context, clientId: 'chat', conversationKey: key, userMessage: message });
+          } else {
+            // Use modular provider system for external APIs
+            reply = await handleModularProvider(prompt, config, context);
+            // The key names the configured provider; a fallback's answer is not its answer
+            if (reply.providerKey && reply.providerKey !== ProviderRouter.keyFor({ id: config.providerId || 'openai', config })) {
+              reply.cacheable = false;
+            }
+          }
+          // Once per provider call: callers joining this request share the turn
+          if (reply.success) {
+            conversations.recordTurn(key, message, reply.reply);
+          }
+          return reply;
+        });
+
+        // A stored reply did not go through the fetcher
+        if (result.success && result.cached) {
+          conversations.recordTurn(key, message, result.reply);
+        }
+        return result;
       } else {
         return {
           success: false,
@@ -44,7 +125,7 @@ function setupAssistantHandlers(mainWindow) {
         };
       }
     } catch (error) {
-      console.error('Error in assistant-chat handler:', error);
+      log.error('Error in assistant-chat handler', error);
       return {
         success: false,
         error: error.message || 'Unknown error'
@@ -52,6 +133,122 @@ function setupAssistantHandlers(mainWindow) {
     }
   });
 
+  /**
+   * Forget the conversation history (all providers when none is given)
+   */
+  ipcMain.handle('assistant-clear-conversation', async (event, { provider, config } = {}) => {
+    conversations.clear(provider ? ConversationManager.keyFor(provider, config) : undefined);
+    return { success: true };
+  });
+
+  /**
+   * Drop all cached assistant replies
+   */
+  ipcMain.handle('assistant-clear-response-cache', async () => {
+    responseCache.clear();
+    return { success: true };
+  });
+
+  /**
+   * Explain many diagnostics in batched requests.
+   * Input: { provider, config, groups, jobId } where groups comes from
+   * DiagnosticsManager.groupDiagnostics. Results are streamed to the renderer
+   * on 'assistant-explain-progress' as each batch completes.
+   */
+  ipcMain.handle('assistant-explain-diagnostics', async (event, { provider, config, groups, jobId }) => {
+    try {
+      if (!['ollama', 'external', 'local'].includes(provider)) {
+        return { success: false, error: 'Unknown provider or assistant not configured' };
+      }
+      await prepareResponseCache(config);
+
+      const batches = packBatches(groups, {
+        batchSize: parseInt(config.bulkBatchSize, 10) || undefined,
+        batchTokens: parseInt(config.bulkBatchTokens, 10) || undefined
+      });
+      const total = batches.reduce((sum, batch) => sum + batch.items.length, 0);
+      let completed = 0;
+
+      const explainer = new BulkExplainer({
+        send: (prompt) => sendExplainPrompt(provider, config, prompt),
+        bucket: getExplainBucket(provider, config),
+        concurrency: parseInt(config.bulkConcurrency, 10) || DEFAULT_BULK_CONCURRENCY[provider] || getLocalSequenceCount(config),
+        outputTokens: parseInt(config.maxTokens, 10) || 500,
+        onResult: (results) => {
+          completed += results.length;
+          if (!event.sender.isDestroyed()) {
+            event.sender.send('assistant-explain-progress', { jobId, results, completed, total });
+          }
+        }
+      });
+
+      explainJobs.set(jobId, explainer);
+      try {
+        const summary = await explainer.run(batches);
+        log.info(`Explained ${summary.explained}/${total} diagnostics in ${batches.length} batches (${summary.elapsedMs} ms, ${summary.retries} retries)`);
+        return { success: true, total, batches: batches.length, ...summary };
+      } finally {
+        explainJobs.delete(jobId);
+      }
+    } catch (error) {
+      log.error('Error explaining diagnostics', error);
+      return { success: false, error: error.message || 'Unknown error' };
+    }
+  });
+
+  /**
+   * Stop a bulk explanation job after the batches already in flight
+   */
+  ipcMain.handle('assistant-explain-cancel', async (event, { jobId } = {}) => {
+    const explainer = explainJobs.get(jobId);
+    if (explainer) explainer.cancel();
+    return { success: true, cancelled: Boolean(explainer) };
+  });
+
+  /**
+   * Load the configured Ollama model in the background so the first question
+   * does not pay the cold-load cost
+   */
+  ipcMain.handle('assistant-ollama-preload', async (event, { config } = {}) => {
+    return preloadOllamaModel(config || {});
+  });
+
+  /**
+   * List models installed on the Ollama server, with the model used when none is configured
+   */
+  ipcMain.handle('assistant-ollama-models', async (event, { config } = {}) => {
+    try {
+      const { status, data } = await ollamaRequest(config || {}, 'GET', '/api/tags', null, 10000);
+      if (status !== 200) {
+        return { success: false, error: `Ollama returned HTTP ${status}` };
+      }
+      return { success: true, models: (data.models || []).map(model => model.name), defaultModel: DEFAULT_OLLAMA_MODEL };
+    } catch (error) {
+      return { success: false, error: 'Ollama request failed: ' + error.message };
+    }
+  });
+
+  /**
+   * Check that the Ollama server is reachable
+   */
+  ipcMain.handle('assistant-ollama-health', async (event, { config } = {}) => {
+    try {
+      const { status, data } = await ollamaRequest(config || {}, 'GET', '/api/version', null, 5000);
+      return status === 200
+        ? { success: true, version: data.version }
+        : { success: false, error: `Ollama returned HTTP ${status}` };
+    } catch (error) {
+      return { success: false, error: 'Ollama request failed: ' + error.message };
+    }
+  });
+
+  /**
+   * Get per-provider latency statistics used for routing
+   */
+  ipcMain.handle('assistant-get-routing-stats', async () => {
+    return { success: true, stats: providerRouter.getSummary() };
+  });
+
   /**
    * Get list of available providers
    */
@@ -62,7 +259,7 @@ function setupAssistantHandlers(mainWindow) {
         providers: providerRegistry.getAllProviders()
       };
     } catch (error) {
-      console.error('Error getting providers:', error);
+      log.error('Error getting providers', error);
       return {
         success: false,
         error: error.message
@@ -78,7 +275,7 @@ function setupAssistantHandlers(mainWindow) {
       const provider = providerRegistry.createProvider(providerId, config);
       return await provider.testConnection();
     } catch (error) {
-      console.error('Error testing provider:', error);
+      log.error('Error testing provider', error);
       return {
         success: false,
         error: error.message
@@ -86,64 +283,264 @@ function setupAssistantHandlers(mainWindow) {
     }
   });
 
+  /**
+   * Benchmark CPU settings for the local model and save the fastest as its
+   * profile. Progress is sent on 'assistant-autotune-progress'.
+   */
+  ipcMain.handle('assistant-local-autotune', async (event, { config } = {}) => {
+    if (!config || !config.localModelPath) {
+      return { success: false, error: 'Local model path is required' };
+    }
+    try {
+      const { model } = await ensureLocalModel({ ...config, localParallelSequences: 1 });
+      const { best, results } = await runAutotune(model, {
+        onProgress: (progress) => {
+          if (!event.sender.isDestroyed()) event.sender.send('assistant-autotune-progress', progress);
+        }
+      });
+      if (!best) {
+        return { success: false, error: 'No setting could be benchmarked', results };
+      }
+
+      const profile = {
+        settings: best.settings,
+        promptTokensPerSecond: best.promptTokensPerSecond,
+        generationTokensPerSecond: best.generationTokensPerSecond,
+        tunedAt: new Date().toISOString()
+      };
+      const store = getProfileStore();
+      if (store) await store.set(config.localModelPath, profile);
+      log.info('Autotune best settings', profile);
+
+      // Reload with the new profile on the next request
+      await disposeLocalModel();
+      return { success: true, profile, results };
+    } catch (error) {
+      log.error('Error during local model autotune', error);
+      return { success: false, error: 'Autotune failed: ' + error.message };
+    }
+  });
+
+  /**
+   * Report the local model's sequence pool: { loaded, size, busy, queued }
+   */
+  ipcMain.handle('assistant-local-status', async () => {
+    if (!localLLM) return { success: true, loaded: false };
+    return { success: true, loaded: true, modelPath: loadedModelPath, ...localLLM.pool.getStatus() };
+  });
+
   /**
    * Unload local model when requested
    */
   ipcMain.handle('assistant-unload-local', async () => {
     try {
-      if (localLLM) {
-        if (localLLM.context) await localLLM.context.dispose();
-        if (localLLM.model) await localLLM.model.dispose();
-        localLLM = null;
-        loadedModelPath = null;
-        loadedGpuLayers = null;
-        return { success: true };
-      }
+      await disposeLocalModel();
       return { success: true };
     } catch (error) {
-      console.error('Error unloading local model:', error);
+      log.error('Error unloading local model', error);
       return { success: false, error: error.message };
     }
   });
 }
 
 /**
- * Handle Ollama chat request
+ * Apply cache settings and, when persistence is enabled, load the cache file once
+ * @param {Object} config - Config (responseCacheSize, responseCacheTtlMinutes, persistResponseCache)
+ * @returns {Promise<void>}
+ */
+async function prepareResponseCache(config) {
+  responseCache.configure(config);
+  if (!config.persistResponseCache || responseCacheLoaded || !electron.app) {
+    return;
+  }
+  responseCacheLoaded = true;
+  const filePath = path.join(electron.app.getPath('userData'), 'assistant-response-cache.json');
+  const loaded = await responseCache.load(filePath);
+  log.info(`Loaded ${loaded} cached assistant replies`);
+}
+
+/**
+ * Serve a request from the response cache or run it through the cache
+ * @param {Object} config - Config (responseCache: false bypasses the cache)
+ * @param {Object} keyParts - From cacheKeyParts
+ * @param {Function} fetcher - Async function performing the provider call
+ * @returns {Promise<Object>} Provider result
+ */
+async function withResponseCache(config, keyParts, fetcher) {
+  if (config.responseCache === false) {
+    return fetcher();
+  }
+  return responseCache.run(ResponseCache.keyFor(keyParts), fetcher);
+}
+
+/**
+ * Response cache key parts of a request. Chat and bulk explanations share
+ * this, so every setting that changes a reply is part of both keys.
+ * @param {string} provider - 'ollama', 'external' or 'local'
+ * @param {Object} config - Assistant configuration
+ * @param {Object} request - { systemPrompt, message, context }
+ * @returns {Object} { provider, model, temperature, maxTokens, systemPrompt, message, context }
+ */
+function cacheKeyParts(provider, config, request) {
+  return {
+    provider: ConversationManager.keyFor(provider, config),
+    model: getModelName(provider, config),
+    temperature: config.temperature,
+    maxTokens: config.maxTokens,
+    ...request
+  };
+}
+
+/**
+ * Name of the model a request will use, for cache keys
+ * @param {string} provider - 'ollama', 'external' or 'local'
+ * @param {Object} config - Assistant configuration
+ * @returns {string} Model identifier
+ */
+function getModelName(provider, config) {
+  if (provider === 'ollama') return getOllamaSettings(config).model;
+  if (provider === 'local') return `${config.localModelPath}|${config.contextSize || ''}`;
+  return config.model || '';
+}
+
+/**
+ * Append workspace code retrieved from the local index to a message
  * @param {string} message - User message
- * @param {Object} config - Config with ollamaHost
- * @returns {Promise<Object>}
+ * @param {Object} config - Config (autoContext: false disables, contextTokenBudget sets the budget)
+ * @param {Array<Object>} diagnostics - Current ctrace diagnostics
+ * @param {string} diagnosticsFile - File the diagnostics belong to
+ * @returns {Promise<string>} Message to send
  */
-async function handleOllamaChat(message, config) {
-  const host = config.ollamaHost || 'http://localhost:11434';
-  const url = new URL('/api/chat', host);
-  
-  const messages = [];
-  
-  // Add system prompt if provided
-  if (config.systemPrompt) {
-    messages.push({ role: 'system', content: config.systemPrompt });
+async function withRetrievedContext(message, config, diagnostics, diagnosticsFile) {
+  if (config.autoContext === false || codeIndex.docs.size === 0) {
+    return message;
   }
-  
-  messages.push({ role: 'user', content: message });
-  
-  const body = JSON.stringify({
-    model: 'llama2', // default model, can be made configurable
-    messages: messages,
-    stream: false
+  try {
+    const retrieved = await codeIndex.buildContext(message, {
+      tokenBudget: parseInt(config.contextTokenBudget, 10) || 1500,
+      diagnostics: Array.isArray(diagnostics) ? diagnostics : [],
+      diagnosticsFile
+    });
+    if (!retrieved.text) return message;
+    log.debug(() => `Retrieved ${retrieved.functions.length} functions, ${retrieved.diagnostics} diagnostics (search ${retrieved.searchMs.toFixed(1)} ms)`);
+    return `${message}\n\n[Context - Related workspace code]:\n${retrieved.text}`;
+  } catch (error) {
+    log.error('Error retrieving workspace context', error);
+    return message;
+  }
+}
+
+/**
+ * Token bucket for a provider's bulk requests; local models are not rate limited
+ * @param {string} provider - 'ollama', 'external' or 'local'
+ * @param {Object} config - Config (rateLimitTokensPerMinute overrides the default)
+ * @returns {TokenBucket|null} Shared bucket
+ */
+function getExplainBucket(provider, config) {
+  if (provider !== 'external') return null;
+  const key = ConversationManager.keyFor(provider, config);
+  const rate = parseInt(config.rateLimitTokensPerMinute, 10) || DEFAULT_TOKENS_PER_MINUTE;
+  let bucket = explainBuckets.get(key);
+  if (!bucket) {
+    bucket = new TokenBucket(rate);
+    explainBuckets.set(key, bucket);
+  } else if (bucket.capacity !== rate) {
+    bucket.setRate(rate);
+  }
+  return bucket;
+}
+
+/**
+ * Send one bulk explanation prompt, without conversation history.
+ * External providers report the HTTP status and retry-after for backoff.
+ * @param {string} provider - 'ollama', 'external' or 'local'
+ * @param {Object} config - Assistant configuration
+ * @param {string} prompt - Batch prompt
+ * @returns {Promise<Object>} { success, reply, error, status, retryAfterMs, retryable }
+ */
+async function sendExplainPrompt(provider, config, prompt) {
+  const keyParts = cacheKeyParts(provider, config, { systemPrompt: config.systemPrompt, message: prompt });
+  let status;
+  let retryAfterMs = null;
+
+  const result = await withResponseCache(config, keyParts, async () => {
+    if (provider === 'ollama') {
+      return handleOllamaChat(prompt, config, { systemPrompt: config.systemPrompt });
+    }
+    if (provider === 'local') {
+      return handleLocalChat(prompt, config, { systemPrompt: config.systemPrompt, clientId: 'explain' });
+    }
+    const instance = providerRegistry.createProvider(config.providerId || 'openai', config);
+    const validation = instance.validateConfig(config);
+    if (!validation.valid) {
+      return { success: false, error: 'Configuration error: ' + validation.errors.join(', ') };
+    }
+    return instance.chat(prompt, {
+      systemPrompt: config.systemPrompt,
+      temperature: config.temperature,
+      maxTokens: config.maxTokens,
+      onResponse: (statusCode, headers) => {
+        status = statusCode;
+        retryAfterMs = parseRetryAfter(headers['retry-after']);
+      }
+    });
   });
 
-  return new Promise((resolve) => {
+  if (result.success) return result;
+  return {
+    ...result,
+    status,
+    retryAfterMs,
+    // No response at all: connection errors and timeouts are worth retrying
+    retryable: status === undefined && /request failed|timed out/i.test(result.error || '')
+  };
+}
+
+/**
+ * Resolve the Ollama model and keep_alive from the config
+ * @param {Object} config - Config with ollamaModel and ollamaKeepAlive
+ * @returns {Object} { model, keepAlive } where keepAlive is a duration string or seconds
+ */
+function getOllamaSettings(config) {
+  const model = (config.ollamaModel || '').trim() || DEFAULT_OLLAMA_MODEL;
+  let keepAlive = config.ollamaKeepAlive;
+  if (keepAlive === undefined || keepAlive === null || String(keepAlive).trim() === '') {
+    keepAlive = DEFAULT_OLLAMA_KEEP_ALIVE;
+  } else if (/^-?\d+$/.test(String(keepAlive).trim())) {
+    // Plain numbers are seconds; -1 keeps the model loaded indefinitely
+    keepAlive = parseInt(keepAlive, 10);
+  } else {
+    keepAlive = String(keepAlive).trim();
+  }
+  return { model, keepAlive };
+}
+
+/**
+ * Send a JSON request to the Ollama server over the keep-alive agent
+ * @param {Object} config - Config with ollamaHost
+ * @param {string} method - HTTP method
+ * @param {string} pathname - API path such as '/api/chat'
+ * @param {Object|null} payload - JSON body
+ * @param {number} timeout - Socket timeout in milliseconds
+ * @returns {Promise<Object>} { status, data } with the parsed body; rejects on network errors
+ */
+function ollamaRequest(config, method, pathname, payload, timeout = 60000) {
+  const url = new URL(pathname, config.ollamaHost || 'http://localhost:11434');
+  const body = payload ? JSON.stringify(payload) : null;
+
+  return new Promise((resolve, reject) => {
     const protocol = url.protocol === 'https:' ? https : http;
     const options = {
       hostname: url.hostname,
       port: url.port || (url.protocol === 'https:' ? 443 : 80),
       path: url.pathname,
-      method: 'POST',
-      headers: {
+      method,
+      agent: ollamaAgents[url.protocol],
+      headers: body ? {
         'Content-Type': 'application/json',
         'Content-Length': Buffer.byteLength(body)
-      },
-      timeout: 60000
+      } : {},
+      timeout
     };
 
     const req = protocol.request(options, (res) => {
@@ -151,62 +548,128 @@ async function handleOllamaChat(message, config) {
       res.on('data', (chunk) => { data += chunk; });
       res.on('end', () => {
         try {
-          const parsed = JSON.parse(data);
-          if (parsed.message && parsed.message.content) {
-            resolve({ success: true, reply: parsed.message.content });
-          } else {
-            resolve({ success: false, error: 'Invalid response from Ollama' });
-          }
+          resolve({ status: res.statusCode, data: data ? JSON.parse(data) : {} });
         } catch (err) {
-          resolve({ success: false, error: 'Failed to parse Ollama response: ' + err.message });
+          reject(new Error('Failed to parse Ollama response: ' + err.message));
         }
       });
     });
 
-    req.on('error', (err) => {
-      resolve({ success: false, error: 'Ollama request failed: ' + err.message });
-    });
-
+    req.on('error', reject);
     req.on('timeout', () => {
-      req.destroy();
-      resolve({ success: false, error: 'Ollama request timed out' });
+      req.destroy(new Error('timed out'));
     });
 
-    req.write(body);
+    if (body) req.write(body);
     req.end();
   });
 }
 
 /**
- * Handle external API chat using modular provider system
+ * Make sure the configured Ollama model is resident, loading it if needed.
+ * Concurrent calls for the same model share one load.
+ * @param {Object} config - Config with ollamaHost, ollamaModel and ollamaKeepAlive
+ * @returns {Promise<Object>} { success, model, alreadyLoaded, elapsedMs }
+ */
+function preloadOllamaModel(config) {
+  const { model, keepAlive } = getOllamaSettings(config);
+  const key = `${config.ollamaHost || ''}|${model}`;
+  if (ollamaPreloads.has(key)) {
+    return ollamaPreloads.get(key);
+  }
+
+  const started = Date.now();
+  const preload = (async () => {
+    try {
+      const running = await ollamaRequest(config, 'GET', '/api/ps', null, 5000);
+      const names = running.status === 200 ? (running.data.models || []).map(m => m.name) : [];
+      if (names.includes(model) || names.includes(`${model}:latest`)) {
+        return { success: true, model, alreadyLoaded: true, elapsedMs: Date.now() - started };
+      }
+
+      // A generate request without a prompt only loads the model
+      const { status, data } = await ollamaRequest(config, 'POST', '/api/generate', { model, keep_alive: keepAlive, stream: false }, 300000);
+      if (status !== 200) {
+        return { success: false, model, error: (data && data.error) || `Ollama returned HTTP ${status}` };
+      }
+      return { success: true, model, alreadyLoaded: false, elapsedMs: Date.now() - started };
+    } catch (error) {
+      return { success: false, model, error: 'Ollama preload failed: ' + error.message };
+    } finally {
+      ollamaPreloads.delete(key);
+    }
+  })();
+  ollamaPreloads.set(key, preload);
+  return preload;
+}
+
+/**
+ * Handle Ollama chat request
  * @param {string} message - User message
- * @param {Object} config - Config with providerId and provider-specific settings
+ * @param {Object} config - Config with ollamaHost, ollamaModel and ollamaKeepAlive
+ * @param {Object} context - Conversation context { systemPrompt, history }
  * @returns {Promise<Object>}
  */
-async function handleModularProvider(message, config) {
-  const providerId = config.providerId || 'openai';
+async function handleOllamaChat(message, config, context = {}) {
+  const { model, keepAlive } = getOllamaSettings(config);
+  const messages = [];
+  
+  // Add system prompt if provided
+  if (context.systemPrompt) {
+    messages.push({ role: 'system', content: context.systemPrompt });
+  }
   
+  // Replay earlier turns so Ollama can reuse its KV cache for the shared prefix
+  messages.push(...(context.history || []));
+  messages.push({ role: 'user', content: message });
+
   try {
-    // Create provider instance
-    const provider = providerRegistry.createProvider(providerId, config);
-    
-    // Validate configuration
-    const validation = provider.validateConfig(config);
-    if (!validation.valid) {
-      return {
-        success: false,
-        error: 'Configuration error: ' + validation.errors.join(', ')
-      };
+    const { data } = await ollamaRequest(config, 'POST', '/api/chat', {
+      model,
+      messages: messages,
+      stream: false,
+      keep_alive: keepAlive
+    });
+    if (data.message && data.message.content) {
+      return { success: true, reply: data.message.content };
     }
-    
-    // Send chat message
-    return await provider.chat(message, {
-      systemPrompt: config.systemPrompt,
+    return { success: false, error: data.error ? `Ollama error: ${data.error}` : 'Invalid response from Ollama' };
+  } catch (err) {
+    if (err.message === 'timed out') {
+      return { success: false, error: 'Ollama request timed out' };
+    }
+    return { success: false, error: 'Ollama request failed: ' + err.message };
+  }
+}
+
+/**
+ * Handle external API chat using modular provider system.
+ * config.fallbackProviders ([{ providerId, ...settings }]) adds providers the
+ * router may prefer or hedge to when the configured one is slow.
+ * @param {string} message - User message
+ * @param {Object} config - Config with providerId and provider-specific settings
+ * @param {Object} context - Conversation context { systemPrompt, history, cacheKey }
+ * @returns {Promise<Object>}
+ */
+async function handleModularProvider(message, config, context = {}) {
+  const candidates = [{ id: config.providerId || 'openai', config }];
+  for (const fallback of Array.isArray(config.fallbackProviders) ? config.fallbackProviders : []) {
+    if (fallback && fallback.providerId) {
+      candidates.push({ id: fallback.providerId, config: fallback });
+    }
+  }
+  
+  try {
+    // Send chat message to the fastest provider, hedging when it stalls
+    return await providerRouter.chat(candidates, message, {
+      systemPrompt: context.systemPrompt,
+      history: context.history,
+      cacheKey: context.cacheKey,
       temperature: config.temperature,
       maxTokens: config.maxTokens
-    });
+    }, config);
   } catch (error) {
-    console.error('Error with modular provider:', error);
+    log.error('Error with modular provider', error);
     return {
       success: false,
       error: error.message || 'Provider error'
@@ -215,133 +678,235 @@ async function handleModularProvider(message, config) {
 }
 
 /**
- * Handle local GGUF model chat using node-llama-cpp
- * @param {string} message - User message
- * @param {Object} config - Config with localModelPath and gpuLayers
- * @returns {Promise<Object>}
+ * Number of context sequences (parallel local requests) to create
+ * @param {Object} config - Config with localParallelSequences
+ * @returns {number} Sequence count
+ */
+function getLocalSequenceCount(config) {
+  const configured = parseInt(config.localParallelSequences, 10);
+  if (configured > 0) return configured;
+  // Each sequence costs KV-cache memory; a few already keep the CPU busy
+  return Math.max(1, Math.min(4, Math.floor(os.cpus().length / 4)));
+}
+
+/**
+ * Dispose the loaded local model, failing queued requests
+ * @returns {Promise<void>}
+ */
+async function disposeLocalModel() {
+  const current = localLLM;
+  localLLM = null;
+  loadedModelPath = null;
+  loadedGpuLayers = null;
+  loadedSignature = null;
+  if (!current) return;
+
+  current.pool.close();
+  try {
+    if (current.context) await current.context.dispose();
+    if (current.model) await current.model.dispose();
+  } catch (disposeErr) {
+    log.warn('Error during disposal', disposeErr);
+  }
+}
+
+/**
+ * Profile store in userData, or null outside Electron
+ * @returns {ProfileStore|null}
+ */
+function getProfileStore() {
+  if (!profileStore && electron.app) {
+    profileStore = new ProfileStore(path.join(electron.app.getPath('userData'), 'local-model-profiles.json'));
+  }
+  return profileStore;
+}
+
+/**
+ * Load the local model and its sequence pool unless already loaded with the same settings
+ * @param {Object} config - Config with localModelPath, gpuLayers, contextSize, localParallelSequences
+ *   and the CPU settings cpuThreads, batchSize, useMmap, useMlock, kvCacheType
+ * @returns {Promise<Object>} Loaded state { model, context, pool, settings }
  */
-async function handleLocalChat(message, config) {
+async function ensureLocalModel(config) {
   const modelPath = config.localModelPath;
+  // Get GPU layers setting (default to 0 if not specified)
+  const gpuLayers = config.gpuLayers !== undefined && config.gpuLayers !== null ? config.gpuLayers : 0;
+  // Get context size setting (default to 8192 if not specified)
+  const contextSize = config.contextSize !== undefined && config.contextSize !== null ? config.contextSize : 8192;
+  const sequences = getLocalSequenceCount(config);
+  // Explicit settings win over the autotuned profile for this model file
+  const store = getProfileStore();
+  const settings = resolveCpuSettings(config, store ? await store.get(modelPath) : null);
+  const signature = JSON.stringify({ sequences, contextSize, settings });
 
-  if (!modelPath) {
-    return { success: false, error: 'Local model path is required' };
+  if (localLLM && loadedModelPath === modelPath && loadedGpuLayers === gpuLayers && loadedSignature === signature) {
+    return localLLM;
+  }
+  if (localLoading) {
+    await localLoading.catch(() => {});
+    return ensureLocalModel(config);
   }
 
-  try {
+  localLoading = (async () => {
+    // Dispose old instance if any
+    if (localLLM) {
+      log.debug('Disposing previous model instance');
+      await disposeLocalModel();
+    }
+
     // Dynamic import of node-llama-cpp (ESM module)
-    const { getLlama, LlamaChatSession } = await import('node-llama-cpp');
-
-    // Get GPU layers setting (default to 0 if not specified)
-    const gpuLayers = config.gpuLayers !== undefined && config.gpuLayers !== null ? config.gpuLayers : 0;
-    
-    // Get context size setting (default to 8192 if not specified)
-    const contextSize = config.contextSize !== undefined && config.contextSize !== null ? config.contextSize : 8192;
-
-    // Load model if not loaded, if path changed, OR if GPU layers setting changed
-    if (!localLLM || loadedModelPath !== modelPath || loadedGpuLayers !== gpuLayers) {
-      console.log('Loading local GGUF model from:', modelPath);
-      
-      // Dispose old instance if any
-      if (localLLM) {
-        console.log('Disposing previous model instance...');
-        try {
-          if (localLLM.context) await localLLM.context.dispose();
-          if (localLLM.model) await localLLM.model.dispose();
-        } catch (disposeErr) {
-          console.warn('Error during disposal:', disposeErr);
-        }
-        localLLM = null;
-      }
+    const { getLlama } = await import('node-llama-cpp');
+    const llama = await getLlama({ logLevel: 'warn' });
+
+    log.info(`Loading local GGUF model from: ${modelPath} (GPU layers: ${gpuLayers === -1 ? 'all' : gpuLayers})`, settings);
+    const model = await llama.loadModel({
+      modelPath: modelPath,
+      gpuLayers: gpuLayers, // 0 = CPU only, -1 = all layers, or specific number
+      // mmap pages weights in lazily; mlock pins them so they are never swapped out
+      useMmap: settings.useMmap,
+      useMlock: settings.useMlock
+    });
 
-      // Initialize llama
-      const llama = await getLlama({
-        // Enable verbose logging to see GPU initialization
-        logLevel: 'debug'
+    // Sequences of one context are decoded together in the same batch
+    let context;
+    try {
+      context = await model.createContext({
+        contextSize: contextSize, // Use configured context size instead of model default (40960)
+        sequences,
+        ...toContextOptions(settings)
       });
-      
-      console.log('=== GPU Detection ===');
-      console.log('Attempting to load model with GPU layers:', gpuLayers);
-      
-      if (gpuLayers === -1) {
-        console.log('Mode: Offloading ALL layers to GPU');
-      } else if (gpuLayers === 0) {
-        console.log('Mode: CPU only (no GPU acceleration)');
+    } catch (error) {
+      await model.dispose();
+      throw error;
+    }
+    const pool = new SequencePool(Array.from({ length: sequences }, () => context.getSequence()));
+
+    localLLM = { model, context, pool, settings, contextSize };
+    loadedModelPath = modelPath;
+    loadedGpuLayers = gpuLayers;
+    loadedSignature = signature;
+    log.info(`Model ready: ${sequences} parallel sequences, context ${contextSize} tokens each`);
+    return localLLM;
+  })();
+
+  try {
+    return await localLoading;
+  } finally {
+    localLoading = null;
+  }
+}
+
+/**
+ * Convert conversation history to node-llama-cpp chat history items
+ * @param {string} systemPrompt - System prompt
+ * @param {Array<Object>} history - [{ role, content }] oldest first
+ * @returns {Array<Object>} Chat history
+ */
+function toLlamaChatHistory(systemPrompt, history) {
+  const items = systemPrompt ? [{ type: 'system', text: systemPrompt }] : [];
+  for (const turn of history || []) {
+    items.push(turn.role === 'assistant'
+      ? { type: 'model', response: [turn.content] }
+      : { type: 'user', text: turn.content });
+  }
+  return items;
+}
+
+/**
+ * Chat sessions left on context sequences by a conversation, with the
+ * history the conversation will send next if nothing else happens to it
+ * @type {WeakMap<Object, Object>} sequence -> { session, expected }
+ */
+const boundSessions = new WeakMap();
+
+/**
+ * @param {string} systemPrompt - System prompt
+ * @param {Array<Object>} history - [{ role, content }]
+ * @returns {string} Comparable form of a conversation state
+ */
+function historySignature(systemPrompt, history) {
+  return JSON.stringify([systemPrompt || '', history]);
+}
+
+/**
+ * Handle local GGUF model chat using node-llama-cpp. Requests run on a pool
+ * of context sequences, so independent requests decode in parallel.
+ * A conversation keeps its sequence and chat session between turns, so only
+ * the new turn is evaluated; the sequence is cleared and the history
+ * replayed only when another conversation (or none) used it in between, or
+ * the history no longer continues what the sequence holds.
+ * @param {string} message - User message
+ * @param {Object} config - Config with localModelPath, gpuLayers, contextSize and localParallelSequences
+ * @param {Object} options - { systemPrompt, history, clientId, conversationKey, userMessage } where
+ *   clientId groups requests for fair queueing, conversationKey binds the sequence to a
+ *   conversation and userMessage is the message as the conversation records it
+ * @returns {Promise<Object>} { success, reply, stats: { tokens, tokensPerSecond, timeToFirstTokenMs, queuedMs } }
+ */
+async function handleLocalChat(message, config, options = {}) {
+  if (!config.localModelPath) {
+    return { success: false, error: 'Local model path is required' };
+  }
+
+  try {
+    const { LlamaChatSession } = await import('node-llama-cpp');
+    const { pool } = await ensureLocalModel(config);
+
+    const conversation = options.conversationKey || null;
+    return await pool.run(options.clientId || 'chat', async (sequence, { queuedMs, previousOwner }) => {
+      const systemPrompt = options.systemPrompt !== undefined ? options.systemPrompt : config.systemPrompt;
+      const history = options.history || [];
+      let bound = boundSessions.get(sequence);
+      boundSessions.delete(sequence);
+      const continues = bound && conversation !== null && previousOwner === conversation &&
+        bound.expected === historySignature(systemPrompt, history);
+
+      let session;
+      if (continues) {
+        session = bound.session;
       } else {
-        console.log(`Mode: Offloading ${gpuLayers} layers to GPU`);
-      }
-      
-      console.log('Note: Watch for [node-llama-cpp] logs below for GPU/Vulkan device info');
-      console.log('=====================');
-      
-      // Load the model with GPU configuration
-      // The underlying llama.cpp will log GPU information like:
-      // "ggml_vulkan: Using Vulkan1 (NVIDIA GeForce RTX 4070) | vulkan"
-      const model = await llama.loadModel({
-        modelPath: modelPath,
-        gpuLayers: gpuLayers, // 0 = CPU only, -1 = all layers, or specific number
-        // Try to enable verbose output
-        onLoadProgress: (progress) => {
-          console.log(`Loading model: ${(progress * 100).toFixed(1)}%`);
+        if (bound) bound.session.dispose({ disposeSequence: false });
+        // Start from a clean sequence; the conversation is replayed as chat history
+        await sequence.clearHistory();
+        session = new LlamaChatSession({ contextSequence: sequence, autoDisposeSequence: false });
+        if (systemPrompt || history.length > 0) {
+          session.setChatHistory(toLlamaChatHistory(systemPrompt, history));
         }
-      });
-      
-      console.log('✓ Model loaded');
-      console.log('  GPU layers used:', gpuLayers === -1 ? 'All layers' : gpuLayers);
-      console.log('  Model size:', model.size, 'parameters');
-      console.log('  Model default context:', model.trainContextSize, 'tokens');
-      console.log('  Using context size:', contextSize, 'tokens (saves VRAM)');
-
-      // Create context with custom size to reduce VRAM usage
-      const context = await model.createContext({
-        contextSize: contextSize // Use configured context size instead of model default (40960)
-      });
-      
-      // Create chat session
-      const session = new LlamaChatSession({
-        contextSequence: context.getSequence()
-      });
-
-      localLLM = { model, context, session };
-      loadedModelPath = modelPath;
-      loadedGpuLayers = gpuLayers;
-      console.log('✓ Model ready for inference');
-      console.log('=====================');
-    } else {
-      console.log('Using cached model (same path and GPU layers)');
-    }
+      }
 
-    // Generate response
-    console.log('Generating response for:', message);
-    
-    // Prepend system prompt to the message if provided
-    let fullMessage = message;
-    if (config.systemPrompt) {
-      fullMessage = `System: ${config.systemPrompt}\n\nUser: ${message}`;
-    }
-    
-    const response = await localLLM.session.prompt(fullMessage);
-    
-    return {
-      success: true,
-      reply: response || '(no response)'
-    };
-  } catch (error) {
-    console.error('Error with local GGUF model:', error);
-    console.error('Error stack:', error.stack);
-    
-    // Clean up on error
-    if (localLLM) {
+      const started = Date.now();
+      let firstTokenAt = null;
+      let tokens = 0;
       try {
-        await localLLM.context?.dispose();
-        await localLLM.model?.dispose();
-      } catch (disposeError) {
-        console.error('Error disposing model:', disposeError);
-      }
-    }
-    localLLM = null;
-    loadedModelPath = null;
-    loadedGpuLayers = null;
+        const response = await session.prompt(message, {
+          onToken: (chunk) => {
+            if (firstTokenAt === null) firstTokenAt = Date.now();
+            tokens += chunk.length;
+          }
+        });
 
+        const elapsedMs = Date.now() - started;
+        const generationMs = firstTokenAt === null ? elapsedMs : Date.now() - firstTokenAt;
+        const stats = {
+          tokens,
+          tokensPerSecond: generationMs > 0 ? Math.round(tokens / (generationMs / 1000) * 10) / 10 : 0,
+          timeToFirstTokenMs: firstTokenAt === null ? null : firstTokenAt - started,
+          elapsedMs,
+          queuedMs
+        };
+        log.debug(() => `Local generation: ${tokens} tokens, ${stats.tokensPerSecond} tok/s, first token ${stats.timeToFirstTokenMs} ms, queued ${queuedMs} ms${continues ? ', continued session' : ''}`);
+
+        const reply = response || '(no response)';
+        if (conversation !== null) {
+          const next = [...history, { role: 'user', content: options.userMessage || message }, { role: 'assistant', content: reply }];
+          boundSessions.set(sequence, { session, expected: historySignature(systemPrompt, next) });
+        }
+        return { success: true, reply, stats };
+      } finally {
+        if (!boundSessions.has(sequence)) session.dispose({ disposeSequence: false });
+      }
+    }, conversation);
+  } catch (error) {
+    log.error('Error with local GGUF model', error);
     return {
       success: false,
       error: 'Local model error: ' + error.message
@@ -349,4 +914,21 @@ async function handleLocalChat(message, config) {
   }
 }
 
-module.exports = { setupAssistantHandlers };
+/**
+ * Memory held by the loaded local model, for the metrics panel
+ * @returns {Object|null} { modelPath, modelBytes, contextSize, sequences, useMmap } or null when unloaded
+ */
+function getLocalModelMemory() {
+  if (!localLLM) return null;
+  const { model, pool, settings, contextSize } = localLLM;
+  return {
+    modelPath: loadedModelPath,
+    // Weights are memory-mapped unless mmap is off, so part of this may be page cache
+    modelBytes: typeof model.size === 'number' ? model.size : null,
+    contextSize,
+    sequences: pool.size,
+    useMmap: settings.useMmap
+  };
+}
+
+module.exports = { setupAssistantHandlers, getLocalModelMemory };
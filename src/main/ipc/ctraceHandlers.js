@@ -6,6 +6,53 @@ const fsSync = require('fs');
 const os = require('os');
 const net = require('net');
 const { v4: uuidv4 } = require('uuid');
+const log = require('../utils/logger').getLogger('ctrace');
+const { childProcesses } = require('../utils/processMetrics');
+const { OutputCoalescer } = require('../utils/outputCoalescer');
+
+/** @type {Map<number, OutputCoalescer>} Output streams of running analyses, by id */
+const outputStreams = new Map();
+let streamCounter = 0;
+
+/** @type {Set<Function>} Cleanups of running analyses, run if the app exits first */
+const activeCleanups = new Set();
+process.on('exit', () => {
+  for (const cleanup of Array.from(activeCleanups)) cleanup();
+});
+
+/**
+ * Show a child process in the metrics panel while it runs
+ * @param {ChildProcess} child - Spawned process
+ * @param {string} label - Role shown in the panel
+ */
+function trackChild(child, label) {
+  childProcesses.register(child.pid, label);
+  child.on('exit', () => childProcesses.unregister(child.pid));
+}
+
+/**
+ * Forward socket output to the renderer in per-frame batches, pausing the
+ * socket while the renderer is behind on acknowledging them
+ * @param {net.Socket} socket - ctrace output socket
+ * @param {Object} event - IPC event of the request
+ * @returns {OutputCoalescer} Stream to write output to
+ */
+function createOutputStream(socket, event) {
+  const id = ++streamCounter;
+  const stream = new OutputCoalescer((text, meta) => {
+    if (event?.sender && !event.sender.isDestroyed?.()) event.sender.send('ctrace-output', text, meta);
+  }, {
+    id,
+    onPause: () => {
+      log.debug(() => `Renderer behind on stream ${id}, pausing socket`);
+      socket.pause();
+    },
+    onResume: () => socket.resume()
+  });
+  outputStreams.set(id, stream);
+  socket.on('close', () => outputStreams.delete(id));
+  return stream;
+}
 
 // ==========================================
 // HELPER FUNCTIONS (Windows/WSL Specific)
@@ -19,7 +66,7 @@ async function ensureSocatInstalled() {
         resolve(true);
         return;
       }
-      console.log('📦 socat not found in WSL, attempting to install...');
+      log.info('socat not found in WSL, attempting to install...');
       const installChild = spawn('wsl', ['--user', 'root', 'bash', '-c', 'apt-get update -qq && apt-get install -y socat'], { stdio: 'inherit' });
       installChild.on('close', (installCode) => resolve(installCode === 0));
       installChild.on('error', () => resolve(false));
@@ -78,188 +125,243 @@ async function waitForSocketFile(socketPath, timeout = 5000) {
   return false;
 }
 
+/** Wait for ctrace to connect after it exits before calling the run failed */
+const CONNECT_GRACE_MS = 1000;
+
 // ==========================================
 // MAIN HANDLER
 // ==========================================
 
-function setupCtraceHandlers() {
-  ipcMain.handle('run-ctrace', async (event, args = []) => {
-    const binaryName = 'ctrace';
-    let server = null;
-    let processes = []; // Track processes to kill on cleanup
+/**
+ * Run ctrace once and collect its output. Used by the 'run-ctrace' handler
+ * and by headless batch analysis, which runs many of these in parallel.
+ * @param {Array<string>} [args] - ctrace arguments
+ * @param {Object} [options]
+ * @param {Function} [options.createStream] - (socket) => { write, end }, receives output as it arrives
+ * @param {Function} [options.onComplete] - (output) => void, once the socket closes
+ * @returns {Promise<Object>} { success, output } or { success: false, error }; socket and
+ *   spawn failures reject with the same shape
+ */
+async function runCtrace(args = [], options = {}) {
+  const binaryName = 'ctrace';
+  let server = null;
+  let processes = []; // Track processes to kill on cleanup
 
-    // 1. Resolve Binary Path
-    let binPath;
-    if (process.resourcesPath) {
-      binPath = path.join(process.resourcesPath, 'bin', binaryName);
+  // 1. Resolve Binary Path
+  let binPath;
+  if (process.resourcesPath) {
+    binPath = path.join(process.resourcesPath, 'bin', binaryName);
+  } else {
+    binPath = path.join(__dirname, '../../../bin', binaryName);
+  }
+
+  // Check if binary exists (Critical for both platforms)
+  try {
+    await fs.access(binPath);
+  } catch (e) {
+      // Fallback check logic for logging
+      const checkedPath = process.resourcesPath ? path.join(process.resourcesPath, 'bin', binaryName) : path.join(__dirname, '../../../bin', binaryName);
+      return { success: false, error: `Binary not found at: ${checkedPath}` };
+  }
+
+  // ==========================================
+  // CLEANUP ROUTINE
+  // ==========================================
+  let wslSocketPath = null;
+  const cleanup = () => {
+    log.debug('Cleaning up resources');
+    activeCleanups.delete(cleanup);
+    
+    // Close Server
+    if (server) server.close();
+    
+    // Kill Processes
+    processes.forEach(p => {
+      if (p && !p.killed) p.kill('SIGTERM');
+    });
+
+    // Platform specific cleanup
+    if (os.platform() === 'win32') {
+       if (wslSocketPath) spawn('wsl', ['rm', '-f', wslSocketPath]);
     } else {
-      binPath = path.join(__dirname, '../../../bin', binaryName);
+       // Linux: Clean up the local socket file if it exists
+       // The path is defined in the Linux block, we can't easily access it here
+       // unless we scope it higher, but usually server.close() handles unlinking 
+       // on Linux if net.createServer was used with a path. 
+       // If not, we rely on os.tmpdir() auto-cleaning eventually.
     }
+  };
 
-    // Check if binary exists (Critical for both platforms)
-    try {
-      await fs.access(binPath);
-    } catch (e) {
-        // Fallback check logic for logging
-        const checkedPath = process.resourcesPath ? path.join(process.resourcesPath, 'bin', binaryName) : path.join(__dirname, '../../../bin', binaryName);
-        return { success: false, error: `Binary not found at: ${checkedPath}` };
+  // ==========================================
+  // WINDOWS EXECUTION PATH (WSL + TCP Bridge)
+  // ==========================================
+  if (os.platform() === 'win32') {
+    log.debug('Windows detected. Initializing WSL bridge');
+    
+    // 1. Check WSL
+    const wslStatus = await checkWSLAvailability();
+    if (!wslStatus.available || !wslStatus.hasDistros) {
+      return { success: false, error: 'WSL is not installed or has no distributions.' };
     }
 
-    // ==========================================
-    // CLEANUP ROUTINE
-    // ==========================================
-    const cleanup = () => {
-      console.log('🧹 Cleaning up resources...');
-      
-      // Close Server
-      if (server) server.close();
-      
-      // Kill Processes
-      processes.forEach(p => {
-        if (p && !p.killed) p.kill('SIGTERM');
-      });
-
-      // Platform specific cleanup
-      if (os.platform() === 'win32') {
-         spawn('wsl', ['rm', '-f', '/tmp/ctrace.sock']);
-      } else {
-         // Linux: Clean up the local socket file if it exists
-         // The path is defined in the Linux block, we can't easily access it here
-         // unless we scope it higher, but usually server.close() handles unlinking 
-         // on Linux if net.createServer was used with a path. 
-         // If not, we rely on os.tmpdir() auto-cleaning eventually.
-      }
-    };
+    // 2. Check Socat
+    if (!(await ensureSocatInstalled())) {
+      return { success: false, error: 'Failed to install socat in WSL.' };
+    }
 
-    process.on('exit', cleanup);
+    activeCleanups.add(cleanup);
+    return new Promise(async (resolve, reject) => {
+      // Unique per run so parallel runs get their own bridge
+      wslSocketPath = `/tmp/ctrace-${uuidv4()}.sock`;
+      let connected = false;
 
-    // ==========================================
-    // WINDOWS EXECUTION PATH (WSL + TCP Bridge)
-    // ==========================================
-    if (os.platform() === 'win32') {
-      console.log('🪟 Windows detected. Initializing WSL bridge...');
-      
-      // 1. Check WSL
-      const wslStatus = await checkWSLAvailability();
-      if (!wslStatus.available || !wslStatus.hasDistros) {
-        return { success: false, error: 'WSL is not installed or has no distributions.' };
-      }
+      // 3. Start TCP Server
+      server = net.createServer((socket) => {
+        connected = true;
+        let outputBuffer = '';
+        const stream = options.createStream ? options.createStream(socket) : null;
+        socket.on('data', (data) => {
+           const str = data.toString();
+           outputBuffer += str;
+           if (stream) stream.write(str);
+        });
+        socket.on('end', () => {
+          if (stream) stream.end();
+          if (options.onComplete) options.onComplete(outputBuffer);
+          cleanup();
+          resolve({ success: true, output: outputBuffer });
+        });
+      });
 
-      // 2. Check Socat
-      if (!(await ensureSocatInstalled())) {
-        return { success: false, error: 'Failed to install socat in WSL.' };
-      }
+      server.listen(0, '0.0.0.0', async () => {
+        const tcpPort = server.address().port;
+        log.debug(() => `TCP Bridge listening on port ${tcpPort}`);
 
-      return new Promise(async (resolve, reject) => {
-        const wslSocketPath = '/tmp/ctrace.sock'; // Fixed path inside WSL
+        try {
+          const hostIP = await getWindowsHostIP();
+          
+          // 4. Start Socat Bridge in WSL
+          const socatCmd = `rm -f ${wslSocketPath}; socat UNIX-LISTEN:${wslSocketPath},fork,reuseaddr TCP:${hostIP}:${tcpPort}`;
+          const socatProc = spawn('wsl', ['bash', '-c', socatCmd]);
+          processes.push(socatProc);
+          trackChild(socatProc, 'socat bridge');
 
-        // 3. Start TCP Server
-        server = net.createServer((socket) => {
-          let outputBuffer = '';
-          socket.on('data', (data) => {
-             const str = data.toString();
-             outputBuffer += str;
-             if (event?.sender) event.sender.send('ctrace-output', str);
-          });
-          socket.on('end', () => {
-            if (event?.sender) event.sender.send('ctrace-complete', { success: true, output: outputBuffer });
+          // 5. Wait for Socket
+          if (!(await waitForSocketFile(wslSocketPath))) {
             cleanup();
-            resolve({ success: true, output: outputBuffer });
-          });
-        });
-
-        server.listen(0, '0.0.0.0', async () => {
-          const tcpPort = server.address().port;
-          console.log(`TCP Bridge listening on port ${tcpPort}`);
+            reject({ success: false, error: 'Timeout waiting for WSL socket.' });
+            return;
+          }
 
-          try {
-            const hostIP = await getWindowsHostIP();
-            
-            // 4. Start Socat Bridge in WSL
-            const socatCmd = `rm -f ${wslSocketPath}; socat UNIX-LISTEN:${wslSocketPath},fork,reuseaddr TCP:${hostIP}:${tcpPort}`;
-            const socatProc = spawn('wsl', ['bash', '-c', socatCmd]);
-            processes.push(socatProc);
+          // 6. Run Binary via WSL
+          const wslBinPath = binPath.replace(/\\/g, '/').replace(/^([A-Z]):/, (m, d) => `/mnt/${d.toLowerCase()}`);
+          const argsList = [wslBinPath, '--ipc', 'socket', '--ipc-path', wslSocketPath, ...args];
+          
+          log.info('Running: wsl', argsList);
+          const child = spawn('wsl', argsList);
+          processes.push(child);
+          trackChild(child, 'ctrace (WSL)');
 
-            // 5. Wait for Socket
-            if (!(await waitForSocketFile(wslSocketPath))) {
+          // Basic error handling for binary
+          child.on('error', (err) => {
               cleanup();
-              reject({ success: false, error: 'Timeout waiting for WSL socket.' });
-              return;
-            }
-
-            // 6. Run Binary via WSL
-            const wslBinPath = binPath.replace(/\\/g, '/').replace(/^([A-Z]):/, (m, d) => `/mnt/${d.toLowerCase()}`);
-            const argsList = [wslBinPath, '--ipc', 'socket', '--ipc-path', wslSocketPath, ...args];
-            
-            console.log('Running:', 'wsl', argsList);
-            const child = spawn('wsl', argsList);
-            processes.push(child);
-
-            // Basic error handling for binary
-            child.on('error', (err) => {
-                cleanup();
-                reject({ success: false, error: err.message });
-            });
-          } catch (err) {
+              reject({ success: false, error: err.message });
+          });
+          child.on('close', (code) => setTimeout(() => {
+            if (connected) return;
             cleanup();
-            reject({ success: false, error: err.message });
-          }
-        });
+            resolve({ success: false, error: `ctrace exited with code ${code} without connecting` });
+          }, CONNECT_GRACE_MS));
+        } catch (err) {
+          cleanup();
+          reject({ success: false, error: err.message });
+        }
       });
-    } 
+    });
+  } 
+  
+  // ==========================================
+  // LINUX / MACOS EXECUTION PATH (Direct Socket)
+  // ==========================================
+  else {
+    log.debug('Linux/Mac detected. Using direct socket IPC');
     
-    // ==========================================
-    // LINUX / MACOS EXECUTION PATH (Direct Socket)
-    // ==========================================
-    else {
-      console.log('🐧 Linux/Mac detected. Using direct socket IPC.');
+    activeCleanups.add(cleanup);
+    return new Promise((resolve, reject) => {
+      // 1. Create unique socket path
+      const socketPath = path.join(os.tmpdir(), `ctrace-${uuidv4()}.sock`);
+      let connected = false;
+      let stderr = '';
       
-      return new Promise((resolve, reject) => {
-        // 1. Create unique socket path
-        const socketPath = path.join(os.tmpdir(), `ctrace-${uuidv4()}.sock`);
-        
-        // 2. Start Unix Socket Server
-        server = net.createServer((socket) => {
-          let outputBuffer = '';
-          socket.on('data', (data) => {
-            const str = data.toString();
-            outputBuffer += str;
-            if (event?.sender) event.sender.send('ctrace-output', str);
-          });
-          socket.on('end', () => {
-            if (event?.sender) event.sender.send('ctrace-complete', { success: true, output: outputBuffer });
-            cleanup();
-            // Try to unlink socket file specifically for Linux
-            try { fsSync.unlinkSync(socketPath); } catch(e) {}
-            resolve({ success: true, output: outputBuffer });
-          });
+      // 2. Start Unix Socket Server
+      server = net.createServer((socket) => {
+        connected = true;
+        let outputBuffer = '';
+        const stream = options.createStream ? options.createStream(socket) : null;
+        socket.on('data', (data) => {
+          const str = data.toString();
+          outputBuffer += str;
+          if (stream) stream.write(str);
         });
+        socket.on('end', () => {
+          if (stream) stream.end();
+          if (options.onComplete) options.onComplete(outputBuffer);
+          cleanup();
+          // Try to unlink socket file specifically for Linux
+          try { fsSync.unlinkSync(socketPath); } catch(e) {}
+          resolve({ success: true, output: outputBuffer });
+        });
+      });
 
-        server.listen(socketPath, () => {
-          console.log(`Listening on Unix socket: ${socketPath}`);
-          
-          // 3. Run Binary Directly
-          const binaryArgs = ['--ipc', 'socket', '--ipc-path', socketPath, ...args];
-          console.log('Running:', binPath, binaryArgs);
-          
-          const child = spawn(binPath, binaryArgs);
-          processes.push(child);
-
-          child.on('error', (err) => {
-            cleanup();
-            reject({ success: false, error: `Failed to start binary: ${err.message}` });
-          });
+      server.listen(socketPath, () => {
+        log.debug(() => `Listening on Unix socket: ${socketPath}`);
+        
+        // 3. Run Binary Directly
+        const binaryArgs = ['--ipc', 'socket', '--ipc-path', socketPath, ...args];
+        log.info(`Running: ${binPath}`, binaryArgs);
+        
+        const child = spawn(binPath, binaryArgs);
+        processes.push(child);
+        trackChild(child, 'ctrace');
 
-          child.stderr.on('data', d => console.error(`[ctrace stderr]: ${d}`));
+        child.on('error', (err) => {
+          cleanup();
+          reject({ success: false, error: `Failed to start binary: ${err.message}` });
         });
-        
-        server.on('error', (err) => {
-            cleanup();
-            reject({ success: false, error: `Server error: ${err.message}` });
+
+        child.stderr.on('data', (d) => {
+          log.warn(() => `ctrace stderr: ${d}`);
+          stderr = (stderr + d).slice(-4096);
         });
+        child.on('close', (code) => setTimeout(() => {
+          if (connected) return;
+          cleanup();
+          try { fsSync.unlinkSync(socketPath); } catch(e) {}
+          resolve({ success: false, error: `ctrace exited with code ${code} without connecting`, stderr });
+        }, CONNECT_GRACE_MS));
       });
-    }
+      
+      server.on('error', (err) => {
+          cleanup();
+          reject({ success: false, error: `Server error: ${err.message}` });
+      });
+    });
+  }
+}
+
+function setupCtraceHandlers() {
+  // The renderer acknowledges output batches once processed
+  ipcMain.on('ctrace-output-ack', (event, streamId, chars) => {
+    const stream = outputStreams.get(streamId);
+    if (stream) stream.ack(chars);
   });
+
+  ipcMain.handle('run-ctrace', (event, args = []) => runCtrace(args, {
+    createStream: (socket) => createOutputStream(socket, event),
+    onComplete: (output) => {
+      if (event?.sender) event.sender.send('ctrace-complete', { success: true, output });
+    }
+  }));
 }
 
-module.exports = { setupCtraceHandlers };
\ No newline at end of file
+module.exports = { setupCtraceHandlers, runCtrace };
\ No newline at end of file
@@ -0,0 +1,134 @@
+/**
+ * @fileoverview IPC handlers for streaming report export
+ *
+ * The renderer produces the report in chunks; each chunk is written before
+ * the next is requested, so neither process holds more than one chunk.
+ * Output goes to a temporary file that replaces the target only once the
+ * export completes.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+const { ipcMain, dialog } = require('electron');
+const fs = require('fs');
+const path = require('path');
+const { once } = require('events');
+const log = require('../utils/logger').getLogger('export');
+
+/** Save dialog filters, one per export format */
+const FORMAT_FILTERS = [
+  { format: 'html', name: 'HTML Report', extensions: ['html', 'htm'] },
+  { format: 'csv', name: 'CSV', extensions: ['csv'] },
+  { format: 'junit', name: 'JUnit XML', extensions: ['xml'] },
+  { format: 'sarif', name: 'SARIF', extensions: ['sarif', 'json'] }
+];
+
+/** @type {Map<number, Object>} Open exports { stream, filePath, tmpPath, bytes } */
+const openExports = new Map();
+let exportCounter = 0;
+
+/**
+ * @param {string} filePath - Chosen file
+ * @returns {string|null} Export format for its extension
+ */
+function formatForPath(filePath) {
+  const ext = path.extname(filePath).slice(1).toLowerCase();
+  const match = FORMAT_FILTERS.find(filter => filter.extensions.includes(ext));
+  return match ? match.format : null;
+}
+
+/**
+ * Close an export and remove its temporary file
+ * @param {number} id - Export id
+ */
+async function abortExport(id) {
+  const entry = openExports.get(id);
+  if (!entry) return;
+  openExports.delete(id);
+  entry.stream.destroy();
+  await fs.promises.rm(entry.tmpPath, { force: true });
+}
+
+/**
+ * Setup IPC handlers for report export
+ * @param {BrowserWindow} mainWindow - Parent of the save dialog
+ */
+function setupExportHandlers(mainWindow) {
+  /**
+   * Ask where to export; the format follows the chosen extension
+   */
+  ipcMain.handle('export-report-begin', async (event, { defaultName = 'ctrace-report.html' } = {}) => {
+    const choice = await dialog.showSaveDialog(mainWindow, {
+      title: 'Export Report',
+      defaultPath: defaultName,
+      filters: FORMAT_FILTERS.map(({ name, extensions }) => ({ name, extensions }))
+    });
+    if (choice.canceled || !choice.filePath) return { success: false, canceled: true };
+
+    const format = formatForPath(choice.filePath);
+    if (!format) {
+      return { success: false, error: `Unsupported export file type: ${path.extname(choice.filePath) || 'none'}` };
+    }
+    try {
+      const tmpPath = `${choice.filePath}.tmp`;
+      const stream = fs.createWriteStream(tmpPath, { encoding: 'utf8' });
+      await once(stream, 'open');
+      const id = ++exportCounter;
+      openExports.set(id, { stream, filePath: choice.filePath, tmpPath, bytes: 0 });
+      return { success: true, id, filePath: choice.filePath, format };
+    } catch (error) {
+      log.error('Cannot create export file', error);
+      return { success: false, error: error.message };
+    }
+  });
+
+  /**
+   * Append a chunk; resolves once the file has room for more
+   */
+  ipcMain.handle('export-report-write', async (event, id, chunk) => {
+    const entry = openExports.get(id);
+    if (!entry) return { success: false, error: 'Export is not open' };
+    try {
+      entry.bytes += Buffer.byteLength(chunk, 'utf8');
+      if (!entry.stream.write(chunk)) {
+        await Promise.race([once(entry.stream, 'drain'), once(entry.stream, 'error').then(([error]) => { throw error; })]);
+      }
+      return { success: true };
+    } catch (error) {
+      log.error('Export write failed', error);
+      await abortExport(id);
+      return { success: false, error: error.message };
+    }
+  });
+
+  /**
+   * Finish the file and move it into place
+   */
+  ipcMain.handle('export-report-end', async (event, id) => {
+    const entry = openExports.get(id);
+    if (!entry) return { success: false, error: 'Export is not open' };
+    try {
+      entry.stream.end();
+      await once(entry.stream, 'finish');
+      await fs.promises.rename(entry.tmpPath, entry.filePath);
+      openExports.delete(id);
+      log.info(`Exported report to ${entry.filePath}`, { bytes: entry.bytes });
+      return { success: true, filePath: entry.filePath, bytes: entry.bytes };
+    } catch (error) {
+      log.error('Export failed', error);
+      await abortExport(id);
+      return { success: false, error: error.message };
+    }
+  });
+
+  /**
+   * Drop an export that the renderer gave up on
+   */
+  ipcMain.handle('export-report-abort', async (event, id) => {
+    await abortExport(id);
+    return { success: true };
+  });
+}
+
+module.exports = { setupExportHandlers, formatForPath };
@@ -14,6 +14,8 @@ const fs = require('fs').promises;
 const path = require('path');
 const chokidar = require('chokidar');
 const { detectFileEncoding, buildFileTree, searchInDirectory, FILE_SIZE_LIMIT } = require('../utils/fileUtils');
+const codeIndex = require('../utils/codeIndex');
+const log = require('../utils/logger').getLogger('files');
 
 /**
  * File watcher instance for monitoring workspace changes
@@ -29,6 +31,34 @@ let fileWatcher = null;
  */
 let currentWatchPath = null;
 
+/**
+ * Load a folder as the workspace and start watching it.
+ * 
+ * @param {string} folderPath - Folder to open
+ * @param {BrowserWindow} mainWindow - Main window reference for change events
+ * @returns {Promise<Object>} { success, folderPath, fileTree } or { success: false, error }
+ * @private
+ */
+async function openFolder(folderPath, mainWindow) {
+  try {
+    const fileTree = await buildFileTree(folderPath);
+    
+    // Start watching the workspace for changes
+    startWatchingWorkspace(folderPath, mainWindow);
+    
+    return {
+      success: true,
+      folderPath,
+      fileTree
+    };
+  } catch (error) {
+    return {
+      success: false,
+      error: error.message
+    };
+  }
+}
+
 /**
  * Sets up all IPC handlers for file operations.
  * 
@@ -50,29 +80,25 @@ function setupFileHandlers(mainWindow) {
     });
     
     if (!result.canceled && result.filePaths.length > 0) {
-      const folderPath = result.filePaths[0];
-      try {
-        const fileTree = await buildFileTree(folderPath);
-        
-        // Start watching the workspace for changes
-        startWatchingWorkspace(folderPath, mainWindow);
-        
-        return {
-          success: true,
-          folderPath,
-          fileTree
-        };
-      } catch (error) {
-        return {
-          success: false,
-          error: error.message
-        };
-      }
+      return openFolder(result.filePaths[0], mainWindow);
     }
     
     return { success: false, canceled: true };
   });
 
+  // Open a known folder without a dialog (session restore)
+  ipcMain.handle('open-folder', async (event, folderPath) => {
+    try {
+      const stats = await fs.stat(folderPath);
+      if (!stats.isDirectory()) {
+        return { success: false, error: 'Not a directory' };
+      }
+    } catch (error) {
+      return { success: false, error: error.message };
+    }
+    return openFolder(folderPath, mainWindow);
+  });
+
   // Get file tree for refresh
   ipcMain.handle('get-file-tree', async (event, folderPath) => {
     try {
@@ -337,7 +363,7 @@ function setupFileHandlers(mainWindow) {
         fileName: path.basename(filePath)
       };
     } catch (error) {
-      console.error('Error force loading full file:', error);
+      log.error('Error force loading full file', error);
       return {
         success: false,
         error: error.message
@@ -357,6 +383,11 @@ function startWatchingWorkspace(workspacePath, mainWindow) {
   
   currentWatchPath = workspacePath;
   
+  // Build the assistant retrieval index in the background
+  codeIndex.build(workspacePath)
+    .then(stats => log.info(`Indexed ${stats.functions} functions in ${stats.files} files (${stats.elapsedMs} ms)`))
+    .catch(error => log.error('Error building code index', error));
+  
   // Create new watcher
   fileWatcher = chokidar.watch(workspacePath, {
     ignoreInitial: true,
@@ -386,20 +417,26 @@ function startWatchingWorkspace(workspacePath, mainWindow) {
           folderPath: workspacePath
         });
       } catch (error) {
-        console.error('Error updating file tree:', error);
+        log.error('Error updating file tree', error);
       }
     }, 300); // 300ms debounce
   };
   
+  // Keep the retrieval index in sync one file at a time
+  const reindexFile = (filePath) => {
+    codeIndex.updateFile(filePath).catch(error => log.error('Error indexing file', error));
+  };
+  
   // Listen for file system events
   fileWatcher
-    .on('add', debouncedUpdate)
-    .on('unlink', debouncedUpdate)
+    .on('add', (filePath) => { reindexFile(filePath); debouncedUpdate(); })
+    .on('change', reindexFile)
+    .on('unlink', (filePath) => { codeIndex.removeFile(filePath); debouncedUpdate(); })
     .on('addDir', debouncedUpdate)
-    .on('unlinkDir', debouncedUpdate)
-    .on('error', error => console.error('File watcher error:', error));
+    .on('unlinkDir', (dirPath) => { codeIndex.removeDirectory(dirPath); debouncedUpdate(); })
+    .on('error', error => log.error('File watcher error', error));
   
-  console.log('Started watching workspace:', workspacePath);
+  log.info(`Started watching workspace: ${workspacePath}`);
 }
 
 /**
@@ -409,7 +446,8 @@ function stopWatchingWorkspace() {
   if (fileWatcher) {
     fileWatcher.close();
     fileWatcher = null;
-    console.log('Stopped watching workspace:', currentWatchPath);
+    codeIndex.clear();
+    log.info(`Stopped watching workspace: ${currentWatchPath}`);
   }
   currentWatchPath = null;
 }
@@ -0,0 +1,76 @@
+const { ipcMain, shell } = require('electron');
+const { logger, createFileSink, formatValue } = require('../utils/logger');
+
+/** Batched file output, created by setupLogHandlers */
+let fileSink = null;
+
+/**
+ * Setup IPC handlers for the application log
+ * @param {string} logFilePath - File receiving the log of both processes
+ */
+function setupLogHandlers(logFilePath) {
+  if (logFilePath && !fileSink) {
+    fileSink = createFileSink(logFilePath);
+    logger.addSink(fileSink);
+  }
+
+  // Renderer entries arrive in batches and join the main ring buffer and file
+  ipcMain.on('log-entries', (event, entries) => {
+    if (!Array.isArray(entries)) return;
+    for (const entry of entries) {
+      if (entry && typeof entry.message === 'string') {
+        logger.record({ ...entry, process: 'renderer' });
+      }
+    }
+  });
+
+  /**
+   * Entries for the log viewer: { level, category, process, search, limit }
+   */
+  ipcMain.handle('log-get-entries', async (event, filter = {}) => {
+    return {
+      success: true,
+      // Data is sent as text: it may hold values that cannot be cloned
+      entries: logger.getEntries(filter).map(entry =>
+        entry.data === undefined || typeof entry.data === 'string' ? entry : { ...entry, data: formatValue(entry.data) }),
+      levels: logger.getLevels(),
+      filePath: fileSink ? fileSink.filePath : null
+    };
+  });
+
+  /**
+   * Change the main process level ({ level, category }); the renderer
+   * changes its own logger directly
+   */
+  ipcMain.handle('log-set-level', async (event, { level, category } = {}) => {
+    if (!level) {
+      return { success: false, error: 'Level is required' };
+    }
+    logger.setLevel(level, category);
+    return { success: true, levels: logger.getLevels() };
+  });
+
+  ipcMain.handle('log-clear', async () => {
+    logger.clear();
+    return { success: true };
+  });
+
+  ipcMain.handle('log-open-file', async () => {
+    if (!fileSink) {
+      return { success: false, error: 'File logging is not enabled' };
+    }
+    await fileSink.flush();
+    const error = await shell.openPath(fileSink.filePath);
+    return error ? { success: false, error } : { success: true };
+  });
+}
+
+/**
+ * Write pending log lines; called before the application quits
+ * @returns {Promise<void>}
+ */
+function flushLogs() {
+  return fileSink ? fileSink.flush() : Promise.resolve();
+}
+
+module.exports = { setupLogHandlers, flushLogs };
@@ -0,0 +1,151 @@
+const { app, ipcMain, webContents } = require('electron');
+const path = require('path');
+const v8 = require('v8');
+const { childProcesses, ChildProcessTracker, HeapSnapshotWatcher } = require('../utils/processMetrics');
+const { getLocalModelMemory } = require('./assistantHandlers');
+const log = require('../utils/logger').getLogger('metrics');
+
+/** How often process memory is checked against the snapshot threshold */
+const CHECK_INTERVAL_MS = 15000;
+
+/** Default per-process memory limit that triggers a heap snapshot */
+const DEFAULT_THRESHOLD_MB = 1536;
+
+let watcher = null;
+
+/**
+ * Label Chromium processes with the window they render
+ * @returns {Map<number, Object>} pid -> { title, contents }
+ */
+function getRendererOwners() {
+  const owners = new Map();
+  for (const contents of webContents.getAllWebContents()) {
+    if (contents.isDestroyed()) continue;
+    owners.set(contents.getOSProcessId(), { title: contents.getTitle(), contents });
+  }
+  return owners;
+}
+
+/**
+ * Collect metrics for every process of the app
+ * @returns {Promise<Object>} { processes, main, children, model }
+ */
+async function collectMetrics() {
+  const owners = getRendererOwners();
+  const processes = app.getAppMetrics().map((metric) => {
+    const owner = owners.get(metric.pid);
+    return {
+      pid: metric.pid,
+      type: metric.type,
+      name: metric.pid === process.pid ? 'Main process' : owner ? owner.title : metric.name || metric.type,
+      cpuPercent: Math.round(metric.cpu.percentCPUUsage * 10) / 10,
+      // workingSetSize is reported in kilobytes
+      memoryMb: Math.round(metric.memory.workingSetSize / 1024),
+      owner
+    };
+  });
+
+  return {
+    processes,
+    main: process.memoryUsage(),
+    children: ChildProcessTracker.isSupported() ? await childProcesses.sample() : [],
+    model: getLocalModelMemory()
+  };
+}
+
+/**
+ * Write a heap snapshot of the main process or a renderer
+ * @param {string|Object} target - 'main' or a webContents
+ * @param {string} filePath - Destination
+ */
+async function captureHeapSnapshot(target, filePath) {
+  if (target === 'main') {
+    v8.writeHeapSnapshot(filePath);
+  } else {
+    const ok = await target.takeHeapSnapshot(filePath);
+    if (ok === false) throw new Error('Heap snapshot failed');
+  }
+}
+
+/**
+ * Processes whose JavaScript heap can be snapshotted
+ * @param {Array<Object>} processes - From collectMetrics
+ * @returns {Array<Object>} [{ key, memoryMb, target }]
+ */
+function snapshotTargets(processes) {
+  return processes
+    .filter(proc => proc.pid === process.pid || proc.owner)
+    .map(proc => ({
+      key: proc.pid === process.pid ? 'main' : `renderer-${proc.pid}`,
+      memoryMb: proc.memoryMb,
+      target: proc.pid === process.pid ? 'main' : proc.owner.contents
+    }));
+}
+
+/**
+ * Setup IPC handlers for process and memory metrics
+ * @param {BrowserWindow} mainWindow - Window notified about automatic snapshots
+ */
+function setupMetricsHandlers(mainWindow) {
+  watcher = new HeapSnapshotWatcher({
+    directory: path.join(app.getPath('userData'), 'heap-snapshots'),
+    capture: captureHeapSnapshot,
+    thresholdMb: DEFAULT_THRESHOLD_MB
+  });
+
+  const timer = setInterval(async () => {
+    try {
+      const { processes } = await collectMetrics();
+      const taken = await watcher.check(snapshotTargets(processes));
+      for (const snapshot of taken) {
+        log.warn(`Heap snapshot captured (${snapshot.reason}): ${snapshot.filePath}`);
+        if (mainWindow && !mainWindow.isDestroyed()) {
+          mainWindow.webContents.send('metrics-heap-snapshot', snapshot);
+        }
+      }
+    } catch (error) {
+      log.error('Error checking memory threshold', error);
+    }
+  }, CHECK_INTERVAL_MS);
+  timer.unref();
+
+  /**
+   * Metrics for the panel: processes, main heap, ctrace children, local model
+   */
+  ipcMain.handle('metrics-get', async () => {
+    try {
+      const metrics = await collectMetrics();
+      return {
+        success: true,
+        ...metrics,
+        // webContents cannot cross IPC
+        processes: metrics.processes.map(({ owner, ...proc }) => proc),
+        snapshots: watcher.snapshots,
+        thresholdMb: watcher.thresholdMb
+      };
+    } catch (error) {
+      log.error('Error collecting metrics', error);
+      return { success: false, error: error.message };
+    }
+  });
+
+  /**
+   * Per-process memory limit for automatic snapshots ({ thresholdMb }, 0 disables)
+   */
+  ipcMain.handle('metrics-set-threshold', async (event, { thresholdMb } = {}) => {
+    watcher.setThreshold(thresholdMb);
+    return { success: true, thresholdMb: watcher.thresholdMb };
+  });
+
+  /**
+   * Capture a heap snapshot now ({ target: 'main' | 'renderer' }); 'renderer'
+   * means the window that asked
+   */
+  ipcMain.handle('metrics-heap-snapshot', async (event, { target = 'main' } = {}) => {
+    const key = target === 'main' ? 'main' : `renderer-${event.sender.getOSProcessId()}`;
+    const snapshot = await watcher.take(key, target === 'main' ? 'main' : event.sender, 'manual');
+    return snapshot ? { success: true, snapshot } : { success: false, error: 'Heap snapshot failed' };
+  });
+}
+
+module.exports = { setupMetricsHandlers };
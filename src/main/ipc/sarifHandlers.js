@@ -0,0 +1,88 @@
+/**
+ * @fileoverview IPC handlers for importing SARIF logs
+ *
+ * Files are streamed and merged in the main process. Deduplicated
+ * diagnostics are sent to the renderer in batches as they are found, so
+ * neither process ever holds them all as objects; the reply carries the
+ * last batch and the metadata.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+const { ipcMain, dialog } = require('electron');
+const { readSarifFile } = require('../utils/sarif');
+const { SarifMerger } = require('../../shared/sarifMerger');
+const log = require('../utils/logger').getLogger('sarif');
+
+/** Minimum time between progress messages */
+const PROGRESS_INTERVAL_MS = 100;
+
+/** Diagnostics per 'sarif-import-batch' message */
+const BATCH_SIZE = 5000;
+
+/**
+ * Setup IPC handlers for SARIF import
+ * @param {BrowserWindow} mainWindow - Parent of the file dialog
+ */
+function setupSarifHandlers(mainWindow) {
+  /**
+   * Import SARIF files into one result set. Without { filePaths } a file
+   * dialog is shown; progress is sent as 'sarif-import-progress' and
+   * diagnostics as 'sarif-import-batch' (an array per message).
+   */
+  ipcMain.handle('import-sarif', async (event, { filePaths } = {}) => {
+    if (!filePaths) {
+      const choice = await dialog.showOpenDialog(mainWindow, {
+        title: 'Import SARIF',
+        properties: ['openFile', 'multiSelections'],
+        filters: [
+          { name: 'SARIF Logs', extensions: ['sarif', 'json'] },
+          { name: 'All Files', extensions: ['*'] }
+        ]
+      });
+      if (choice.canceled || choice.filePaths.length === 0) {
+        return { success: false, canceled: true };
+      }
+      filePaths = choice.filePaths;
+    }
+
+    let batch = [];
+    const merger = new SarifMerger({
+      onDiagnostic: (diag) => {
+        batch.push(diag);
+        if (batch.length < BATCH_SIZE) return;
+        if (event?.sender) event.sender.send('sarif-import-batch', batch);
+        batch = [];
+      }
+    });
+    let lastProgress = 0;
+    try {
+      for (let i = 0; i < filePaths.length; i++) {
+        await readSarifFile(filePaths[i], merger, (bytesRead) => {
+          const now = Date.now();
+          if (now - lastProgress < PROGRESS_INTERVAL_MS || !event?.sender) return;
+          lastProgress = now;
+          event.sender.send('sarif-import-progress', {
+            file: i + 1,
+            files: filePaths.length,
+            bytesRead,
+            results: merger.totalResults
+          });
+        });
+      }
+      const results = merger.finish();
+      log.info(`Imported ${results.meta.diagnostics} diagnostics from ${filePaths.length} SARIF file(s)`, {
+        runs: results.meta.runs,
+        duplicates: results.meta.duplicates
+      });
+      // The tail goes with the reply, after every batch sent before it
+      return { success: true, ...results, diagnostics: batch };
+    } catch (error) {
+      log.error('Error importing SARIF', error);
+      return { success: false, error: error.message };
+    }
+  });
+}
+
+module.exports = { setupSarifHandlers };
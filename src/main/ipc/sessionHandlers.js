@@ -0,0 +1,71 @@
+/**
+ * @fileoverview IPC handlers for session restore
+ *
+ * The renderer sends batches of journal records as the session changes and
+ * asks for the last session once at startup. The journal is compacted only
+ * once the renderer has restored it, off the startup path.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+const { ipcMain, app } = require('electron');
+const path = require('path');
+const { SessionJournal } = require('../utils/sessionJournal');
+const log = require('../utils/logger').getLogger('session');
+
+/** @type {SessionJournal|null} */
+let journal = null;
+
+/**
+ * Setup IPC handlers for the session journal
+ */
+function setupSessionHandlers() {
+  journal = new SessionJournal(path.join(app.getPath('userData'), 'session'));
+
+  /**
+   * Last session; diagnostics are listed by file, their output is loaded on demand
+   */
+  ipcMain.handle('session-restore', async () => {
+    try {
+      const started = Date.now();
+      const session = await journal.restore();
+      log.info(`Restored session with ${session.tabs.length} tabs in ${Date.now() - started} ms`);
+      return { success: true, session };
+    } catch (error) {
+      log.error('Error restoring session', error);
+      return { success: false, error: error.message };
+    }
+  });
+
+  /**
+   * Saved ctrace output of a file, when its tab is first focused
+   */
+  ipcMain.handle('session-load-diagnostics', async (event, filePath) => {
+    try {
+      return { success: true, output: await journal.loadDiagnostics(filePath) };
+    } catch (error) {
+      return { success: false, error: error.message };
+    }
+  });
+
+  /**
+   * The renderer has reopened the session; fold the journal into the snapshot
+   */
+  ipcMain.on('session-restored', () => {
+    journal.compact().catch(error => log.error('Error compacting session journal', error));
+  });
+
+  /**
+   * Append journal records; fire-and-forget so it also works while the window unloads
+   */
+  ipcMain.on('session-journal-append', (event, records) => {
+    journal.append(records).catch(error => log.error('Error writing session journal', error));
+  });
+
+  app.on('will-quit', () => {
+    journal.close().catch(() => {});
+  });
+}
+
+module.exports = { setupSessionHandlers };
@@ -0,0 +1,150 @@
+/**
+ * @fileoverview Fair pool of local model context sequences
+ *
+ * A loaded GGUF model can decode several independent sequences of one
+ * context in the same batch. This pool hands those sequences out to
+ * requests, queueing the rest. Waiting requests are grouped by client
+ * (interactive chat, a bulk job, ...) and served round-robin, so a job that
+ * queues hundreds of prompts cannot starve the chat panel.
+ *
+ * A sequence keeps the tokens of its last request in the KV cache, so a
+ * request may name an owner (a conversation): it is given the sequence that
+ * owner used last when that one is free, and unowned sequences before
+ * sequences another owner still holds state in.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+/**
+ * Round-robin pool of reusable resources
+ */
+class SequencePool {
+  /**
+   * @param {Array<*>} sequences - Resources to hand out (context sequences)
+   */
+  constructor(sequences) {
+    this.free = sequences.slice();
+    this.size = sequences.length;
+    /** @type {Map<*, string>} sequence -> owner whose state it holds */
+    this.owners = new Map();
+    /** @type {Map<string, Array<Function>>} client id -> waiting resolvers, oldest first */
+    this.queues = new Map();
+    /** Client ids in service order; the next grant goes to the first one waiting */
+    this.rotation = [];
+    this.closed = false;
+  }
+
+  /**
+   * @returns {Object} { size, busy, queued }
+   */
+  getStatus() {
+    let queued = 0;
+    for (const queue of this.queues.values()) queued += queue.length;
+    return { size: this.size, busy: this.size - this.free.length, queued };
+  }
+
+  /**
+   * Wait for a free sequence
+   * @param {string} clientId - Requesting client, used for fairness
+   * @param {string} [owner] - Owner whose sequence is preferred
+   * @returns {Promise<*>} Sequence; hand it back with release()
+   */
+  acquire(clientId = 'default', owner = null) {
+    if (this.closed) {
+      return Promise.reject(new Error('Sequence pool is closed'));
+    }
+    if (this.free.length > 0 && this.queues.size === 0) {
+      return Promise.resolve(this.take(owner));
+    }
+    return new Promise((resolve, reject) => {
+      let queue = this.queues.get(clientId);
+      if (!queue) {
+        queue = [];
+        this.queues.set(clientId, queue);
+        this.rotation.push(clientId);
+      }
+      queue.push({ resolve, reject, owner });
+      this.dispatch();
+    });
+  }
+
+  /**
+   * Remove a free sequence: the owner's own, else an unowned one, else the
+   * one released longest ago
+   * @param {string|null} owner - Preferred owner
+   * @returns {*} Sequence
+   * @private
+   */
+  take(owner) {
+    let index = owner === null ? -1 : this.free.findIndex(sequence => this.owners.get(sequence) === owner);
+    if (index === -1) index = this.free.findIndex(sequence => !this.owners.has(sequence));
+    if (index === -1) index = 0;
+    return this.free.splice(index, 1)[0];
+  }
+
+  /**
+   * Return a sequence and serve the next waiting client
+   * @param {*} sequence - Sequence obtained from acquire()
+   */
+  release(sequence) {
+    if (this.closed) return;
+    this.free.push(sequence);
+    this.dispatch();
+  }
+
+  /**
+   * Grant free sequences to waiting clients in round-robin order
+   * @private
+   */
+  dispatch() {
+    while (this.free.length > 0 && this.rotation.length > 0) {
+      const clientId = this.rotation.shift();
+      const queue = this.queues.get(clientId);
+      const waiter = queue.shift();
+      if (queue.length > 0) {
+        this.rotation.push(clientId);
+      } else {
+        this.queues.delete(clientId);
+      }
+      waiter.resolve(this.take(waiter.owner));
+    }
+  }
+
+  /**
+   * Run a task with a pooled sequence
+   * @param {string} clientId - Requesting client
+   * @param {Function} task - async (sequence, { queuedMs, previousOwner }) => result
+   * @param {string} [owner] - Owner the sequence holds state for afterwards; none
+   *   leaves it unowned
+   * @returns {Promise<*>} Task result
+   */
+  async run(clientId, task, owner = null) {
+    const queuedAt = Date.now();
+    const sequence = await this.acquire(clientId, owner);
+    const previousOwner = this.owners.has(sequence) ? this.owners.get(sequence) : null;
+    if (owner === null) this.owners.delete(sequence);
+    else this.owners.set(sequence, owner);
+    try {
+      return await task(sequence, { queuedMs: Date.now() - queuedAt, previousOwner });
+    } finally {
+      this.release(sequence);
+    }
+  }
+
+  /**
+   * Reject every waiting request; used when the model is unloaded
+   */
+  close() {
+    this.closed = true;
+    for (const queue of this.queues.values()) {
+      for (const waiter of queue) waiter.reject(new Error('Local model was unloaded'));
+    }
+    this.queues.clear();
+    this.rotation = [];
+    this.free = [];
+    this.owners.clear();
+  }
+}
+
+module.exports = SequencePool;
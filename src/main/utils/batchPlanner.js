@@ -0,0 +1,345 @@
+/**
+ * @fileoverview Adaptive multi-file batching of ctrace invocations
+ *
+ * Every ctrace run pays a fixed cost (process start, socket setup, loading
+ * the analyzer) before it looks at a single line, and for a repository of
+ * tiny C files that cost dominates. The planner packs small translation
+ * units into one multi-input invocation (`--input=a.c,b.c,...`) so the
+ * fixed cost is shared, while large files still run alone.
+ *
+ * How much to pack comes from AnalysisCostModel: a decayed least-squares fit
+ * of invocation time against input bytes gives this machine's per-invocation
+ * overhead (the intercept) and analysis rate (the slope), and files seen
+ * before use their own recorded analysis time. Batches are sized so the
+ * overhead stays a small share of each invocation, and shrink towards the
+ * end of a run so every job stays busy.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+const fs = require('fs').promises;
+const path = require('path');
+
+/** Starting guesses until the first invocations have been timed */
+const DEFAULT_OVERHEAD_MS = 250;
+const DEFAULT_MS_PER_KB = 2;
+
+/** Weight kept by older observations at each new one */
+const DECAY = 0.8;
+
+/** Target share of an invocation spent on fixed overhead */
+const OVERHEAD_SHARE = 0.2;
+
+/** Most files in one invocation */
+const DEFAULT_MAX_FILES = 32;
+
+/** Most files remembered in the history */
+const MAX_HISTORY = 20000;
+
+/**
+ * Per-invocation overhead and per-file analysis time on this machine
+ */
+class AnalysisCostModel {
+  /**
+   * @param {Object} [options]
+   * @param {number} [options.overheadMs] - Initial overhead estimate
+   * @param {number} [options.msPerKB] - Initial analysis rate estimate
+   */
+  constructor({ overheadMs = DEFAULT_OVERHEAD_MS, msPerKB = DEFAULT_MS_PER_KB } = {}) {
+    /** @type {Map<string, Object>} File -> { size, ms } of its last analysis */
+    this.history = new Map();
+    this.filePath = null;
+    this.seed(overheadMs, msPerKB);
+  }
+
+  /**
+   * Reset the fit to two pseudo-observations on the line overhead + rate * KB
+   * @private
+   */
+  seed(overheadMs, msPerKB) {
+    this.overheadMs = overheadMs;
+    this.msPerKB = msPerKB;
+    this.sums = { w: 0, x: 0, y: 0, xx: 0, xy: 0 };
+    this.add(0, overheadMs, 1);
+    this.add(64, overheadMs + 64 * msPerKB, 1);
+  }
+
+  /**
+   * @private
+   */
+  add(kb, ms, weight) {
+    const s = this.sums;
+    s.w += weight;
+    s.x += weight * kb;
+    s.y += weight * ms;
+    s.xx += weight * kb * kb;
+    s.xy += weight * kb * ms;
+  }
+
+  /**
+   * @param {Object} file - { path, size }
+   * @returns {number} Expected analysis time without overhead, in ms
+   */
+  estimate(file) {
+    const known = this.history.get(file.path);
+    if (known && known.size === file.size) return known.ms;
+    return (file.size / 1024) * this.msPerKB;
+  }
+
+  /**
+   * Record a finished invocation
+   * @param {Array<Object>} files - { path, size } of its inputs
+   * @param {number} durationMs - Wall time of the invocation
+   * @returns {Array<number>} Analysis time attributed to each file
+   */
+  observe(files, durationMs) {
+    const s = this.sums;
+    for (const key of Object.keys(s)) s[key] *= DECAY;
+    const kb = files.reduce((sum, file) => sum + file.size, 0) / 1024;
+    this.add(kb, durationMs, 1);
+
+    const variance = s.xx - (s.x * s.x) / s.w;
+    if (variance > 1e-9) {
+      this.msPerKB = Math.max(0, (s.xy - (s.x * s.y) / s.w) / variance);
+    }
+    this.overheadMs = Math.min(durationMs, Math.max(0, (s.y - this.msPerKB * s.x) / s.w));
+
+    // Split the work time over the inputs in proportion to their estimates
+    const estimates = files.map(file => this.estimate(file));
+    const total = estimates.reduce((sum, value) => sum + value, 0);
+    const work = Math.max(0, durationMs - this.overheadMs);
+    return files.map((file, index) => {
+      const ms = total > 0 ? (work * estimates[index]) / total : work / files.length;
+      this.history.delete(file.path);
+      this.history.set(file.path, { size: file.size, ms });
+      if (this.history.size > MAX_HISTORY) this.history.delete(this.history.keys().next().value);
+      return ms;
+    });
+  }
+
+  /**
+   * Restore the model saved by a previous run
+   * @param {string} filePath - JSON file
+   * @returns {Promise<number>} Files with a recorded time
+   */
+  async load(filePath) {
+    this.filePath = filePath;
+    try {
+      const saved = JSON.parse(await fs.readFile(filePath, 'utf8'));
+      if (saved.version === 1) {
+        this.seed(saved.overheadMs, saved.msPerKB);
+        for (const [file, entry] of saved.files || []) {
+          if (entry && typeof entry.size === 'number' && typeof entry.ms === 'number') this.history.set(file, entry);
+        }
+      }
+    } catch (error) {
+      if (error.code !== 'ENOENT') console.warn('Ignoring unreadable analysis history:', error.message);
+    }
+    return this.history.size;
+  }
+
+  /**
+   * @returns {Promise<void>}
+   */
+  async save() {
+    if (!this.filePath) return;
+    await fs.mkdir(path.dirname(this.filePath), { recursive: true });
+    const tmpPath = `${this.filePath}.tmp`;
+    await fs.writeFile(tmpPath, JSON.stringify({
+      version: 1,
+      overheadMs: this.overheadMs,
+      msPerKB: this.msPerKB,
+      files: Array.from(this.history)
+    }), 'utf8');
+    await fs.rename(tmpPath, this.filePath);
+  }
+}
+
+/**
+ * Hands out batches of files, sized from the cost model at the time each
+ * batch is taken
+ */
+class BatchPlanner {
+  /**
+   * @param {Array<Object>} files - { path, size }
+   * @param {AnalysisCostModel} model - Cost model, updated by the caller as batches finish
+   * @param {Object} [options]
+   * @param {number} [options.jobs] - Invocations run in parallel
+   * @param {number} [options.maxFiles] - Most files per invocation; 1 disables batching
+   */
+  constructor(files, model, { jobs = 1, maxFiles = DEFAULT_MAX_FILES } = {}) {
+    this.model = model;
+    this.jobs = Math.max(1, jobs);
+    this.maxFiles = Math.max(1, maxFiles);
+    // Largest first: big files start early, small ones fill the batches
+    this.queue = files.filter(BatchPlanner.canBatch)
+      .sort((a, b) => model.estimate(b) - model.estimate(a) || (a.path < b.path ? -1 : 1));
+    this.head = 0;
+    this.tail = this.queue.length - 1;
+    /** @type {Array<Object>} Files to run on their own, served first */
+    this.retry = files.filter(file => !BatchPlanner.canBatch(file));
+    // Queued work: recorded times, plus bytes priced at the current rate
+    this.queuedMs = 0;
+    this.queuedKB = 0;
+    for (const file of this.queue) this.account(file, 1);
+  }
+
+  /**
+   * Add a file to, or remove it from, the queued work
+   * @private
+   */
+  account(file, sign) {
+    const known = this.model.history.get(file.path);
+    if (known && known.size === file.size) this.queuedMs += sign * known.ms;
+    else this.queuedKB += sign * (file.size / 1024);
+  }
+
+  /**
+   * @private
+   */
+  take(index) {
+    const file = this.queue[index];
+    this.account(file, -1);
+    return file;
+  }
+
+  /**
+   * Work per invocation that keeps overhead at OVERHEAD_SHARE of it,
+   * capped so the remaining work still spreads over every job
+   * @returns {number} Target estimated ms per batch
+   * @private
+   */
+  targetWork() {
+    const left = Math.max(0, this.queuedMs + this.queuedKB * this.model.msPerKB);
+    const target = (this.model.overheadMs * (1 - OVERHEAD_SHARE)) / OVERHEAD_SHARE;
+    return Math.min(target, left / this.jobs);
+  }
+
+  /**
+   * @returns {Array<Object>|null} Files of the next invocation, null when done
+   */
+  next() {
+    if (this.retry.length > 0) return [this.retry.shift()];
+    if (this.head > this.tail) return null;
+
+    // Priced before taking anything, so the first file counts towards the cap
+    const target = this.targetWork();
+    const first = this.take(this.head++);
+    const batch = [first];
+    if (this.maxFiles === 1) return batch;
+
+    let work = this.model.estimate(first);
+    while (batch.length < this.maxFiles && this.head <= this.tail) {
+      const candidate = this.queue[this.tail];
+      const cost = this.model.estimate(candidate);
+      if (work + cost > target) break;
+      batch.push(this.take(this.tail--));
+      work += cost;
+    }
+    return batch;
+  }
+
+  /**
+   * Hand out one file at a time from now on
+   */
+  disableBatching() {
+    this.maxFiles = 1;
+  }
+
+  /**
+   * Run files again, each on its own, e.g. after their batch failed
+   * @param {Array<Object>} files - Files to requeue
+   */
+  requeue(files) {
+    this.retry.push(...files);
+  }
+
+  /**
+   * @param {Object} file - { path }
+   * @returns {boolean} Whether the path can be part of a comma-separated --input
+   */
+  static canBatch(file) {
+    return !file.path.includes(',');
+  }
+}
+
+/**
+ * Whether a reported file names an input
+ * @param {string} reported - location.file from ctrace output
+ * @param {Object} input - { path, ctracePath }
+ * @returns {number} 3 exact, 2 path suffix, 1 same file name, 0 no match
+ */
+function matchQuality(reported, input) {
+  const file = reported.replace(/\\/g, '/');
+  const candidates = [input.ctracePath, input.path].map(value => value.replace(/\\/g, '/'));
+  if (candidates.includes(file)) return 3;
+  const relative = file.replace(/^(\.\/)+/, '');
+  if (candidates.some(value => value.endsWith(`/${relative}`))) return 2;
+  return path.posix.basename(file) === path.posix.basename(candidates[0]) ? 1 : 0;
+}
+
+/**
+ * Inputs that the output of a multi-input invocation shows were analyzed:
+ * named in its meta or in the location of one of its diagnostics. An input
+ * that is not confirmed may have been skipped by a ctrace that reads only
+ * its first input.
+ * @param {Object} analysis - { meta, diagnostics } of the whole invocation
+ * @param {Array<Object>} inputs - { path, ctracePath } in --input order
+ * @returns {Array<boolean>} Whether each input is confirmed
+ */
+function confirmedInputs(analysis, inputs) {
+  const named = [];
+  const meta = analysis.meta || {};
+  for (const key of ['inputFile', 'inputFiles', 'input', 'inputs']) {
+    for (const value of [].concat(meta[key] || [])) {
+      if (typeof value === 'string') named.push(...value.split(','));
+    }
+  }
+  for (const diag of analysis.diagnostics || []) {
+    if (diag.location && diag.location.file) named.push(diag.location.file);
+  }
+  return inputs.map(input => named.some(file => matchQuality(file, input) >= 2));
+}
+
+/**
+ * Split the output of a multi-input invocation into per-input results
+ * @param {Object} analysis - { meta, functions, diagnostics } of the whole invocation
+ * @param {Array<Object>} inputs - { path, ctracePath } in --input order
+ * @returns {Array<Object>} { meta, functions, diagnostics } per input. Diagnostics in a
+ *   file that is not an input (a header) go to the first input; function names go to
+ *   the inputs whose diagnostics mention them, the rest to the first input
+ */
+function demultiplex(analysis, inputs) {
+  const parts = inputs.map(() => ({ meta: analysis.meta, functions: [], diagnostics: [] }));
+  const functionOwner = new Map();
+  const owner = (file) => {
+    if (!file) return 0;
+    let best = 0;
+    let bestQuality = 0;
+    inputs.forEach((input, index) => {
+      const quality = matchQuality(file, input);
+      if (quality > bestQuality) {
+        best = index;
+        bestQuality = quality;
+      }
+    });
+    return best;
+  };
+
+  for (const diag of analysis.diagnostics || []) {
+    const location = diag.location || {};
+    const index = owner(location.file);
+    parts[index].diagnostics.push(diag);
+    if (location.function && !functionOwner.has(location.function)) functionOwner.set(location.function, index);
+  }
+  for (const fn of analysis.functions || []) {
+    const location = fn && typeof fn === 'object' ? fn.location || fn : null;
+    const name = location ? fn.name || location.function : fn;
+    const index = location && location.file ? owner(location.file) : functionOwner.has(name) ? functionOwner.get(name) : 0;
+    parts[index].functions.push(fn);
+  }
+  return parts;
+}
+
+module.exports = { AnalysisCostModel, BatchPlanner, demultiplex, confirmedInputs, DEFAULT_MAX_FILES };
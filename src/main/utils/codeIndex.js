@@ -0,0 +1,594 @@
+/**
+ * @fileoverview Local BM25 retrieval over workspace C/C++ functions
+ *
+ * Splits workspace C/C++ sources into function-level documents, tokenizes
+ * them into identifier parts (snake_case and camelCase are split, the whole
+ * identifier is kept as well) and maintains an in-memory inverted index.
+ * The index is built when a workspace is opened and kept current by the
+ * workspace watcher, one file at a time. Queries are answered entirely
+ * offline; function bodies are re-read from disk only when packed into a
+ * context, so memory holds postings and line ranges, not source text.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+const fs = require('fs').promises;
+const path = require('path');
+const { splitIdentifiers } = require('../../shared/identifiers');
+
+/** Source extensions that are indexed */
+const INDEXED_EXTENSIONS = new Set(['.c', '.h', '.cc', '.cpp', '.cxx', '.hh', '.hpp', '.hxx']);
+
+/** Directories never descended into (same list as the file tree) */
+const SKIPPED_DIRECTORIES = new Set(['node_modules', 'dist', 'build', '.git', 'My Music', 'My Pictures', 'My Videos', '$RECYCLE.BIN', 'System Volume Information']);
+
+/** Files larger than this are not indexed */
+const MAX_INDEXED_FILE_SIZE = 2 * 1024 * 1024;
+
+/** Approximate characters per token for budget estimates */
+const CHARS_PER_TOKEN = 4;
+
+/** BM25 parameters */
+const BM25_K1 = 1.2;
+const BM25_B = 0.75;
+
+/** Extra weight of the function name tokens relative to body tokens */
+const NAME_WEIGHT = 3;
+
+/** Words that look like calls but never start a function definition */
+const NON_FUNCTION_NAMES = new Set(['if', 'for', 'while', 'switch', 'return', 'sizeof', 'catch', 'decltype', 'alignof', 'static_assert']);
+
+const SCOPE_REGEX = /\b(namespace|class|struct|union)\b[^()]*$|extern\s*"C"\s*$/;
+const FUNCTION_NAME_REGEX = /([A-Za-z_~][\w:~]*)\s*\(/;
+
+/**
+ * Find function definitions in C/C++ source.
+ * A lightweight scanner: skips comments, strings, character literals and
+ * preprocessor lines, and treats namespace/class/struct/extern "C" bodies as
+ * transparent so methods defined inline are found too.
+ * @param {string} code - Source text
+ * @returns {Array<Object>} [{ name, start, end, startLine, endLine }] (offsets and 1-based lines)
+ */
+function extractFunctions(code) {
+  const functions = [];
+  const stack = []; // block kinds: 'scope', 'function', 'other'
+  let segmentStart = 0;
+  let functionStart = -1;
+  let functionName = null;
+  let line = 1;
+  let functionLine = 0;
+  let atLineStart = true;
+  const length = code.length;
+
+  const inScope = () => stack.every(kind => kind === 'scope');
+
+  for (let i = 0; i < length; i++) {
+    const ch = code[i];
+
+    if (ch === '\n') {
+      line++;
+      atLineStart = true;
+      continue;
+    }
+    if (ch === ' ' || ch === '\t' || ch === '\r') continue;
+
+    // Preprocessor line (with continuations)
+    if (atLineStart && ch === '#') {
+      while (i < length && !(code[i] === '\n' && !isContinued(code, i))) {
+        if (code[i] === '\n') line++;
+        i++;
+      }
+      if (i < length) line++;
+      if (inScope()) segmentStart = i + 1;
+      continue;
+    }
+    atLineStart = false;
+
+    if (ch === '/' && code[i + 1] === '/') {
+      while (i < length && code[i] !== '\n') i++;
+      i--;
+      continue;
+    }
+    if (ch === '/' && code[i + 1] === '*') {
+      i += 2;
+      while (i < length && !(code[i] === '*' && code[i + 1] === '/')) {
+        if (code[i] === '\n') line++;
+        i++;
+      }
+      i++;
+      continue;
+    }
+    if (ch === '"' || ch === '\'') {
+      i++;
+      while (i < length && code[i] !== ch && code[i] !== '\n') {
+        if (code[i] === '\\') i++;
+        i++;
+      }
+      // Unterminated literal: let the loop see the newline
+      if (code[i] === '\n') i--;
+      continue;
+    }
+
+    if (ch === '{') {
+      let kind = 'other';
+      if (inScope()) {
+        const header = code.slice(segmentStart, i);
+        const signature = header.replace(/\/\*[\s\S]*?\*\//g, ' ').replace(/\/\/.*$/gm, ' ');
+        if (/=\s*$/.test(signature)) {
+          kind = 'other';
+        } else if (SCOPE_REGEX.test(signature)) {
+          kind = 'scope';
+        } else {
+          const nameMatch = signature.match(FUNCTION_NAME_REGEX);
+          if (nameMatch && !NON_FUNCTION_NAMES.has(nameMatch[1])) {
+            kind = 'function';
+            functionName = nameMatch[1];
+            const leading = header.length - header.trimStart().length;
+            functionStart = segmentStart + leading;
+            functionLine = line - countNewlines(header, leading);
+          }
+        }
+      }
+      stack.push(kind);
+      if (kind === 'scope') segmentStart = i + 1;
+    } else if (ch === '}') {
+      const kind = stack.pop();
+      if (kind === 'function' && inScope()) {
+        functions.push({ name: functionName, start: functionStart, end: i + 1, startLine: functionLine, endLine: line });
+        functionStart = -1;
+      }
+      if (inScope()) segmentStart = i + 1;
+    } else if (ch === ';' && inScope()) {
+      segmentStart = i + 1;
+    }
+  }
+
+  return functions;
+}
+
+/**
+ * Whether the newline at an offset is escaped by a backslash (LF or CRLF)
+ * @param {string} code - Source text
+ * @param {number} index - Offset of a newline
+ * @returns {boolean} True for a line continuation
+ * @private
+ */
+function isContinued(code, index) {
+  const before = code[index - 1] === '\r' ? index - 2 : index - 1;
+  return code[before] === '\\';
+}
+
+/**
+ * Count newlines in text after an offset
+ * @param {string} text - Text
+ * @param {number} from - Offset to start counting at
+ * @returns {number} Newline count
+ * @private
+ */
+function countNewlines(text, from) {
+  let count = 0;
+  for (let i = from; i < text.length; i++) {
+    if (text.charCodeAt(i) === 10) count++;
+  }
+  return count;
+}
+
+/**
+ * @param {string} text - Text
+ * @returns {number} Estimated tokens
+ */
+function estimateTokens(text) {
+  return Math.ceil(text.length / CHARS_PER_TOKEN);
+}
+
+/**
+ * Posting list for one term: parallel growable arrays of doc ids and
+ * term frequencies. Removed documents are skipped at query time and
+ * dropped on compaction.
+ * @private
+ */
+class PostingList {
+  constructor(term) {
+    this.term = term;
+    this.ids = new Int32Array(4);
+    this.tfs = new Uint16Array(4);
+    this.size = 0;
+    this.live = 0;
+  }
+
+  push(id, tf) {
+    if (this.size === this.ids.length) {
+      const ids = new Int32Array(this.size * 2);
+      const tfs = new Uint16Array(this.size * 2);
+      ids.set(this.ids);
+      tfs.set(this.tfs);
+      this.ids = ids;
+      this.tfs = tfs;
+    }
+    this.ids[this.size] = id;
+    this.tfs[this.size] = Math.min(tf, 65535);
+    this.size++;
+    this.live++;
+  }
+
+  compact(alive) {
+    let write = 0;
+    for (let read = 0; read < this.size; read++) {
+      if (alive[this.ids[read]]) {
+        this.ids[write] = this.ids[read];
+        this.tfs[write] = this.tfs[read];
+        write++;
+      }
+    }
+    this.size = write;
+  }
+}
+
+/**
+ * Inverted index of workspace functions with BM25 ranking
+ */
+class CodeIndex {
+  constructor() {
+    this.clear();
+  }
+
+  /**
+   * Drop the whole index
+   */
+  clear() {
+    this.rootPath = null;
+    /** @type {Map<number, Object>} doc id -> { file, name, startLine, endLine, lists } */
+    this.docs = new Map();
+    /** @type {Map<string, Array<number>>} file path -> doc ids */
+    this.fileDocs = new Map();
+    /** @type {Map<string, PostingList>} term -> posting list */
+    this.postings = new Map();
+    // Per doc id: token count and liveness; scores is reused across queries
+    this.docLengths = new Float64Array(1024);
+    this.alive = new Uint8Array(1024);
+    this.scores = new Float64Array(1024);
+    this.totalLength = 0;
+    this.deadCount = 0;
+    this.nextDocId = 1;
+    this.generation = (this.generation || 0) + 1;
+  }
+
+  /**
+   * @param {string} filePath - Path to check
+   * @returns {boolean} Whether the file is a C/C++ source the index covers
+   */
+  static isIndexable(filePath) {
+    return INDEXED_EXTENSIONS.has(path.extname(filePath).toLowerCase());
+  }
+
+  /**
+   * Index every C/C++ file below a directory, replacing the current index
+   * @param {string} rootPath - Workspace root
+   * @returns {Promise<Object>} { files, functions, elapsedMs }
+   */
+  async build(rootPath) {
+    const started = Date.now();
+    this.clear();
+    this.rootPath = rootPath;
+    const generation = this.generation;
+
+    const files = [];
+    await collectSourceFiles(rootPath, files, 0);
+
+    for (const filePath of files) {
+      // A newer build or clear() supersedes this one
+      if (this.generation !== generation) break;
+      await this.updateFile(filePath);
+    }
+
+    return { files: this.fileDocs.size, functions: this.docs.size, elapsedMs: Date.now() - started };
+  }
+
+  /**
+   * (Re)index one file from disk
+   * @param {string} filePath - Absolute file path
+   * @returns {Promise<void>}
+   */
+  async updateFile(filePath) {
+    if (!CodeIndex.isIndexable(filePath)) return;
+    // A clear() or build() while the file is read makes the result stale
+    const generation = this.generation;
+    try {
+      const stats = await fs.stat(filePath);
+      if (this.generation !== generation) return;
+      if (stats.size > MAX_INDEXED_FILE_SIZE) {
+        this.removeFile(filePath);
+        return;
+      }
+      const code = await fs.readFile(filePath, 'utf8');
+      if (this.generation !== generation) return;
+      this.indexSource(filePath, code);
+    } catch (error) {
+      if (this.generation === generation) this.removeFile(filePath);
+    }
+  }
+
+  /**
+   * Index source text for a file, replacing its previous documents
+   * @param {string} filePath - File path the text belongs to
+   * @param {string} code - Source text
+   */
+  indexSource(filePath, code) {
+    this.removeFile(filePath);
+
+    const ids = [];
+    for (const fn of extractFunctions(code)) {
+      const tokens = splitIdentifiers(code.slice(fn.start, fn.end));
+      const nameTokens = splitIdentifiers(fn.name.replace(/::/g, ' '));
+      for (let w = 0; w < NAME_WEIGHT; w++) tokens.push(...nameTokens);
+      if (tokens.length === 0) continue;
+
+      const id = this.nextDocId++;
+      this.ensureCapacity(id + 1);
+
+      const frequencies = new Map();
+      for (const token of tokens) {
+        frequencies.set(token, (frequencies.get(token) || 0) + 1);
+      }
+      const lists = [];
+      for (const [term, tf] of frequencies) {
+        let list = this.postings.get(term);
+        if (!list) {
+          list = new PostingList(term);
+          this.postings.set(term, list);
+        }
+        list.push(id, tf);
+        lists.push(list);
+      }
+
+      this.docs.set(id, { file: filePath, name: fn.name, startLine: fn.startLine, endLine: fn.endLine, lists });
+      this.docLengths[id] = tokens.length;
+      this.alive[id] = 1;
+      this.totalLength += tokens.length;
+      ids.push(id);
+    }
+
+    if (ids.length > 0) this.fileDocs.set(filePath, ids);
+  }
+
+  /**
+   * Grow the per-document arrays
+   * @param {number} size - Required length
+   * @private
+   */
+  ensureCapacity(size) {
+    if (size <= this.alive.length) return;
+    const capacity = Math.max(size, this.alive.length * 2);
+    const docLengths = new Float64Array(capacity);
+    const alive = new Uint8Array(capacity);
+    docLengths.set(this.docLengths);
+    alive.set(this.alive);
+    this.docLengths = docLengths;
+    this.alive = alive;
+    this.scores = new Float64Array(capacity);
+  }
+
+  /**
+   * Remove a file's documents
+   * @param {string} filePath - File path
+   */
+  removeFile(filePath) {
+    const ids = this.fileDocs.get(filePath);
+    if (!ids) return;
+    for (const id of ids) {
+      const doc = this.docs.get(id);
+      for (const list of doc.lists) {
+        list.live--;
+        if (list.live === 0) this.postings.delete(list.term);
+      }
+      this.alive[id] = 0;
+      this.totalLength -= this.docLengths[id];
+      this.docs.delete(id);
+      this.deadCount++;
+    }
+    this.fileDocs.delete(filePath);
+
+    // Posting lists skip removed docs lazily; compact once they dominate
+    if (this.deadCount > 1024 && this.deadCount > this.docs.size) {
+      for (const list of this.postings.values()) list.compact(this.alive);
+      this.deadCount = 0;
+    }
+  }
+
+  /**
+   * Remove every file below a directory
+   * @param {string} dirPath - Directory path
+   */
+  removeDirectory(dirPath) {
+    const prefix = dirPath.endsWith(path.sep) ? dirPath : dirPath + path.sep;
+    for (const filePath of Array.from(this.fileDocs.keys())) {
+      if (filePath.startsWith(prefix)) this.removeFile(filePath);
+    }
+  }
+
+  /**
+   * Rank functions for a query
+   * @param {string} query - Question or identifiers
+   * @param {number} limit - Maximum number of results
+   * @returns {Array<Object>} [{ id, score, file, name, startLine, endLine }] best first
+   */
+  search(query, limit = 8) {
+    const docCount = this.docs.size;
+    if (docCount === 0) return [];
+
+    const terms = Array.from(new Set(splitIdentifiers(query)));
+    const averageLength = this.totalLength / docCount;
+    const { scores, alive, docLengths } = this;
+    const touched = [];
+
+    for (const term of terms) {
+      const list = this.postings.get(term);
+      if (!list) continue;
+      const idf = Math.log(1 + (docCount - list.live + 0.5) / (list.live + 0.5));
+      const { ids, tfs, size } = list;
+      for (let j = 0; j < size; j++) {
+        const id = ids[j];
+        if (!alive[id]) continue;
+        const tf = tfs[j];
+        const norm = tf * (BM25_K1 + 1) / (tf + BM25_K1 * (1 - BM25_B + BM25_B * docLengths[id] / averageLength));
+        if (scores[id] === 0) touched.push(id);
+        scores[id] += idf * norm;
+      }
+    }
+
+    // Keep only the best `limit` entries instead of sorting every match
+    const top = [];
+    for (const id of touched) {
+      const score = scores[id];
+      scores[id] = 0;
+      if (top.length === limit && score <= top[top.length - 1].score) continue;
+      let pos = top.length;
+      while (pos > 0 && top[pos - 1].score < score) pos--;
+      top.splice(pos, 0, { id, score });
+      if (top.length > limit) top.pop();
+    }
+
+    return top.map(({ id, score }) => {
+      const doc = this.docs.get(id);
+      return { id, score, file: doc.file, name: doc.name, startLine: doc.startLine, endLine: doc.endLine };
+    });
+  }
+
+  /**
+   * Build an assistant context for a question: relevant ctrace diagnostics
+   * first, then the best-matching function bodies, within a token budget.
+   * @param {string} query - User question
+   * @param {Object} options - { tokenBudget, limit, diagnostics, diagnosticsFile }
+   * @returns {Promise<Object>} { text, functions, diagnostics, searchMs }
+   */
+  async buildContext(query, options = {}) {
+    const tokenBudget = options.tokenBudget || 1500;
+    const started = process.hrtime.bigint();
+    const results = this.search(query, options.limit || 8);
+    const searchMs = Number(process.hrtime.bigint() - started) / 1e6;
+
+    let remaining = tokenBudget;
+    const sections = [];
+
+    // Diagnostics are short and high-signal; they may use up to a third of the budget
+    const diagnosticLines = selectDiagnostics(options.diagnostics || [], query, results);
+    if (diagnosticLines.length > 0) {
+      let block = `ctrace diagnostics${options.diagnosticsFile ? ` for ${path.basename(options.diagnosticsFile)}` : ''}:\n`;
+      const cap = Math.floor(tokenBudget / 3);
+      let used = 0;
+      for (const line of diagnosticLines) {
+        const cost = estimateTokens(line) + 1;
+        if (used + cost > cap) break;
+        block += line + '\n';
+        used += cost;
+      }
+      remaining -= estimateTokens(block);
+      sections.push(block);
+    }
+
+    const packed = [];
+    const fileCache = new Map();
+    for (const result of results) {
+      if (remaining < 64) break;
+      let lines = fileCache.get(result.file);
+      if (!lines) {
+        try {
+          lines = (await fs.readFile(result.file, 'utf8')).split('\n');
+        } catch (error) {
+          continue;
+        }
+        fileCache.set(result.file, lines);
+      }
+
+      const label = this.rootPath ? path.relative(this.rootPath, result.file) : result.file;
+      const header = `// ${label}:${result.startLine}-${result.endLine} (${result.name})\n`;
+      let body = lines.slice(result.startLine - 1, result.endLine).join('\n').replace(/\r/g, '');
+      const available = (remaining - estimateTokens(header) - 4) * CHARS_PER_TOKEN;
+      if (available <= 0) break;
+      if (body.length > available) {
+        const cut = body.lastIndexOf('\n', available);
+        body = body.slice(0, cut > 0 ? cut : available) + '\n// ... (truncated)';
+      }
+
+      const section = `${header}\`\`\`\n${body}\n\`\`\`\n`;
+      remaining -= estimateTokens(section);
+      sections.push(section);
+      packed.push({ file: result.file, name: result.name, startLine: result.startLine, endLine: result.endLine, score: result.score });
+    }
+
+    return {
+      text: sections.join('\n'),
+      functions: packed,
+      diagnostics: diagnosticLines.length,
+      searchMs
+    };
+  }
+}
+
+/**
+ * Pick the diagnostics that relate to a question or to the retrieved functions
+ * @param {Array<Object>} diagnostics - ctrace diagnostics
+ * @param {string} query - User question
+ * @param {Array<Object>} results - Search results
+ * @returns {Array<string>} Formatted diagnostic lines, most relevant first
+ * @private
+ */
+function selectDiagnostics(diagnostics, query, results) {
+  if (diagnostics.length === 0) return [];
+  const queryTerms = new Set(splitIdentifiers(query));
+  const retrieved = new Set(results.map(result => result.name.split('::').pop()));
+
+  const scored = [];
+  for (const diag of diagnostics) {
+    const fn = (diag.location && diag.location.function) || '';
+    const message = (diag.details && diag.details.message) || '';
+    let score = retrieved.has(fn) ? 2 : 0;
+    for (const token of splitIdentifiers(`${fn} ${diag.ruleId || ''} ${message}`)) {
+      if (queryTerms.has(token)) {
+        score += 1;
+        break;
+      }
+    }
+    if (score > 0) {
+      const firstLine = message.split('\n')[0].replace(/^\s*\[!!\]\s*/, '').trim();
+      const where = diag.location ? `${fn}:${diag.location.startLine || '?'}` : fn;
+      scored.push({ score, text: `- [${diag.severity || 'INFO'} ${diag.ruleId || ''}] ${where} ${firstLine}` });
+    }
+  }
+  return scored.sort((a, b) => b.score - a.score).map(entry => entry.text);
+}
+
+/**
+ * Recursively collect indexable files
+ * @param {string} dirPath - Directory to walk
+ * @param {Array<string>} out - Collected file paths
+ * @param {number} depth - Current depth
+ * @returns {Promise<void>}
+ * @private
+ */
+async function collectSourceFiles(dirPath, out, depth) {
+  if (depth > 10) return;
+  let entries;
+  try {
+    entries = await fs.readdir(dirPath, { withFileTypes: true });
+  } catch (error) {
+    return;
+  }
+  for (const entry of entries) {
+    if (entry.name.startsWith('.') || SKIPPED_DIRECTORIES.has(entry.name)) continue;
+    const fullPath = path.join(dirPath, entry.name);
+    if (entry.isDirectory()) {
+      await collectSourceFiles(fullPath, out, depth + 1);
+    } else if (entry.isFile() && CodeIndex.isIndexable(entry.name)) {
+      out.push(fullPath);
+    }
+  }
+}
+
+// Export singleton instance shared by the file watcher and the assistant
+module.exports = new CodeIndex();
+module.exports.CodeIndex = CodeIndex;
+module.exports.splitIdentifiers = splitIdentifiers;
+module.exports.extractFunctions = extractFunctions;
+module.exports.collectSourceFiles = collectSourceFiles;
@@ -1,5 +1,6 @@
 const fs = require('fs').promises;
 const path = require('path');
+const log = require('./logger').getLogger('files');
 
 // File size limit for initial display (1MB)
 const FILE_SIZE_LIMIT = 1024 * 1024;
@@ -27,7 +28,7 @@ function isValidUTF8(buffer) {
   
   // If more than 1% null bytes, likely binary
   if (nullCount / sampleSize > 0.01) {
-    console.log(`Detected binary file: ${nullCount}/${sampleSize} null bytes`);
+    log.debug(() => `Detected binary file: ${nullCount}/${sampleSize} null bytes`);
     return false;
   }
   
@@ -37,7 +38,7 @@ function isValidUTF8(buffer) {
   
   // If more than 1% replacement characters, likely binary/non-UTF8
   if (replacementCount / text.length > 0.01) {
-    console.log(`Detected non-UTF8: ${replacementCount}/${text.length} replacement chars`);
+    log.debug(() => `Detected non-UTF8: ${replacementCount}/${text.length} replacement chars`);
     return false;
   }
   
@@ -45,7 +46,7 @@ function isValidUTF8(buffer) {
   if (text.includes('FFTM') || text.includes('GDEF') || text.includes('glyf') || 
       text.includes('cmap') || text.includes('fpgm') || text.includes('gasp') ||
       text.includes('DSIG') || text.includes('GSUB') || text.includes('GPOS')) {
-    console.log('Detected font file by signature');
+    log.debug('Detected font file by signature');
     return false;
   }
   
@@ -63,7 +64,7 @@ function isValidUTF8(buffer) {
   
   // If more than 10% non-printable characters, likely binary
   if (nonPrintableCount / checkLength > 0.1) {
-    console.log(`Detected binary: ${nonPrintableCount}/${checkLength} non-printable chars`);
+    log.debug(() => `Detected binary: ${nonPrintableCount}/${checkLength} non-printable chars`);
     return false;
   }
   
@@ -79,8 +80,9 @@ async function detectFileEncoding(filePath) {
   try {
     const buffer = await fs.readFile(filePath);
     const isUTF8 = isValidUTF8(buffer);
-    console.log(`File: ${filePath}, Size: ${buffer.length}, IsUTF8: ${isUTF8}`);
-    console.log(`First 100 bytes:`, buffer.slice(0, 100).toString('hex'));
+    log.debug(() => `File: ${filePath}, Size: ${buffer.length}, IsUTF8: ${isUTF8}`);
+    // The hex dump is only built when trace logging is on
+    log.trace(() => `First 100 bytes: ${buffer.slice(0, 100).toString('hex')}`);
     return {
       isUTF8,
       size: buffer.length,
@@ -135,7 +137,7 @@ async function buildFileTree(dirPath, maxDepth = 3, currentDepth = 0) {
       } catch (itemError) {
         // Skip items that cause permission errors or other access issues
         if (itemError.code === 'EPERM' || itemError.code === 'EACCES' || itemError.code === 'ENOENT') {
-          console.warn(`Skipping inaccessible item: ${itemPath} (${itemError.code})`);
+          log.debug(() => `Skipping inaccessible item: ${itemPath} (${itemError.code})`);
           continue;
         }
         // Re-throw unexpected errors
@@ -152,10 +154,10 @@ async function buildFileTree(dirPath, maxDepth = 3, currentDepth = 0) {
   } catch (error) {
     // Handle directory-level permission errors
     if (error.code === 'EPERM' || error.code === 'EACCES') {
-      console.warn(`Permission denied accessing directory: ${dirPath}`);
+      log.warn(`Permission denied accessing directory: ${dirPath}`);
       return [];
     }
-    console.error('Error building file tree:', error);
+    log.error('Error building file tree', error);
     return [];
   }
 }
@@ -219,7 +221,7 @@ async function searchInDirectory(dirPath, searchTerm, maxResults = 100) {
         }
       }
     } catch (error) {
-      console.error('Error searching directory:', error);
+      log.error('Error searching directory', error);
     }
   }
   
@@ -0,0 +1,242 @@
+/**
+ * @fileoverview Diff-scoped analysis: changed hunks from git
+ *
+ * One `git diff --unified=0` run yields every changed file and the line
+ * ranges that changed on the new side. From that we pick the translation
+ * units worth analyzing (changed sources, plus sources including a changed
+ * header) and afterwards keep only diagnostics in functions that overlap a
+ * changed hunk, so review-time analysis follows the size of the diff rather
+ * than the size of the repository.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+const { spawn } = require('child_process');
+const fs = require('fs').promises;
+const path = require('path');
+const { extractFunctions } = require('./codeIndex');
+
+/** Extensions analyzed on their own; headers are covered by their includers */
+const TRANSLATION_UNITS = new Set(['.c', '.cc', '.cpp', '.cxx']);
+const HEADERS = new Set(['.h', '.hh', '.hpp', '.hxx']);
+
+const HUNK_REGEX = /^@@ -\d+(?:,\d+)? \+(\d+)(?:,(\d+))? @@/;
+const INCLUDE_REGEX = /^[ \t]*#[ \t]*include[ \t]*["<]([^">]+)[">]/gm;
+
+/**
+ * Undo git's C-style quoting of unusual paths
+ * @param {string} value - Path as printed by git
+ * @returns {string} Path
+ */
+function unquotePath(value) {
+  if (!value.startsWith('"')) return value;
+  const escapes = { n: '\n', t: '\t', '"': '"', '\\': '\\' };
+  return value.slice(1, -1).replace(/\\(["\\nt])/g, (match, c) => escapes[c]);
+}
+
+/**
+ * Parse `git diff --unified=0` output
+ * @param {string} text - Diff output
+ * @returns {Map<string, Array<Object>>} Path (as in the diff) -> changed new-side ranges { start, end }
+ */
+function parseDiff(text) {
+  const hunks = new Map();
+  let current = null;
+  for (const line of text.split('\n')) {
+    if (line.startsWith('+++ ')) {
+      const target = line.slice(4).replace(/\t.*$/, '');
+      current = target === '/dev/null' ? null : unquotePath(target).replace(/^b\//, '');
+      if (current && !hunks.has(current)) hunks.set(current, []);
+      continue;
+    }
+    if (!current || !line.startsWith('@@')) continue;
+    const match = HUNK_REGEX.exec(line);
+    if (!match) continue;
+    const start = parseInt(match[1], 10);
+    const count = match[2] === undefined ? 1 : parseInt(match[2], 10);
+    // A pure deletion touches the lines on either side of where it was
+    hunks.get(current).push(count === 0 ? { start: Math.max(1, start), end: start + 1 } : { start, end: start + count - 1 });
+  }
+  return hunks;
+}
+
+/**
+ * Run git and collect its output
+ * @param {string} cwd - Working directory
+ * @param {Array<string>} args - git arguments
+ * @returns {Promise<string>} stdout
+ * @throws {Error} When git is missing or fails
+ */
+function runGit(cwd, args) {
+  return new Promise((resolve, reject) => {
+    const child = spawn('git', args, { cwd, stdio: ['ignore', 'pipe', 'pipe'] });
+    const stdout = [];
+    let stderr = '';
+    child.stdout.on('data', data => stdout.push(data));
+    child.stderr.on('data', data => { stderr += data.toString(); });
+    child.on('error', error => reject(new Error(`Cannot run git: ${error.message}`)));
+    child.on('close', (code) => {
+      if (code === 0) resolve(Buffer.concat(stdout).toString('utf8'));
+      else reject(new Error(`git ${args[0]} failed: ${stderr.trim() || `exit code ${code}`}`));
+    });
+  });
+}
+
+/**
+ * Changed hunks under a directory since a ref
+ * @param {string} root - Directory inside a git work tree
+ * @param {string} ref - Anything `git diff` accepts, e.g. origin/main or origin/main...HEAD
+ * @returns {Promise<Map<string, Array<Object>>>} Absolute path -> changed ranges
+ */
+async function getChangedHunks(root, ref) {
+  if (!ref || ref.startsWith('-')) throw new Error(`Invalid ref: ${ref}`);
+  const output = await runGit(root, [
+    'diff', '--unified=0', '--no-color', '--no-ext-diff', '--diff-filter=d',
+    '--src-prefix=a/', '--dst-prefix=b/', '--relative', ref, '--'
+  ]);
+  const hunks = new Map();
+  for (const [file, ranges] of parseDiff(output)) {
+    hunks.set(path.resolve(root, file), ranges);
+  }
+  return hunks;
+}
+
+/**
+ * Translation units affected by a change: changed sources, and sources
+ * that include a changed header (matched by file name)
+ * @param {Map<string, Array<Object>>} hunks - From getChangedHunks
+ * @param {Array<string>} sources - Every translation unit under the root
+ * @returns {Promise<Array<string>>} Sorted translation units to analyze
+ */
+async function affectedTranslationUnits(hunks, sources) {
+  const affected = new Set();
+  const headers = new Set();
+  for (const file of hunks.keys()) {
+    const ext = path.extname(file).toLowerCase();
+    if (TRANSLATION_UNITS.has(ext)) affected.add(file);
+    else if (HEADERS.has(ext)) headers.add(path.basename(file));
+  }
+  if (headers.size > 0) {
+    for (const source of sources) {
+      if (affected.has(source)) continue;
+      let code;
+      try {
+        code = await fs.readFile(source, 'utf8');
+      } catch (error) {
+        continue;
+      }
+      INCLUDE_REGEX.lastIndex = 0;
+      let match;
+      while ((match = INCLUDE_REGEX.exec(code)) !== null) {
+        if (headers.has(path.basename(match[1]))) {
+          affected.add(source);
+          break;
+        }
+      }
+    }
+  }
+  return Array.from(affected).sort();
+}
+
+/**
+ * @param {Array<Object>} ranges - Changed ranges
+ * @param {number} start - First line
+ * @param {number} end - Last line
+ * @returns {boolean} Whether [start, end] overlaps any range
+ */
+function overlaps(ranges, start, end) {
+  return ranges.some(range => range.start <= end && start <= range.end);
+}
+
+/**
+ * Keeps the diagnostics of one analysis that fall in changed code
+ */
+class HunkFilter {
+  /**
+   * @param {Map<string, Array<Object>>} hunks - From getChangedHunks
+   */
+  constructor(hunks) {
+    this.hunks = hunks;
+    /** @type {Map<string, Promise<Map<string, Object>>>} File -> function name -> range, parsed from source */
+    this.sourceRanges = new Map();
+  }
+
+  /**
+   * Function ranges of a file, parsed from its source
+   * @param {string} file - Absolute path
+   * @returns {Promise<Map<string, Object>>} Name -> { startLine, endLine }
+   * @private
+   */
+  rangesFromSource(file) {
+    if (!this.sourceRanges.has(file)) {
+      this.sourceRanges.set(file, fs.readFile(file, 'utf8').then((code) => {
+        const ranges = new Map();
+        for (const fn of extractFunctions(code)) {
+          if (!ranges.has(fn.name)) ranges.set(fn.name, { startLine: fn.startLine, endLine: fn.endLine });
+        }
+        return ranges;
+      }, () => new Map()));
+    }
+    return this.sourceRanges.get(file);
+  }
+
+  /**
+   * Local path of a file named in ctrace output
+   * @param {string} [file] - Path as reported; on Windows it is a WSL path
+   * @param {string} unit - Analyzed translation unit
+   * @returns {string} Absolute local path
+   * @private
+   */
+  resolveFile(file, unit) {
+    if (!file || path.basename(file.replace(/\\/g, '/')) === path.basename(unit)) return unit;
+    return path.resolve(path.dirname(unit), file);
+  }
+
+  /**
+   * Function ranges reported by ctrace, when its `functions` output has them
+   * @param {Array<*>} functions - ctrace functions: names or { name, file?, startLine, endLine }
+   * @param {string} unit - Analyzed translation unit
+   * @returns {Map<string, Object>} "file\0name" -> { startLine, endLine }
+   * @private
+   */
+  rangesFromOutput(functions, unit) {
+    const ranges = new Map();
+    for (const fn of functions || []) {
+      if (!fn || typeof fn !== 'object') continue;
+      const location = fn.location || fn;
+      const name = fn.name || location.function;
+      const startLine = location.startLine || location.line;
+      if (!name || !startLine) continue;
+      const file = this.resolveFile(location.file, unit);
+      ranges.set(`${file}\0${name}`, { startLine, endLine: location.endLine || startLine });
+    }
+    return ranges;
+  }
+
+  /**
+   * @param {Object} analysis - { functions, diagnostics } of one translation unit
+   * @param {string} unit - Absolute path of the translation unit
+   * @returns {Promise<Array<Object>>} Diagnostics in functions overlapping a changed hunk;
+   *   diagnostics outside any known function are kept when their own lines changed
+   */
+  async filter(analysis, unit) {
+    const reported = this.rangesFromOutput(analysis.functions, unit);
+    const kept = [];
+    for (const diag of analysis.diagnostics || []) {
+      const location = diag.location || {};
+      const file = this.resolveFile(location.file, unit);
+      const changed = this.hunks.get(file);
+      if (!changed) continue;
+
+      let range = location.function ? reported.get(`${file}\0${location.function}`) : null;
+      if (!range && location.function) range = (await this.rangesFromSource(file)).get(location.function);
+      const start = range ? range.startLine : location.startLine || 0;
+      const end = range ? range.endLine : location.endLine || start;
+      if (overlaps(changed, start, end)) kept.push(diag);
+    }
+    return kept;
+  }
+}
+
+module.exports = { parseDiff, getChangedHunks, affectedTranslationUnits, overlaps, HunkFilter };
@@ -0,0 +1,281 @@
+/**
+ * @fileoverview CPU inference settings and autotune for local GGUF models
+ *
+ * Resolves the CPU-side settings that decide local inference throughput
+ * (threads, batch size, mmap, mlock, KV-cache type) from the assistant
+ * config and a saved per-model profile, and benchmarks prompt processing
+ * and generation speed across a small grid of settings to find that
+ * profile on the user's machine.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+const fs = require('fs').promises;
+const os = require('os');
+
+/** KV-cache element types offered in the settings */
+const KV_CACHE_TYPES = ['f16', 'q8_0', 'q4_0'];
+
+/** Benchmark shape: a typical assistant request */
+const BENCH_PROMPT_TOKENS = 256;
+const BENCH_GENERATED_TOKENS = 32;
+
+/** Request shape the score optimizes for: prompt and reply tokens */
+const SCORE_PROMPT_TOKENS = 1024;
+const SCORE_GENERATED_TOKENS = 256;
+
+const BENCH_TEXT = 'static int parse_header(const char *line, struct header *out) { ' +
+  'char buffer[64]; strncpy(buffer, line, sizeof(buffer)); return validate(buffer, out); } ';
+
+/**
+ * Resolve CPU inference settings: explicit config first, then the saved
+ * profile, then defaults
+ * @param {Object} config - Assistant config (cpuThreads, batchSize, useMmap, useMlock, kvCacheType)
+ * @param {Object|null} profile - Saved autotune profile for the model
+ * @returns {Object} { threads, batchSize, useMmap, useMlock, kvCacheType }
+ */
+function resolveCpuSettings(config = {}, profile = null) {
+  const saved = (profile && profile.settings) || {};
+  const pick = (value, fallback) => (value === undefined || value === null || value === '' ? fallback : value);
+  const threads = parseInt(pick(config.cpuThreads, saved.threads), 10);
+  const batchSize = parseInt(pick(config.batchSize, saved.batchSize), 10);
+  const kvCacheType = pick(config.kvCacheType, saved.kvCacheType);
+
+  return {
+    // 0 lets node-llama-cpp use its own default
+    threads: threads > 0 ? threads : 0,
+    batchSize: batchSize > 0 ? batchSize : 512,
+    useMmap: pick(config.useMmap, saved.useMmap) !== false,
+    useMlock: pick(config.useMlock, saved.useMlock) === true,
+    kvCacheType: KV_CACHE_TYPES.includes(kvCacheType) ? kvCacheType : 'f16'
+  };
+}
+
+/**
+ * Context options for node-llama-cpp from resolved settings
+ * @param {Object} settings - Output of resolveCpuSettings
+ * @returns {Object} Options merged into createContext()
+ */
+function toContextOptions(settings) {
+  const options = { batchSize: settings.batchSize };
+  if (settings.threads > 0) options.threads = settings.threads;
+  if (settings.kvCacheType !== 'f16') {
+    options.experimentalKvCacheKeyType = settings.kvCacheType;
+    options.experimentalKvCacheValueType = settings.kvCacheType;
+  }
+  return options;
+}
+
+/**
+ * Thread counts worth trying on this machine
+ * @param {number} cpuCount - Logical CPUs
+ * @returns {Array<number>} Distinct thread counts, largest first
+ */
+function candidateThreadCounts(cpuCount = os.cpus().length) {
+  // Logical CPUs, an estimate of physical cores, and a quarter of the machine
+  const counts = [cpuCount, Math.ceil(cpuCount / 2), Math.ceil(cpuCount / 4)].filter(n => n >= 1);
+  return Array.from(new Set(counts));
+}
+
+/**
+ * Settings benchmarked in the first autotune pass (threads x batch size).
+ * mmap and mlock are left out on purpose: they are model-load options, so
+ * trying them means reloading a multi-GB model per variant, and once the
+ * weights are resident they change load time and memory pressure rather
+ * than the tokens/sec measured here. They stay user settings.
+ * @param {number} cpuCount - Logical CPUs
+ * @returns {Array<Object>} Settings to try, with f16 KV cache
+ */
+function buildTuningGrid(cpuCount = os.cpus().length) {
+  const grid = [];
+  for (const threads of candidateThreadCounts(cpuCount)) {
+    for (const batchSize of [256, 512]) {
+      grid.push({ threads, batchSize, kvCacheType: 'f16' });
+    }
+  }
+  return grid;
+}
+
+/**
+ * Estimated time for a typical request, lower is better
+ * @param {Object} result - { promptTokensPerSecond, generationTokensPerSecond }
+ * @returns {number} Seconds
+ */
+function requestSeconds(result) {
+  if (!(result.promptTokensPerSecond > 0) || !(result.generationTokensPerSecond > 0)) return Infinity;
+  return SCORE_PROMPT_TOKENS / result.promptTokensPerSecond + SCORE_GENERATED_TOKENS / result.generationTokensPerSecond;
+}
+
+/**
+ * Pick the fastest benchmark result
+ * @param {Array<Object>} results - Benchmark results with settings
+ * @returns {Object|null} Best result
+ */
+function pickBest(results) {
+  let best = null;
+  for (const result of results) {
+    if (!best || requestSeconds(result) < requestSeconds(best)) best = result;
+  }
+  return best && requestSeconds(best) < Infinity ? best : null;
+}
+
+/**
+ * Measure prompt-processing and generation speed for one setting
+ * @param {Object} model - Loaded node-llama-cpp model
+ * @param {Object} settings - { threads, batchSize, kvCacheType }
+ * @returns {Promise<Object>} { settings, promptTokensPerSecond, generationTokensPerSecond }
+ */
+async function benchmarkSettings(model, settings) {
+  let promptTokens = model.tokenize(BENCH_TEXT);
+  while (promptTokens.length < BENCH_PROMPT_TOKENS) promptTokens = promptTokens.concat(promptTokens);
+  promptTokens = promptTokens.slice(0, BENCH_PROMPT_TOKENS);
+
+  const context = await model.createContext({
+    contextSize: BENCH_PROMPT_TOKENS + BENCH_GENERATED_TOKENS + 64,
+    sequences: 1,
+    ...toContextOptions(settings)
+  });
+  try {
+    const sequence = context.getSequence();
+    const started = process.hrtime.bigint();
+    let firstTokenAt = null;
+    let generated = 0;
+
+    // The first token arrives once the whole prompt has been processed
+    for await (const token of sequence.evaluate(promptTokens)) {
+      void token;
+      if (firstTokenAt === null) firstTokenAt = process.hrtime.bigint();
+      generated++;
+      if (generated >= BENCH_GENERATED_TOKENS) break;
+    }
+
+    const finished = process.hrtime.bigint();
+    const promptSeconds = Number(firstTokenAt - started) / 1e9;
+    const generationSeconds = Number(finished - firstTokenAt) / 1e9;
+    return {
+      settings,
+      promptTokensPerSecond: Math.round(promptTokens.length / promptSeconds * 10) / 10,
+      // The first token is part of prompt processing
+      generationTokensPerSecond: generated > 1 ? Math.round((generated - 1) / generationSeconds * 10) / 10 : 0
+    };
+  } finally {
+    await context.dispose();
+  }
+}
+
+/**
+ * Benchmark the grid, then try quantized KV caches on the best setting
+ * @param {Object} model - Loaded node-llama-cpp model
+ * @param {Object} options - { grid, onProgress({ index, total, result }), benchmark }
+ * @returns {Promise<Object>} { best, results }
+ */
+async function runAutotune(model, options = {}) {
+  const grid = options.grid || buildTuningGrid();
+  const benchmark = options.benchmark || benchmarkSettings;
+  const onProgress = options.onProgress || (() => {});
+  const total = grid.length + KV_CACHE_TYPES.length - 1;
+  const results = [];
+
+  const measure = async (settings) => {
+    let result;
+    try {
+      result = await benchmark(model, settings);
+    } catch (error) {
+      // Unsupported combinations (e.g. a KV type this build lacks) are skipped
+      result = { settings, error: error.message, promptTokensPerSecond: 0, generationTokensPerSecond: 0 };
+    }
+    results.push(result);
+    onProgress({ index: results.length, total, result });
+  };
+
+  for (const settings of grid) {
+    await measure(settings);
+  }
+  const bestF16 = pickBest(results);
+  if (bestF16) {
+    for (const kvCacheType of KV_CACHE_TYPES.filter(type => type !== 'f16')) {
+      await measure({ ...bestF16.settings, kvCacheType });
+    }
+  }
+
+  return { best: pickBest(results), results };
+}
+
+/**
+ * Saved autotune profiles, one per model file
+ */
+class ProfileStore {
+  /**
+   * @param {string} filePath - JSON file holding the profiles
+   */
+  constructor(filePath) {
+    this.filePath = filePath;
+    this.profiles = null;
+  }
+
+  /**
+   * Identify a model file so profiles are dropped when the file changes
+   * @param {string} modelPath - GGUF file path
+   * @returns {Promise<string>} Profile key
+   */
+  static async keyFor(modelPath) {
+    const stats = await fs.stat(modelPath);
+    return `${modelPath}|${stats.size}|${Math.round(stats.mtimeMs)}`;
+  }
+
+  /**
+   * @private
+   */
+  async load() {
+    if (this.profiles) return this.profiles;
+    try {
+      this.profiles = JSON.parse(await fs.readFile(this.filePath, 'utf8'));
+    } catch (error) {
+      this.profiles = {};
+    }
+    return this.profiles;
+  }
+
+  /**
+   * @param {string} modelPath - GGUF file path
+   * @returns {Promise<Object|null>} Saved profile { settings, promptTokensPerSecond, generationTokensPerSecond, tunedAt }
+   */
+  async get(modelPath) {
+    try {
+      const profiles = await this.load();
+      return profiles[await ProfileStore.keyFor(modelPath)] || null;
+    } catch (error) {
+      return null;
+    }
+  }
+
+  /**
+   * @param {string} modelPath - GGUF file path
+   * @param {Object} profile - Profile to save
+   * @returns {Promise<void>}
+   */
+  async set(modelPath, profile) {
+    const profiles = await this.load();
+    const key = await ProfileStore.keyFor(modelPath);
+    // Forget profiles of older versions of the same file
+    for (const existing of Object.keys(profiles)) {
+      if (existing.startsWith(`${modelPath}|`)) delete profiles[existing];
+    }
+    profiles[key] = profile;
+    await fs.writeFile(this.filePath, JSON.stringify(profiles, null, 2), 'utf8');
+  }
+}
+
+module.exports = {
+  KV_CACHE_TYPES,
+  resolveCpuSettings,
+  toContextOptions,
+  candidateThreadCounts,
+  buildTuningGrid,
+  requestSeconds,
+  pickBest,
+  benchmarkSettings,
+  runAutotune,
+  ProfileStore
+};
@@ -0,0 +1,261 @@
+/**
+ * @fileoverview Streaming selection of values from a large JSON document
+ *
+ * JsonPathStream scans a document chunk by chunk and only materializes the
+ * values at selected paths, e.g. every element of runs[*].results in a
+ * SARIF log. The scanner tracks structure (containers, keys, indices)
+ * without building anything; when a selected value ends, just its text is
+ * handed to JSON.parse. Memory is bounded by the largest selected value
+ * rather than by the document, and the native parser does the real work.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+/** Matches any key or index in a path pattern */
+const WILDCARD = '*';
+
+/** Whitespace: space, tab, newline, carriage return */
+function isWhitespace(code) {
+  return code === 32 || code === 9 || code === 10 || code === 13;
+}
+
+/** Characters that end a number or literal */
+function isDelimiter(code) {
+  return code === 44 || code === 93 || code === 125 || isWhitespace(code);
+}
+
+class JsonPathStream {
+  /**
+   * @param {Array<Array<string|number>>} patterns - Paths to select; '*' matches any key or index
+   * @param {Function} onValue - (value, path) => void, called for each selected value
+   */
+  constructor(patterns, onValue) {
+    this.patterns = patterns;
+    this.depths = new Set(patterns.map(p => p.length));
+    this.onValue = onValue;
+    /** Text from the first character still needed */
+    this.buffer = '';
+    /** Buffer offset to continue scanning from */
+    this.position = 0;
+    /** @type {Array<Object>} Open containers { array, key, index } */
+    this.stack = [];
+    this.state = 'value';
+    /** Buffer offset where the selected value being read starts, or -1 */
+    this.captureStart = -1;
+    this.captureDepth = 0;
+    /** Offset to resume scanning an unterminated string from */
+    this.stringResume = 0;
+    this.done = false;
+  }
+
+  /**
+   * Scan a chunk
+   * @param {string} chunk - Next part of the document
+   */
+  write(chunk) {
+    this.buffer += chunk;
+    this.process(false);
+  }
+
+  /**
+   * Finish the document
+   * @throws {Error} When the document is truncated
+   */
+  end() {
+    this.process(true);
+    if (!this.done || this.buffer.trim() !== '') {
+      throw new Error(this.done ? 'Unexpected data after JSON document' : 'Unexpected end of JSON document');
+    }
+  }
+
+  /**
+   * @returns {Array<string|number>} Path of the value about to be read
+   */
+  currentPath() {
+    return this.stack.map(frame => (frame.array ? frame.index : frame.key));
+  }
+
+  /**
+   * @returns {boolean} Whether the value about to be read is selected
+   * @private
+   */
+  isSelected() {
+    const depth = this.stack.length;
+    if (!this.depths.has(depth)) return false;
+    return this.patterns.some(pattern => pattern.length === depth && pattern.every((part, k) => {
+      const frame = this.stack[k];
+      return part === WILDCARD || part === (frame.array ? frame.index : frame.key);
+    }));
+  }
+
+  /**
+   * Find the closing quote of a string
+   * @param {number} from - Offset after the opening quote
+   * @returns {number} Offset of the closing quote, or -1 when not in the buffer yet
+   * @private
+   */
+  findStringEnd(from) {
+    const buffer = this.buffer;
+    let i = Math.max(from, this.stringResume);
+    while (true) {
+      const quote = buffer.indexOf('"', i);
+      if (quote === -1) {
+        // Resume later, but never from inside an escape sequence
+        this.stringResume = Math.max(from, buffer.length - 1);
+        return -1;
+      }
+      let backslashes = 0;
+      for (let k = quote - 1; k >= from && buffer.charCodeAt(k) === 92; k--) backslashes++;
+      if (backslashes % 2 === 0) {
+        this.stringResume = 0;
+        return quote;
+      }
+      i = quote + 1;
+    }
+  }
+
+  /**
+   * Scan as far as the buffer allows, then drop what is no longer needed
+   * @param {boolean} final - No more input follows
+   * @private
+   */
+  process(final) {
+    const buffer = this.buffer;
+    let i = this.position;
+    // Start of the token that could not be completed
+    let keepFrom = -1;
+
+    scan: while (i < buffer.length && !this.done) {
+      const code = buffer.charCodeAt(i);
+      if (isWhitespace(code)) {
+        i++;
+        continue;
+      }
+      const frame = this.stack[this.stack.length - 1];
+
+      switch (this.state) {
+        case 'value':
+        case 'valueOrEnd': {
+          if (this.state === 'valueOrEnd' && code === 93) {
+            i = this.closeContainer(i);
+            break;
+          }
+          if (this.captureStart === -1 && this.isSelected()) {
+            this.captureStart = i;
+            this.captureDepth = this.stack.length;
+          }
+          if (code === 123) {
+            this.stack.push({ array: false, key: null, index: 0 });
+            this.state = 'keyOrEnd';
+            i++;
+          } else if (code === 91) {
+            this.stack.push({ array: true, key: null, index: 0 });
+            this.state = 'valueOrEnd';
+            i++;
+          } else if (code === 34) {
+            const close = this.findStringEnd(i + 1);
+            if (close === -1) {
+              keepFrom = i;
+              break scan;
+            }
+            i = this.endValue(close + 1);
+          } else {
+            let j = i;
+            while (j < buffer.length && !isDelimiter(buffer.charCodeAt(j))) j++;
+            if (j === buffer.length && !final) {
+              keepFrom = i;
+              break scan;
+            }
+            if (!/^(-?\d+(\.\d+)?([eE][+-]?\d+)?|true|false|null)$/.test(buffer.slice(i, j))) {
+              throw new Error(`Unexpected token in JSON at ${buffer.slice(i, i + 20)}`);
+            }
+            i = this.endValue(j);
+          }
+          break;
+        }
+        case 'keyOrEnd':
+        case 'key': {
+          if (this.state === 'keyOrEnd' && code === 125) {
+            i = this.closeContainer(i);
+            break;
+          }
+          if (code !== 34) throw new Error('Expected property name in JSON');
+          const close = this.findStringEnd(i + 1);
+          if (close === -1) {
+            keepFrom = i;
+            break scan;
+          }
+          // Keys inside a captured value are never needed
+          if (this.captureStart === -1) frame.key = JSON.parse(buffer.slice(i, close + 1));
+          this.state = 'colon';
+          i = close + 1;
+          break;
+        }
+        case 'colon':
+          if (code !== 58) throw new Error('Expected \':\' in JSON');
+          this.state = 'value';
+          i++;
+          break;
+        case 'commaOrEnd':
+          if (code === 44) {
+            if (frame.array) {
+              frame.index++;
+              this.state = 'value';
+            } else {
+              this.state = 'key';
+            }
+            i++;
+          } else if (code === (frame.array ? 93 : 125)) {
+            i = this.closeContainer(i);
+          } else {
+            throw new Error('Expected \',\' or end of container in JSON');
+          }
+          break;
+      }
+    }
+
+    // An unfinished token is scanned again once more text arrives
+    if (keepFrom !== -1) i = keepFrom;
+    // Keep the selected value being read and anything not scanned
+    const keep = this.captureStart === -1 ? i : Math.min(this.captureStart, i);
+    this.position = i - keep;
+    if (keep > 0) {
+      if (this.captureStart !== -1) this.captureStart -= keep;
+      if (this.stringResume > 0) this.stringResume -= keep;
+      this.buffer = buffer.slice(keep);
+    }
+  }
+
+  /**
+   * @param {number} i - Offset of '}' or ']'
+   * @returns {number} Offset after it
+   * @private
+   */
+  closeContainer(i) {
+    this.stack.pop();
+    return this.endValue(i + 1);
+  }
+
+  /**
+   * Emit a selected value that just ended and move to the next state
+   * @param {number} end - Offset after the value
+   * @returns {number} The same offset
+   * @private
+   */
+  endValue(end) {
+    if (this.captureStart !== -1 && this.stack.length === this.captureDepth) {
+      const text = this.buffer.slice(this.captureStart, end);
+      this.captureStart = -1;
+      this.onValue(JSON.parse(text), this.currentPath());
+    }
+    if (this.stack.length === 0) {
+      this.done = true;
+    } else {
+      this.state = 'commaOrEnd';
+    }
+    return end;
+  }
+}
+
+module.exports = { JsonPathStream, WILDCARD };
@@ -0,0 +1,397 @@
+/**
+ * @fileoverview Leveled, categorized logger with an in-memory ring buffer
+ *
+ * Log calls go through per-category loggers whose methods are rebound
+ * whenever levels change: a disabled level is the shared no-op function, so
+ * a debug call in a hot path costs one empty call. Pass a function instead
+ * of a string to defer building expensive messages until the level is on.
+ * Enabled entries are kept in a fixed-size ring buffer for the log viewer
+ * and handed to sinks (console, batched file output, IPC forwarding).
+ *
+ * Works in both processes: the main process writes the log file, the
+ * renderer forwards its entries to the main process over IPC.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+const fs = require('fs').promises;
+const path = require('path');
+
+/** Level names, most severe first; a level enables itself and everything above */
+const LEVELS = ['error', 'warn', 'info', 'debug', 'trace'];
+
+/** Entries kept in memory for the viewer */
+const DEFAULT_RING_SIZE = 2000;
+
+/** File output is flushed after this delay or this many pending lines */
+const FLUSH_INTERVAL_MS = 1000;
+const FLUSH_MAX_LINES = 500;
+
+/** Log file size that triggers rotation to <file>.1 */
+const MAX_FILE_BYTES = 5 * 1024 * 1024;
+
+const noop = () => {};
+
+/**
+ * Convert a level name to its index
+ * @param {string|number} level - Level name or index
+ * @returns {number} Index into LEVELS, -1 for 'off'
+ */
+function levelIndex(level) {
+  if (typeof level === 'number') return level;
+  if (level === 'off') return -1;
+  const index = LEVELS.indexOf(String(level).toLowerCase());
+  return index === -1 ? LEVELS.indexOf('info') : index;
+}
+
+/**
+ * Fixed-capacity ring of log entries, oldest overwritten first
+ */
+class RingBuffer {
+  /**
+   * @param {number} capacity - Entries kept
+   */
+  constructor(capacity = DEFAULT_RING_SIZE) {
+    this.capacity = capacity;
+    this.items = new Array(capacity);
+    this.next = 0;
+    this.count = 0;
+  }
+
+  /**
+   * @param {*} item - Item to append
+   */
+  push(item) {
+    this.items[this.next] = item;
+    this.next = (this.next + 1) % this.capacity;
+    if (this.count < this.capacity) this.count++;
+  }
+
+  /**
+   * @returns {Array<*>} Items, oldest first
+   */
+  toArray() {
+    const start = (this.next - this.count + this.capacity) % this.capacity;
+    const result = new Array(this.count);
+    for (let i = 0; i < this.count; i++) {
+      result[i] = this.items[(start + i) % this.capacity];
+    }
+    return result;
+  }
+
+  clear() {
+    this.items = new Array(this.capacity);
+    this.next = 0;
+    this.count = 0;
+  }
+}
+
+/**
+ * Render one data value for text output
+ * @param {*} value - Value to render
+ * @returns {string} Text
+ */
+function formatValue(value) {
+  if (value instanceof Error) return value.stack || value.message;
+  if (typeof value === 'string') return value;
+  try {
+    return JSON.stringify(value);
+  } catch (error) {
+    return String(value);
+  }
+}
+
+/**
+ * Render an entry as one log file line
+ * @param {Object} entry - Log entry
+ * @returns {string} Line without the trailing newline
+ */
+function formatEntry(entry) {
+  const data = entry.data === undefined ? '' : ' ' + formatValue(entry.data);
+  return `${new Date(entry.time).toISOString()} ${entry.level.toUpperCase().padEnd(5)} [${entry.process}:${entry.category}] ${entry.message}${data}`;
+}
+
+/**
+ * Central logger: levels, categories, ring buffer and sinks
+ */
+class Logger {
+  /**
+   * @param {Object} options
+   * @param {string} [options.level] - Default level for every category
+   * @param {string} [options.process] - Process tag stored on entries ('main', 'renderer')
+   * @param {number} [options.ringSize] - Entries kept in memory
+   */
+  constructor(options = {}) {
+    this.level = levelIndex(options.level || 'info');
+    this.process = options.process || 'main';
+    /** @type {Map<string, number>} category -> level override */
+    this.categoryLevels = new Map();
+    /** @type {Map<string, Object>} category -> category logger */
+    this.categories = new Map();
+    this.ring = new RingBuffer(options.ringSize || DEFAULT_RING_SIZE);
+    this.sinks = [];
+  }
+
+  /**
+   * Get the logger for a category, creating it on first use
+   * @param {string} category - Category such as 'ctrace' or 'editor'
+   * @returns {Object} { error, warn, info, debug, trace, enabled(level) }
+   */
+  get(category) {
+    let log = this.categories.get(category);
+    if (!log) {
+      log = { category, enabled: (level) => levelIndex(level) <= this.effectiveLevel(category) };
+      this.categories.set(category, log);
+      this.bind(log);
+    }
+    return log;
+  }
+
+  /**
+   * @param {string} category - Category name
+   * @returns {number} Level index in force for the category
+   */
+  effectiveLevel(category) {
+    return this.categoryLevels.has(category) ? this.categoryLevels.get(category) : this.level;
+  }
+
+  /**
+   * Point each level method at the writer or at the no-op
+   * @param {Object} log - Category logger
+   * @private
+   */
+  bind(log) {
+    const threshold = this.effectiveLevel(log.category);
+    LEVELS.forEach((level, index) => {
+      log[level] = index <= threshold
+        ? (message, data) => this.write(level, log.category, message, data)
+        : noop;
+    });
+  }
+
+  /**
+   * Change the level of every category, or of one category
+   * @param {string} level - Level name or 'off'
+   * @param {string} [category] - Category to override; omit for the default
+   */
+  setLevel(level, category) {
+    if (category) {
+      this.categoryLevels.set(category, levelIndex(level));
+    } else {
+      this.level = levelIndex(level);
+    }
+    for (const log of this.categories.values()) this.bind(log);
+  }
+
+  /**
+   * @returns {Object} { level, categories: { name: level } }
+   */
+  getLevels() {
+    const categories = {};
+    for (const name of this.categories.keys()) {
+      const index = this.effectiveLevel(name);
+      categories[name] = index === -1 ? 'off' : LEVELS[index];
+    }
+    return { level: this.level === -1 ? 'off' : LEVELS[this.level], categories };
+  }
+
+  /**
+   * Register a sink receiving every enabled entry
+   * @param {Function} sink - (entry) => void
+   * @returns {Function} Unregister function
+   */
+  addSink(sink) {
+    this.sinks.push(sink);
+    return () => {
+      this.sinks = this.sinks.filter(existing => existing !== sink);
+    };
+  }
+
+  /**
+   * Record an entry produced in this process
+   * @param {string} level - Level name
+   * @param {string} category - Category name
+   * @param {string|Function} message - Message, or a function building it
+   * @param {*} [data] - Extra data (object, error, ...)
+   * @private
+   */
+  write(level, category, message, data) {
+    this.record({
+      time: Date.now(),
+      level,
+      process: this.process,
+      category,
+      message: typeof message === 'function' ? String(message()) : String(message),
+      data: data instanceof Error ? formatValue(data) : data
+    });
+  }
+
+  /**
+   * Store an entry and pass it to the sinks; also used for entries
+   * forwarded from another process
+   * @param {Object} entry - { time, level, process, category, message, data }
+   */
+  record(entry) {
+    this.ring.push(entry);
+    for (const sink of this.sinks) {
+      try {
+        sink(entry);
+      } catch (error) {
+        // A failing sink must never break the code that logged
+      }
+    }
+  }
+
+  /**
+   * Entries in the ring buffer, oldest first
+   * @param {Object} filter - { level (most verbose level kept), category, process, search, limit }
+   * @returns {Array<Object>} Entries
+   */
+  getEntries(filter = {}) {
+    const maxLevel = filter.level ? levelIndex(filter.level) : LEVELS.length;
+    const search = filter.search ? String(filter.search).toLowerCase() : '';
+    let entries = this.ring.toArray().filter(entry =>
+      levelIndex(entry.level) <= maxLevel &&
+      (!filter.category || entry.category === filter.category) &&
+      (!filter.process || entry.process === filter.process) &&
+      (!search || entry.message.toLowerCase().includes(search)));
+    if (filter.limit && entries.length > filter.limit) {
+      entries = entries.slice(entries.length - filter.limit);
+    }
+    return entries;
+  }
+
+  clear() {
+    this.ring.clear();
+  }
+}
+
+/**
+ * Sink printing entries up to a level to the console
+ * @param {string} level - Most verbose level printed
+ * @param {string} [processName] - Only print entries of this process (forwarded entries are skipped)
+ * @returns {Function} Sink with a setLevel(level) method
+ */
+function createConsoleSink(level = 'info', processName = null) {
+  let threshold = levelIndex(level);
+  const sink = (entry) => {
+    const index = levelIndex(entry.level);
+    if (index > threshold || (processName && entry.process !== processName)) return;
+    const method = index === 0 ? 'error' : index === 1 ? 'warn' : 'log';
+    const prefix = `[${entry.category}] ${entry.message}`;
+    if (entry.data === undefined) console[method](prefix);
+    else console[method](prefix, entry.data);
+  };
+  sink.setLevel = (next) => { threshold = levelIndex(next); };
+  return sink;
+}
+
+/**
+ * Sink appending entries to a file in batches. Lines are buffered and
+ * written with one append per flush, so logging never waits on the disk.
+ * @param {string} filePath - Log file
+ * @param {Object} options - { flushIntervalMs, maxLines, maxBytes }
+ * @returns {Function} Sink with flush() and filePath
+ */
+function createFileSink(filePath, options = {}) {
+  const flushIntervalMs = options.flushIntervalMs || FLUSH_INTERVAL_MS;
+  const maxLines = options.maxLines || FLUSH_MAX_LINES;
+  const maxBytes = options.maxBytes || MAX_FILE_BYTES;
+  let pending = [];
+  let timer = null;
+  let writing = Promise.resolve();
+  let size = null;
+
+  const writeBatch = async (lines) => {
+    const text = lines.join('\n') + '\n';
+    try {
+      if (size === null) {
+        await fs.mkdir(path.dirname(filePath), { recursive: true });
+        size = await fs.stat(filePath).then(stats => stats.size, () => 0);
+      }
+      if (size + text.length > maxBytes) {
+        await fs.rename(filePath, filePath + '.1').catch(() => {});
+        size = 0;
+      }
+      await fs.appendFile(filePath, text, 'utf8');
+      size += Buffer.byteLength(text);
+    } catch (error) {
+      // Losing log lines is preferable to failing the application
+    }
+  };
+
+  const flush = () => {
+    clearTimeout(timer);
+    timer = null;
+    if (pending.length > 0) {
+      const lines = pending;
+      pending = [];
+      writing = writing.then(() => writeBatch(lines));
+    }
+    return writing;
+  };
+
+  const sink = (entry) => {
+    pending.push(formatEntry(entry));
+    if (pending.length >= maxLines) {
+      flush();
+    } else if (!timer) {
+      timer = setTimeout(flush, flushIntervalMs);
+      if (timer.unref) timer.unref();
+    }
+  };
+  sink.flush = flush;
+  sink.filePath = filePath;
+  return sink;
+}
+
+/**
+ * Sink forwarding entries in batches to another process
+ * @param {Function} send - (entries) => void, e.g. ipcRenderer.send('log-entries', ...)
+ * @param {number} intervalMs - Batch delay
+ * @returns {Function} Sink with flush()
+ */
+function createForwardSink(send, intervalMs = 500) {
+  let pending = [];
+  let timer = null;
+  const flush = () => {
+    clearTimeout(timer);
+    timer = null;
+    if (pending.length === 0) return;
+    const entries = pending;
+    pending = [];
+    send(entries);
+  };
+  const sink = (entry) => {
+    // Data may hold values that cannot cross the process boundary
+    pending.push(entry.data === undefined ? entry : { ...entry, data: formatValue(entry.data) });
+    if (!timer) timer = setTimeout(flush, intervalMs);
+  };
+  sink.flush = flush;
+  return sink;
+}
+
+/** Process-wide logger; CTRACE_LOG_LEVEL sets the starting level */
+const logger = new Logger({
+  level: (typeof process !== 'undefined' && process.env && process.env.CTRACE_LOG_LEVEL) || 'info',
+  process: typeof process !== 'undefined' && process.type === 'renderer' ? 'renderer' : 'main'
+});
+
+/** Console output; the main process lowers it to warnings in packaged builds */
+const consoleSink = createConsoleSink((typeof process !== 'undefined' && process.env && process.env.CTRACE_LOG_CONSOLE) || 'info', logger.process);
+logger.addSink(consoleSink);
+
+module.exports = {
+  LEVELS,
+  Logger,
+  RingBuffer,
+  logger,
+  consoleSink,
+  getLogger: (category) => logger.get(category),
+  formatValue,
+  formatEntry,
+  createConsoleSink,
+  createFileSink,
+  createForwardSink
+};
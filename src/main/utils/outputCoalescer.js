@@ -0,0 +1,128 @@
+/**
+ * @fileoverview Frame-coalesced output stream with renderer backpressure
+ *
+ * ctrace writes to its socket in small pieces; forwarding each 'data' event
+ * as its own IPC message floods the renderer with thousands of messages a
+ * second. The coalescer collects text and sends it as one batch per frame
+ * interval, or sooner when a batch reaches the size threshold.
+ *
+ * The renderer acknowledges each batch once it has processed it. Text sent
+ * but not yet acknowledged is the renderer's backlog: above the high-water
+ * mark the source is paused (socket.pause(), so the kernel buffer and
+ * finally ctrace itself block), and it is resumed once the backlog drains
+ * below the low-water mark. Flow control only starts with the first
+ * acknowledgement, so a renderer that never acknowledges cannot stall a run.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+/** Flush interval, one frame at 60 Hz */
+const FLUSH_INTERVAL_MS = 16;
+
+/** Characters that trigger an immediate flush */
+const MAX_BATCH = 64 * 1024;
+
+/** Unacknowledged characters at which the source is paused */
+const HIGH_WATER_MARK = 1024 * 1024;
+
+class OutputCoalescer {
+  /**
+   * @param {Function} send - (text, { stream, seq }) => void
+   * @param {Object} [options]
+   * @param {*} [options.id] - Stream id passed along with every batch
+   * @param {Function} [options.onPause] - Stop reading from the source
+   * @param {Function} [options.onResume] - Start reading again
+   * @param {number} [options.intervalMs] - Flush interval
+   * @param {number} [options.maxBatch] - Batch size that flushes at once
+   * @param {number} [options.highWaterMark] - Backlog that pauses the source
+   * @param {number} [options.lowWaterMark] - Backlog that resumes it
+   * @param {Function} [options.setTimer] - setTimeout replacement for tests
+   * @param {Function} [options.clearTimer] - clearTimeout replacement for tests
+   */
+  constructor(send, options = {}) {
+    this.send = send;
+    this.id = options.id;
+    this.onPause = options.onPause || (() => {});
+    this.onResume = options.onResume || (() => {});
+    this.intervalMs = options.intervalMs || FLUSH_INTERVAL_MS;
+    this.maxBatch = options.maxBatch || MAX_BATCH;
+    this.highWaterMark = options.highWaterMark || HIGH_WATER_MARK;
+    this.lowWaterMark = options.lowWaterMark || Math.floor(this.highWaterMark / 4);
+    this.setTimer = options.setTimer || setTimeout;
+    this.clearTimer = options.clearTimer || clearTimeout;
+
+    /** @type {Array<string>} Text waiting for the next flush */
+    this.chunks = [];
+    this.buffered = 0;
+    /** Characters sent but not acknowledged */
+    this.unacked = 0;
+    this.seq = 0;
+    this.timer = null;
+    this.paused = false;
+    /** Set by the first acknowledgement */
+    this.flowControl = false;
+    this.ended = false;
+  }
+
+  /**
+   * Queue text for the next batch
+   * @param {string} text - Output text
+   */
+  write(text) {
+    if (this.ended || !text) return;
+    this.chunks.push(text);
+    this.buffered += text.length;
+    if (this.buffered >= this.maxBatch) {
+      this.flush();
+    } else if (this.timer === null) {
+      this.timer = this.setTimer(() => {
+        this.timer = null;
+        this.flush();
+      }, this.intervalMs);
+    }
+  }
+
+  /**
+   * Send everything queued as one batch
+   */
+  flush() {
+    if (this.timer !== null) {
+      this.clearTimer(this.timer);
+      this.timer = null;
+    }
+    if (this.buffered === 0) return;
+    const text = this.chunks.length === 1 ? this.chunks[0] : this.chunks.join('');
+    this.chunks = [];
+    this.buffered = 0;
+    this.unacked += text.length;
+    this.send(text, { stream: this.id, seq: ++this.seq });
+    if (this.flowControl && !this.paused && this.unacked >= this.highWaterMark) {
+      this.paused = true;
+      this.onPause();
+    }
+  }
+
+  /**
+   * Record that the renderer has processed output
+   * @param {number} chars - Characters processed
+   */
+  ack(chars) {
+    this.flowControl = true;
+    this.unacked = Math.max(0, this.unacked - (Number(chars) || 0));
+    if (this.paused && this.unacked <= this.lowWaterMark) {
+      this.paused = false;
+      if (!this.ended) this.onResume();
+    }
+  }
+
+  /**
+   * Flush what is left; later writes are ignored
+   */
+  end() {
+    this.flush();
+    this.ended = true;
+  }
+}
+
+module.exports = { OutputCoalescer, FLUSH_INTERVAL_MS, MAX_BATCH, HIGH_WATER_MARK };
@@ -0,0 +1,232 @@
+/**
+ * @fileoverview Process metrics: per-child CPU and RSS from /proc and
+ * heap snapshots captured when a process crosses a memory threshold
+ *
+ * Electron's app.getAppMetrics() only knows about Chromium processes. The
+ * ctrace binary and its socat bridge are plain child processes, so their
+ * RSS and CPU time are read from /proc on Linux. CPU percentages come from
+ * the difference in CPU ticks between two samples.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+const fs = require('fs').promises;
+const path = require('path');
+
+/** Kernel clock ticks per second (USER_HZ), 100 on every mainstream Linux */
+const CLOCK_TICKS = 100;
+
+/** Heap snapshots kept on disk; they are large */
+const MAX_SNAPSHOTS = 5;
+
+/** Minimum time between automatic snapshots of the same process */
+const SNAPSHOT_COOLDOWN_MS = 10 * 60 * 1000;
+
+/**
+ * Parse /proc/<pid>/stat
+ * @param {string} text - File content
+ * @returns {Object|null} { name, state, cpuTicks, rssPages }
+ */
+function parseProcStat(text) {
+  // The command name is in parentheses and may itself contain spaces or ')'
+  const open = text.indexOf('(');
+  const close = text.lastIndexOf(')');
+  if (open === -1 || close === -1) return null;
+  const fields = text.slice(close + 2).trim().split(/\s+/);
+  // fields[0] is field 3 (state); utime and stime are fields 14 and 15, rss is 24
+  return {
+    name: text.slice(open + 1, close),
+    state: fields[0],
+    cpuTicks: Number(fields[11]) + Number(fields[12]),
+    rssPages: Number(fields[21])
+  };
+}
+
+/**
+ * Read VmRSS from /proc/<pid>/status
+ * @param {string} text - File content
+ * @returns {number|null} Resident set size in bytes
+ */
+function parseStatusRss(text) {
+  const match = /^VmRSS:\s+(\d+)\s+kB/m.exec(text);
+  return match ? Number(match[1]) * 1024 : null;
+}
+
+/**
+ * Tracks child processes that Electron does not report
+ */
+class ChildProcessTracker {
+  /**
+   * @param {Object} options - { procRoot, now } replaceable in tests
+   */
+  constructor(options = {}) {
+    this.procRoot = options.procRoot || '/proc';
+    this.now = options.now || Date.now;
+    /** @type {Map<number, Object>} pid -> { pid, label, startedAt, lastTicks, lastTime } */
+    this.children = new Map();
+  }
+
+  /**
+   * @returns {boolean} Whether /proc sampling works on this platform
+   */
+  static isSupported() {
+    return process.platform === 'linux';
+  }
+
+  /**
+   * @param {number} pid - Child pid
+   * @param {string} label - Role shown in the panel ('ctrace', 'socat', ...)
+   */
+  register(pid, label) {
+    if (!pid) return;
+    this.children.set(pid, { pid, label, startedAt: this.now(), lastTicks: null, lastTime: null });
+  }
+
+  /**
+   * @param {number} pid - Child pid
+   */
+  unregister(pid) {
+    this.children.delete(pid);
+  }
+
+  /**
+   * Sample every tracked child; children that exited are dropped
+   * @returns {Promise<Array<Object>>} [{ pid, label, name, rssBytes, cpuPercent, runningMs }]
+   */
+  async sample() {
+    const results = [];
+    for (const child of Array.from(this.children.values())) {
+      let stat;
+      let rssBytes;
+      try {
+        const dir = path.join(this.procRoot, String(child.pid));
+        const [statText, statusText] = await Promise.all([
+          fs.readFile(path.join(dir, 'stat'), 'utf8'),
+          fs.readFile(path.join(dir, 'status'), 'utf8')
+        ]);
+        stat = parseProcStat(statText);
+        rssBytes = parseStatusRss(statusText);
+      } catch (error) {
+        this.children.delete(child.pid);
+        continue;
+      }
+      if (!stat || stat.state === 'Z') {
+        this.children.delete(child.pid);
+        continue;
+      }
+
+      const time = this.now();
+      let cpuPercent = null;
+      if (child.lastTicks !== null && time > child.lastTime) {
+        const cpuMs = (stat.cpuTicks - child.lastTicks) * 1000 / CLOCK_TICKS;
+        cpuPercent = Math.round(cpuMs / (time - child.lastTime) * 1000) / 10;
+      }
+      child.lastTicks = stat.cpuTicks;
+      child.lastTime = time;
+
+      results.push({
+        pid: child.pid,
+        label: child.label,
+        name: stat.name,
+        rssBytes: rssBytes !== null ? rssBytes : stat.rssPages * 4096,
+        cpuPercent,
+        runningMs: time - child.startedAt
+      });
+    }
+    return results;
+  }
+}
+
+/**
+ * Captures heap snapshots when a process's memory crosses a threshold.
+ * A process is re-armed once it drops below 90% of the threshold, so a
+ * process hovering around the limit does not produce a stream of files.
+ */
+class HeapSnapshotWatcher {
+  /**
+   * @param {Object} options
+   * @param {string} options.directory - Where snapshots are written
+   * @param {Function} options.capture - async (target, filePath) => void
+   * @param {number} [options.thresholdMb] - Per-process limit, 0 disables
+   * @param {Function} [options.now] - Clock, replaceable in tests
+   */
+  constructor(options) {
+    this.directory = options.directory;
+    this.capture = options.capture;
+    this.thresholdMb = options.thresholdMb || 0;
+    this.now = options.now || Date.now;
+    /** @type {Map<string, number>} target key -> time of the last snapshot */
+    this.lastCaptured = new Map();
+    this.armed = new Map();
+    this.snapshots = [];
+  }
+
+  /**
+   * @param {number} thresholdMb - New limit, 0 disables automatic snapshots
+   */
+  setThreshold(thresholdMb) {
+    this.thresholdMb = Math.max(0, Number(thresholdMb) || 0);
+  }
+
+  /**
+   * Check processes against the threshold and capture where needed
+   * @param {Array<Object>} processes - [{ key, memoryMb, target }]
+   * @returns {Promise<Array<Object>>} Snapshots taken
+   */
+  async check(processes) {
+    const taken = [];
+    if (!this.thresholdMb) return taken;
+    for (const proc of processes) {
+      if (proc.memoryMb < this.thresholdMb * 0.9) {
+        this.armed.set(proc.key, true);
+        continue;
+      }
+      if (proc.memoryMb < this.thresholdMb || this.armed.get(proc.key) === false) continue;
+      const last = this.lastCaptured.get(proc.key) || 0;
+      if (this.now() - last < SNAPSHOT_COOLDOWN_MS) continue;
+
+      this.armed.set(proc.key, false);
+      const snapshot = await this.take(proc.key, proc.target, `automatic: ${Math.round(proc.memoryMb)} MB >= ${this.thresholdMb} MB`);
+      if (snapshot) taken.push(snapshot);
+    }
+    return taken;
+  }
+
+  /**
+   * Capture a snapshot now
+   * @param {string} key - Process key used in the file name
+   * @param {*} target - Passed to the capture function
+   * @param {string} reason - Why it was taken
+   * @returns {Promise<Object|null>} { filePath, key, reason, time } or null on failure
+   */
+  async take(key, target, reason) {
+    const time = this.now();
+    const fileName = `${key.replace(/[^\w-]+/g, '_')}-${new Date(time).toISOString().replace(/[:.]/g, '-')}.heapsnapshot`;
+    const filePath = path.join(this.directory, fileName);
+    try {
+      await fs.mkdir(this.directory, { recursive: true });
+      await this.capture(target, filePath);
+    } catch (error) {
+      return null;
+    }
+    this.lastCaptured.set(key, time);
+    const snapshot = { filePath, key, reason, time };
+    this.snapshots.push(snapshot);
+
+    while (this.snapshots.length > MAX_SNAPSHOTS) {
+      const old = this.snapshots.shift();
+      await fs.unlink(old.filePath).catch(() => {});
+    }
+    return snapshot;
+  }
+}
+
+module.exports = {
+  parseProcStat,
+  parseStatusRss,
+  ChildProcessTracker,
+  HeapSnapshotWatcher,
+  /** Children started by the app (ctrace runs, WSL bridge) */
+  childProcesses: new ChildProcessTracker()
+};
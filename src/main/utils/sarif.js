@@ -0,0 +1,52 @@
+/**
+ * @fileoverview SARIF import: streaming file reader
+ *
+ * Files are read with JsonPathStream, so only one result is materialized
+ * at a time and a multi-hundred-MB log never exists as a single string.
+ * Results are merged by SarifMerger (shared/sarifMerger), shared
+ * with the results panel.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+const fs = require('fs');
+const { JsonPathStream, WILDCARD } = require('./jsonStream');
+
+/** Read size for SARIF files */
+const READ_CHUNK_SIZE = 1024 * 1024;
+
+/** Parts of a run that are materialized; everything else is skipped */
+const RUN_PATTERNS = [
+  ['runs', WILDCARD, 'tool'],
+  ['runs', WILDCARD, 'originalUriBaseIds'],
+  ['runs', WILDCARD, 'results', WILDCARD]
+];
+
+/**
+ * Stream a SARIF file into a merger
+ * @param {string} filePath - SARIF file
+ * @param {SarifMerger} merger - Merge target
+ * @param {Function} [onProgress] - (bytesRead) => void, once per chunk
+ * @returns {Promise<void>}
+ */
+async function readSarifFile(filePath, merger, onProgress) {
+  const prefix = merger.beginDocument(filePath);
+  const parser = new JsonPathStream(RUN_PATTERNS, (value, path) => {
+    const key = `${prefix}${path[1]}`;
+    if (path[2] === 'tool') merger.setTool(key, value);
+    else if (path[2] === 'originalUriBaseIds') merger.setBaseUris(key, value);
+    else merger.addResult(key, value);
+  });
+
+  const stream = fs.createReadStream(filePath, { encoding: 'utf8', highWaterMark: READ_CHUNK_SIZE });
+  let first = true;
+  for await (const chunk of stream) {
+    parser.write(first && chunk.charCodeAt(0) === 0xfeff ? chunk.slice(1) : chunk);
+    first = false;
+    if (onProgress) onProgress(stream.bytesRead);
+  }
+  parser.end();
+}
+
+module.exports = { readSarifFile };
@@ -0,0 +1,296 @@
+/**
+ * @fileoverview Crash-safe session journal
+ *
+ * The session (workspace, open tabs, view states, unsaved edits, the last
+ * diagnostics of each file) is kept as an append-only journal of small
+ * JSON records, one per line, next to a snapshot of the state at the last
+ * compaction. Appends are batched by the renderer and synced to disk, so a
+ * crash loses at most the last unflushed batch; a torn last line is
+ * ignored on replay. Records are idempotent (each sets state rather than
+ * changing it), so replaying a journal over a snapshot that already
+ * contains it is harmless.
+ *
+ * Diagnostics can be megabytes per file, so their output goes to a side
+ * file per analyzed file and the journal only notes that it exists; the
+ * renderer loads it when the file's tab is first focused.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+const fs = require('fs').promises;
+const path = require('path');
+const crypto = require('crypto');
+
+/** Journal size that triggers a compaction */
+const COMPACT_BYTES = 8 * 1024 * 1024;
+
+/** Files whose last diagnostics are kept */
+const MAX_DIAGNOSTIC_FILES = 20;
+
+const SNAPSHOT_FILE = 'session.json';
+const JOURNAL_FILE = 'journal.jsonl';
+const DIAGNOSTICS_DIR = 'diagnostics';
+
+/**
+ * @returns {Object} State of an empty session
+ */
+function emptySession() {
+  return { version: 1, workspace: null, tabs: [], activeKey: null, diagnostics: {} };
+}
+
+/**
+ * Apply one journal record
+ * @param {Object} state - Session state, modified in place
+ * @param {Object} record - { type, ... }
+ * @returns {Object} The state
+ */
+function applyRecord(state, record) {
+  const tab = record.key ? state.tabs.find(t => t.key === record.key) : null;
+  switch (record.type) {
+    case 'workspace':
+      state.workspace = record.path || null;
+      break;
+    case 'open':
+      if (tab) {
+        Object.assign(tab, { filePath: record.filePath, fileName: record.fileName, fileInfo: record.fileInfo || {} });
+      } else {
+        state.tabs.push({
+          key: record.key,
+          filePath: record.filePath || null,
+          fileName: record.fileName,
+          fileInfo: record.fileInfo || {},
+          modified: false,
+          content: null,
+          viewState: null
+        });
+      }
+      break;
+    case 'close':
+      state.tabs = state.tabs.filter(t => t.key !== record.key);
+      if (state.activeKey === record.key) state.activeKey = null;
+      break;
+    case 'rename':
+      if (tab) Object.assign(tab, { filePath: record.filePath, fileName: record.fileName });
+      break;
+    case 'active':
+      state.activeKey = record.key;
+      break;
+    case 'view':
+      if (tab) tab.viewState = record.viewState || null;
+      break;
+    case 'edit':
+      if (tab) Object.assign(tab, { modified: true, content: record.content });
+      break;
+    case 'saved':
+      if (tab) Object.assign(tab, { modified: false, content: null });
+      break;
+    case 'diagnostics': {
+      if (!record.filePath) break;
+      delete state.diagnostics[record.filePath];
+      state.diagnostics[record.filePath] = { at: record.at || 0 };
+      const files = Object.keys(state.diagnostics);
+      for (const file of files.slice(0, Math.max(0, files.length - MAX_DIAGNOSTIC_FILES))) {
+        delete state.diagnostics[file];
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return state;
+}
+
+class SessionJournal {
+  /**
+   * @param {string} directory - Directory holding the snapshot and the journal
+   * @param {Object} [options]
+   * @param {number} [options.compactBytes] - Journal size that triggers a compaction
+   */
+  constructor(directory, { compactBytes = COMPACT_BYTES } = {}) {
+    this.directory = directory;
+    this.snapshotPath = path.join(directory, SNAPSHOT_FILE);
+    this.journalPath = path.join(directory, JOURNAL_FILE);
+    this.diagnosticsDir = path.join(directory, DIAGNOSTICS_DIR);
+    this.compactBytes = compactBytes;
+    /** Current state, kept in step with the journal once restored */
+    this.state = null;
+    this.journalBytes = 0;
+    this.handle = null;
+    /** Serializes appends and compactions */
+    this.queue = Promise.resolve();
+  }
+
+  /**
+   * Load the last session. New records are appended to the same journal;
+   * call compact() once startup is over to fold it into the snapshot.
+   * @returns {Promise<Object>} Session state
+   */
+  restore() {
+    return this.enqueue(async () => {
+      await fs.mkdir(this.directory, { recursive: true });
+      let state = emptySession();
+      try {
+        const snapshot = JSON.parse(await fs.readFile(this.snapshotPath, 'utf8'));
+        if (snapshot && snapshot.version === 1) state = Object.assign(emptySession(), snapshot);
+      } catch (error) {
+        // No snapshot yet, or an unreadable one: start from the journal alone
+      }
+      let journal = '';
+      try {
+        journal = await fs.readFile(this.journalPath, 'utf8');
+      } catch (error) {
+        // No journal yet
+      }
+      let validBytes = 0;
+      for (const line of journal.split('\n')) {
+        if (!line) {
+          validBytes += 1;
+          continue;
+        }
+        let record;
+        try {
+          record = JSON.parse(line);
+        } catch (error) {
+          // Torn write from a crash; later lines were never acknowledged either
+          break;
+        }
+        applyRecord(state, record);
+        validBytes += Buffer.byteLength(line, 'utf8') + 1;
+      }
+      const journalBytes = Buffer.byteLength(journal, 'utf8');
+      this.journalBytes = Math.min(validBytes, journalBytes);
+      // Drop a torn tail so records appended after it are not lost on the next replay
+      if (this.journalBytes < journalBytes) await fs.truncate(this.journalPath, this.journalBytes);
+      this.state = state;
+      return state;
+    });
+  }
+
+  /**
+   * Fold the journal into a fresh snapshot and drop unreferenced diagnostics
+   * @returns {Promise<void>}
+   */
+  compact() {
+    return this.enqueue(async () => {
+      if (!this.state) return;
+      await this.compactNow();
+    });
+  }
+
+  /**
+   * Saved ctrace output of a file
+   * @param {string} filePath - Analyzed file
+   * @returns {Promise<string|null>} Output, or null if none was kept
+   */
+  async loadDiagnostics(filePath) {
+    try {
+      return await fs.readFile(this.diagnosticsPath(filePath), 'utf8');
+    } catch (error) {
+      return null;
+    }
+  }
+
+  /**
+   * Append records
+   * @param {Array<Object>} records - Journal records
+   * @returns {Promise<void>}
+   */
+  append(records) {
+    if (!records || records.length === 0) return this.queue;
+    return this.enqueue(async () => {
+      if (!this.state) this.state = emptySession();
+      const stored = [];
+      for (const record of records) stored.push(await this.storeOutput(record));
+      records = stored;
+      const text = records.map(record => `${JSON.stringify(record)}\n`).join('');
+      if (!this.handle) this.handle = await fs.open(this.journalPath, 'a');
+      await this.handle.appendFile(text, 'utf8');
+      await this.handle.datasync();
+      this.journalBytes += Buffer.byteLength(text, 'utf8');
+      for (const record of records) applyRecord(this.state, record);
+      if (this.journalBytes > this.compactBytes) await this.compactNow();
+    });
+  }
+
+  /**
+   * Close the journal file
+   * @returns {Promise<void>}
+   */
+  close() {
+    return this.enqueue(async () => {
+      if (this.handle) await this.handle.close();
+      this.handle = null;
+    });
+  }
+
+  /**
+   * @private
+   */
+  enqueue(task) {
+    const run = this.queue.then(task);
+    // A failed task must not block the ones after it
+    this.queue = run.catch(() => {});
+    return run;
+  }
+
+  /**
+   * @private
+   */
+  diagnosticsPath(filePath) {
+    const name = crypto.createHash('sha1').update(filePath).digest('hex');
+    return path.join(this.diagnosticsDir, `${name}.out`);
+  }
+
+  /**
+   * Move the output of a diagnostics record to its side file. The side file
+   * is not synced: losing it only loses the restored diagnostics.
+   * @returns {Promise<Object>} Record to journal
+   * @private
+   */
+  async storeOutput(record) {
+    if (record.type !== 'diagnostics' || !record.filePath || typeof record.output !== 'string') return record;
+    await fs.mkdir(this.diagnosticsDir, { recursive: true });
+    const target = this.diagnosticsPath(record.filePath);
+    await fs.writeFile(`${target}.tmp`, record.output, 'utf8');
+    await fs.rename(`${target}.tmp`, target);
+    const { output, ...rest } = record;
+    return rest;
+  }
+
+  /**
+   * Write the state as the new snapshot and empty the journal
+   * @private
+   */
+  async compactNow() {
+    await fs.mkdir(this.directory, { recursive: true });
+    const tmpPath = `${this.snapshotPath}.tmp`;
+    const snapshot = await fs.open(tmpPath, 'w');
+    try {
+      await snapshot.writeFile(JSON.stringify(this.state), 'utf8');
+      await snapshot.sync();
+    } finally {
+      await snapshot.close();
+    }
+    await fs.rename(tmpPath, this.snapshotPath);
+    // A crash before the truncation only replays records the snapshot already holds
+    if (this.handle) {
+      await this.handle.close();
+      this.handle = null;
+    }
+    await fs.writeFile(this.journalPath, '');
+    this.journalBytes = 0;
+
+    const kept = new Set(Object.keys(this.state.diagnostics).map(file => path.basename(this.diagnosticsPath(file))));
+    let names = [];
+    try {
+      names = await fs.readdir(this.diagnosticsDir);
+    } catch (error) {
+      // No diagnostics saved yet
+    }
+    await Promise.all(names.filter(name => !kept.has(name))
+      .map(name => fs.unlink(path.join(this.diagnosticsDir, name)).catch(() => {})));
+  }
+}
+
+module.exports = { SessionJournal, applyRecord, emptySession };
@@ -5,9 +5,20 @@ const TabManager = require('./managers/TabManager');
 const SearchManager = require('./managers/SearchManager');
 const FileOperationsManager = require('./managers/FileOperationsManager');
 const DiagnosticsManager = require('./managers/DiagnosticsManager');
+const LogViewerManager = require('./managers/LogViewerManager');
+const RawOutputView = require('./managers/RawOutputView');
+const MetricsManager = require('./managers/MetricsManager');
+const SessionManager = require('./managers/SessionManager');
 
 // Import utilities
 const fileTypeUtils = require('./utils/fileTypeUtils');
+const { renderMarkdown, IncrementalMarkdownRenderer } = require('./utils/markdownRenderer');
+const { ansiToHtml } = require('./utils/ansiDecoder');
+const { DiagnosticStore } = require('./utils/diagnosticStore');
+const { getLogger } = require('./utils/logger');
+const { perfMonitor } = require('./utils/perfMonitor');
+const packageInfo = require('../../package.json');
+const log = getLogger('ui');
 
 /**
  * Main UI Controller - Coordinates all managers and components
@@ -65,6 +76,7 @@ class UIController {
      * @private
      */
     this.fileOpsManager = new FileOperationsManager(this.tabManager, this.notificationManager);
+    this.tabManager.fileTreeSelector = (filePath) => this.fileOpsManager.selectInFileTree(filePath);
 
     /**
      * Diagnostics manager instance
@@ -72,6 +84,48 @@ class UIController {
      * @private
      */
     this.diagnosticsManager = new DiagnosticsManager(this.editorManager);
+    this.diagnosticsManager.assistantConfigProvider = () => this.getAssistantConfig();
+    this.diagnosticsManager.activeFileProvider = () => {
+      const active = this.tabManager.getActiveTab();
+      return active ? active.filePath : null;
+    };
+
+    /**
+     * Application log viewer instance
+     * @type {LogViewerManager}
+     * @private
+     */
+    this.logViewerManager = new LogViewerManager(this.notificationManager);
+
+    /**
+     * Process and memory metrics panel instance
+     * @type {MetricsManager}
+     * @private
+     */
+    this.metricsManager = new MetricsManager({
+      tabManager: this.tabManager,
+      diagnosticsManager: this.diagnosticsManager,
+      notificationManager: this.notificationManager
+    });
+
+    /**
+     * Session journal and restore
+     * @type {SessionManager}
+     * @private
+     */
+    this.sessionManager = new SessionManager({
+      tabManager: this.tabManager,
+      editorManager: this.editorManager,
+      fileOpsManager: this.fileOpsManager,
+      diagnosticsManager: this.diagnosticsManager
+    });
+
+    /**
+     * Terminal-style view of the last non-JSON ctrace output
+     * @type {RawOutputView|null}
+     * @private
+     */
+    this.rawOutputView = null;
 
     /**
      * Flag indicating if UI is being resized
@@ -174,6 +228,53 @@ class UIController {
     
     // Set up WSL status listener
     this.setupWSLStatusListener();
+    
+    // Set up the jank indicator in the status bar
+    this.setupPerfMonitor();
+
+    // Reopen the last session; only the active tab is read now
+    this.sessionManager.restore().catch(error => log.error('Session restore failed', error));
+  }
+
+  /**
+   * Stop the raw output view's background search before it is replaced
+   */
+  discardRawOutput() {
+    if (this.rawOutputView) {
+      this.rawOutputView.dispose();
+      this.rawOutputView = null;
+    }
+  }
+
+  /**
+   * Start the long-task monitor and keep the status bar jank indicator
+   * current. Clicking the indicator exports the latency report.
+   */
+  setupPerfMonitor() {
+    perfMonitor.start();
+    const indicator = document.getElementById('jankIndicator');
+    if (!indicator) return;
+
+    const labels = { ok: 'UI: smooth', warn: 'UI: janky', bad: 'UI: blocked' };
+    const update = () => {
+      const status = perfMonitor.getStatus();
+      indicator.className = `jank-indicator jank-${status.level}`;
+      indicator.textContent = labels[status.level];
+      const worst = status.worst ? `\nWorst: ${Math.round(status.worst.duration)} ms in ${status.worst.name}` : '';
+      const p75 = status.p75 === null ? 'n/a' : `${Math.round(status.p75)} ms`;
+      indicator.title = `Last 10 s: ${status.longTasks} long tasks, ${status.blockingMs} ms over frame budget${worst}` +
+        `\nInput to paint p75: ${p75}\nClick to export the latency report`;
+    };
+    setInterval(update, 2000);
+    update();
+
+    indicator.addEventListener('click', async () => {
+      const report = perfMonitor.getReport({ appVersion: packageInfo.version, platform: process.platform });
+      const result = await window.ipcRenderer.invoke('save-file-as', JSON.stringify(report, null, 2));
+      if (result.success) {
+        this.notificationManager.showSuccess(`Latency report saved to ${result.fileName}`);
+      }
+    });
   }
   /**
    * Set up file system watcher to auto-refresh file tree
@@ -237,7 +338,7 @@ class UIController {
       if (data.success) {
         const folderName = data.folderPath.split(/[/\\]/).pop();
         this.fileOpsManager.updateWorkspaceUI(folderName, data.fileTree);
-        console.log('File tree auto-refreshed due to file system changes');
+        log.debug('File tree auto-refreshed due to file system changes');
       } else {
         console.error('Error in workspace change notification:', data.error);
       }
@@ -267,7 +368,7 @@ class UIController {
           );
           console.warn('WSL detected but no distributions installed');
         } else {
-          console.log('WSL is available and ready with distributions');
+          log.debug('WSL is available and ready with distributions');
         }
       }
     });
@@ -574,6 +675,18 @@ class UIController {
     this.tabManager.onLoadFullFile = (filePath) => {
       this.fileOpsManager.loadFullFile(filePath);
     };
+    this.tabManager.tabLoader = (filePath) => this.fileOpsManager.readForTab(filePath);
+
+    // Journal the session as it changes
+    this.tabManager.onTabsChanged = (type, tabId) => {
+      this.sessionManager.onTabsChanged(type, tabId);
+      // Decorations follow the file shown in the editor
+      if (type === 'active' && this.diagnosticsManager.store) this.diagnosticsManager.applyMonacoDecorations();
+    };
+    this.fileOpsManager.onWorkspaceOpened = (folderPath) => {
+      this.searchManager.setWorkspacePath(folderPath);
+      this.sessionManager.recordWorkspace(folderPath);
+    };
 
     // Set up search manager callbacks
     this.searchManager.openSearchResult = async (filePath, lineNumber) => {
@@ -921,6 +1034,8 @@ class UIController {
 
     // UI navigation
     window.toggleSidebar = () => this.toggleSidebar();
+    window.showLogViewer = () => this.logViewerManager.open();
+    window.showProcessMetrics = () => this.metricsManager.open();
     window.toggleToolsPanel = () => this.toggleToolsPanel();
     window.showToolsPanel = () => this.showToolsPanel();
     window.hideToolsPanel = () => this.hideToolsPanel();
@@ -929,13 +1044,6 @@ class UIController {
     // Visualyzer operations
     window.toggleVisualyzerPanel = () => this.toggleVisualyzerPanel();
 
-    // CTrace helpers
-    const stripAnsi = (input) => {
-      if (!input || typeof input !== 'string') return input;
-      const ansiRegex = /\x1b\[[0-9;]*m/g;
-      return input.replace(ansiRegex, '');
-    };
-
     window.runCTrace = async () => {
       const resultsArea = document.getElementById('ctrace-results-area');
       this.showToolsPanel();
@@ -963,6 +1071,7 @@ class UIController {
       
       // Clear previous diagnostics and show loading state
       this.diagnosticsManager.clear();
+      this.discardRawOutput();
       resultsArea.innerHTML = `
         <div class="ctrace-loading">
           <div class="loading-spinner"></div>
@@ -989,14 +1098,44 @@ class UIController {
         // Always prepend --input parameter as first argument
         args.unshift(`--input=${wslFilePath}`);
         
-        console.log("invoke run-ctrace with WSL path:", wslFilePath);
-        console.log("Custom arguments:", args);
-        const result = await window.ipcRenderer.invoke('run-ctrace', args);
-        console.log("after exec result");
-        console.log(result);
+        log.info(`Running ctrace on ${wslFilePath}`, args);
+        // Decode non-JSON output while it streams so a large result is ready on
+        // completion. JSON output is parsed from result.output instead, so the
+        // view only starts once the first non-whitespace character rules JSON out.
+        let rawOutput = null;
+        let leadingWhitespace = [];
+        let linesReceived = 0;
+        const loadingSubtext = resultsArea.querySelector('.loading-subtext');
+        const onOutput = (event, chunk, meta) => {
+          for (let i = chunk.indexOf('\n'); i !== -1; i = chunk.indexOf('\n', i + 1)) linesReceived++;
+          if (rawOutput) {
+            rawOutput.append(chunk);
+          } else if (leadingWhitespace) {
+            const text = chunk.trimStart();
+            if (!text) {
+              leadingWhitespace.push(chunk);
+            } else {
+              if (text[0] !== '{' && text[0] !== '[') {
+                rawOutput = new RawOutputView();
+                for (const whitespace of leadingWhitespace) rawOutput.append(whitespace);
+                rawOutput.append(chunk);
+              }
+              leadingWhitespace = null;
+            }
+          }
+          if (loadingSubtext) loadingSubtext.textContent = `${linesReceived.toLocaleString()} lines received`;
+          // Main pauses the socket while batches go unacknowledged
+          if (meta) window.ipcRenderer.send('ctrace-output-ack', meta.stream, chunk.length);
+        };
+        window.ipcRenderer.on('ctrace-output', onOutput);
+        let result;
+        try {
+          result = await window.ipcRenderer.invoke('run-ctrace', args);
+        } finally {
+          window.ipcRenderer.removeListener('ctrace-output', onOutput);
+        }
+        log.debug(() => `ctrace finished: ${result && result.success ? `${(result.output || '').length} characters of output` : (result && result.error)}`);
         if (result && result.success) {
-          console.log("result.output");
-          console.log(result.output);
           
           // Check if output is empty
           if (!result.output || result.output.trim() === '') {
@@ -1021,19 +1160,21 @@ class UIController {
           const isParsed = this.diagnosticsManager.parseOutput(result.output);
           
           if (isParsed) {
+            this.sessionManager.recordDiagnostics(currentFilePath, result.output);
+
             // Display diagnostics with rich UI
             await this.diagnosticsManager.displayDiagnostics();
             this.notificationManager.showSuccess('CTrace analysis completed');
           } else {
-            // Fallback to plain text output
-            resultsArea.innerHTML = `
-              <div class="ctrace-raw-output">
-                <div class="raw-output-header">
-                  <span>Raw Output</span>
-                </div>
-                <pre class="raw-output-content">${this.diagnosticsManager.escapeHtml(result.output)}</pre>
-              </div>
-            `;
+            // Fallback to the terminal-style view of the streamed output; output
+            // that looked like JSON, or did not stream, is decoded now
+            if (!rawOutput) {
+              rawOutput = new RawOutputView();
+              rawOutput.append(result.output);
+            }
+            rawOutput.end();
+            resultsArea.replaceChildren(rawOutput.element);
+            this.rawOutputView = rawOutput;
             this.notificationManager.showSuccess('CTrace completed');
           }
         } else {
@@ -1045,7 +1186,7 @@ class UIController {
               <div class="ctrace-error">
                 <div class="error-icon">⚠️</div>
                 <div class="error-text">WSL Setup Required</div>
-                <div class="error-details">${stripAnsi(details)}</div>
+                <div class="error-details">${ansiToHtml(details)}</div>
                 <div class="error-help">
                   <strong>Quick Setup:</strong><br>
                   1. Open PowerShell as Administrator<br>
@@ -1061,9 +1202,14 @@ class UIController {
               <div class="ctrace-error">
                 <div class="error-icon">❌</div>
                 <div class="error-text">CTrace Error</div>
-                <pre class="error-details">${stripAnsi(details)}</pre>
               </div>
             `;
+            // Error output can be as long as a verbose run: show it in the virtualized view
+            const errorOutput = new RawOutputView({ title: 'Error Output' });
+            errorOutput.append(details);
+            errorOutput.end();
+            resultsArea.firstElementChild.appendChild(errorOutput.element);
+            this.rawOutputView = errorOutput;
             this.notificationManager.showError('Failed to run CTrace');
           }
         }
@@ -1079,7 +1225,83 @@ class UIController {
       }
     };
 
+    window.importSarif = async () => {
+      const resultsArea = document.getElementById('ctrace-results-area');
+      this.showToolsPanel();
+      if (!resultsArea) return;
+
+      // Progress starts once files are chosen in the dialog
+      const onProgress = (event, progress) => {
+        if (!resultsArea.querySelector('.sarif-import')) {
+          this.diagnosticsManager.clear();
+          this.discardRawOutput();
+          resultsArea.innerHTML = `
+            <div class="ctrace-loading sarif-import">
+              <div class="loading-spinner"></div>
+              <div class="loading-text">Importing SARIF...</div>
+              <div class="loading-subtext"></div>
+            </div>
+          `;
+        }
+        resultsArea.querySelector('.loading-subtext').textContent = `File ${progress.file} of ${progress.files}: ` +
+          `${this.diagnosticsManager.formatBytes(progress.bytesRead)} read, ${progress.results.toLocaleString()} results`;
+      };
+      // Diagnostics go into columns batch by batch; each batch is garbage after
+      const store = new DiagnosticStore();
+      const onBatch = (event, diagnostics) => {
+        for (const diag of diagnostics) store.add(diag);
+      };
+      window.ipcRenderer.on('sarif-import-progress', onProgress);
+      window.ipcRenderer.on('sarif-import-batch', onBatch);
+      try {
+        const result = await window.ipcRenderer.invoke('import-sarif');
+        if (result.canceled) return;
+        if (!result.success) {
+          if (resultsArea.querySelector('.sarif-import')) this.diagnosticsManager.clear();
+          this.notificationManager.showError(`SARIF import failed: ${result.error}`);
+          return;
+        }
+        this.diagnosticsManager.clear();
+        this.discardRawOutput();
+        this.diagnosticsManager.loadResults(result, store);
+        await this.diagnosticsManager.displayDiagnostics();
+        const duplicates = result.meta.duplicates ? `, ${result.meta.duplicates} duplicates merged` : '';
+        this.notificationManager.showSuccess(`Imported ${store.length} diagnostics from ${result.meta.runs} run(s)${duplicates}`);
+      } catch (err) {
+        this.notificationManager.showError(`SARIF import failed: ${err.message}`);
+      } finally {
+        window.ipcRenderer.removeListener('sarif-import-progress', onProgress);
+        window.ipcRenderer.removeListener('sarif-import-batch', onBatch);
+      }
+    };
+
+    window.exportReport = async () => {
+      if (this.diagnosticsManager.getVisibleRows().length === 0) {
+        this.notificationManager.showWarning('No diagnostics to export');
+        return;
+      }
+      const target = await window.ipcRenderer.invoke('export-report-begin', { defaultName: 'ctrace-report.html' });
+      if (target.canceled) return;
+      if (!target.success) {
+        this.notificationManager.showError(`Export failed: ${target.error}`);
+        return;
+      }
+      try {
+        const written = await this.diagnosticsManager.exportReport(target.format, async (chunk) => {
+          const result = await window.ipcRenderer.invoke('export-report-write', target.id, chunk);
+          if (!result.success) throw new Error(result.error);
+        }, (rows, total) => log.debug(() => `Exported ${rows} of ${total} diagnostics`));
+        const done = await window.ipcRenderer.invoke('export-report-end', target.id);
+        if (!done.success) throw new Error(done.error);
+        this.notificationManager.showSuccess(`Exported ${written.rows.toLocaleString()} diagnostics to ${this.diagnosticsManager.getFileName(done.filePath)}`);
+      } catch (err) {
+        await window.ipcRenderer.invoke('export-report-abort', target.id);
+        this.notificationManager.showError(`Export failed: ${err.message}`);
+      }
+    };
+
     window.clearCTraceOutput = () => {
+      this.discardRawOutput();
       this.diagnosticsManager.clear();
     };
 
@@ -1220,10 +1442,27 @@ class UIController {
         this.showToolsPanel();
         // Inject assistant chat UI into tools panel
         this.renderAssistantUI();
+        this.preloadAssistantModel();
       }
     });
   }
 
+  /**
+   * Start loading the Ollama model in the background so the first question
+   * does not wait for a cold load
+   */
+  preloadAssistantModel() {
+    const cfg = this.getAssistantConfig();
+    if (!cfg || cfg.provider !== 'ollama') return;
+    window.ipcRenderer.invoke('assistant-ollama-preload', { config: cfg })
+      .then((result) => {
+        if (result && !result.success) {
+          console.warn('Ollama preload failed:', result.error);
+        }
+      })
+      .catch(() => {});
+  }
+
   /**
    * Inject a simple chat UI into the tools panel (like VSCode Copilot sidebar)
    */
@@ -1262,7 +1501,8 @@ class UIController {
     } else if (cfg.provider === 'external') {
       displayName = cfg.externalProvider || 'External';
     } else if (cfg.provider === 'ollama') {
-      displayName = 'Ollama';
+      // Without a model the main process picks its default
+      displayName = cfg.ollamaModel ? `Ollama (${cfg.ollamaModel})` : 'Ollama';
     } else if (cfg.provider !== 'none') {
       displayName = cfg.provider;
     }
@@ -1272,6 +1512,7 @@ class UIController {
         <div style="padding:8px 12px; border-bottom:1px solid rgba(255,255,255,0.03); display:flex; align-items:center; justify-content:space-between">
           <div style="font-size:13px; color:#c9d1d9">Assistant — ${displayName}</div>
           <div style="display:flex; gap:8px; align-items:center">
+            <button id="assistant-new-chat" title="Start a new conversation (forgets earlier turns)" style="padding:6px 8px; background:#21262d; border:1px solid #30363d; color:#f0f6fc; border-radius:6px; cursor:pointer; font-size:12px">New chat</button>
             <button id="assistant-settings" style="padding:6px 8px; background:#21262d; border:1px solid #30363d; color:#f0f6fc; border-radius:6px; cursor:pointer; font-size:12px">Settings</button>
           </div>
         </div>
@@ -1334,17 +1575,39 @@ class UIController {
       }
     };
 
-    // Typing effect for assistant messages
-    const typeMessage = async (bubble, text, speed = 0.1) => { // Changed from 20 to 10ms (faster). Increase for slower, decrease for faster
+    // Typing effect for assistant messages: reveals `speed` ms per character,
+    // rendering incrementally and touching the DOM at most once per frame.
+    // The default matches the old per-character setTimeout loop, which the
+    // browser clamped to about 4 ms per character.
+    const typeMessage = (bubble, text, speed = 4) => {
       const container = document.getElementById('assistant-messages');
-      let currentText = '';
-      
-      for (let i = 0; i < text.length; i++) {
-        currentText += text[i];
-        bubble.innerHTML = renderMarkdown(currentText);
-        if (container) container.scrollTop = container.scrollHeight;
-        await new Promise(resolve => setTimeout(resolve, speed));
-      }
+      const renderer = new IncrementalMarkdownRenderer(bubble, {
+        onFlush: () => {
+          if (container) container.scrollTop = container.scrollHeight;
+        }
+      });
+
+      return new Promise(resolve => {
+        const startTime = performance.now();
+        let revealed = 0;
+
+        const step = (now) => {
+          const target = speed > 0
+            ? Math.min(text.length, Math.floor((now - startTime) / speed) + 1)
+            : text.length;
+          if (target > revealed) {
+            renderer.write(text.slice(revealed, target));
+            revealed = target;
+          }
+          if (revealed < text.length) {
+            requestAnimationFrame(step);
+          } else {
+            renderer.end();
+            resolve();
+          }
+        };
+        requestAnimationFrame(step);
+      });
     };
 
     // Animated thinking indicator
@@ -1373,95 +1636,6 @@ class UIController {
       }
     };
 
-    // Simple markdown renderer
-    const renderMarkdown = (text) => {
-      // Trim leading/trailing whitespace to avoid extra newlines
-      text = text.trim();
-      
-      // Store original code blocks before any processing
-      const codeBlocks = [];
-      let codeIndex = 0;
-      
-      // Extract and store original code blocks with language info
-      const textWithPlaceholders = text.replace(/```(\w+)?\n([\s\S]*?)```/g, (match, lang, code) => {
-        const trimmedCode = code.trim();
-        codeBlocks.push({ code: trimmedCode, lang: lang || '' });
-        return `__CODE_BLOCK_${codeIndex++}__`;
-      });
-      
-      // Escape HTML
-      let html = textWithPlaceholders.replace(/&/g, '&amp;')
-                                     .replace(/</g, '&lt;')
-                                     .replace(/>/g, '&gt;');
-      
-      // Replace code block placeholders with rendered HTML
-      codeIndex = 0;
-      html = html.replace(/__CODE_BLOCK_(\d+)__/g, (match, index) => {
-        const blockData = codeBlocks[parseInt(index)];
-        const originalCode = blockData.code;
-        const lang = blockData.lang.toLowerCase();
-        
-        // Store original code in base64 to avoid any escaping issues
-        const base64Code = btoa(unescape(encodeURIComponent(originalCode)));
-        
-        // Apply syntax highlighting for C/C++ code
-        let displayCode;
-        if (lang === 'c' || lang === 'cpp' || lang === 'c++') {
-          // Use syntax highlighter
-          const { applySyntaxHighlight } = window.syntaxHighlighter;
-          const fileType = lang === 'c' ? 'C' : 'C++';
-          displayCode = applySyntaxHighlight(originalCode, fileType);
-        } else {
-          // No highlighting - just escape HTML
-          displayCode = originalCode.replace(/&/g, '&amp;')
-                                     .replace(/</g, '&lt;')
-                                     .replace(/>/g, '&gt;');
-        }
-        
-        const langLabel = lang ? `<span style="position:absolute; top:8px; left:12px; font-size:10px; color:#7d8590; text-transform:uppercase; font-weight:600;">${lang}</span>` : '';
-        
-        return `<div style="position:relative; margin:8px 0;">
-          ${langLabel}
-          <div style="position:absolute; top:8px; right:8px; display:flex; gap:6px;">
-            <button class="code-copy-btn" data-code-b64="${base64Code}" style="padding:4px 8px; background:#21262d; border:1px solid #30363d; color:#f0f6fc; border-radius:4px; cursor:pointer; font-size:11px;">Copy</button>
-            <button class="code-replace-btn" data-code-b64="${base64Code}" style="padding:4px 8px; background:#238636; border:1px solid #2ea043; color:#fff; border-radius:4px; cursor:pointer; font-size:11px;">Replace</button>
-          </div>
-          <pre style="background:#0d1117; padding:12px; border-radius:6px; overflow-x:auto; padding-top:${lang ? '28px' : '12px'};"><code style="font-family:Consolas,Monaco,'Courier New',monospace; font-size:13px; color:#c9d1d9;">${displayCode}</code></pre>
-        </div>`;
-      });
-      
-      // Inline code (`code`)
-      html = html.replace(/`([^`]+)`/g, '<code style="background:#21262d; padding:2px 6px; border-radius:3px; font-family:Consolas,Monaco,monospace; font-size:13px; color:#f0f6fc;">$1</code>');
-      
-      // Bold (**text** or __text__)
-      html = html.replace(/\*\*([^*]+)\*\*/g, '<strong>$1</strong>');
-      html = html.replace(/__([^_]+)__/g, '<strong>$1</strong>');
-      
-      // Italic (*text* or _text_)
-      html = html.replace(/\*([^*]+)\*/g, '<em>$1</em>');
-      html = html.replace(/_([^_]+)_/g, '<em>$1</em>');
-      
-      // Headers (### text)
-      html = html.replace(/^### (.+)$/gm, '<h3 style="margin:12px 0 8px 0; font-size:16px; font-weight:600; color:#f0f6fc;">$1</h3>');
-      html = html.replace(/^## (.+)$/gm, '<h2 style="margin:14px 0 10px 0; font-size:18px; font-weight:600; color:#f0f6fc;">$1</h2>');
-      html = html.replace(/^# (.+)$/gm, '<h1 style="margin:16px 0 12px 0; font-size:20px; font-weight:600; color:#f0f6fc;">$1</h1>');
-      
-      // Lists (- item or * item or 1. item)
-      html = html.replace(/^- (.+)$/gm, '<li style="margin-left:20px;">$1</li>');
-      html = html.replace(/^\* (.+)$/gm, '<li style="margin-left:20px;">$1</li>');
-      html = html.replace(/^\d+\. (.+)$/gm, '<li style="margin-left:20px; list-style-type:decimal;">$1</li>');
-      
-      // Wrap consecutive <li> in <ul>
-      html = html.replace(/(<li[^>]*>.*<\/li>\n?)+/g, (match) => {
-        return `<ul style="margin:8px 0; padding-left:0;">${match}</ul>`;
-      });
-      
-      // Line breaks (preserve double newlines as paragraphs)
-      html = html.replace(/\n\n/g, '<br><br>');
-      
-      return html;
-    };
-
     // Prefill a small welcome message with typing effect (only first time)
     const providerName = cfg.provider === 'external' ? (cfg.externalProvider || 'External') : cfg.provider;
     const welcomeText = `Hi — I'm your assistant. Using: ${providerName}. Ask me something or open Settings to change providers.`;
@@ -1485,6 +1659,7 @@ class UIController {
     const sendBtn = document.getElementById('assistant-send');
     const inputEl = document.getElementById('assistant-input');
     const settingsBtn = document.getElementById('assistant-settings');
+    const newChatBtn = document.getElementById('assistant-new-chat');
     const contextIndicator = document.getElementById('context-indicator');
     const contextText = document.getElementById('context-text');
     const contextClearBtn = document.getElementById('context-clear');
@@ -1607,7 +1782,9 @@ class UIController {
         const result = await window.ipcRenderer.invoke('assistant-chat', {
           provider: cfg.provider,
           message: fullMessage,
-          config: cfg
+          config: cfg,
+          diagnostics: this.diagnosticsManager.getRelevantDiagnostics(fullMessage),
+          diagnosticsFile: this.diagnosticsManager.currentMetadata ? this.diagnosticsManager.currentMetadata.inputFile : null
         });
 
         // Remove the thinking message
@@ -1742,6 +1919,15 @@ class UIController {
       });
     };
 
+    newChatBtn.onclick = async () => {
+      const current = this.getAssistantConfig();
+      if (current) {
+        await window.ipcRenderer.invoke('assistant-clear-conversation', { provider: current.provider, config: current });
+      }
+      const container = document.getElementById('assistant-messages');
+      if (container) container.innerHTML = '';
+    };
+
     settingsBtn.onclick = () => {
       // Open the assistant setup modal for reconfiguration
       this.showAssistantSetupGuide((cfg) => {
@@ -1833,6 +2019,14 @@ class UIController {
 
       <div id="assist-extra" style="margin-top:16px"></div>
 
+      <div style="margin-top:16px; padding-top:12px; border-top:1px solid #eee">
+        <div style="display:flex; align-items:center; justify-content:space-between">
+          <span style="font-size:13px; color:#333">Assistant status</span>
+          <button id="assist-clear-cache" type="button" title="Forget cached replies so repeated questions are asked again" style="padding:6px 10px; border:1px solid #e2e2e2; border-radius:4px; background:#f6f8fa; cursor:pointer; font-size:12px">Clear cached replies</button>
+        </div>
+        <div id="assist-stats" style="margin-top:6px; font-size:11px; color:#666; white-space:pre-line">Loading...</div>
+      </div>
+
       <div style="display:flex; justify-content:flex-end; gap:8px; margin-top:18px;">
         <button id="assist-skip" style="padding:8px 12px; background:transparent; border:1px solid #cfcfcf; border-radius:6px; cursor:pointer">Skip for now</button>
         <button id="assist-cancel" style="padding:8px 12px; background:#ddd; border:none; border-radius:6px; cursor:pointer">Cancel</button>
@@ -1871,18 +2065,76 @@ class UIController {
       clearExtra();
       if (value === 'ollama') {
         extra.appendChild(makeInputRow('Ollama host (include protocol)', 'ollama-host', 'http://localhost:11434'));
+        extra.appendChild(makeInputRow('Model', 'ollama-model', 'Model name'));
+        const checkRow = document.createElement('div');
+        checkRow.style.cssText = 'display:flex; gap:8px; align-items:center; margin-top:8px;';
+        checkRow.innerHTML = `
+          <button id="ollama-check" type="button" style="padding:6px 10px; border:1px solid #e2e2e2; border-radius:4px; background:#f6f8fa; cursor:pointer; font-size:12px">Check connection</button>
+          <span id="ollama-status" style="font-size:11px; color:#666"></span>
+          <datalist id="ollama-model-list"></datalist>
+        `;
+        extra.appendChild(checkRow);
+        extra.appendChild(makeInputRow('Keep model loaded for (e.g. 30m, 2h, -1 = always)', 'ollama-keep-alive', '30m'));
         extra.appendChild(makeInputRow('System prompt (optional)', 'system-prompt', 'You are a helpful assistant...'));
         
         // Pre-fill with saved values
         setTimeout(() => {
           const hostInput = document.getElementById('ollama-host');
+          const modelInput = document.getElementById('ollama-model');
+          const keepAliveInput = document.getElementById('ollama-keep-alive');
           const systemInput = document.getElementById('system-prompt');
           if (hostInput && existingConfig.ollamaHost) {
             hostInput.value = existingConfig.ollamaHost;
           }
+          if (modelInput && existingConfig.ollamaModel) {
+            modelInput.value = existingConfig.ollamaModel;
+          }
+          if (keepAliveInput && existingConfig.ollamaKeepAlive !== undefined) {
+            keepAliveInput.value = existingConfig.ollamaKeepAlive;
+          }
           if (systemInput && existingConfig.systemPrompt) {
             systemInput.value = existingConfig.systemPrompt;
           }
+
+          // Offer the installed models and show whether the server answers
+          if (modelInput) modelInput.setAttribute('list', 'ollama-model-list');
+          const checkBtn = document.getElementById('ollama-check');
+          const statusEl = document.getElementById('ollama-status');
+          const checkOllama = async () => {
+            if (!checkBtn || !statusEl) return;
+            const config = { ...existingConfig, ollamaHost: hostInput && hostInput.value.trim() ? hostInput.value.trim() : undefined };
+            checkBtn.disabled = true;
+            statusEl.textContent = 'Checking...';
+            try {
+              const health = await window.ipcRenderer.invoke('assistant-ollama-health', { config });
+              if (!health || !health.success) {
+                statusEl.textContent = health && health.error ? health.error : 'Ollama is not reachable';
+                return;
+              }
+              const models = await window.ipcRenderer.invoke('assistant-ollama-models', { config });
+              if (!models || !models.success) {
+                statusEl.textContent = `Connected to Ollama ${health.version}; ${models && models.error ? models.error : 'cannot list models'}`;
+                return;
+              }
+              const list = document.getElementById('ollama-model-list');
+              if (list) {
+                list.replaceChildren(...models.models.map(name => {
+                  const option = document.createElement('option');
+                  option.value = name;
+                  return option;
+                }));
+              }
+              if (modelInput) modelInput.placeholder = `${models.defaultModel} (default)`;
+              statusEl.textContent = `Connected to Ollama ${health.version}, ${models.models.length} models installed`;
+            } catch (error) {
+              statusEl.textContent = error.message;
+            } finally {
+              checkBtn.disabled = false;
+            }
+          };
+          if (checkBtn) checkBtn.onclick = checkOllama;
+          if (hostInput) hostInput.onchange = checkOllama;
+          checkOllama();
         }, 0);
       } else if (value === 'external') {
         const selRow = document.createElement('div');
@@ -1968,6 +2220,42 @@ class UIController {
         `;
         extra.appendChild(gpuRow);
         
+        // Add parallel sequences configuration
+        const sequencesRow = document.createElement('div');
+        sequencesRow.style.cssText = 'margin-top:12px;';
+        sequencesRow.innerHTML = `
+          <label style="display:block; margin-bottom:4px; color:#333; font-size:13px">Parallel requests (context sequences):</label>
+          <input id="local-parallel-sequences" type="number" placeholder="auto" style="width:100%; padding:8px; border:1px solid #e2e2e2; border-radius:4px" min="1" max="16">
+          <div style="margin-top:4px; font-size:11px; color:#666">Independent requests decode together in one batch. Each sequence needs its own context memory. Leave empty to pick from the CPU count.</div>
+        `;
+        extra.appendChild(sequencesRow);
+        
+        // Add CPU inference settings; empty fields use the autotuned profile
+        const cpuRow = document.createElement('div');
+        cpuRow.style.cssText = 'margin-top:12px;';
+        cpuRow.innerHTML = `
+          <label style="display:block; margin-bottom:4px; color:#333; font-size:13px">CPU inference:</label>
+          <div style="display:flex; gap:8px;">
+            <input id="cpu-threads" type="number" placeholder="Threads (auto)" style="flex:1; padding:8px; border:1px solid #e2e2e2; border-radius:4px" min="1">
+            <input id="batch-size" type="number" placeholder="Batch size (512)" style="flex:1; padding:8px; border:1px solid #e2e2e2; border-radius:4px" min="32">
+            <select id="kv-cache-type" style="flex:1; padding:8px; border:1px solid #e2e2e2; border-radius:4px">
+              <option value="">KV cache (auto)</option>
+              <option value="f16">KV cache f16</option>
+              <option value="q8_0">KV cache q8_0</option>
+              <option value="q4_0">KV cache q4_0</option>
+            </select>
+          </div>
+          <div style="display:flex; gap:16px; margin-top:6px; font-size:12px; color:#333">
+            <label><input id="use-mmap" type="checkbox" checked> Memory-map model file</label>
+            <label><input id="use-mlock" type="checkbox"> Lock model in RAM (mlock)</label>
+          </div>
+          <div style="display:flex; gap:8px; align-items:center; margin-top:8px">
+            <button id="local-autotune" type="button" style="padding:6px 10px; border:1px solid #e2e2e2; border-radius:4px; background:#f6f8fa; cursor:pointer; font-size:12px">Run autotune</button>
+            <span id="local-autotune-status" style="font-size:11px; color:#666">Benchmarks threads, batch size and KV cache type on this machine and saves the fastest for this model.</span>
+          </div>
+        `;
+        extra.appendChild(cpuRow);
+        
         // Add system prompt field for local models too
         extra.appendChild(makeInputRow('System prompt (optional)', 'system-prompt', 'You are a helpful assistant...'));
         
@@ -1976,6 +2264,7 @@ class UIController {
           const systemInput = document.getElementById('system-prompt');
           const gpuLayersInput = document.getElementById('gpu-layers');
           const contextSizeInput = document.getElementById('context-size');
+          const sequencesInput = document.getElementById('local-parallel-sequences');
           
           if (systemInput && existingConfig.systemPrompt) {
             systemInput.value = existingConfig.systemPrompt;
@@ -1986,6 +2275,52 @@ class UIController {
           if (contextSizeInput && existingConfig.contextSize !== undefined) {
             contextSizeInput.value = existingConfig.contextSize;
           }
+          if (sequencesInput && existingConfig.localParallelSequences) {
+            sequencesInput.value = existingConfig.localParallelSequences;
+          }
+          
+          const threadsInput = document.getElementById('cpu-threads');
+          const batchInput = document.getElementById('batch-size');
+          const kvInput = document.getElementById('kv-cache-type');
+          const mmapInput = document.getElementById('use-mmap');
+          const mlockInput = document.getElementById('use-mlock');
+          if (threadsInput && existingConfig.cpuThreads) threadsInput.value = existingConfig.cpuThreads;
+          if (batchInput && existingConfig.batchSize) batchInput.value = existingConfig.batchSize;
+          if (kvInput && existingConfig.kvCacheType) kvInput.value = existingConfig.kvCacheType;
+          if (mmapInput && existingConfig.useMmap === false) mmapInput.checked = false;
+          if (mlockInput && existingConfig.useMlock) mlockInput.checked = true;
+          
+          const autotuneBtn = document.getElementById('local-autotune');
+          const autotuneStatus = document.getElementById('local-autotune-status');
+          if (autotuneBtn) {
+            autotuneBtn.onclick = async () => {
+              const modelPath = document.getElementById('local-model-path');
+              if (!modelPath || !modelPath.value) {
+                this.notificationManager.showError('Please choose a local GGUF model file first');
+                return;
+              }
+              autotuneBtn.disabled = true;
+              const onProgress = (event, progress) => {
+                autotuneStatus.textContent = `Benchmarking ${progress.index}/${progress.total}...`;
+              };
+              window.ipcRenderer.on('assistant-autotune-progress', onProgress);
+              try {
+                const result = await window.ipcRenderer.invoke('assistant-local-autotune', {
+                  config: { ...existingConfig, localModelPath: modelPath.value }
+                });
+                if (result && result.success) {
+                  const best = result.profile;
+                  autotuneStatus.textContent = `Saved: ${best.settings.threads} threads, batch ${best.settings.batchSize}, KV ${best.settings.kvCacheType} ` +
+                    `(${best.promptTokensPerSecond} prompt tok/s, ${best.generationTokensPerSecond} gen tok/s)`;
+                } else {
+                  autotuneStatus.textContent = result && result.error ? result.error : 'Autotune failed';
+                }
+              } finally {
+                window.ipcRenderer.removeListener('assistant-autotune-progress', onProgress);
+                autotuneBtn.disabled = false;
+              }
+            };
+          }
         }, 0);
       }
     };
@@ -2006,6 +2341,39 @@ class UIController {
     const btnCancel = dialog.querySelector('#assist-cancel');
     const btnSkip = dialog.querySelector('#assist-skip');
 
+    // Latency the router measured per provider, and the local model's sequences
+    const statsEl = dialog.querySelector('#assist-stats');
+    const refreshStats = async () => {
+      const lines = [];
+      try {
+        const [routing, local] = await Promise.all([
+          window.ipcRenderer.invoke('assistant-get-routing-stats'),
+          window.ipcRenderer.invoke('assistant-local-status')
+        ]);
+        if (local && local.success && local.loaded) {
+          lines.push(`Local model: ${local.busy}/${local.size} sequences busy, ${local.queued} queued`);
+        }
+        for (const [key, stats] of Object.entries(routing && routing.success ? routing.stats : {})) {
+          const latency = stats.totalMs !== null ? `${Math.round(stats.totalMs)} ms average` : 'no timings yet';
+          lines.push(`${key}: ${latency}, ${stats.requests} requests, ${stats.errors} errors, ${stats.wins}/${stats.hedges} hedges won`);
+        }
+      } catch (error) {
+        lines.push(`Status unavailable: ${error.message}`);
+      }
+      statsEl.textContent = lines.length > 0 ? lines.join('\n') : 'No requests yet';
+    };
+    refreshStats();
+
+    const btnClearCache = dialog.querySelector('#assist-clear-cache');
+    btnClearCache.onclick = async () => {
+      const result = await window.ipcRenderer.invoke('assistant-clear-response-cache');
+      if (result && result.success) {
+        this.notificationManager.showSuccess('Cached assistant replies cleared');
+      } else {
+        this.notificationManager.showError('Cannot clear cached replies');
+      }
+    };
+
     const closeModal = (result) => {
       try { document.body.removeChild(modal); } catch (_) {}
       if (done) done(result);
@@ -2037,6 +2405,11 @@ class UIController {
       if (provider === 'ollama') {
         const hostEl = document.getElementById('ollama-host');
         cfg.ollamaHost = hostEl && hostEl.value ? hostEl.value.trim() : 'http://localhost:11434';
+        const modelEl = document.getElementById('ollama-model');
+        const keepAliveEl = document.getElementById('ollama-keep-alive');
+        // Empty leaves the choice to the main process default
+        if (modelEl && modelEl.value.trim()) cfg.ollamaModel = modelEl.value.trim();
+        cfg.ollamaKeepAlive = keepAliveEl && keepAliveEl.value.trim() ? keepAliveEl.value.trim() : '30m';
       } else if (provider === 'external') {
         const prov = document.getElementById('external-provider');
         const key = document.getElementById('external-api-key');
@@ -2062,6 +2435,23 @@ class UIController {
         
         // Save context size setting (default to 8192 if not specified)
         cfg.contextSize = contextSizeEl && contextSizeEl.value !== '' ? parseInt(contextSizeEl.value, 10) : 8192;
+        
+        // Empty means automatic (based on CPU count)
+        const sequencesEl = document.getElementById('local-parallel-sequences');
+        const sequences = sequencesEl && sequencesEl.value !== '' ? parseInt(sequencesEl.value, 10) : 0;
+        if (sequences > 0) cfg.localParallelSequences = sequences;
+        
+        // Empty CPU fields fall back to the autotuned profile
+        const threadsEl = document.getElementById('cpu-threads');
+        const batchEl = document.getElementById('batch-size');
+        const kvEl = document.getElementById('kv-cache-type');
+        const mmapEl = document.getElementById('use-mmap');
+        const mlockEl = document.getElementById('use-mlock');
+        if (threadsEl && threadsEl.value !== '') cfg.cpuThreads = parseInt(threadsEl.value, 10);
+        if (batchEl && batchEl.value !== '') cfg.batchSize = parseInt(batchEl.value, 10);
+        if (kvEl && kvEl.value) cfg.kvCacheType = kvEl.value;
+        if (mmapEl && !mmapEl.checked) cfg.useMmap = false;
+        if (mlockEl && mlockEl.checked) cfg.useMlock = true;
       }
 
       // Persist and close
@@ -2090,29 +2480,27 @@ class UIController {
    * @param {number} lineNumber - Line number
    */
   async openSearchResult(filePath, lineNumber) {
-    console.log('Opening search result:', filePath, 'at line', lineNumber);
+    log.debug(() => `Opening search result: ${filePath} at line ${lineNumber}`);
     
     try {
       const normalizedPath = filePath.replace(/\\\\/g, '\\');
       
       const result = await window.ipcRenderer.invoke('read-file', normalizedPath);
-      console.log('Search result read result:', result);
       
       if (result.success) {
         let tabId;
         
         if (result.warning === 'encoding') {
-          console.log('Search result: Encoding warning detected, showing dialog...');
+          log.debug('Search result: Encoding warning detected, showing dialog');
           const userChoice = await this.notificationManager.showEncodingWarningDialog();
-          console.log('Search result: User choice:', userChoice);
+          log.debug(() => `Search result: User choice: ${userChoice}`);
           
           if (userChoice === 'no') {
-            console.log('Search result: User chose not to open file');
+            log.debug('Search result: User chose not to open file');
             return;
           } else if (userChoice === 'yes') {
-            console.log('Search result: User chose to open file anyway');
+            log.debug('Search result: User chose to open file anyway');
             const forceResult = await window.ipcRenderer.invoke('force-open-file', normalizedPath);
-            console.log('Search result: Force open result:', forceResult);
             
             if (forceResult.success) {
               tabId = this.fileOpsManager.openFileInTab(normalizedPath, forceResult.content, forceResult.fileName, {
@@ -2129,7 +2517,7 @@ class UIController {
             }
           }
         } else {
-          console.log('Search result: No warnings, opening file normally');
+          log.debug('Search result: No warnings, opening file normally');
           tabId = this.fileOpsManager.openFileInTab(normalizedPath, result.content, result.fileName, {
             isPartial: result.isPartial,
             totalSize: result.totalSize,
@@ -0,0 +1,171 @@
+/**
+ * Diagnostic List View - Virtualized diagnostics list
+ *
+ * Only the diagnostics inside the list viewport (plus a small overscan)
+ * are built as objects and exist as DOM elements. Entries differ in
+ * height once details or explanations are shown, so heights start at an
+ * estimate and are measured as entries come into view; a height index
+ * turns scroll offsets into rows either way.
+ */
+
+const { HeightIndex } = require('../utils/heightIndex');
+
+/** Height assumed for an entry not measured yet, gap included */
+const ESTIMATED_HEIGHT = 96;
+
+/** Space between entries in px; matches the old flex gap */
+const GAP = 8;
+
+/** Entries rendered above and below the viewport */
+const OVERSCAN = 5;
+
+class DiagnosticListView {
+  /**
+   * @param {HTMLElement} scroller - The .diagnostics-flat-list element
+   * @param {Object} options
+   * @param {DiagnosticStore} options.store - Store the rows index into
+   * @param {Uint32Array} options.rows - Rows to list, in display order
+   * @param {Function} options.renderItem - (diag) => HTML of one entry
+   */
+  constructor(scroller, options) {
+    this.scroller = scroller;
+    this.store = options.store;
+    this.rows = options.rows;
+    this.renderItem = options.renderItem;
+    this.heights = new HeightIndex(this.rows.length, ESTIMATED_HEIGHT);
+    /** @type {Map<number, HTMLElement>} List position -> bound slot */
+    this.bound = new Map();
+    /** @type {Map<string, HTMLElement>} Diagnostic id -> bound slot */
+    this.slotsById = new Map();
+    /** @type {Array<HTMLElement>} Slots not showing an entry */
+    this.free = [];
+    this.frame = null;
+
+    this.content = document.createElement('div');
+    this.content.className = 'diagnostics-flat-list-content';
+    this.content.style.height = `${this.heights.total}px`;
+    scroller.appendChild(this.content);
+
+    scroller.addEventListener('scroll', () => this.scheduleRender(), { passive: true });
+    if (typeof ResizeObserver !== 'undefined') {
+      this.resizeObserver = new ResizeObserver(() => this.scheduleRender());
+      this.resizeObserver.observe(scroller);
+    }
+    this.render();
+  }
+
+  /**
+   * Stop observing the list; called when it is replaced
+   */
+  dispose() {
+    if (this.frame !== null) cancelAnimationFrame(this.frame);
+    this.frame = null;
+    if (this.resizeObserver) this.resizeObserver.disconnect();
+  }
+
+  /**
+   * Render on the next frame, once however many changes come in
+   */
+  scheduleRender() {
+    if (this.frame !== null) return;
+    this.frame = requestAnimationFrame(() => {
+      this.frame = null;
+      this.render();
+    });
+  }
+
+  /**
+   * Bind slots to the entries in the viewport, measure them and place
+   * them at their offsets
+   * @private
+   */
+  render() {
+    const count = this.rows.length;
+    // Offset of the viewport top within the content
+    const top = Math.max(0, this.scroller.getBoundingClientRect().top - this.content.getBoundingClientRect().top);
+    const anchor = this.heights.indexAt(top);
+    const first = Math.max(0, anchor - OVERSCAN);
+    const last = count === 0 ? 0 : Math.min(count, this.heights.indexAt(top + this.scroller.clientHeight) + 1 + OVERSCAN);
+
+    for (const [position, slot] of this.bound) {
+      if (position < first || position >= last) {
+        this.bound.delete(position);
+        this.slotsById.delete(slot.diagId);
+        slot.diagId = null;
+        slot.hidden = true;
+        this.free.push(slot);
+      }
+    }
+    for (let position = first; position < last; position++) {
+      if (!this.bound.has(position)) {
+        const slot = this.free.pop() || this.createSlot();
+        this.bindSlot(slot, position);
+        this.bound.set(position, slot);
+      }
+    }
+
+    // Measure every bound entry: explanations and width changes move heights
+    let shift = 0;
+    let changed = false;
+    for (const [position, slot] of this.bound) {
+      const delta = this.heights.set(position, slot.offsetHeight + GAP);
+      if (delta === 0) continue;
+      changed = true;
+      if (position < anchor) shift += delta;
+    }
+    for (const [position, slot] of this.bound) {
+      slot.style.top = `${this.heights.offsetOf(position)}px`;
+    }
+    this.content.style.height = `${this.heights.total}px`;
+
+    // Keep the entry at the top of the viewport in place
+    if (shift !== 0) this.scroller.scrollTop += shift;
+    // Measured heights may bring other entries into view
+    if (changed) this.scheduleRender();
+  }
+
+  /**
+   * Re-render an entry if it is on screen, e.g. after its explanation
+   * arrived
+   * @param {string} id - Diagnostic id
+   * @returns {boolean} Whether the entry was on screen
+   */
+  refresh(id) {
+    const slot = this.slotsById.get(id);
+    if (!slot) return false;
+    this.bindSlot(slot, slot.position);
+    this.scheduleRender();
+    return true;
+  }
+
+  /**
+   * @returns {HTMLElement} Empty slot appended to the content
+   * @private
+   */
+  createSlot() {
+    const slot = document.createElement('div');
+    slot.className = 'diagnostic-slot';
+    slot.diagId = null;
+    slot.position = -1;
+    this.content.appendChild(slot);
+    return slot;
+  }
+
+  /**
+   * Show the entry at a list position in a slot; only this entry is
+   * built as an object
+   * @param {HTMLElement} slot - Pooled slot
+   * @param {number} position - Index into the rows
+   * @private
+   */
+  bindSlot(slot, position) {
+    const diag = this.store.get(this.rows[position]);
+    slot.diagId = diag.id;
+    slot.position = position;
+    this.slotsById.set(diag.id, slot);
+    slot.innerHTML = this.renderItem(diag);
+    slot.hidden = false;
+  }
+}
+
+module.exports = { DiagnosticListView };
@@ -3,15 +3,39 @@
  * Manages parsing, display, filtering, and Monaco editor integration
  */
 
+const { renderMarkdown } = require('../utils/markdownRenderer');
+const log = require('../utils/logger').getLogger('diagnostics');
+const { perfMonitor } = require('../utils/perfMonitor');
+const { taskScheduler } = require('../utils/taskScheduler');
+const { SarifMerger, isSarifLog } = require('../../shared/sarifMerger');
+const { DiagnosticStore, fileMatcher } = require('../utils/diagnosticStore');
+const { streamReport } = require('../utils/reportExport');
+const { DiagnosticListView } = require('./DiagnosticListView');
+const { splitIdentifiers } = require('../../shared/identifiers');
+
+/** Monaco decorations built per scheduler step */
+const DECORATION_CHUNK_SIZE = 500;
+
+/** Diagnostics sent with a chat question at most */
+const CHAT_DIAGNOSTICS_LIMIT = 50;
+
 class DiagnosticsManager {
   constructor(monacoEditorManager) {
     this.monacoEditorManager = monacoEditorManager;
-    this.currentDiagnostics = null;
+    this.store = null; // DiagnosticStore of the current results
+    this.visibleRows = null; // Filtered and sorted row indices, cached
+    this.listView = null; // DiagnosticListView over the visible rows
     this.currentMetadata = null;
     this.currentFunctions = null;
+    this.currentRules = {}; // rule id -> metadata, from SARIF
     this.decorations = []; // Store Monaco decorations
     this.hoverProviderDisposable = null;
     this.currentSeverityFilter = 'ALL'; // ALL, ERROR, WARNING, INFO
+    this.currentSortOrder = 'report'; // report, severity, location, rule
+    this.explanations = new Map(); // diagnostic id -> { text } or { error }
+    this.explainJob = null; // { id, total, completed } while "Explain all" runs
+    this.assistantConfigProvider = null; // set by UIController, returns the assistant config
+    this.activeFileProvider = null; // set by UIController, returns the active tab's file path
     
     this.severityColors = {
       'ERROR': '#ff6b6b',
@@ -21,39 +45,62 @@ class DiagnosticsManager {
   }
 
   /**
-   * Parse CTrace JSON output and store data
+   * Parse CTrace JSON output and store data. SARIF output (--sarif-format)
+   * is converted to the same shape.
    * @param {string} output - JSON output from CTrace
    * @returns {boolean} Success status
    */
   parseOutput(output) {
     // Check if output is empty or whitespace only
     if (!output || output.trim() === '') {
-      console.warn('CTrace output is empty');
+      log.warn('CTrace output is empty');
       this.clear();
       return false;
     }
     
     try {
-      const data = JSON.parse(output);
-      
-      this.currentMetadata = data.meta || null;
-      this.currentFunctions = data.functions || [];
-      this.currentDiagnostics = data.diagnostics || [];
-      
-      console.log('Parsed CTrace output:', {
-        meta: this.currentMetadata,
-        functionsCount: this.currentFunctions.length,
-        diagnosticsCount: this.currentDiagnostics.length
-      });
-      
+      let data = JSON.parse(output);
+      if (isSarifLog(data)) {
+        const merger = new SarifMerger();
+        merger.addDocument(data);
+        data = merger.finish();
+      }
+      this.loadResults(data);
       return true;
     } catch (error) {
-      console.error('Failed to parse CTrace JSON output:', error);
+      log.error('Failed to parse CTrace JSON output', error);
       this.clear();
       return false;
     }
   }
 
+  /**
+   * Store parsed results: ctrace output or merged SARIF logs
+   * @param {Object} data - { meta, functions, diagnostics, rules }
+   * @param {DiagnosticStore} [store] - Diagnostics received earlier in batches;
+   *   data.diagnostics is appended to it
+   */
+  loadResults(data, store = null) {
+    this.currentMetadata = data.meta || null;
+    this.currentFunctions = data.functions || [];
+    // The parsed objects become garbage once copied into columns
+    if (store) {
+      for (const diag of data.diagnostics || []) store.add(diag);
+      this.store = store;
+    } else {
+      this.store = DiagnosticStore.from(data.diagnostics || []);
+    }
+    this.visibleRows = null;
+    this.currentRules = data.rules || {};
+    this.explanations.clear();
+
+    log.info('Parsed CTrace output', {
+      meta: this.currentMetadata,
+      functionsCount: this.currentFunctions.length,
+      diagnosticsCount: this.store.length
+    });
+  }
+
   /**
    * Group diagnostics by Rule ID and then by Function
    * @param {Array} diagnostics - Array of diagnostics
@@ -157,11 +204,12 @@ class DiagnosticsManager {
   }
 
   /**
-   * Render diagnostics list with filtering
+   * Render the diagnostics toolbar and an empty list; the list view fills
+   * in the entries on screen
    * @returns {string} HTML string for diagnostics
    */
   renderDiagnostics() {
-    if (!this.currentDiagnostics || this.currentDiagnostics.length === 0) {
+    if (!this.store || this.store.length === 0) {
       return `
         <div class="diagnostics-container">
           <div class="diagnostics-toolbar">
@@ -178,18 +226,13 @@ class DiagnosticsManager {
       `;
     }
     
-    const filteredDiagnostics = this.filterDiagnostics(this.currentDiagnostics);
+    const rows = this.getVisibleRows();
     
     // Generate summary text
-    const severityCounts = {};
-    filteredDiagnostics.forEach(diag => {
-      severityCounts[diag.severity] = (severityCounts[diag.severity] || 0) + 1;
-    });
-    
-    const groupedDiagnostics = this.groupDiagnostics(filteredDiagnostics);
-    const ruleCount = Object.keys(groupedDiagnostics).length;
+    const severityCounts = this.store.countBySeverity(rows);
+    const ruleCount = this.store.countRules(rows);
     
-    let summaryText = `${filteredDiagnostics.length} total`;
+    let summaryText = `${rows.length} total`;
     if (severityCounts.ERROR) summaryText = `${severityCounts.ERROR} Error${severityCounts.ERROR > 1 ? 's' : ''}`;
     else if (severityCounts.WARNING) summaryText = `${severityCounts.WARNING} Warning${severityCounts.WARNING > 1 ? 's' : ''}`;
     else if (severityCounts.INFO) summaryText = `${severityCounts.INFO} Info`;
@@ -198,38 +241,6 @@ class DiagnosticsManager {
       summaryText += ` (${ruleCount} Rule${ruleCount > 1 ? 's' : ''})`;
     }
     
-    // Generate flat list HTML
-    const diagnosticsHtml = filteredDiagnostics.map(diag => {
-      const severityColor = this.severityColors[diag.severity] || '#7d8590';
-      const icon = this.getSeverityIcon(diag.severity);
-      const parsed = this.parseMessage(diag.details.message);
-      
-      return `
-        <div class="diagnostic-item" data-diag-id="${this.escapeHtml(diag.id)}" onclick="window.diagnosticsManager.jumpToDiagnostic('${this.escapeHtml(diag.id)}')">
-          <div class="diagnostic-item-header">
-            <div class="diagnostic-severity-icon" style="background: ${severityColor};">
-              ${icon}
-            </div>
-            <div class="diagnostic-item-info">
-              <div class="diagnostic-title">
-                <span class="diagnostic-rule">${this.escapeHtml(diag.ruleId)}</span>
-                <span class="diagnostic-separator">•</span>
-                <span class="diagnostic-function">${this.escapeHtml(diag.location.function)}</span>
-              </div>
-              <div class="diagnostic-location">
-                📍 Line ${diag.location.startLine}${diag.location.startColumn ? ':' + diag.location.startColumn : ''}
-              </div>
-            </div>
-          </div>
-          <div class="diagnostic-item-details">
-            ${parsed.variable ? `<div class="detail-row"><span class="detail-label">Variable:</span> <code>${this.escapeHtml(parsed.variable)}</code></div>` : ''}
-            ${parsed.escapesVia ? `<div class="detail-row"><span class="detail-label">Escapes via:</span> <code>${this.escapeHtml(parsed.escapesVia)}</code></div>` : ''}
-            ${parsed.details ? `<div class="detail-row detail-note">${this.escapeHtml(parsed.details)}</div>` : ''}
-          </div>
-        </div>
-      `;
-    }).join('');
-    
     return `
       <div class="diagnostics-container">
         <div class="diagnostics-toolbar">
@@ -237,11 +248,51 @@ class DiagnosticsManager {
             <span class="count-icon">🔍</span>
             <span class="count-text">${summaryText}</span>
           </div>
-          ${this.renderFilterDropdown()}
+          <div class="diagnostics-toolbar-actions">
+            ${this.renderExplainButton()}
+            ${this.renderSortDropdown()}
+            ${this.renderFilterDropdown()}
+          </div>
+        </div>
+        <div class="diagnostics-flat-list"></div>
+      </div>
+    `;
+  }
+
+  /**
+   * Render one entry of the diagnostics list
+   * @param {Object} diag - Diagnostic
+   * @returns {string} HTML string
+   */
+  renderDiagnosticItem(diag) {
+    const severityColor = this.severityColors[diag.severity] || '#7d8590';
+    const icon = this.getSeverityIcon(diag.severity);
+    const parsed = this.parseMessage(diag.details.message);
+    const rule = this.currentRules[diag.ruleId];
+    
+    return `
+      <div class="diagnostic-item" data-diag-id="${this.escapeHtml(diag.id)}" onclick="window.diagnosticsManager.jumpToDiagnostic('${this.escapeHtml(diag.id)}')">
+        <div class="diagnostic-item-header">
+          <div class="diagnostic-severity-icon" style="background: ${severityColor};">
+            ${icon}
+          </div>
+          <div class="diagnostic-item-info">
+            <div class="diagnostic-title">
+              <span class="diagnostic-rule" title="${this.escapeHtml(rule ? rule.shortDescription || rule.name : '')}">${this.escapeHtml(diag.ruleId)}</span>
+              <span class="diagnostic-separator">•</span>
+              <span class="diagnostic-function">${this.escapeHtml(diag.location.function)}</span>
+            </div>
+            <div class="diagnostic-location">
+              📍 ${diag.location.file ? this.escapeHtml(this.getFileName(diag.location.file)) + ' ' : ''}Line ${diag.location.startLine}${diag.location.startColumn ? ':' + diag.location.startColumn : ''}
+            </div>
+          </div>
         </div>
-        <div class="diagnostics-flat-list">
-          ${diagnosticsHtml}
+        <div class="diagnostic-item-details">
+          ${parsed.variable ? `<div class="detail-row"><span class="detail-label">Variable:</span> <code>${this.escapeHtml(parsed.variable)}</code></div>` : ''}
+          ${parsed.escapesVia ? `<div class="detail-row"><span class="detail-label">Escapes via:</span> <code>${this.escapeHtml(parsed.escapesVia)}</code></div>` : ''}
+          ${parsed.details ? `<div class="detail-row detail-note">${this.escapeHtml(parsed.details)}</div>` : ''}
         </div>
+        ${this.renderExplanation(diag.id)}
       </div>
     `;
   }
@@ -264,15 +315,188 @@ class DiagnosticsManager {
   }
 
   /**
-   * Filter diagnostics by current severity filter
-   * @param {Array} diagnostics - Diagnostics array
-   * @returns {Array} Filtered diagnostics
+   * Render sort order dropdown
+   * @returns {string} HTML for sort dropdown
+   */
+  renderSortDropdown() {
+    const option = (value, label) => `<option value="${value}" ${this.currentSortOrder === value ? 'selected' : ''}>${label}</option>`;
+    return `
+      <div class="severity-filter">
+        <select id="sort-order-select" title="Sort order" onchange="window.diagnosticsManager.changeSortOrder(this.value)">
+          ${option('report', '↕ Report order')}
+          ${option('severity', '↕ Severity')}
+          ${option('location', '↕ Location')}
+          ${option('rule', '↕ Rule')}
+        </select>
+      </div>
+    `;
+  }
+
+  /**
+   * Render the "Explain all" button, which shows progress while a job runs
+   * @returns {string} HTML for the button
+   */
+  renderExplainButton() {
+    const label = this.explainJob
+      ? `⏹ Stop (${this.explainJob.completed}/${this.explainJob.total})`
+      : '✨ Explain all';
+    return `<button id="explain-all-btn" class="explain-all-btn" title="Ask the assistant to explain every listed diagnostic" onclick="window.diagnosticsManager.toggleExplainAll()">${label}</button>`;
+  }
+
+  /**
+   * Render the assistant explanation attached to a diagnostic
+   * @param {string} diagId - Diagnostic ID
+   * @returns {string} HTML string (empty when there is none)
+   */
+  renderExplanation(diagId) {
+    const explanation = this.explanations.get(diagId);
+    if (!explanation) return '';
+    if (explanation.error) {
+      return `<div class="diagnostic-explanation diagnostic-explanation-error">${this.escapeHtml(explanation.error)}</div>`;
+    }
+    return `<div class="diagnostic-explanation">${renderMarkdown(explanation.text)}</div>`;
+  }
+
+  /**
+   * Start "Explain all", or stop the running job
+   */
+  toggleExplainAll() {
+    if (this.explainJob) {
+      window.ipcRenderer.invoke('assistant-explain-cancel', { jobId: this.explainJob.id });
+      return;
+    }
+    this.explainAll();
+  }
+
+  /**
+   * Explain every listed diagnostic that has no explanation yet. Diagnostics
+   * are grouped by rule and function and sent in batches from the main
+   * process; explanations are attached as each batch completes.
+   * @returns {Promise<Object|null>} Job summary, or null when nothing ran
+   */
+  async explainAll() {
+    const cfg = this.assistantConfigProvider ? this.assistantConfigProvider() : null;
+    if (!cfg || cfg.provider === 'none' || cfg.skipped) {
+      log.warn('Explain all: assistant not configured');
+      return null;
+    }
+
+    if (!this.store) return null;
+    const pendingRows = Array.from(this.getVisibleRows())
+      .filter(row => !(this.explanations.get(this.store.ids[row]) || {}).text);
+    if (pendingRows.length === 0) return null;
+    const pending = this.store.getAll(pendingRows);
+
+    const jobId = `explain-${Date.now()}`;
+    this.explainJob = { id: jobId, total: pending.length, completed: 0 };
+    this.updateExplainButton();
+
+    const onProgress = (event, data) => {
+      if (data.jobId === jobId) this.handleExplainProgress(data);
+    };
+    window.ipcRenderer.on('assistant-explain-progress', onProgress);
+
+    try {
+      const result = await window.ipcRenderer.invoke('assistant-explain-diagnostics', {
+        provider: cfg.provider,
+        config: cfg,
+        groups: this.groupDiagnostics(pending),
+        jobId
+      });
+      if (!result.success) {
+        log.error('Explain all failed', result.error);
+      }
+      return result;
+    } finally {
+      window.ipcRenderer.removeListener('assistant-explain-progress', onProgress);
+      this.explainJob = null;
+      this.updateExplainButton();
+    }
+  }
+
+  /**
+   * Attach explanations from a completed batch without re-rendering the list
+   * @param {Object} data - { results: [{ id, explanation } | { id, error }], completed, total }
+   */
+  handleExplainProgress(data) {
+    if (this.explainJob) {
+      this.explainJob.completed = data.completed;
+      this.updateExplainButton();
+    }
+
+    for (const result of data.results) {
+      this.explanations.set(result.id, result.error ? { error: result.error } : { text: result.explanation });
+      // Only entries on screen exist; the rest pick it up when scrolled to
+      if (this.listView) this.listView.refresh(result.id);
+    }
+  }
+
+  /**
+   * Refresh the "Explain all" button label
    */
-  filterDiagnostics(diagnostics) {
-    if (this.currentSeverityFilter === 'ALL') {
-      return diagnostics;
+  updateExplainButton() {
+    const button = document.getElementById('explain-all-btn');
+    if (button) button.outerHTML = this.renderExplainButton();
+  }
+
+  /**
+   * Rows passing the severity filter, in the current sort order
+   * @returns {Uint32Array} Row indices into the store
+   */
+  getVisibleRows() {
+    if (!this.store) return new Uint32Array(0);
+    if (!this.visibleRows) {
+      this.visibleRows = this.store.sort(this.store.select(this.currentSeverityFilter), this.currentSortOrder);
     }
-    return diagnostics.filter(diag => diag.severity === this.currentSeverityFilter);
+    return this.visibleRows;
+  }
+
+  /**
+   * The diagnostics a chat question is about: those whose function, rule
+   * or message shares an identifier with it. Matching runs once per
+   * distinct string on the store columns; only the picked rows become
+   * objects, so the assistant never receives the whole result set.
+   * @param {string} query - User question
+   * @param {number} [limit] - Diagnostics returned at most
+   * @returns {Array<Object>} Function matches first, then the rest, each in report order
+   */
+  getRelevantDiagnostics(query, limit = CHAT_DIAGNOSTICS_LIMIT) {
+    if (!this.store) return [];
+    const terms = new Set(splitIdentifiers(query));
+    if (terms.size === 0) return [];
+    const matches = value => splitIdentifiers(value).some(token => terms.has(token));
+
+    const store = this.store;
+    const functions = store.mask('func', matches);
+    const rules = store.mask('rule', matches);
+    const messages = store.mask('message', matches);
+    // A matching function ranks highest, as in the main process
+    const byFunction = [];
+    const byText = [];
+    for (let row = 0; row < store.length && byFunction.length < limit; row++) {
+      if (functions[store.func[row]]) {
+        byFunction.push(row);
+      } else if (byText.length < limit && (rules[store.rule[row]] || messages[store.message[row]])) {
+        byText.push(row);
+      }
+    }
+    return store.getAll(byFunction.concat(byText).slice(0, limit));
+  }
+
+  /**
+   * Write the current view (severity filter and sort order) as a report
+   * @param {string} format - 'html', 'csv', 'junit' or 'sarif'
+   * @param {Function} write - async (chunk) => void, awaited before the next chunk is built
+   * @param {Function} [onProgress] - (rowsWritten, totalRows) => void
+   * @returns {Promise<Object>} { rows, chars }
+   */
+  exportReport(format, write, onProgress) {
+    return streamReport(format, {
+      store: this.store,
+      rows: this.getVisibleRows(),
+      meta: this.currentMetadata,
+      rules: this.currentRules
+    }, write, { onProgress });
   }
 
   /**
@@ -281,33 +505,60 @@ class DiagnosticsManager {
    */
   changeSeverityFilter(severity) {
     this.currentSeverityFilter = severity;
+    this.visibleRows = null;
     this.render();
     this.applyMonacoDecorations(); // Re-apply decorations with new filter
   }
 
+  /**
+   * Change sort order and re-render the list
+   * @param {string} order - 'report', 'severity', 'location' or 'rule'
+   */
+  changeSortOrder(order) {
+    this.currentSortOrder = order;
+    this.visibleRows = null;
+    this.render();
+  }
+
   /**
    * Jump to diagnostic location in editor
    * @param {string} diagId - Diagnostic ID
    */
   jumpToDiagnostic(diagId) {
-    const diag = this.currentDiagnostics.find(d => d.id === diagId);
-    if (!diag || !diag.location || !diag.location.startLine) {
-      console.warn('Cannot jump to diagnostic - no location info:', diagId);
+    const row = this.store ? this.store.indexOf(diagId) : -1;
+    const line = row === -1 ? 0 : this.store.startLine[row];
+    if (!line) {
+      log.warn('Cannot jump to diagnostic - no location info', diagId);
       return;
     }
     
     if (this.monacoEditorManager && this.monacoEditorManager.editor) {
-      this.monacoEditorManager.jumpToLine(diag.location.startLine);
-      console.log(`Jumped to diagnostic ${diagId} at line ${diag.location.startLine}`);
+      this.monacoEditorManager.jumpToLine(line);
+      log.debug(() => `Jumped to diagnostic ${diagId} at line ${line}`);
     }
   }
 
+  /**
+   * Which file ids of the store belong to the file open in the editor.
+   * Rows without a file belong to meta.inputFile, or to any file when the
+   * output does not name one (a single-file ctrace run).
+   * @returns {Uint8Array} Mask over the store's file table
+   */
+  activeFileMask() {
+    const filePath = this.activeFileProvider ? this.activeFileProvider() : null;
+    const matches = filePath ? fileMatcher(filePath) : () => false;
+    const mask = this.store.fileMask(matches);
+    const inputFile = this.currentMetadata && this.currentMetadata.inputFile;
+    mask[0] = !inputFile || matches(inputFile) ? 1 : 0;
+    return mask;
+  }
+
   /**
    * Apply Monaco editor decorations for diagnostics
    */
   async applyMonacoDecorations() {
     if (!this.monacoEditorManager || !this.monacoEditorManager.editor) {
-      console.warn('Monaco editor not available for decorations');
+      log.warn('Monaco editor not available for decorations');
       return;
     }
 
@@ -316,64 +567,85 @@ class DiagnosticsManager {
     const model = editor.getModel();
     
     if (!model) {
-      console.warn('Monaco model not available');
+      log.warn('Monaco model not available');
       return;
     }
 
-    // Clear previous decorations
-    this.decorations = editor.deltaDecorations(this.decorations, []);
-
-    // Get filtered diagnostics
-    const filteredDiagnostics = this.filterDiagnostics(this.currentDiagnostics || []);
+    // Filtered rows of this file that have a line
+    const store = this.store;
+    const files = store ? this.activeFileMask() : null;
+    const rows = store ? this.getVisibleRows().filter(row => store.startLine[row] > 0 && files[store.file[row]]) : [];
     
-    if (filteredDiagnostics.length === 0) {
+    if (rows.length === 0) {
+      taskScheduler.cancel('diagnostics.decorations');
+      this.decorations = editor.deltaDecorations(this.decorations, []);
       return;
     }
 
-    // Create new decorations
-    const newDecorations = filteredDiagnostics
-      .filter(diag => diag.location && diag.location.startLine > 0)
-      .map(diag => {
-        const line = diag.location.startLine;
-        const startCol = diag.location.startColumn || 1;
-        const endCol = diag.location.endColumn || model.getLineMaxColumn(line);
-        const severity = diag.severity;
-        const color = this.severityColors[severity] || '#7d8590';
-        
-        // Choose decoration class based on severity
-        let inlineClassName = 'diagnostic-decoration-warning';
-        let glyphMarginClassName = 'diagnostic-glyph-warning';
-        
-        if (severity === 'ERROR') {
-          inlineClassName = 'diagnostic-decoration-error';
-          glyphMarginClassName = 'diagnostic-glyph-error';
-        } else if (severity === 'INFO') {
-          inlineClassName = 'diagnostic-decoration-info';
-          glyphMarginClassName = 'diagnostic-glyph-info';
+    // Build decorations in slices; a newer call (filter change) supersedes this one
+    const job = taskScheduler.schedule('diagnostics.decorations', function* () {
+      const newDecorations = [];
+      const lineCount = model.getLineCount();
+      for (let i = 0; i < rows.length; i += DECORATION_CHUNK_SIZE) {
+        const end = Math.min(rows.length, i + DECORATION_CHUNK_SIZE);
+        for (let k = i; k < end; k++) {
+          // Results of an older version of the file can point past its end
+          if (store.startLine[rows[k]] <= lineCount) newDecorations.push(this.createDecoration(store, rows[k], model));
         }
+        yield;
+      }
+      // The user may have switched files meanwhile
+      if (editor.getModel() !== model) return;
+      // Swap old for new in one call so the editor never shows none
+      this.decorations = editor.deltaDecorations(this.decorations, newDecorations);
+      log.debug(() => `Applied ${newDecorations.length} Monaco decorations`);
+    }.bind(this));
+    await job.promise;
+  }
 
-        return {
-          range: new window.monaco.Range(line, startCol, line, endCol),
-          options: {
-            isWholeLine: false,
-            className: inlineClassName,
-            glyphMarginClassName: glyphMarginClassName,
-            minimap: {
-              color: color,
-              position: window.monaco.editor.MinimapPosition.Inline
-            },
-            overviewRuler: {
-              color: color,
-              position: window.monaco.editor.OverviewRulerLane.Full
-            }
-          }
-        };
-      });
+  /**
+   * Monaco decoration for a diagnostic, read straight from the columns
+   * @param {DiagnosticStore} store - Diagnostics
+   * @param {number} row - Row with a line within the model
+   * @param {Object} model - Editor model
+   * @returns {Object} Decoration
+   */
+  createDecoration(store, row, model) {
+    const line = store.startLine[row];
+    const maxCol = model.getLineMaxColumn(line);
+    const startCol = Math.min(store.startColumn[row] || 1, maxCol);
+    const endCol = Math.min(store.endColumn[row] || maxCol, maxCol);
+    const severity = store.severityAt(row);
+    const color = this.severityColors[severity] || '#7d8590';
+    
+    // Choose decoration class based on severity
+    let inlineClassName = 'diagnostic-decoration-warning';
+    let glyphMarginClassName = 'diagnostic-glyph-warning';
+    
+    if (severity === 'ERROR') {
+      inlineClassName = 'diagnostic-decoration-error';
+      glyphMarginClassName = 'diagnostic-glyph-error';
+    } else if (severity === 'INFO') {
+      inlineClassName = 'diagnostic-decoration-info';
+      glyphMarginClassName = 'diagnostic-glyph-info';
+    }
 
-    // Apply decorations
-    this.decorations = editor.deltaDecorations([], newDecorations);
-    
-    console.log(`Applied ${newDecorations.length} Monaco decorations`);
+    return {
+      range: new window.monaco.Range(line, startCol, line, endCol),
+      options: {
+        isWholeLine: false,
+        className: inlineClassName,
+        glyphMarginClassName: glyphMarginClassName,
+        minimap: {
+          color: color,
+          position: window.monaco.editor.MinimapPosition.Inline
+        },
+        overviewRuler: {
+          color: color,
+          position: window.monaco.editor.OverviewRulerLane.Full
+        }
+      }
+    };
   }
 
   /**
@@ -386,13 +658,10 @@ class DiagnosticsManager {
 
     this.hoverProviderDisposable = window.monaco.languages.registerHoverProvider(['c', 'cpp'], {
       provideHover: (model, position) => {
-        if (!this.currentDiagnostics) return null;
+        if (!this.store) return null;
 
         const line = position.lineNumber;
-        const filteredDiagnostics = this.filterDiagnostics(this.currentDiagnostics);
-        const diagnosticsAtLine = filteredDiagnostics.filter(
-          diag => diag.location && diag.location.startLine === line
-        );
+        const diagnosticsAtLine = this.store.getAll(this.store.select(this.currentSeverityFilter, line, this.activeFileMask()));
 
         if (diagnosticsAtLine.length === 0) return null;
 
@@ -406,7 +675,7 @@ class DiagnosticsManager {
       }
     });
 
-    console.log('Registered Monaco hover provider for diagnostics');
+    log.debug('Registered Monaco hover provider for diagnostics');
   }
 
   /**
@@ -418,6 +687,11 @@ class DiagnosticsManager {
     const parsed = this.parseMessage(diag.details.message);
     
     let message = `**[${diag.severity}] ${diag.ruleId}**\n\n`;
+    const rule = this.currentRules[diag.ruleId];
+    if (rule) {
+      const ruleText = [rule.shortDescription, rule.helpUri && `([help](${rule.helpUri}))`].filter(Boolean).join(' ');
+      if (ruleText) message += `${ruleText}\n\n`;
+    }
     message += `**Function:** ${diag.location.function}\n\n`;
     message += `**Location:** Line ${diag.location.startLine}`;
     
@@ -466,7 +740,8 @@ class DiagnosticsManager {
   }
 
   /**
-   * Render all diagnostic content to output panel
+   * Render all diagnostic content to output panel. The list is
+   * virtualized, so a large result set costs the same as a small one.
    */
   render() {
     const resultsArea = document.getElementById('ctrace-results-area');
@@ -476,6 +751,26 @@ class DiagnosticsManager {
     const diagnosticsHtml = this.renderDiagnostics();
     
     resultsArea.innerHTML = metadataHtml + diagnosticsHtml;
+
+    this.disposeListView();
+    const list = resultsArea.querySelector('.diagnostics-flat-list');
+    if (!list) return;
+    this.listView = new DiagnosticListView(list, {
+      store: this.store,
+      rows: this.getVisibleRows(),
+      renderItem: diag => this.renderDiagnosticItem(diag)
+    });
+  }
+
+  /**
+   * Drop the list view of the previous render
+   * @private
+   */
+  disposeListView() {
+    if (this.listView) {
+      this.listView.dispose();
+      this.listView = null;
+    }
   }
 
   /**
@@ -493,8 +788,16 @@ class DiagnosticsManager {
   clear() {
     this.currentMetadata = null;
     this.currentFunctions = null;
-    this.currentDiagnostics = null;
+    this.store = null;
+    this.visibleRows = null;
+    this.currentRules = {};
     this.currentSeverityFilter = 'ALL';
+    this.explanations.clear();
+    if (this.explainJob) {
+      window.ipcRenderer.invoke('assistant-explain-cancel', { jobId: this.explainJob.id });
+    }
+    this.disposeListView();
+    taskScheduler.cancel('diagnostics.decorations');
     
     // Clear Monaco decorations
     if (this.monacoEditorManager && this.monacoEditorManager.editor) {
@@ -520,6 +823,17 @@ class DiagnosticsManager {
     }
   }
 
+  /**
+   * Approximate memory held by the current diagnostics
+   * @returns {Object} { count, bytes }
+   */
+  getMemoryEstimate() {
+    return {
+      count: this.store ? this.store.length : 0,
+      bytes: this.store ? this.store.estimateBytes() : 0
+    };
+  }
+
   /**
    * Utility: Escape HTML
    * @param {string} text - Text to escape
@@ -567,4 +881,7 @@ class DiagnosticsManager {
   }
 }
 
+// Attribute long tasks to these operations
+perfMonitor.instrument(DiagnosticsManager.prototype, ['parseOutput', 'getVisibleRows', 'renderDiagnostics', 'render', 'applyMonacoDecorations'], 'diagnostics');
+
 module.exports = DiagnosticsManager;
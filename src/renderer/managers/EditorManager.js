@@ -3,8 +3,14 @@
  */
 
 // Import syntax highlighter
-const { highlightCppSyntax, applySyntaxHighlight, shouldHighlight } = require('../utils/syntaxHighlighter');
+const { shouldHighlight, IncrementalHighlighter } = require('../utils/syntaxHighlighter');
 const { detectFileType } = require('../utils/fileTypeUtils');
+const log = require('../utils/logger').getLogger('editor');
+const { perfMonitor } = require('../utils/perfMonitor');
+
+// Word wrap breaks the fixed line height the window math relies on, so only
+// documents this small, rendered whole, are wrapped
+const WRAP_MAX_LINES = 2000;
 
 class EditorManager {
   constructor() {
@@ -13,6 +19,15 @@ class EditorManager {
     this.lineCounter = document.getElementById('lineCounter');
     this.currentFileType = 'Plain Text';
     this.highlightEnabled = false;
+    // The highlighter doubles as the line model; only the viewport window lives in the DOM
+    this.highlighter = new IncrementalHighlighter(this.currentFileType);
+    this.lineHeight = 20;
+    this.overscan = 30;
+    this.viewStart = 0;
+    this.viewEnd = 0;
+    this.contentCache = null;
+    this.wordWrap = false;
+    this.scrollFrame = null;
     this.updateTimer = null;
     this.isUpdating = false;
     this.init();
@@ -21,11 +36,14 @@ class EditorManager {
   init() {
     if (!this.editor || !this.gutter || !this.lineCounter) return;
 
+    this.setupViewport();
+    this.highlighter.update('');
+
     // Maintain visual selection when editor loses focus
     this.setupPersistentSelection();
 
     // Make TAB key insert tab character in editor
-    this.editor.addEventListener('keydown', (e) => {
+    this.viewportEl.addEventListener('keydown', (e) => {
       if (e.key === 'Tab') {
         e.preventDefault();
         document.execCommand('insertText', false, '\t');
@@ -36,8 +54,9 @@ class EditorManager {
     });
 
     // Enhanced input handler with debounced syntax highlighting
-    this.editor.addEventListener('input', (e) => {
+    this.viewportEl.addEventListener('input', (e) => {
       if (!this.isUpdating) {
+        this.syncViewportEdit();
         this.updateGutter();
         this.updateStatusBar();
         this.debouncedHighlightUpdate();
@@ -47,47 +66,183 @@ class EditorManager {
     this.editor.addEventListener('scroll', () => {
       this.syncScroll();
     });
-    this.editor.addEventListener('click', () => {
+    this.viewportEl.addEventListener('click', () => {
       this.updateStatusBar();
       this.updateGutter();
     });
-    this.editor.addEventListener('keyup', () => {
+    this.viewportEl.addEventListener('keyup', () => {
       this.updateStatusBar();
       this.updateGutter();
     });
     
     // Initialize
-    this.updateGutter();
+    this.renderViewport(true);
     this.updateStatusBar();
   }
 
+  /**
+   * Build the spacer / window structure used for viewport-only rendering.
+   * The editor element scrolls; spacers stand in for the lines outside the window.
+   */
+  setupViewport() {
+    this.editor.innerHTML = '';
+    this.editor.style.overflow = 'auto';
+    this.topSpacer = document.createElement('div');
+    this.topSpacer.className = 'editor-spacer';
+    this.viewportEl = document.createElement('div');
+    this.viewportEl.className = 'editor-viewport';
+    this.viewportEl.contentEditable = 'true';
+    this.viewportEl.spellcheck = false;
+    this.bottomSpacer = document.createElement('div');
+    this.bottomSpacer.className = 'editor-spacer';
+    this.editor.append(this.topSpacer, this.viewportEl, this.bottomSpacer);
+
+    this.gutter.innerHTML = '';
+    this.gutterTopSpacer = document.createElement('div');
+    this.gutterTopSpacer.className = 'gutter-spacer';
+    this.gutterRows = document.createElement('div');
+    this.gutterBottomSpacer = document.createElement('div');
+    this.gutterBottomSpacer.className = 'gutter-spacer';
+    this.gutter.append(this.gutterTopSpacer, this.gutterRows, this.gutterBottomSpacer);
+  }
+
+  /**
+   * Compute the visible line range and the rendered window around it
+   * @param {number} scrollTop - Scroll offset in pixels
+   * @param {number} viewportHeight - Visible height in pixels
+   * @param {number} lineHeight - Height of one line in pixels
+   * @param {number} lineCount - Total number of lines
+   * @param {number} overscan - Extra lines rendered above and below
+   * @returns {Object} { first, last, start, end } - visible [first, last) and window [start, end)
+   */
+  static computeVisibleRange(scrollTop, viewportHeight, lineHeight, lineCount, overscan) {
+    const first = Math.min(lineCount, Math.max(0, Math.floor(scrollTop / lineHeight)));
+    const last = Math.min(lineCount, Math.max(first + 1, Math.ceil((scrollTop + viewportHeight) / lineHeight)));
+    return {
+      first,
+      last,
+      start: Math.max(0, first - overscan),
+      end: Math.min(lineCount, last + overscan)
+    };
+  }
+
+  /**
+   * Render the current window of lines into the editor
+   * @param {boolean} force - Re-render even if the window did not move
+   */
+  renderViewport(force = false) {
+    if (!this.viewportEl) return;
+
+    const lineCount = Math.max(1, this.highlighter.getLineCount());
+    const wrap = this.wordWrap && lineCount <= WRAP_MAX_LINES;
+    const range = wrap ? { start: 0, end: lineCount } : EditorManager.computeVisibleRange(
+      this.editor.scrollTop, this.editor.clientHeight, this.lineHeight, lineCount, this.overscan
+    );
+    this.viewportEl.style.whiteSpace = wrap ? 'pre-wrap' : 'pre';
+    if (!force && range.start === this.viewStart && range.end === this.viewEnd) return;
+
+    this.isUpdating = true;
+    const savedCursor = this.saveCursorPosition();
+
+    this.viewStart = range.start;
+    this.viewEnd = range.end;
+    this.updateSpacers();
+    this.viewportEl.innerHTML = this.highlighter.getLinesHtml(this.viewStart, this.viewEnd).join('\n');
+
+    this.restoreCursorPosition(savedCursor);
+    this.isUpdating = false;
+    this.updateGutter();
+  }
+
+  /**
+   * Size the spacers so the scroll height matches the full document
+   */
+  updateSpacers() {
+    const lineCount = Math.max(1, this.highlighter.getLineCount());
+    const top = `${this.viewStart * this.lineHeight}px`;
+    const bottom = `${Math.max(0, lineCount - this.viewEnd) * this.lineHeight}px`;
+    this.topSpacer.style.height = top;
+    this.bottomSpacer.style.height = bottom;
+    this.gutterTopSpacer.style.height = top;
+    this.gutterBottomSpacer.style.height = bottom;
+  }
+
+  /**
+   * Fold the edited window text back into the line model.
+   * Only lines that differ from the model are handed to the highlighter.
+   */
+  syncViewportEdit() {
+    const windowLines = this.viewportEl.textContent.split('\n');
+    const modelLines = this.highlighter.lines;
+
+    let prefix = 0;
+    const oldCount = this.viewEnd - this.viewStart;
+    const maxPrefix = Math.min(oldCount, windowLines.length);
+    while (prefix < maxPrefix && windowLines[prefix] === modelLines[this.viewStart + prefix]) prefix++;
+
+    let suffix = 0;
+    while (suffix < oldCount - prefix && suffix < windowLines.length - prefix &&
+      windowLines[windowLines.length - 1 - suffix] === modelLines[this.viewEnd - 1 - suffix]) {
+      suffix++;
+    }
+
+    this.highlighter.applyLineEdit(
+      this.viewStart + prefix,
+      oldCount - prefix - suffix,
+      windowLines.slice(prefix, windowLines.length - suffix)
+    );
+    this.viewEnd = this.viewStart + windowLines.length;
+    this.contentCache = null;
+    this.updateSpacers();
+  }
+
   /**
    * Save current cursor position
+   * @returns {Object|null} { line, column } in document coordinates (0-based)
    */
   saveCursorPosition() {
     const selection = window.getSelection();
-    if (!selection.rangeCount) return null;
+    if (!this.viewportEl || !selection.rangeCount) return null;
     
     const range = selection.getRangeAt(0);
+    if (!this.viewportEl.contains(range.endContainer)) return null;
+
     const preCaretRange = range.cloneRange();
-    preCaretRange.selectNodeContents(this.editor);
+    preCaretRange.selectNodeContents(this.viewportEl);
     preCaretRange.setEnd(range.endContainer, range.endOffset);
-    
-    return preCaretRange.toString().length;
+    const textBeforeCursor = preCaretRange.toString();
+
+    let line = this.viewStart;
+    let lastBreak = -1;
+    let index = textBeforeCursor.indexOf('\n');
+    while (index !== -1) {
+      line++;
+      lastBreak = index;
+      index = textBeforeCursor.indexOf('\n', index + 1);
+    }
+    return { line, column: textBeforeCursor.length - lastBreak - 1 };
   }
 
   /**
-   * Restore cursor position
+   * Restore cursor position if it falls inside the rendered window
+   * @param {Object|null} position - { line, column } from saveCursorPosition
    */
-  restoreCursorPosition(offset) {
-    if (offset === null || offset === undefined) return;
+  restoreCursorPosition(position) {
+    if (!position || position.line < this.viewStart || position.line >= this.viewEnd) return;
     
+    const lines = this.highlighter.lines;
+    let offset = 0;
+    for (let i = this.viewStart; i < position.line; i++) {
+      offset += lines[i].length + 1;
+    }
+    offset += Math.min(position.column, lines[position.line].length);
+
     const selection = window.getSelection();
     const range = document.createRange();
     
     let currentOffset = 0;
     const walker = document.createTreeWalker(
-      this.editor,
+      this.viewportEl,
       NodeFilter.SHOW_TEXT,
       null,
       false
@@ -108,8 +263,8 @@ class EditorManager {
     }
     
     // If we didn't find the position, place cursor at end
-    if (this.editor.lastChild) {
-      range.selectNodeContents(this.editor);
+    if (this.viewportEl.lastChild) {
+      range.selectNodeContents(this.viewportEl);
       range.collapse(false);
       selection.removeAllRanges();
       selection.addRange(range);
@@ -134,76 +289,55 @@ class EditorManager {
   updateSyntaxHighlight() {
     if (!this.editor || this.isUpdating) return;
 
-    this.isUpdating = true;
-    const savedOffset = this.saveCursorPosition();
-    
-    // Get plain text content
-    const text = this.getContent();
-    
-    // Apply syntax highlighting if enabled
-    if (this.highlightEnabled && shouldHighlight(this.currentFileType)) {
-      const highlighted = applySyntaxHighlight(text, this.currentFileType);
-      this.editor.innerHTML = highlighted;
-    } else {
-      this.editor.textContent = text;
-    }
-    
-    // Restore cursor position
-    this.restoreCursorPosition(savedOffset);
-    this.isUpdating = false;
+    // The model is already tokenized on input; repaint just the visible window
+    this.renderViewport(true);
   }
 
   /**
-   * Sync gutter scroll with editor
+   * Sync gutter scroll with editor and move the window when the visible lines leave it
    */
   syncScroll() {
-    if (this.gutter && this.editor) {
-      this.gutter.scrollTop = this.editor.scrollTop;
-    }
+    if (!this.gutter || !this.editor) return;
+
+    this.gutter.scrollTop = this.editor.scrollTop;
+    if (this.scrollFrame) return;
+    this.scrollFrame = requestAnimationFrame(() => {
+      this.scrollFrame = null;
+      const lineCount = Math.max(1, this.highlighter.getLineCount());
+      const range = EditorManager.computeVisibleRange(
+        this.editor.scrollTop, this.editor.clientHeight, this.lineHeight, lineCount, this.overscan
+      );
+      if (range.first < this.viewStart || range.last > this.viewEnd) {
+        this.renderViewport();
+      }
+    });
   }
 
   /**
-   * Enhanced gutter line numbers with proper formatting (like VS Code)
+   * Gutter line numbers for the rendered window only (like VS Code)
    */
   updateGutter() {
-    if (!this.editor || !this.gutter) return;
+    if (!this.editor || !this.gutter || !this.gutterRows) return;
     
-    const text = this.getContent();
-    // Count lines properly - if text ends with newline, don't count it as extra line
-    let lines = 1;
-    if (text) {
-      const splitLines = text.split('\n');
-      lines = splitLines.length;
-      // If last element is empty string (trailing newline), don't count it
-      if (splitLines[splitLines.length - 1] === '') {
-        lines = Math.max(1, lines - 1);
-      }
-    }
-    
-    // Get current line number for highlighting
+    const lines = Math.max(1, this.highlighter.getLineCount());
     const currentLine = this.getCurrentLineNumber();
-    
     const maxDigits = Math.max(2, lines.toString().length);
+    const rowCount = this.viewEnd - this.viewStart;
     
-    // Clear gutter and rebuild with styled line numbers
-    this.gutter.innerHTML = '';
+    // Reuse row elements; the count only changes with the window size
+    while (this.gutterRows.childElementCount < rowCount) {
+      this.gutterRows.appendChild(document.createElement('div'));
+    }
+    while (this.gutterRows.childElementCount > rowCount) {
+      this.gutterRows.lastChild.remove();
+    }
     
-    // Create line numbers with current line highlighted
-    for (let i = 1; i <= lines; i++) {
-      const lineSpan = document.createElement('div');
-      lineSpan.textContent = i.toString().padStart(maxDigits, ' ');
-      lineSpan.style.lineHeight = '20px';
-      
-      if (i === currentLine) {
-        lineSpan.style.color = '#f0f6fc';
-        lineSpan.style.fontWeight = 'bold';
-        lineSpan.style.fontSize = '13px';
-      } else {
-        lineSpan.style.color = '#6e7681';
-        lineSpan.style.fontSize = '12px';
-      }
-      
-      this.gutter.appendChild(lineSpan);
+    let row = this.gutterRows.firstChild;
+    for (let i = this.viewStart + 1; i <= this.viewEnd; i++) {
+      const label = i.toString().padStart(maxDigits, ' ');
+      if (row.textContent !== label) row.textContent = label;
+      row.className = i === currentLine ? 'gutter-line active' : 'gutter-line';
+      row = row.nextSibling;
     }
     
     // Update gutter width based on content
@@ -215,19 +349,8 @@ class EditorManager {
    * Get current line number where cursor is
    */
   getCurrentLineNumber() {
-    if (!this.editor) return 1;
-    
-    const selection = window.getSelection();
-    if (!selection.rangeCount) return 1;
-    
-    const range = selection.getRangeAt(0);
-    const preCaretRange = range.cloneRange();
-    preCaretRange.selectNodeContents(this.editor);
-    preCaretRange.setEnd(range.endContainer, range.endOffset);
-    
-    const textBeforeCursor = preCaretRange.toString();
-    const lines = textBeforeCursor.split('\n');
-    return lines.length;
+    const position = this.saveCursorPosition();
+    return position ? position.line + 1 : 1;
   }
 
   /**
@@ -236,18 +359,12 @@ class EditorManager {
   updateStatusBar() {
     if (!this.editor || !this.lineCounter) return;
     
-    const selection = window.getSelection();
-    if (!selection.rangeCount) return;
-    
-    const range = selection.getRangeAt(0);
-    const preCaretRange = range.cloneRange();
-    preCaretRange.selectNodeContents(this.editor);
-    preCaretRange.setEnd(range.endContainer, range.endOffset);
+    const position = this.saveCursorPosition();
+    if (!position) return;
     
-    const textBeforeCursor = preCaretRange.toString();
-    const lines = textBeforeCursor.split('\n');
-    const line = lines.length;
-    const col = lines[lines.length - 1].length + 1;
+    const range = window.getSelection().getRangeAt(0);
+    const line = position.line + 1;
+    const col = position.column + 1;
     
     if (range.toString().length > 0) {
       const selectedText = range.toString();
@@ -263,73 +380,31 @@ class EditorManager {
    * @param {number} lineNumber - Line number to jump to
    */
   jumpToLine(lineNumber) {
-    console.log('Jumping to line:', lineNumber);
+    log.debug(() => `Jumping to line: ${lineNumber}`);
     
-    if (!this.editor) {
-      console.error('Editor not found');
+    if (!this.editor || !this.viewportEl) {
+      log.error('Editor not found');
       return;
     }
     
-    const text = this.getContent();
-    const lines = text.split('\n');
-    console.log('Total lines in editor:', lines.length);
+    const lineCount = this.highlighter.getLineCount();
+    log.debug(() => `Total lines in editor: ${lineCount}`);
     
-    if (lineNumber > lines.length) {
-      console.warn('Line number exceeds file length');
+    if (lineNumber > lineCount) {
+      log.warn('Line number exceeds file length');
       return;
     }
     
-    // Calculate character position
-    let position = 0;
-    for (let i = 0; i < lineNumber - 1 && i < lines.length; i++) {
-      position += lines[i].length + 1; // +1 for newline
-    }
-    
-    console.log('Calculated position:', position);
-    
-    // Create range and set cursor
-    const range = document.createRange();
-    const sel = window.getSelection();
-    
-    let currentPos = 0;
-    let targetNode = null;
-    let targetOffset = 0;
+    // Scroll first so the target line is inside the rendered window
+    this.editor.scrollTop = Math.max(0, (lineNumber - 10) * this.lineHeight);
+    this.renderViewport();
     
-    // Find the text node and offset
-    const walker = document.createTreeWalker(
-      this.editor,
-      NodeFilter.SHOW_TEXT,
-      null,
-      false
-    );
-    
-    let node;
-    while (node = walker.nextNode()) {
-      const nodeLength = node.textContent.length;
-      if (currentPos + nodeLength >= position) {
-        targetNode = node;
-        targetOffset = position - currentPos;
-        break;
-      }
-      currentPos += nodeLength;
-    }
-    
-    if (targetNode) {
-      range.setStart(targetNode, targetOffset);
-      range.collapse(true);
-      sel.removeAllRanges();
-      sel.addRange(range);
-      
-      // Scroll into view
-      const lineHeight = 20;
-      const targetScrollTop = Math.max(0, (lineNumber - 10) * lineHeight);
-      this.editor.scrollTop = targetScrollTop;
-    }
-    
-    this.editor.focus();
+    this.viewportEl.focus();
+    this.restoreCursorPosition({ line: lineNumber - 1, column: 0 });
     this.updateStatusBar();
+    this.updateGutter();
     
-    console.log('Successfully jumped to line:', lineNumber);
+    log.debug(() => `Successfully jumped to line: ${lineNumber}`);
   }
 
   /**
@@ -361,12 +436,17 @@ class EditorManager {
   }
 
   /**
-   * Toggle word wrap
+   * Toggle word wrap. Large documents stay unwrapped while they are
+   * rendered as a window of fixed-height lines.
    */
   toggleWordWrap() {
-    if (!this.editor) return;
+    if (!this.viewportEl) return;
     
-    this.editor.style.whiteSpace = this.editor.style.whiteSpace === 'pre-wrap' ? 'pre' : 'pre-wrap';
+    this.wordWrap = !this.wordWrap;
+    if (this.wordWrap && this.highlighter.getLineCount() > WRAP_MAX_LINES) {
+      log.info(`Word wrap applies to documents up to ${WRAP_MAX_LINES} lines`);
+    }
+    this.renderViewport(true);
   }
 
   /**
@@ -375,8 +455,11 @@ class EditorManager {
    */
   getContent() {
     if (!this.editor) return '';
-    // Replace <br> tags with newlines and get text content
-    return this.editor.textContent || '';
+    // The DOM only holds the visible window, so read from the line model
+    if (this.contentCache === null) {
+      this.contentCache = this.highlighter.lines.join('\n');
+    }
+    return this.contentCache;
   }
 
   /**
@@ -385,10 +468,10 @@ class EditorManager {
    */
   setContent(content) {
     if (this.editor) {
-      this.editor.textContent = content;
-      this.updateGutter();
+      this.highlighter.update(content || '');
+      this.contentCache = null;
+      this.renderViewport(true);
       this.updateStatusBar();
-      this.updateSyntaxHighlight();
     }
   }
 
@@ -397,7 +480,10 @@ class EditorManager {
    * @param {string} filename - The filename to detect type from
    */
   setFileType(filename) {
+    const text = this.getContent();
     this.currentFileType = detectFileType(filename);
+    this.highlighter.setFileType(this.currentFileType);
+    this.highlighter.update(text);
     
     // Enable syntax highlighting for C/C++ files
     this.highlightEnabled = shouldHighlight(this.currentFileType);
@@ -569,10 +655,13 @@ class EditorManager {
    * Focus the editor
    */
   focus() {
-    if (this.editor) {
-      this.editor.focus();
+    if (this.viewportEl) {
+      this.viewportEl.focus();
     }
   }
 }
 
+// Attribute long tasks to these operations
+perfMonitor.instrument(EditorManager.prototype, ['renderViewport', 'updateGutter', 'updateSyntaxHighlight'], 'editor');
+
 module.exports = EditorManager;
\ No newline at end of file
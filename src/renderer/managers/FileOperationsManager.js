@@ -1,3 +1,7 @@
+const log = require('../utils/logger').getLogger('files');
+const { perfMonitor } = require('../utils/perfMonitor');
+const FileTreeView = require('./FileTreeView');
+
 /**
  * File Operations Manager - Handles all file operations via IPC communication.
  * 
@@ -43,6 +47,13 @@ class FileOperationsManager {
      * @private
      */
     this.currentWorkspacePath = null;
+
+    /**
+     * Explorer tree, created with the first workspace
+     * @type {FileTreeView|null}
+     * @private
+     */
+    this.fileTreeView = null;
   }
 
   /**
@@ -72,6 +83,7 @@ class FileOperationsManager {
         
         // Update workspace UI
         this.updateWorkspaceUI(folderName, result.fileTree);
+        this.onWorkspaceOpened(result.folderPath);
         
         this.notificationManager.showSuccess(`Workspace "${folderName}" opened successfully`);
         
@@ -84,29 +96,55 @@ class FileOperationsManager {
     }
   }
 
+  /**
+   * Open a known folder as the workspace, without a dialog
+   * @param {string} folderPath - Folder to open
+   * @returns {Promise<Object>} Result object with folder info
+   */
+  async openWorkspacePath(folderPath) {
+    try {
+      const result = await window.ipcRenderer.invoke('open-folder', folderPath);
+      if (result.success) {
+        this.currentWorkspacePath = result.folderPath;
+        this.updateWorkspaceUI(result.folderPath.split(/[/\\]/).pop(), result.fileTree);
+        this.onWorkspaceOpened(result.folderPath);
+      }
+      return result;
+    } catch (error) {
+      return { success: false, error: error.message };
+    }
+  }
+
+  /**
+   * Callback for when a workspace is opened (to be implemented by parent)
+   * @param {string} folderPath - Workspace folder
+   */
+  onWorkspaceOpened(folderPath) {
+    // This will be set by the main UI controller
+    log.debug(() => `Workspace opened: ${folderPath}`);
+  }
+
   /**
    * Open single file
    */
   async openFile() {
     try {
-      console.log('Opening file dialog...');
+      log.debug('Opening file dialog');
       const result = await window.ipcRenderer.invoke('open-file-dialog');
-      console.log('Open file result:', result);
       
       if (result.success) {
-        console.log('File opened successfully, checking for warnings...');
+        log.debug('File opened successfully, checking for warnings');
         if (result.warning === 'encoding') {
-          console.log('Encoding warning detected, showing dialog...');
+          log.debug('Encoding warning detected, showing dialog');
           const userChoice = await this.notificationManager.showEncodingWarningDialog();
-          console.log('User choice:', userChoice);
+          log.debug(() => `User choice: ${userChoice}`);
           
           if (userChoice === 'no') {
-            console.log('User chose not to open file');
+            log.debug('User chose not to open file');
             return;
           } else if (userChoice === 'yes') {
-            console.log('User chose to open file anyway');
+            log.debug('User chose to open file anyway');
             const forceResult = await window.ipcRenderer.invoke('force-open-file', result.filePath);
-            console.log('Force open result:', forceResult);
             
             if (forceResult.success) {
               this.openFileInTab(forceResult.filePath, forceResult.content, forceResult.fileName, {
@@ -121,7 +159,7 @@ class FileOperationsManager {
             }
           }
         } else {
-          console.log('No warnings, opening file normally');
+          log.debug('No warnings, opening file normally');
           this.openFileInTab(result.filePath, result.content, result.fileName, {
             isPartial: result.isPartial,
             totalSize: result.totalSize,
@@ -238,23 +276,21 @@ class FileOperationsManager {
    */
   async readFileFromTree(filePath) {
     try {
-      console.log('Reading file from tree:', filePath);
+      log.debug(() => `Reading file from tree: ${filePath}`);
       const result = await window.ipcRenderer.invoke('read-file', filePath);
-      console.log('File tree read result:', result);
       
       if (result.success) {
         if (result.warning === 'encoding') {
-          console.log('File tree: Encoding warning detected, showing dialog...');
+          log.debug('File tree: Encoding warning detected, showing dialog');
           const userChoice = await this.notificationManager.showEncodingWarningDialog();
-          console.log('File tree: User choice:', userChoice);
+          log.debug(() => `File tree: User choice: ${userChoice}`);
           
           if (userChoice === 'no') {
-            console.log('File tree: User chose not to open file');
+            log.debug('File tree: User chose not to open file');
             return;
           } else if (userChoice === 'yes') {
-            console.log('File tree: User chose to open file anyway');
+            log.debug('File tree: User chose to open file anyway');
             const forceResult = await window.ipcRenderer.invoke('force-open-file', filePath);
-            console.log('File tree: Force open result:', forceResult);
             
             if (forceResult.success) {
               const tabId = this.openFileInTab(filePath, forceResult.content, forceResult.fileName, {
@@ -272,7 +308,7 @@ class FileOperationsManager {
           }
         } else {
           // Normal file opening - no encoding issues
-          console.log('File tree: No warnings, opening file normally');
+          log.debug('File tree: No warnings, opening file normally');
           const tabId = this.openFileInTab(filePath, result.content, result.fileName, {
             isPartial: result.isPartial,
             totalSize: result.totalSize,
@@ -290,6 +326,33 @@ class FileOperationsManager {
     }
   }
 
+  /**
+   * Read a file for a tab that was created without its content (restored
+   * sessions). Files with encoding warnings are opened as they are, since
+   * the user already chose to open them before.
+   * @param {string} filePath - File path
+   * @returns {Promise<Object|null>} { content, fileInfo }, or null if the file cannot be read
+   */
+  async readForTab(filePath) {
+    let result = await window.ipcRenderer.invoke('read-file', filePath);
+    if (result.success && result.warning === 'encoding') {
+      result = await window.ipcRenderer.invoke('force-open-file', filePath);
+    }
+    if (!result.success) {
+      log.warn(`Cannot read ${filePath}: ${result.error}`);
+      return null;
+    }
+    return {
+      content: result.content,
+      fileInfo: {
+        isPartial: result.isPartial,
+        totalSize: result.totalSize,
+        loadedSize: result.loadedSize,
+        encodingWarning: result.encodingWarning
+      }
+    };
+  }
+
   /**
    * Load full file (for partially loaded large files)
    * @param {string} filePath - File path
@@ -331,7 +394,7 @@ class FileOperationsManager {
         this.notificationManager.showError('Failed to load full file: ' + result.error);
       }
     } catch (error) {
-      console.error('Error loading full file:', error);
+      log.error('Error loading full file', error);
       this.notificationManager.showError('Error loading full file');
     }
   }
@@ -365,70 +428,31 @@ class FileOperationsManager {
   }
 
   /**
-   * Render file tree
+   * Render file tree. Only visible rows are rendered; expanded folders
+   * stay expanded across refreshes.
    * @param {Array} tree - File tree structure
    * @param {Element} container - Container element
-   * @param {number} level - Nesting level
    */
-  renderFileTree(tree, container = null, level = 0) {
-    if (!container) {
-      container = document.getElementById('file-tree');
+  renderFileTree(tree, container = null) {
+    if (!this.fileTreeView) {
+      container = container || document.getElementById('file-tree');
+      if (!container) return;
+      this.fileTreeView = new FileTreeView(container, {
+        openFile: (filePath) => this.readFileFromTree(filePath),
+        getFileIcon: (name) => this.getFileIcon(name)
+      });
     }
-    
-    if (!container) return;
-    
-    if (level === 0) {
-      container.innerHTML = '';
+    this.fileTreeView.setTree(tree);
+  }
+
+  /**
+   * Highlight a file in the explorer tree
+   * @param {string} filePath - File path
+   */
+  selectInFileTree(filePath) {
+    if (this.fileTreeView) {
+      this.fileTreeView.select(filePath);
     }
-    
-    tree.forEach(item => {
-      const itemElement = document.createElement('div');
-      itemElement.style.marginLeft = (level * 16) + 'px';
-      
-      if (item.type === 'directory') {
-        itemElement.className = 'file-tree-item';
-        itemElement.innerHTML = `
-          <span class="icon">📁</span>
-          <span class="name">${item.name}</span>
-        `;
-        
-        let expanded = false;
-        let childContainer = null;
-        
-        itemElement.addEventListener('click', () => {
-          if (!expanded && item.children) {
-            childContainer = document.createElement('div');
-            itemElement.parentNode.insertBefore(childContainer, itemElement.nextSibling);
-            this.renderFileTree(item.children, childContainer, level + 1);
-            itemElement.querySelector('.icon').textContent = '📂';
-            expanded = true;
-          } else if (expanded && childContainer) {
-            childContainer.remove();
-            itemElement.querySelector('.icon').textContent = '📁';
-            expanded = false;
-          }
-        });
-      } else {
-        itemElement.className = 'file-tree-item';
-        itemElement.setAttribute('data-file-path', item.path);
-        const fileIcon = this.getFileIcon(item.name);
-        itemElement.innerHTML = `
-          <span class="icon">${fileIcon}</span>
-          <span class="name">${item.name}</span>
-        `;
-        
-        itemElement.addEventListener('click', async () => {
-          const tabId = await this.readFileFromTree(item.path);
-          if (tabId) {
-            // Highlight selected file
-            document.querySelectorAll('.file-tree-item').forEach(el => el.classList.remove('selected'));
-            itemElement.classList.add('selected');
-          }
-        });
-      }
-      
-      container.appendChild(itemElement);
-    });
   }
 
   /**
@@ -480,4 +504,7 @@ class FileOperationsManager {
   }
 }
 
+// Attribute long tasks to these operations
+perfMonitor.instrument(FileOperationsManager.prototype, ['renderFileTree'], 'fileTree');
+
 module.exports = FileOperationsManager;
\ No newline at end of file
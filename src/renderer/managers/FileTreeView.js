@@ -0,0 +1,177 @@
+/**
+ * File Tree View - Virtualized explorer tree
+ *
+ * Only the rows inside the sidebar viewport (plus a small overscan) exist
+ * as DOM elements. Rows come from a fixed pool and are repositioned and
+ * re-labelled in place while scrolling, so a directory with 50k entries
+ * costs the same to show as one with 50, and a refresh does not rebuild
+ * the DOM.
+ */
+
+const { FlatTree } = require('../utils/flatTree');
+
+/** Row height in px; must match .file-tree-item in sidebar.css */
+const ROW_HEIGHT = 22;
+
+/** Rows rendered above and below the viewport */
+const OVERSCAN = 10;
+
+/** Indentation per nesting level in px */
+const INDENT = 16;
+
+class FileTreeView {
+  /**
+   * @param {HTMLElement} container - The #file-tree element
+   * @param {Object} options
+   * @param {Function} options.openFile - async (path) => truthy when opened
+   * @param {Function} options.getFileIcon - (name) => icon
+   */
+  constructor(container, options) {
+    this.container = container;
+    this.openFile = options.openFile;
+    this.getFileIcon = options.getFileIcon;
+    this.model = new FlatTree();
+    this.selectedPath = null;
+    /** @type {Array<HTMLElement>} Row elements, reused while scrolling */
+    this.pool = [];
+    this.frame = null;
+
+    // The sidebar content scrolls, not the tree itself
+    this.scroller = container.closest('.sidebar-content') || container;
+    this.scroller.addEventListener('scroll', () => this.scheduleRender(), { passive: true });
+    if (typeof ResizeObserver !== 'undefined') {
+      new ResizeObserver(() => this.scheduleRender()).observe(this.scroller);
+    }
+    container.addEventListener('click', (e) => this.handleClick(e));
+  }
+
+  /**
+   * Show a new tree; expanded directories and the selection are kept
+   * @param {Array<Object>} tree - Nodes from 'get-file-tree'
+   */
+  setTree(tree) {
+    this.model.setTree(tree);
+    // Nodes are new objects: force every pooled row to re-bind
+    this.pool.forEach(row => { row.node = null; });
+    this.update();
+  }
+
+  /**
+   * Highlight a file, e.g. when its tab becomes active
+   * @param {string|null} path - File path
+   */
+  select(path) {
+    this.selectedPath = path;
+    this.scheduleRender();
+  }
+
+  /**
+   * Size the tree to its row count and re-render
+   * @private
+   */
+  update() {
+    this.container.style.height = `${this.model.rowCount * ROW_HEIGHT}px`;
+    this.scheduleRender();
+  }
+
+  /**
+   * Render on the next frame, once however many changes come in
+   * @private
+   */
+  scheduleRender() {
+    if (this.frame !== null) return;
+    this.frame = requestAnimationFrame(() => {
+      this.frame = null;
+      this.render();
+    });
+  }
+
+  /**
+   * Bind pooled rows to the rows in the viewport
+   * @private
+   */
+  render() {
+    const rowCount = this.model.rowCount;
+    // Offset of the viewport top within the tree
+    const top = this.scroller.getBoundingClientRect().top - this.container.getBoundingClientRect().top;
+    const first = Math.max(0, Math.floor(top / ROW_HEIGHT) - OVERSCAN);
+    const last = Math.min(rowCount, Math.ceil((top + this.scroller.clientHeight) / ROW_HEIGHT) + OVERSCAN);
+    const needed = Math.max(0, last - first);
+
+    while (this.pool.length < needed) {
+      this.pool.push(this.createRow());
+    }
+    for (let i = 0; i < this.pool.length; i++) {
+      const row = this.pool[i];
+      if (i < needed) {
+        this.bindRow(row, first + i);
+      } else if (!row.hidden) {
+        row.hidden = true;
+      }
+    }
+  }
+
+  /**
+   * @returns {HTMLElement} Empty row appended to the container
+   * @private
+   */
+  createRow() {
+    const row = document.createElement('div');
+    row.className = 'file-tree-item';
+    row.innerHTML = '<span class="icon"></span><span class="name"></span>';
+    row.node = null;
+    row.index = -1;
+    this.container.appendChild(row);
+    return row;
+  }
+
+  /**
+   * Show a visible row in a pooled element, touching only what changed
+   * @param {HTMLElement} row - Pooled element
+   * @param {number} index - Row index
+   * @private
+   */
+  bindRow(row, index) {
+    const node = this.model.nodes[index];
+    const expanded = this.model.isExpanded(node);
+    if (row.node !== node || row.expanded !== expanded) {
+      const isDirectory = node.type === 'directory';
+      row.firstChild.textContent = isDirectory ? (expanded ? '📂' : '📁') : this.getFileIcon(node.name);
+      row.lastChild.textContent = node.name;
+      row.title = node.path;
+      row.style.paddingLeft = `${8 + this.model.depths[index] * INDENT}px`;
+      if (isDirectory) row.removeAttribute('data-file-path');
+      else row.setAttribute('data-file-path', node.path);
+      row.node = node;
+      row.expanded = expanded;
+    }
+    if (row.index !== index) {
+      row.style.transform = `translateY(${index * ROW_HEIGHT}px)`;
+      row.index = index;
+    }
+    row.classList.toggle('selected', node.path === this.selectedPath);
+    if (row.hidden) row.hidden = false;
+  }
+
+  /**
+   * @param {MouseEvent} e - Click inside the tree
+   * @private
+   */
+  async handleClick(e) {
+    const row = e.target.closest('.file-tree-item');
+    if (!row || !row.node) return;
+    const node = row.node;
+
+    if (node.type === 'directory') {
+      // The row may not have been re-bound since the last change
+      const index = this.model.nodes[row.index] === node ? row.index : this.model.nodes.indexOf(node);
+      if (this.model.toggle(index)) this.update();
+      return;
+    }
+    if (await this.openFile(node.path)) {
+      this.select(node.path);
+    }
+  }
+}
+
+module.exports = FileTreeView;
@@ -0,0 +1,146 @@
+/**
+ * Log Viewer Manager - Shows the application log ring buffer
+ *
+ * Displays recent entries of both processes (the main process keeps the
+ * renderer's forwarded entries next to its own), with process and text
+ * filters, and changes the recording level of both loggers at runtime.
+ */
+
+const { logger, flushToMain } = require('../utils/logger');
+
+/** Entries rendered at most */
+const MAX_VISIBLE_ENTRIES = 1000;
+
+/** Refresh interval while the viewer is open */
+const REFRESH_INTERVAL_MS = 1000;
+
+class LogViewerManager {
+  constructor(notificationManager) {
+    this.notificationManager = notificationManager;
+    this.overlay = null;
+    this.refreshTimer = null;
+    this.filter = { process: '', search: '' };
+  }
+
+  /**
+   * Open the viewer, or bring it up to date when already open
+   */
+  async open() {
+    if (!this.overlay) {
+      this.overlay = this.createDialog();
+      document.body.appendChild(this.overlay);
+      this.refreshTimer = setInterval(() => this.refresh(), REFRESH_INTERVAL_MS);
+    }
+    await this.refresh();
+  }
+
+  close() {
+    clearInterval(this.refreshTimer);
+    this.refreshTimer = null;
+    if (this.overlay) {
+      this.overlay.remove();
+      this.overlay = null;
+    }
+  }
+
+  /**
+   * Build the dialog and wire its controls
+   * @returns {HTMLElement} Overlay element
+   * @private
+   */
+  createDialog() {
+    const overlay = document.createElement('div');
+    overlay.className = 'app-dialog-overlay';
+    overlay.innerHTML = `
+      <div class="app-dialog log-viewer">
+        <div class="app-dialog-header">
+          <span class="app-dialog-title">Application Log</span>
+          <select class="log-viewer-level" title="Most verbose level recorded">
+            <option value="error">Error</option>
+            <option value="warn">Warn</option>
+            <option value="info">Info</option>
+            <option value="debug">Debug</option>
+            <option value="trace">Trace</option>
+          </select>
+          <select class="log-viewer-process">
+            <option value="">All processes</option>
+            <option value="main">Main</option>
+            <option value="renderer">Renderer</option>
+          </select>
+          <input class="log-viewer-search" type="text" placeholder="Filter messages">
+          <button class="app-dialog-btn" data-action="clear">Clear</button>
+          <button class="app-dialog-btn" data-action="open-file">Open log file</button>
+          <button class="app-dialog-close" data-action="close" title="Close">×</button>
+        </div>
+        <div class="log-viewer-entries"></div>
+        <div class="app-dialog-footer"></div>
+      </div>
+    `;
+
+    const levelSelect = overlay.querySelector('.log-viewer-level');
+    levelSelect.value = logger.getLevels().level;
+    levelSelect.addEventListener('change', () => this.setLevel(levelSelect.value));
+    overlay.querySelector('.log-viewer-process').addEventListener('change', (e) => {
+      this.filter.process = e.target.value;
+      this.refresh();
+    });
+    overlay.querySelector('.log-viewer-search').addEventListener('input', (e) => {
+      this.filter.search = e.target.value;
+      this.refresh();
+    });
+    overlay.addEventListener('click', async (e) => {
+      const action = e.target.dataset && e.target.dataset.action;
+      if (e.target === overlay || action === 'close') {
+        this.close();
+      } else if (action === 'clear') {
+        logger.clear();
+        await window.ipcRenderer.invoke('log-clear');
+        this.refresh();
+      } else if (action === 'open-file') {
+        const result = await window.ipcRenderer.invoke('log-open-file');
+        if (!result.success) this.notificationManager.showError(result.error);
+      }
+    });
+    return overlay;
+  }
+
+  /**
+   * Change the recording level in both processes
+   * @param {string} level - Level name
+   */
+  async setLevel(level) {
+    logger.setLevel(level);
+    await window.ipcRenderer.invoke('log-set-level', { level });
+    this.refresh();
+  }
+
+  /**
+   * Fetch entries from the main process and render them
+   * @private
+   */
+  async refresh() {
+    if (!this.overlay) return;
+    flushToMain();
+    const result = await window.ipcRenderer.invoke('log-get-entries', { ...this.filter, limit: MAX_VISIBLE_ENTRIES });
+    if (!this.overlay || !result.success) return;
+
+    const list = this.overlay.querySelector('.log-viewer-entries');
+    const atBottom = list.scrollTop + list.clientHeight >= list.scrollHeight - 4;
+    const fragment = document.createDocumentFragment();
+    for (const entry of result.entries) {
+      const row = document.createElement('div');
+      row.className = `log-entry log-${entry.level}`;
+      const time = new Date(entry.time).toLocaleTimeString();
+      const data = entry.data === undefined ? '' : ' ' + entry.data;
+      row.textContent = `${time} ${entry.level.toUpperCase().padEnd(5)} [${entry.process}:${entry.category}] ${entry.message}${data}`;
+      fragment.appendChild(row);
+    }
+    list.replaceChildren(fragment);
+    if (atBottom) list.scrollTop = list.scrollHeight;
+
+    this.overlay.querySelector('.app-dialog-footer').textContent =
+      `${result.entries.length} entries` + (result.filePath ? ` — ${result.filePath}` : '');
+  }
+}
+
+module.exports = LogViewerManager;
@@ -0,0 +1,222 @@
+/**
+ * Metrics Manager - Process and memory metrics panel
+ *
+ * Shows every process of the app (main, renderers, GPU, ctrace children),
+ * memory attributable to tabs, diagnostics, the local model and the
+ * Visualyzer graph, and the heap snapshots captured when a process crosses
+ * the configured memory threshold.
+ */
+
+const { getLogger } = require('../utils/logger');
+
+const log = getLogger('metrics');
+
+/** localStorage key of the snapshot threshold */
+const THRESHOLD_KEY = 'ctrace-heap-threshold-mb';
+
+/** Refresh interval while the panel is open */
+const REFRESH_INTERVAL_MS = 2000;
+
+const MB = 1024 * 1024;
+
+class MetricsManager {
+  /**
+   * @param {Object} sources - { tabManager, diagnosticsManager, notificationManager }
+   */
+  constructor(sources) {
+    this.tabManager = sources.tabManager;
+    this.diagnosticsManager = sources.diagnosticsManager;
+    this.notificationManager = sources.notificationManager;
+    this.overlay = null;
+    this.refreshTimer = null;
+
+    // The main process keeps no settings of its own: send the saved threshold
+    const saved = localStorage.getItem(THRESHOLD_KEY);
+    if (saved !== null) {
+      window.ipcRenderer.invoke('metrics-set-threshold', { thresholdMb: Number(saved) });
+    }
+    window.ipcRenderer.on('metrics-heap-snapshot', (event, snapshot) => {
+      this.notificationManager.showWarning(`Memory threshold crossed: heap snapshot saved (${snapshot.key})`);
+    });
+  }
+
+  /**
+   * Open the panel, or bring it up to date when already open
+   */
+  async open() {
+    if (!this.overlay) {
+      this.overlay = this.createDialog();
+      document.body.appendChild(this.overlay);
+      this.refreshTimer = setInterval(() => this.refresh(), REFRESH_INTERVAL_MS);
+    }
+    await this.refresh();
+  }
+
+  close() {
+    clearInterval(this.refreshTimer);
+    this.refreshTimer = null;
+    if (this.overlay) {
+      this.overlay.remove();
+      this.overlay = null;
+    }
+  }
+
+  /**
+   * @returns {HTMLElement} Overlay element
+   * @private
+   */
+  createDialog() {
+    const overlay = document.createElement('div');
+    overlay.className = 'app-dialog-overlay';
+    overlay.innerHTML = `
+      <div class="app-dialog">
+        <div class="app-dialog-header">
+          <span class="app-dialog-title">Process Metrics</span>
+          <label>Heap snapshot above
+            <input class="metrics-threshold-input" type="number" min="0" step="128" title="Per-process memory in MB, 0 disables"> MB
+          </label>
+          <button class="app-dialog-btn" data-action="snapshot-main">Snapshot main</button>
+          <button class="app-dialog-btn" data-action="snapshot-renderer">Snapshot this window</button>
+          <button class="app-dialog-close" data-action="close" title="Close">×</button>
+        </div>
+        <div class="metrics-body"></div>
+        <div class="app-dialog-footer"></div>
+      </div>
+    `;
+
+    const thresholdInput = overlay.querySelector('.metrics-threshold-input');
+    thresholdInput.addEventListener('change', async () => {
+      const thresholdMb = Math.max(0, parseInt(thresholdInput.value, 10) || 0);
+      localStorage.setItem(THRESHOLD_KEY, String(thresholdMb));
+      await window.ipcRenderer.invoke('metrics-set-threshold', { thresholdMb });
+    });
+    overlay.addEventListener('click', async (e) => {
+      const action = e.target.dataset && e.target.dataset.action;
+      if (e.target === overlay || action === 'close') {
+        this.close();
+      } else if (action === 'snapshot-main' || action === 'snapshot-renderer') {
+        e.target.disabled = true;
+        const result = await window.ipcRenderer.invoke('metrics-heap-snapshot', { target: action === 'snapshot-main' ? 'main' : 'renderer' });
+        e.target.disabled = false;
+        if (result.success) {
+          this.notificationManager.showSuccess('Heap snapshot saved');
+          this.refresh();
+        } else {
+          this.notificationManager.showError(result.error);
+        }
+      }
+    });
+    return overlay;
+  }
+
+  /**
+   * Memory held by this window's own data
+   * @returns {Promise<Object>} { heapUsed, residentSet, tabs, diagnostics }
+   * @private
+   */
+  async getRendererMemory() {
+    let residentSet = null;
+    try {
+      // Electron reports kilobytes
+      const info = await process.getProcessMemoryInfo();
+      residentSet = info.residentSet * 1024;
+    } catch (error) {
+      log.debug('Process memory info unavailable');
+    }
+    return {
+      heapUsed: performance.memory ? performance.memory.usedJSHeapSize : null,
+      residentSet,
+      tabs: this.tabManager.getMemoryEstimate(),
+      diagnostics: this.diagnosticsManager.getMemoryEstimate()
+    };
+  }
+
+  /**
+   * @private
+   */
+  async refresh() {
+    if (!this.overlay) return;
+    const [metrics, renderer] = await Promise.all([
+      window.ipcRenderer.invoke('metrics-get'),
+      this.getRendererMemory()
+    ]);
+    if (!this.overlay) return;
+    if (!metrics.success) {
+      this.overlay.querySelector('.metrics-body').textContent = metrics.error;
+      return;
+    }
+
+    const thresholdInput = this.overlay.querySelector('.metrics-threshold-input');
+    if (document.activeElement !== thresholdInput) thresholdInput.value = metrics.thresholdMb;
+    this.overlay.querySelector('.metrics-body').innerHTML = this.render(metrics, renderer);
+
+    const total = metrics.processes.reduce((sum, proc) => sum + proc.memoryMb, 0) +
+      metrics.children.reduce((sum, child) => sum + child.rssBytes / MB, 0);
+    this.overlay.querySelector('.app-dialog-footer').textContent =
+      `Total ${Math.round(total)} MB across ${metrics.processes.length + metrics.children.length} processes`;
+  }
+
+  /**
+   * @param {Object} metrics - Result of 'metrics-get'
+   * @param {Object} renderer - Result of getRendererMemory()
+   * @returns {string} HTML
+   * @private
+   */
+  render(metrics, renderer) {
+    const esc = (text) => this.escapeHtml(String(text));
+    const mb = (bytes) => bytes === null || bytes === undefined ? 'n/a' : (bytes / MB).toFixed(1);
+    const cpu = (percent) => percent === null || percent === undefined ? '…' : percent.toFixed(1);
+
+    const processRows = metrics.processes.map(proc => `
+      <tr><td>${esc(proc.name)}</td><td>${esc(proc.type)}</td><td class="number">${proc.pid}</td>
+      <td class="number">${cpu(proc.cpuPercent)}</td><td class="number">${proc.memoryMb}</td></tr>`);
+    const childRows = metrics.children.map(child => `
+      <tr><td>${esc(child.label)} (${esc(child.name)})</td><td>Child</td><td class="number">${child.pid}</td>
+      <td class="number">${cpu(child.cpuPercent)}</td><td class="number">${mb(child.rssBytes)}</td></tr>`);
+
+    const visualyzer = metrics.processes.find(proc => proc.name === 'CTrace Visualyzer');
+    const model = metrics.model;
+    const attributed = [
+      ['Open tabs', `${renderer.tabs.count} tabs`, mb(renderer.tabs.bytes)],
+      ['Diagnostics', `${renderer.diagnostics.count} findings`, mb(renderer.diagnostics.bytes)],
+      ['Local model', model ? `${esc(model.modelPath.split(/[\\/]/).pop())}, ${model.sequences} × ${model.contextSize} tokens${model.useMmap ? ', mmap' : ''}` : 'not loaded',
+        model ? mb(model.modelBytes) : '0.0'],
+      ['Visualyzer graph', visualyzer ? 'window open' : 'window closed', visualyzer ? visualyzer.memoryMb.toFixed(1) : '0.0'],
+      ['Main process JS heap', `${mb(metrics.main.heapTotal)} MB allocated`, mb(metrics.main.heapUsed)],
+      ['Main process native', 'buffers and addons', mb(metrics.main.external)],
+      ['This window JS heap', renderer.residentSet !== null ? `${mb(renderer.residentSet)} MB resident` : '', mb(renderer.heapUsed)]
+    ].map(([name, detail, size]) => `<tr><td>${name}</td><td>${detail}</td><td class="number">${size}</td></tr>`);
+
+    const snapshots = metrics.snapshots.length === 0
+      ? '<tr><td colspan="3">None</td></tr>'
+      : metrics.snapshots.slice().reverse().map(snapshot => `
+        <tr><td>${new Date(snapshot.time).toLocaleString()}</td><td>${esc(snapshot.key)} (${esc(snapshot.reason)})</td>
+        <td>${esc(snapshot.filePath)}</td></tr>`).join('');
+
+    return `
+      <div class="metrics-section-title">Processes</div>
+      <table class="metrics-table">
+        <tr><th>Name</th><th>Type</th><th>PID</th><th>CPU %</th><th>Memory MB</th></tr>
+        ${processRows.join('')}${childRows.join('')}
+      </table>
+      <div class="metrics-section-title">Attributed memory</div>
+      <table class="metrics-table">
+        <tr><th>Owner</th><th>Details</th><th>MB</th></tr>
+        ${attributed.join('')}
+      </table>
+      <div class="metrics-section-title">Heap snapshots</div>
+      <table class="metrics-table">
+        <tr><th>Time</th><th>Process</th><th>File</th></tr>
+        ${snapshots}
+      </table>
+    `;
+  }
+
+  escapeHtml(text) {
+    const div = document.createElement('div');
+    div.textContent = text;
+    return div.innerHTML;
+  }
+}
+
+module.exports = MetricsManager;
@@ -3,6 +3,7 @@
  */
 
 const { detectFileType } = require('../utils/fileTypeUtils');
+const log = require('../utils/logger').getLogger('editor');
 
 class MonacoEditorManager {
   constructor() {
@@ -15,24 +16,23 @@ class MonacoEditorManager {
   }
 
   async init() {
-    console.log('MonacoEditorManager: Starting initialization');
-    console.log('MonacoEditorManager: Editor container:', this.editorContainer);
+    log.debug('Starting Monaco initialization');
     
     if (!this.editorContainer) {
-      console.error('Editor container not found');
+      log.error('Editor container not found');
       return;
     }
 
     // Wait for Monaco to be loaded (from global window.monaco)
-    console.log('MonacoEditorManager: Waiting for Monaco...');
+    log.debug('Waiting for Monaco');
     await this.waitForMonaco();
 
     if (!window.monaco) {
-      console.error('Monaco Editor not loaded');
+      log.error('Monaco Editor not loaded');
       return;
     }
 
-    console.log('MonacoEditorManager: Creating editor instance');
+    log.debug('Creating editor instance');
     // Create Monaco Editor instance
     this.editor = window.monaco.editor.create(this.editorContainer, {
       value: '',
@@ -125,8 +125,7 @@ class MonacoEditorManager {
     // Initialize status bar
     this.updateStatusBar();
 
-    console.log('Monaco Editor initialized successfully');
-    console.log('Monaco editor instance:', this.editor);
+    log.info('Monaco Editor initialized');
   }
 
   /**
@@ -135,14 +134,14 @@ class MonacoEditorManager {
   async waitForMonaco() {
     return new Promise((resolve) => {
       if (window.monaco) {
-        console.log('Monaco already loaded');
+        log.debug('Monaco already loaded');
         resolve();
         return;
       }
       
       // Listen for the monaco-loaded event
       const onMonacoLoaded = () => {
-        console.log('Monaco loaded via event');
+        log.debug('Monaco loaded via event');
         window.removeEventListener('monaco-loaded', onMonacoLoaded);
         resolve();
       };
@@ -153,7 +152,7 @@ class MonacoEditorManager {
         if (window.monaco) {
           clearInterval(checkInterval);
           window.removeEventListener('monaco-loaded', onMonacoLoaded);
-          console.log('Monaco loaded via polling');
+          log.debug('Monaco loaded via polling');
           resolve();
         }
       }, 100);
@@ -162,7 +161,7 @@ class MonacoEditorManager {
       setTimeout(() => {
         clearInterval(checkInterval);
         window.removeEventListener('monaco-loaded', onMonacoLoaded);
-        console.error('Monaco Editor failed to load within timeout');
+        log.error('Monaco Editor failed to load within timeout');
         resolve();
       }, 10000);
     });
@@ -200,7 +199,7 @@ class MonacoEditorManager {
    */
   jumpToLine(lineNumber) {
     if (!this.editor) {
-      console.error('Editor not initialized');
+      log.error('Editor not initialized');
       return;
     }
 
@@ -209,7 +208,7 @@ class MonacoEditorManager {
 
     const totalLines = model.getLineCount();
     if (lineNumber > totalLines) {
-      console.warn(`Line number ${lineNumber} exceeds file length (${totalLines} lines)`);
+      log.warn(`Line number ${lineNumber} exceeds file length (${totalLines} lines)`);
       lineNumber = totalLines;
     }
 
@@ -222,7 +221,7 @@ class MonacoEditorManager {
     // Focus editor
     this.editor.focus();
 
-    console.log(`Jumped to line ${lineNumber}`);
+    log.debug(() => `Jumped to line ${lineNumber}`);
   }
 
   /**
@@ -266,32 +265,46 @@ class MonacoEditorManager {
    * @param {string} content - Content to set
    */
   async setContent(content) {
-    console.log('MonacoEditorManager.setContent called with content length:', content ? content.length : 0);
     await this.initializationPromise;
-    console.log('MonacoEditorManager.setContent: Initialization complete, editor:', this.editor);
     
     if (!this.editor) {
-      console.error('MonacoEditorManager.setContent: Editor not initialized');
+      log.error('MonacoEditorManager.setContent: Editor not initialized');
       return;
     }
 
     const model = this.editor.getModel();
-    console.log('MonacoEditorManager.setContent: Got model:', model);
     
     if (model) {
       model.setValue(content || '');
-      console.log('MonacoEditorManager.setContent: Content set successfully');
+      log.debug(() => `setContent: ${content ? content.length : 0} characters`);
       this.updateStatusBar();
       
       // Force layout update in case container was hidden when editor was created
       setTimeout(() => {
         if (this.editor) {
           this.editor.layout();
-          console.log('MonacoEditorManager.setContent: Layout updated');
         }
       }, 100);
     } else {
-      console.error('MonacoEditorManager.setContent: No model available');
+      log.error('MonacoEditorManager.setContent: No model available');
+    }
+  }
+
+  /**
+   * Get cursor, selection and scroll position
+   * @returns {Object|null} - Monaco view state, serializable as JSON
+   */
+  getViewState() {
+    return this.editor ? this.editor.saveViewState() : null;
+  }
+
+  /**
+   * Restore a view state saved with getViewState
+   * @param {Object} viewState - Monaco view state
+   */
+  restoreViewState(viewState) {
+    if (this.editor && viewState) {
+      this.editor.restoreViewState(viewState);
     }
   }
 
@@ -334,7 +347,7 @@ class MonacoEditorManager {
       window.monaco.editor.setModelLanguage(model, monacoLanguage);
     }
 
-    console.log(`Set language to ${monacoLanguage} for file type ${this.currentFileType}`);
+    log.debug(() => `Set language to ${monacoLanguage} for file type ${this.currentFileType}`);
   }
 
   /**
@@ -0,0 +1,272 @@
+/**
+ * Raw Output View - Virtualized terminal-style output panel
+ *
+ * Used when ctrace output is not JSON. Chunks are decoded as they stream
+ * in (ANSI colors included) into a paged line ring; only the rows in the
+ * viewport exist in the DOM. The view follows the tail while scrolled to
+ * the bottom, and in-view search scans the store in scheduler slices so
+ * typing stays responsive on tens of megabytes of output.
+ */
+
+const { AnsiDecoder, lineToHtml } = require('../utils/ansiDecoder');
+const { LineStore } = require('../utils/lineStore');
+const { taskScheduler } = require('../utils/taskScheduler');
+
+/** Row height in px; must match .raw-output-line in diagnostics.css */
+const LINE_HEIGHT = 16;
+
+/** Rows rendered above and below the viewport */
+const OVERSCAN = 20;
+
+/** Lines scanned per search step */
+const SEARCH_CHUNK = 20000;
+
+/** Gives every view its own scheduler key */
+let viewCounter = 0;
+
+class RawOutputView {
+  /**
+   * @param {Object} [options] - { title, capacity }
+   */
+  constructor(options = {}) {
+    this.decoder = new AnsiDecoder();
+    this.store = new LineStore({ capacity: options.capacity });
+    this.query = '';
+    /** Absolute numbers of matching lines, ascending */
+    this.matches = [];
+    this.currentMatch = -1;
+    /** Lines up to this number have been searched */
+    this.searchedTo = 0;
+    this.follow = true;
+    this.pool = [];
+    this.frame = null;
+    this.searchKey = `rawOutput.search.${++viewCounter}`;
+
+    this.element = document.createElement('div');
+    this.element.className = 'ctrace-raw-output';
+    this.element.innerHTML = `
+      <div class="raw-output-header">
+        <span class="raw-output-title"></span>
+        <span class="raw-output-status"></span>
+        <input class="raw-output-search" type="text" placeholder="Find in output" spellcheck="false">
+        <span class="raw-output-match-count"></span>
+        <button class="raw-output-nav" data-direction="-1" title="Previous match (Shift+Enter)">↑</button>
+        <button class="raw-output-nav" data-direction="1" title="Next match (Enter)">↓</button>
+      </div>
+      <div class="raw-output-content"><div class="raw-output-spacer"></div></div>
+    `;
+    this.element.querySelector('.raw-output-title').textContent = options.title || 'Raw Output';
+    this.viewport = this.element.querySelector('.raw-output-content');
+    this.spacer = this.element.querySelector('.raw-output-spacer');
+    this.status = this.element.querySelector('.raw-output-status');
+    this.matchCount = this.element.querySelector('.raw-output-match-count');
+
+    this.viewport.addEventListener('scroll', () => {
+      this.follow = this.viewport.scrollTop + this.viewport.clientHeight >= this.viewport.scrollHeight - LINE_HEIGHT;
+      this.scheduleRender();
+    }, { passive: true });
+    if (typeof ResizeObserver !== 'undefined') {
+      new ResizeObserver(() => this.scheduleRender()).observe(this.viewport);
+    }
+
+    const searchInput = this.element.querySelector('.raw-output-search');
+    searchInput.addEventListener('input', () => this.setQuery(searchInput.value));
+    searchInput.addEventListener('keydown', (e) => {
+      if (e.key === 'Enter') {
+        e.preventDefault();
+        this.nextMatch(e.shiftKey ? -1 : 1);
+      }
+    });
+    this.element.querySelectorAll('.raw-output-nav').forEach(button => {
+      button.addEventListener('click', () => this.nextMatch(Number(button.dataset.direction)));
+    });
+  }
+
+  /**
+   * @returns {number} Lines held
+   */
+  get lineCount() {
+    return this.store.length;
+  }
+
+  /**
+   * Ingest a chunk of output
+   * @param {string} chunk - Text, possibly with ANSI sequences
+   */
+  append(chunk) {
+    this.addLines(this.decoder.write(chunk));
+  }
+
+  /**
+   * Flush the last unterminated line at the end of the stream
+   */
+  end() {
+    this.addLines(this.decoder.end());
+  }
+
+  /**
+   * @param {Array<Object>} lines - Decoded lines
+   * @private
+   */
+  addLines(lines) {
+    if (lines.length === 0) return;
+    this.store.push(lines);
+    // Matches that fell out of the ring
+    while (this.matches.length > 0 && this.matches[0] < this.store.first) {
+      this.matches.shift();
+      this.currentMatch = Math.max(-1, this.currentMatch - 1);
+    }
+    if (this.query && !taskScheduler.isPending(this.searchKey)) this.continueSearch();
+    this.update();
+  }
+
+  /**
+   * Resize the scroll area and re-render on the next frame
+   * @private
+   */
+  update() {
+    this.spacer.style.height = `${this.store.length * LINE_HEIGHT}px`;
+    this.status.textContent = `${this.store.length.toLocaleString()} lines` +
+      (this.store.first > 0 ? ` (first ${this.store.first.toLocaleString()} dropped)` : '');
+    if (this.follow) {
+      this.viewport.scrollTop = this.viewport.scrollHeight;
+    }
+    this.scheduleRender();
+  }
+
+  /**
+   * Render on the next frame, once however many chunks arrive
+   * @private
+   */
+  scheduleRender() {
+    if (this.frame !== null) return;
+    this.frame = requestAnimationFrame(() => {
+      this.frame = null;
+      this.render();
+    });
+  }
+
+  /**
+   * Bind pooled rows to the lines in the viewport
+   * @private
+   */
+  render() {
+    const top = this.viewport.scrollTop;
+    const first = Math.max(0, Math.floor(top / LINE_HEIGHT) - OVERSCAN);
+    const last = Math.min(this.store.length, Math.ceil((top + this.viewport.clientHeight) / LINE_HEIGHT) + OVERSCAN);
+    const needed = Math.max(0, last - first);
+    const current = this.currentMatch >= 0 ? this.matches[this.currentMatch] : -1;
+
+    while (this.pool.length < needed) {
+      const row = document.createElement('div');
+      row.className = 'raw-output-line';
+      row.lineNumber = -1;
+      this.viewport.appendChild(row);
+      this.pool.push(row);
+    }
+    for (let i = 0; i < this.pool.length; i++) {
+      const row = this.pool[i];
+      if (i >= needed) {
+        row.hidden = true;
+        continue;
+      }
+      const index = first + i;
+      const lineNumber = this.store.first + index;
+      if (row.lineNumber !== lineNumber || row.query !== this.query) {
+        row.innerHTML = lineToHtml(this.store.get(lineNumber), this.decoder.styles, this.query);
+        row.lineNumber = lineNumber;
+        row.query = this.query;
+      }
+      row.style.transform = `translateY(${index * LINE_HEIGHT}px)`;
+      row.classList.toggle('current-match', lineNumber === current);
+      row.hidden = false;
+    }
+  }
+
+  /**
+   * Start a new search
+   * @param {string} query - Search term
+   */
+  setQuery(query) {
+    this.query = query.toLowerCase();
+    this.matches = [];
+    this.currentMatch = -1;
+    this.searchedTo = this.store.first;
+    taskScheduler.cancel(this.searchKey);
+    this.updateMatchCount();
+    this.scheduleRender();
+    if (this.query) this.continueSearch();
+  }
+
+  /**
+   * Scan lines not searched yet, in slices
+   * @private
+   */
+  continueSearch() {
+    const query = this.query;
+    taskScheduler.schedule(this.searchKey, function* () {
+      while (this.searchedTo < this.store.end) {
+        const to = Math.min(this.store.end, this.searchedTo + SEARCH_CHUNK);
+        const found = this.store.search(query, this.searchedTo, to);
+        this.searchedTo = to;
+        if (found.length > 0) {
+          this.matches.push(...found);
+          if (this.currentMatch === -1) {
+            this.currentMatch = 0;
+            this.scrollToLine(this.matches[0]);
+          }
+        }
+        this.updateMatchCount();
+        yield;
+      }
+    }.bind(this), { priority: 'user-visible' });
+  }
+
+  /**
+   * Show the current match position, with an ellipsis while scanning
+   * @private
+   */
+  updateMatchCount() {
+    if (!this.query) {
+      this.matchCount.textContent = '';
+      return;
+    }
+    const scanning = this.searchedTo < this.store.end ? '…' : '';
+    this.matchCount.textContent = this.matches.length === 0
+      ? `No results${scanning}`
+      : `${this.currentMatch + 1} of ${this.matches.length}${scanning}`;
+  }
+
+  /**
+   * Move to the next or previous matching line
+   * @param {number} direction - 1 or -1
+   */
+  nextMatch(direction) {
+    if (this.matches.length === 0) return;
+    this.currentMatch = (this.currentMatch + direction + this.matches.length) % this.matches.length;
+    this.scrollToLine(this.matches[this.currentMatch]);
+    this.updateMatchCount();
+  }
+
+  /**
+   * Center a line in the viewport and stop following the tail
+   * @param {number} lineNumber - Absolute line number
+   * @private
+   */
+  scrollToLine(lineNumber) {
+    const top = (lineNumber - this.store.first) * LINE_HEIGHT;
+    this.follow = false;
+    this.viewport.scrollTop = Math.max(0, top - this.viewport.clientHeight / 2);
+    this.scheduleRender();
+  }
+
+  /**
+   * Stop background work when the view is discarded
+   */
+  dispose() {
+    taskScheduler.cancel(this.searchKey);
+    if (this.frame !== null) cancelAnimationFrame(this.frame);
+  }
+}
+
+module.exports = RawOutputView;
@@ -1,3 +1,10 @@
+const log = require('../utils/logger').getLogger('search');
+const { perfMonitor } = require('../utils/perfMonitor');
+const { taskScheduler } = require('../utils/taskScheduler');
+
+/** Files of search results rendered synchronously; the rest follow in slices */
+const FIRST_RESULT_FILES = 20;
+
 /**
  * Search Manager - Handles search functionality
  */
@@ -8,6 +15,7 @@ class SearchManager {
     this.currentSearchMatches = [];
     this.currentMatchIndex = -1;
     this.searchTimeout = null;
+    this.searchRequest = 0; // Incremented per workspace search; stale replies are dropped
     this.init();
   }
 
@@ -126,7 +134,7 @@ class SearchManager {
         this.highlightAllMatches();
       }
     } catch (e) {
-      console.warn('Invalid search regex:', e);
+      log.warn('Invalid search regex', e);
     }
 
     this.updateSearchResults();
@@ -299,6 +307,7 @@ class SearchManager {
    * @param {string} searchTerm - Term to search for
    */
   async performWorkspaceSearch(searchTerm) {
+    const request = ++this.searchRequest;
     if (!this.currentWorkspacePath) {
       this.displaySearchResults([], searchTerm);
       return;
@@ -311,6 +320,7 @@ class SearchManager {
       }
       
       const result = await window.ipcRenderer.invoke('search-in-files', searchTerm, this.currentWorkspacePath);
+      if (request !== this.searchRequest) return;
       
       if (result.success) {
         this.displaySearchResults(result.results, searchTerm);
@@ -336,6 +346,7 @@ class SearchManager {
   displaySearchResults(results, searchTerm) {
     const searchResults = document.getElementById('search-results');
     if (!searchResults) return;
+    taskScheduler.cancel('search.results');
 
     if (results.length === 0) {
       searchResults.innerHTML = '<div style="color: #7d8590; padding: 12px; text-align: center;">No results found</div>';
@@ -350,45 +361,64 @@ class SearchManager {
       groupedResults[result.file].push(result);
     });
 
-    let html = '<div style="display: flex; flex-direction: column; gap: 8px;">';
+    const files = Object.keys(groupedResults);
+    const termPattern = new RegExp(searchTerm.replace(/[.*+?^${}()|[\]\\]/g, '\\$&'), 'gi');
+    const renderFiles = (names) => names.map(file => this.renderSearchResultFile(file, groupedResults[file], termPattern)).join('');
+
+    searchResults.innerHTML = '<div style="display: flex; flex-direction: column; gap: 8px;">' + renderFiles(files.slice(0, FIRST_RESULT_FILES)) + '</div>';
+    if (files.length <= FIRST_RESULT_FILES) return;
+
+    // Append the remaining files without blocking typing in the search box
+    const list = searchResults.firstElementChild;
+    taskScheduler.schedule('search.results', function* () {
+      for (let i = FIRST_RESULT_FILES; i < files.length; i += 5) {
+        list.insertAdjacentHTML('beforeend', renderFiles(files.slice(i, i + 5)));
+        yield;
+      }
+    });
+  }
+
+  /**
+   * Render the results of one file
+   * @param {string} file - File path
+   * @param {Array} fileResults - Results in the file
+   * @param {RegExp} termPattern - Global pattern of the search term
+   * @returns {string} HTML string
+   */
+  renderSearchResultFile(file, fileResults, termPattern) {
+    const fileName = file.split(/[/\\]/).pop();
+    const relativePath = file.replace(this.currentWorkspacePath, '').replace(/^[/\\]/, '');
     
-    Object.keys(groupedResults).forEach(file => {
-      const fileResults = groupedResults[file];
-      const fileName = file.split(/[/\\]/).pop();
-      const relativePath = file.replace(this.currentWorkspacePath, '').replace(/^[/\\]/, '');
-      
-      // Escape the file path properly for onclick
-      const escapedPath = file.replace(/\\/g, '\\\\').replace(/'/g, "\\'");
-      
-      html += `<div class="search-result-item" style="display: flex; flex-direction: column;">`;
-      html += `<div class="search-result-file" onclick="window.searchManager.openSearchResult('${escapedPath}', ${fileResults[0].line})" style="margin-bottom: 4px;">${fileName}</div>`;
-      html += `<div class="search-result-line" style="margin-bottom: 6px;">${relativePath} • ${fileResults.length} result${fileResults.length > 1 ? 's' : ''}</div>`;
-      
-      // Show each line result individually in vertical layout
-      html += '<div style="display: flex; flex-direction: column; gap: 2px;">';
-      fileResults.forEach(result => {
-        const highlightedContent = result.content.replace(
-          new RegExp(searchTerm.replace(/[.*+?^${}()|[\]\\]/g, '\\$&'), 'gi'),
-          match => `<span class="search-highlight">${match}</span>`
-        );
-        html += `<div class="search-result-content" onclick="window.searchManager.openSearchResult('${escapedPath}', ${result.line}); event.stopPropagation();" style="display: block; margin: 2px 0; padding: 4px 6px; cursor: pointer; border-radius: 3px; background: #161b22; border-left: 2px solid #1f6feb;" onmouseover="this.style.background='#30363d'" onmouseout="this.style.background='#161b22'">`;
-        html += `<div style="color: #7d8590; font-size: 10px; margin-bottom: 2px;">Line ${result.line}:</div>`;
-        html += `<div style="font-family: monospace; font-size: 11px;">${highlightedContent}</div>`;
-        html += `</div>`;
-      });
-      html += '</div>';
-      
-      html += '</div>';
+    // Escape the file path properly for onclick
+    const escapedPath = file.replace(/\\/g, '\\\\').replace(/'/g, "\\'");
+    
+    let html = `<div class="search-result-item" style="display: flex; flex-direction: column;">`;
+    html += `<div class="search-result-file" onclick="window.searchManager.openSearchResult('${escapedPath}', ${fileResults[0].line})" style="margin-bottom: 4px;">${fileName}</div>`;
+    html += `<div class="search-result-line" style="margin-bottom: 6px;">${relativePath} • ${fileResults.length} result${fileResults.length > 1 ? 's' : ''}</div>`;
+    
+    // Show each line result individually in vertical layout
+    html += '<div style="display: flex; flex-direction: column; gap: 2px;">';
+    fileResults.forEach(result => {
+      const highlightedContent = result.content.replace(
+        termPattern,
+        match => `<span class="search-highlight">${match}</span>`
+      );
+      html += `<div class="search-result-content" onclick="window.searchManager.openSearchResult('${escapedPath}', ${result.line}); event.stopPropagation();" style="display: block; margin: 2px 0; padding: 4px 6px; cursor: pointer; border-radius: 3px; background: #161b22; border-left: 2px solid #1f6feb;" onmouseover="this.style.background='#30363d'" onmouseout="this.style.background='#161b22'">`;
+      html += `<div style="color: #7d8590; font-size: 10px; margin-bottom: 2px;">Line ${result.line}:</div>`;
+      html += `<div style="font-family: monospace; font-size: 11px;">${highlightedContent}</div>`;
+      html += `</div>`;
     });
+    html += '</div>';
     
     html += '</div>';
-    searchResults.innerHTML = html;
+    return html;
   }
 
   /**
    * Clear search results
    */
   clearSearchResults() {
+    taskScheduler.cancel('search.results');
     const searchResults = document.getElementById('search-results');
     if (searchResults) {
       searchResults.innerHTML = '';
@@ -402,7 +432,7 @@ class SearchManager {
    */
   async openSearchResult(filePath, lineNumber) {
     // This will be implemented by the main controller
-    console.log('Open search result requested:', filePath, 'at line', lineNumber);
+    log.debug(() => `Open search result requested: ${filePath} at line ${lineNumber}`);
   }
 
   /**
@@ -414,4 +444,7 @@ class SearchManager {
   }
 }
 
+// Attribute long tasks to these operations
+perfMonitor.instrument(SearchManager.prototype, ['highlightAllMatches', 'displaySearchResults'], 'search');
+
 module.exports = SearchManager;
\ No newline at end of file
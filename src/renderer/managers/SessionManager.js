@@ -0,0 +1,261 @@
+/**
+ * Session Manager - Crash-safe session journal and restore
+ *
+ * Changes to the session (workspace, tabs, the active tab, view states,
+ * unsaved edits, diagnostics) are buffered as small records and sent to the
+ * main process about once a second, where they are appended to the journal
+ * in userData. Edits only mark their tab dirty; the tab's text is journaled
+ * once per flush, however many keystrokes went into it.
+ *
+ * On startup only the active tab reads its file; the other tabs are created
+ * empty and read their file on first focus. The last diagnostics of a file
+ * are not part of the restored session: they are loaded and shown the first
+ * time its tab is focused.
+ */
+
+const { getLogger } = require('../utils/logger');
+
+const log = getLogger('session');
+
+/** Interval between journal flushes */
+const FLUSH_INTERVAL_MS = 1000;
+
+/** Larger ctrace outputs are not journaled */
+const MAX_DIAGNOSTICS_CHARS = 4 * 1024 * 1024;
+
+class SessionManager {
+  /**
+   * @param {Object} sources - { tabManager, editorManager, fileOpsManager, diagnosticsManager }
+   */
+  constructor(sources) {
+    this.tabManager = sources.tabManager;
+    this.editorManager = sources.editorManager;
+    this.fileOpsManager = sources.fileOpsManager;
+    this.diagnosticsManager = sources.diagnosticsManager;
+
+    /** Records not yet sent to the main process */
+    this.pending = [];
+    /** @type {Map<string, string>} Tab ID -> session key, stable across restarts */
+    this.keys = new Map();
+    this.keyPrefix = Date.now().toString(36);
+    this.keyCounter = 0;
+    /** @type {Set<string>} Tabs edited since the last flush */
+    this.dirty = new Set();
+    /** @type {Map<string, string>} Tab ID -> last journaled view state, as JSON */
+    this.viewStates = new Map();
+    this.activeTabId = null;
+    /** @type {Set<string>} Files with saved diagnostics not shown yet */
+    this.savedDiagnostics = new Set();
+    this.restoring = false;
+
+    this.flushTimer = setInterval(() => this.flush(), FLUSH_INTERVAL_MS);
+    window.addEventListener('beforeunload', () => this.flush());
+  }
+
+  /**
+   * Queue a journal record
+   * @param {Object} record - { type, ... }
+   * @private
+   */
+  record(record) {
+    if (!this.restoring) this.pending.push(record);
+  }
+
+  /**
+   * @param {string} folderPath - Workspace folder
+   */
+  recordWorkspace(folderPath) {
+    this.record({ type: 'workspace', path: folderPath });
+  }
+
+  /**
+   * Remember the last ctrace output of a file
+   * @param {string} filePath - Analyzed file
+   * @param {string} output - Raw ctrace output, as given to DiagnosticsManager.parseOutput
+   */
+  recordDiagnostics(filePath, output) {
+    if (!filePath || !output) return;
+    if (output.length > MAX_DIAGNOSTICS_CHARS) {
+      log.debug(() => `Not journaling ${output.length} characters of diagnostics for ${filePath}`);
+      return;
+    }
+    this.savedDiagnostics.delete(filePath);
+    this.record({ type: 'diagnostics', filePath, output, at: Date.now() });
+  }
+
+  /**
+   * Journal a tab change; assigned to TabManager.onTabsChanged
+   * @param {string} type - open, close, active, change, clean or rename
+   * @param {string} tabId - Tab ID
+   */
+  onTabsChanged(type, tabId) {
+    if (this.restoring) return;
+    const tab = this.tabManager.openTabs.get(tabId);
+    switch (type) {
+      case 'open':
+        this.keys.set(tabId, `${this.keyPrefix}-${++this.keyCounter}`);
+        this.record({ type: 'open', key: this.keys.get(tabId), filePath: tab.filePath, fileName: tab.fileName, fileInfo: tab.fileInfo });
+        break;
+      case 'close':
+        this.record({ type: 'close', key: this.keys.get(tabId) });
+        this.keys.delete(tabId);
+        this.dirty.delete(tabId);
+        this.viewStates.delete(tabId);
+        if (this.activeTabId === tabId) this.activeTabId = null;
+        break;
+      case 'active': {
+        // TabManager kept the view state of the tab being left
+        const previous = this.tabManager.openTabs.get(this.activeTabId);
+        if (previous && this.activeTabId !== tabId) this.recordViewState(this.activeTabId, previous.viewState);
+        this.activeTabId = tabId;
+        this.record({ type: 'active', key: this.keys.get(tabId) });
+        this.showSavedDiagnostics(tab.filePath);
+        break;
+      }
+      case 'change':
+        this.dirty.add(tabId);
+        break;
+      case 'clean':
+        this.dirty.delete(tabId);
+        this.record({ type: 'saved', key: this.keys.get(tabId) });
+        break;
+      case 'rename':
+        this.record({ type: 'rename', key: this.keys.get(tabId), filePath: tab.filePath, fileName: tab.fileName });
+        break;
+      default:
+        break;
+    }
+  }
+
+  /**
+   * @private
+   */
+  recordViewState(tabId, viewState) {
+    if (!this.keys.has(tabId) || !viewState) return;
+    const json = JSON.stringify(viewState);
+    if (this.viewStates.get(tabId) === json) return;
+    this.viewStates.set(tabId, json);
+    this.record({ type: 'view', key: this.keys.get(tabId), viewState });
+  }
+
+  /**
+   * Send buffered records, with the text of tabs edited since the last flush
+   */
+  flush() {
+    for (const tabId of this.dirty) {
+      const tab = this.tabManager.openTabs.get(tabId);
+      if (tab && tab.modified && this.keys.has(tabId)) {
+        this.record({ type: 'edit', key: this.keys.get(tabId), content: tab.content });
+      }
+    }
+    this.dirty.clear();
+    if (this.activeTabId && this.editorManager.getViewState) {
+      this.recordViewState(this.activeTabId, this.editorManager.getViewState());
+    }
+    if (this.pending.length === 0) return;
+    window.ipcRenderer.send('session-journal-append', this.pending);
+    this.pending = [];
+  }
+
+  /**
+   * Show the restored diagnostics of a file the first time its tab is focused
+   * @param {string|null} filePath - File of the focused tab
+   * @private
+   */
+  async showSavedDiagnostics(filePath) {
+    if (!filePath || !this.savedDiagnostics.has(filePath)) return;
+    this.savedDiagnostics.delete(filePath);
+    let result;
+    try {
+      result = await window.ipcRenderer.invoke('session-load-diagnostics', filePath);
+    } catch (error) {
+      result = { success: false, error: error.message };
+    }
+    if (!result.success) {
+      log.warn(`Cannot load saved diagnostics of ${filePath}: ${result.error}`);
+      return;
+    }
+    // The user may have moved to another tab meanwhile
+    if (!result.output || this.activeFilePath() !== filePath) return;
+    if (this.diagnosticsManager.parseOutput(result.output)) {
+      await this.diagnosticsManager.displayDiagnostics();
+    }
+  }
+
+  /**
+   * @returns {string|null} File of the active tab
+   * @private
+   */
+  activeFilePath() {
+    const tab = this.tabManager.openTabs.get(this.tabManager.activeTabId);
+    return tab ? tab.filePath : null;
+  }
+
+  /**
+   * Reopen the last session: workspace, tabs with their view state and
+   * unsaved edits, and the active tab. Only the active tab reads its file now.
+   * @returns {Promise<boolean>} Whether a session was restored
+   */
+  async restore() {
+    let result;
+    try {
+      result = await window.ipcRenderer.invoke('session-restore');
+    } catch (error) {
+      result = { success: false, error: error.message };
+    }
+    if (!result.success) {
+      log.warn(`Cannot restore session: ${result.error}`);
+      return false;
+    }
+    const session = result.session;
+    if (!session.workspace && session.tabs.length === 0) {
+      window.ipcRenderer.send('session-restored');
+      return false;
+    }
+
+    let activeTabId = null;
+    const dropped = [];
+    this.restoring = true;
+    try {
+      if (session.workspace) {
+        const opened = await this.fileOpsManager.openWorkspacePath(session.workspace);
+        if (!opened.success) log.warn(`Cannot reopen workspace ${session.workspace}: ${opened.error}`);
+      }
+      for (const saved of session.tabs) {
+        // Untitled tabs without edits have nothing worth restoring
+        if (!saved.filePath && !saved.modified) {
+          dropped.push(saved.key);
+          continue;
+        }
+        const tabId = this.tabManager.createTab(saved.fileName, saved.filePath, saved.modified ? saved.content : null, saved.fileInfo || {});
+        this.keys.set(tabId, saved.key);
+        const tab = this.tabManager.openTabs.get(tabId);
+        tab.viewState = saved.viewState || null;
+        if (saved.viewState) this.viewStates.set(tabId, JSON.stringify(saved.viewState));
+        if (saved.modified) this.tabManager.markTabModified(tabId);
+        if (saved.key === session.activeKey) activeTabId = tabId;
+      }
+      for (const filePath of Object.keys(session.diagnostics || {})) {
+        this.savedDiagnostics.add(filePath);
+      }
+    } finally {
+      this.restoring = false;
+    }
+    for (const key of dropped) this.record({ type: 'close', key });
+
+    // An unreadable file closes its tab; fall back to the others, most recent first
+    const candidates = [activeTabId, ...Array.from(this.tabManager.openTabs.keys()).reverse()];
+    for (const tabId of candidates) {
+      if (!tabId || !this.tabManager.openTabs.has(tabId)) continue;
+      await this.tabManager.switchToTab(tabId);
+      if (this.tabManager.activeTabId) break;
+    }
+    if (!this.tabManager.activeTabId) this.tabManager.showWelcomeScreen();
+    window.ipcRenderer.send('session-restored');
+
+    log.info(`Restored ${this.tabManager.getTabCount()} tabs`);
+    return true;
+  }
+}
+
+module.exports = SessionManager;
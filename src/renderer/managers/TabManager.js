@@ -1,3 +1,5 @@
+const log = require('../utils/logger').getLogger('tabs');
+
 /**
  * Tab Manager - Handles all tab operations including creation, switching, and closing.
  * 
@@ -70,6 +72,21 @@ class TabManager {
      * @private
      */
     this.welcomeScreen = document.getElementById('welcome-screen');
+
+    /**
+     * Highlights the active file in the explorer; set by UIController
+     * @type {Function|null}
+     * @private
+     */
+    this.fileTreeSelector = null;
+
+    /**
+     * Reads the content of a tab created without it; set by UIController.
+     * Called with the file path, resolves to { content, fileInfo } or null
+     * @type {Function|null}
+     * @private
+     */
+    this.tabLoader = null;
     
     /**
      * Editor area DOM element
@@ -83,7 +100,7 @@ class TabManager {
    * Create a new tab
    * @param {string} fileName - Tab file name
    * @param {string} filePath - File path (optional)
-   * @param {string} content - File content
+   * @param {string|null} content - File content; null defers reading the file to the first switch
    * @param {Object} fileInfo - File metadata
    * @returns {string} - Tab ID
    */
@@ -126,6 +143,7 @@ class TabManager {
     });
     
     this.tabsContainer.appendChild(tabElement);
+    this.onTabsChanged('open', tabId);
     return tabId;
   }
 
@@ -134,10 +152,19 @@ class TabManager {
    * @param {string} tabId - Tab ID to switch to
    */
   async switchToTab(tabId) {
-    // Save current tab content if we have an active tab
+    // Tabs restored from a session read their file on first use
+    const pendingTab = this.openTabs.get(tabId);
+    if (pendingTab && pendingTab.content === null && !(await this.loadPendingTab(tabId))) {
+      return;
+    }
+
+    // Save current tab content and view state if we have an active tab
     if (this.activeTabId && this.openTabs.has(this.activeTabId)) {
       const currentTab = this.openTabs.get(this.activeTabId);
       currentTab.content = this.editorManager.getContent();
+      if (this.editorManager.getViewState) {
+        currentTab.viewState = this.editorManager.getViewState();
+      }
     }
 
     // Update active tab
@@ -152,6 +179,11 @@ class TabManager {
       if (newTab.fileName) {
         await this.editorManager.setFileType(newTab.fileName);
       }
+
+      // Bring back cursor and scroll position
+      if (newTab.viewState && this.editorManager.restoreViewState) {
+        this.editorManager.restoreViewState(newTab.viewState);
+      }
       
       // Update tab appearance
       document.querySelectorAll('.tab').forEach(tab => {
@@ -163,19 +195,38 @@ class TabManager {
       }
       
       // Update file tree selection
-      if (newTab.filePath) {
-        document.querySelectorAll('.file-tree-item').forEach(el => el.classList.remove('selected'));
-        const fileTreeItem = document.querySelector(`[data-file-path="${newTab.filePath}"]`);
-        if (fileTreeItem) {
-          fileTreeItem.classList.add('selected');
-        }
+      if (newTab.filePath && this.fileTreeSelector) {
+        this.fileTreeSelector(newTab.filePath);
       }
 
       // Emit tab switch event for other components
+      this.onTabsChanged('active', tabId);
       this.onTabSwitch(newTab);
     }
   }
 
+  /**
+   * Read the file of a tab created without content
+   * @param {string} tabId - Tab ID
+   * @returns {Promise<boolean>} Whether the tab has its content now; unreadable files are closed
+   * @private
+   */
+  async loadPendingTab(tabId) {
+    const tab = this.openTabs.get(tabId);
+    const loaded = tab.filePath && this.tabLoader ? await this.tabLoader(tab.filePath) : null;
+    if (!this.openTabs.has(tabId)) return false;
+    if (tab.content !== null) return true;
+
+    if (!loaded) {
+      this.notificationManager.showWarning(`"${tab.fileName}" could not be reopened and was closed`);
+      this.removeTab(tabId);
+      return false;
+    }
+    tab.content = loaded.content;
+    tab.fileInfo = loaded.fileInfo || {};
+    return true;
+  }
+
   /**
    * Close a tab
    * @param {Event} event - Click event
@@ -193,6 +244,15 @@ class TabManager {
       if (!result) return;
     }
     
+    this.removeTab(tabId);
+  }
+
+  /**
+   * Remove a tab without asking about unsaved changes
+   * @param {string} tabId - Tab ID to remove
+   * @private
+   */
+  removeTab(tabId) {
     // Remove tab element
     const tabElement = document.querySelector(`[data-tab-id="${tabId}"]`);
     if (tabElement) {
@@ -201,6 +261,7 @@ class TabManager {
     
     // Remove from data
     this.openTabs.delete(tabId);
+    this.onTabsChanged('close', tabId);
     
     // If closing active tab, switch to another tab or show welcome screen
     if (this.activeTabId === tabId) {
@@ -243,6 +304,7 @@ class TabManager {
         tabElement.classList.remove('modified');
       }
     }
+    this.onTabsChanged('clean', tabId);
   }
 
   /**
@@ -288,6 +350,7 @@ class TabManager {
         }
         tabElement.setAttribute('data-file-path', filePath);
       }
+      this.onTabsChanged('rename', tabId);
     }
   }
 
@@ -312,7 +375,7 @@ class TabManager {
     setTimeout(() => {
       if (this.editorManager && this.editorManager.editor) {
         this.editorManager.editor.layout();
-        console.log('TabManager: Triggered Monaco layout update after showing editor');
+        log.debug('TabManager: Triggered Monaco layout update after showing editor');
       }
     }, 50);
   }
@@ -327,9 +390,19 @@ class TabManager {
     if (tab && tab.content !== newContent) {
       tab.content = newContent;
       this.markTabModified(tabId);
+      this.onTabsChanged('change', tabId);
     }
   }
 
+  /**
+   * Callback for tab list and content changes (to be implemented by parent)
+   * @param {string} type - open, close, active, change, clean or rename
+   * @param {string} tabId - Tab ID
+   */
+  onTabsChanged(type, tabId) {
+    // This will be set by the session manager
+  }
+
   /**
    * Callback for when tab switches (for other components to listen to)
    * @param {Object} tabData - Tab data
@@ -384,7 +457,7 @@ class TabManager {
    */
   onLoadFullFile(filePath) {
     // This will be set by the main UI controller
-    console.log('Load full file requested for:', filePath);
+    log.debug(() => `Load full file requested for: ${filePath}`);
   }
 
   /**
@@ -418,6 +491,18 @@ class TabManager {
   getTabCount() {
     return this.openTabs.size;
   }
+
+  /**
+   * Approximate memory held by tab contents (strings are UTF-16)
+   * @returns {Object} { count, bytes }
+   */
+  getMemoryEstimate() {
+    let bytes = 0;
+    for (const tab of this.openTabs.values()) {
+      bytes += (tab.content ? tab.content.length : 0) * 2;
+    }
+    return { count: this.openTabs.size, bytes };
+  }
 }
 
 module.exports = TabManager;
\ No newline at end of file
@@ -3,6 +3,8 @@
  * Uses D3.js for force-directed graph rendering
  */
 
+const { perfMonitor } = require('../utils/perfMonitor');
+
 class VisualyzerManager {
   constructor() {
     this.currentGraph = null;
@@ -644,7 +646,7 @@ class VisualyzerManager {
     });
     
     // Update positions on simulation tick
-    this.simulation.on('tick', () => {
+    this.simulation.on('tick', () => perfMonitor.measure('visualyzer.tick', () => {
       linkAll
         .attr('x1', d => d.source.x)
         .attr('y1', d => d.source.y)
@@ -652,7 +654,7 @@ class VisualyzerManager {
         .attr('y2', d => d.target.y);
       
       nodeAll.attr('transform', d => `translate(${d.x},${d.y})`);
-    });
+    }));
   }
 
   /**
@@ -946,4 +948,7 @@ class VisualyzerManager {
   }
 }
 
+// Attribute long tasks to these operations
+perfMonitor.instrument(VisualyzerManager.prototype, ['parseDotContent', 'createForceGraph', 'updateGraph'], 'visualyzer');
+
 module.exports = VisualyzerManager;
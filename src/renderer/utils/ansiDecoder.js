@@ -0,0 +1,302 @@
+/**
+ * Incremental ANSI decoder for terminal-style output
+ *
+ * Turns a stream of text chunks into lines of plain text with style runs.
+ * Escape sequences split across chunks are carried over, and the current
+ * SGR state (colors, bold, ...) carries across lines the way a terminal
+ * does. Styles are interned, so a line stores only its text and a flat
+ * [start, styleId, start, styleId, ...] array, or null when unstyled.
+ * Non-SGR control sequences (cursor movement, erase) are dropped.
+ */
+
+/** Lines longer than this are wrapped so a row never holds megabytes */
+const MAX_LINE_LENGTH = 4096;
+
+/** Standard and bright colors 0-15, tuned for the dark theme */
+const PALETTE = [
+  '#484f58', '#ff7b72', '#3fb950', '#d29922', '#58a6ff', '#bc8cff', '#39c5cf', '#b1bac4',
+  '#6e7681', '#ffa198', '#56d364', '#e3b341', '#79c0ff', '#d2a8ff', '#56d4dd', '#f0f6fc'
+];
+
+/** Characters that end a run of printable text */
+const SPECIAL_PATTERN = /[\x1b\r\n]/g;
+
+/** A complete CSI sequence */
+const CSI_PATTERN = /\x1b\[([0-?]*)[ -/]*([@-~])/y;
+
+/** An OSC sequence (window title, hyperlinks) */
+const OSC_PATTERN = /\x1b\][^\x07\x1b]*(\x07|\x1b\\)/y;
+
+/** The start of a CSI or OSC sequence cut off by the end of a chunk */
+const PARTIAL_PATTERN = /\x1b(\[[0-?]*[ -/]*|\][^\x07\x1b]*\x1b?)?$/y;
+
+/**
+ * Color of a 256-color index
+ * @param {number} n - Index 0-255
+ * @returns {string} CSS color
+ */
+function color256(n) {
+  if (n < 16) return PALETTE[n];
+  if (n >= 232) {
+    const level = 8 + (n - 232) * 10;
+    return `rgb(${level},${level},${level})`;
+  }
+  const cube = n - 16;
+  const channel = (v) => (v === 0 ? 0 : 55 + v * 40);
+  return `rgb(${channel(Math.floor(cube / 36))},${channel(Math.floor(cube / 6) % 6)},${channel(cube % 6)})`;
+}
+
+class AnsiDecoder {
+  /**
+   * @param {Object} [options] - { maxLineLength }
+   */
+  constructor(options = {}) {
+    this.maxLineLength = options.maxLineLength || MAX_LINE_LENGTH;
+    /** Interned styles; id 0 is the default style */
+    this.styles = [{ css: '' }];
+    this.styleIds = new Map([['', 0]]);
+    this.state = { fg: null, bg: null, bold: false, dim: false, italic: false, underline: false };
+    this.styleId = 0;
+    /** Unfinished escape sequence or '\r' from the previous chunk */
+    this.pending = '';
+    this.text = '';
+    this.runs = [];
+    this.lines = [];
+  }
+
+  /**
+   * Decode a chunk
+   * @param {string} chunk - Output text
+   * @returns {Array<Object>} Lines completed by this chunk, { text, runs }
+   */
+  write(chunk) {
+    const input = this.pending + chunk;
+    this.pending = '';
+    this.lines = [];
+
+    let i = 0;
+    while (i < input.length) {
+      SPECIAL_PATTERN.lastIndex = i;
+      const special = SPECIAL_PATTERN.exec(input);
+      if (!special) {
+        this.appendText(input.slice(i));
+        break;
+      }
+      if (special.index > i) this.appendText(input.slice(i, special.index));
+      i = special.index;
+
+      const ch = input[i];
+      if (ch === '\n') {
+        this.finishLine();
+        i++;
+      } else if (ch === '\r') {
+        if (i + 1 === input.length) {
+          this.pending = '\r';
+          i++;
+        } else if (input[i + 1] === '\n') {
+          this.finishLine();
+          i += 2;
+        } else {
+          // Carriage return redraws the line (progress output): keep the last version
+          this.text = '';
+          this.runs = [];
+          i++;
+        }
+      } else {
+        const consumed = this.readEscape(input, i);
+        if (consumed === 0) {
+          this.pending = input.slice(i);
+          break;
+        }
+        i += consumed;
+      }
+    }
+    return this.lines;
+  }
+
+  /**
+   * Flush the last line at the end of the stream
+   * @returns {Array<Object>} Remaining line, if any
+   */
+  end() {
+    this.pending = '';
+    this.lines = [];
+    if (this.text.length > 0) this.finishLine();
+    return this.lines;
+  }
+
+  /**
+   * Apply the escape sequence at a position
+   * @param {string} input - Text
+   * @param {number} index - Position of ESC
+   * @returns {number} Characters consumed, 0 when the sequence is incomplete
+   * @private
+   */
+  readEscape(input, index) {
+    CSI_PATTERN.lastIndex = index;
+    const csi = CSI_PATTERN.exec(input);
+    if (csi) {
+      if (csi[2] === 'm') this.applySgr(csi[1]);
+      return csi[0].length;
+    }
+    OSC_PATTERN.lastIndex = index;
+    const osc = OSC_PATTERN.exec(input);
+    if (osc) return osc[0].length;
+    PARTIAL_PATTERN.lastIndex = index;
+    if (PARTIAL_PATTERN.test(input)) return 0;
+    // Unknown or malformed: drop ESC and the next character
+    return 2;
+  }
+
+  /**
+   * Update the style state from SGR parameters
+   * @param {string} paramText - Parameters, e.g. '1;31'
+   * @private
+   */
+  applySgr(paramText) {
+    const params = paramText === '' ? [0] : paramText.split(';').map(p => parseInt(p, 10) || 0);
+    const state = this.state;
+    for (let k = 0; k < params.length; k++) {
+      const p = params[k];
+      if (p === 0) {
+        Object.assign(state, { fg: null, bg: null, bold: false, dim: false, italic: false, underline: false });
+      } else if (p === 1) state.bold = true;
+      else if (p === 2) state.dim = true;
+      else if (p === 3) state.italic = true;
+      else if (p === 4) state.underline = true;
+      else if (p === 22) state.bold = state.dim = false;
+      else if (p === 23) state.italic = false;
+      else if (p === 24) state.underline = false;
+      else if (p >= 30 && p <= 37) state.fg = PALETTE[p - 30];
+      else if (p >= 90 && p <= 97) state.fg = PALETTE[p - 90 + 8];
+      else if (p === 39) state.fg = null;
+      else if (p >= 40 && p <= 47) state.bg = PALETTE[p - 40];
+      else if (p >= 100 && p <= 107) state.bg = PALETTE[p - 100 + 8];
+      else if (p === 49) state.bg = null;
+      else if (p === 38 || p === 48) {
+        let value = null;
+        if (params[k + 1] === 5) {
+          value = color256(params[k + 2] & 255);
+          k += 2;
+        } else if (params[k + 1] === 2) {
+          value = `rgb(${params[k + 2] & 255},${params[k + 3] & 255},${params[k + 4] & 255})`;
+          k += 4;
+        }
+        if (p === 38) state.fg = value;
+        else state.bg = value;
+      }
+    }
+    this.styleId = this.intern(state);
+  }
+
+  /**
+   * Style id of a state, adding it to the table when new
+   * @param {Object} state - Style state
+   * @returns {number} Style id
+   * @private
+   */
+  intern(state) {
+    let css = '';
+    if (state.fg) css += `color:${state.fg};`;
+    if (state.bg) css += `background:${state.bg};`;
+    if (state.bold) css += 'font-weight:bold;';
+    if (state.dim) css += 'opacity:0.7;';
+    if (state.italic) css += 'font-style:italic;';
+    if (state.underline) css += 'text-decoration:underline;';
+    let id = this.styleIds.get(css);
+    if (id === undefined) {
+      id = this.styles.length;
+      this.styles.push({ css });
+      this.styleIds.set(css, id);
+    }
+    return id;
+  }
+
+  /**
+   * @param {string} text - Printable text in the current style
+   * @private
+   */
+  appendText(text) {
+    while (text.length > 0) {
+      const room = this.maxLineLength - this.text.length;
+      const part = text.length > room ? text.slice(0, room) : text;
+      const lastStyle = this.runs.length ? this.runs[this.runs.length - 1] : 0;
+      if (this.styleId !== lastStyle) this.runs.push(this.text.length, this.styleId);
+      this.text += part;
+      text = text.slice(part.length);
+      if (this.text.length >= this.maxLineLength) this.finishLine();
+    }
+  }
+
+  /**
+   * Complete the current line; the style carries over to the next
+   * @private
+   */
+  finishLine() {
+    this.lines.push({ text: this.text, runs: this.runs.length ? this.runs : null });
+    this.text = '';
+    this.runs = [];
+  }
+}
+
+/**
+ * Escape text for HTML
+ * @param {string} text - Text
+ * @returns {string} Escaped text
+ */
+function escapeHtml(text) {
+  return text.replace(/[&<>"]/g, ch => ({ '&': '&amp;', '<': '&lt;', '>': '&gt;', '"': '&quot;' })[ch]);
+}
+
+/**
+ * Render a decoded line, optionally marking occurrences of a search term
+ * @param {Object} line - { text, runs }
+ * @param {Array<Object>} styles - Decoder styles
+ * @param {string} [query] - Lower-case search term
+ * @returns {string} HTML
+ */
+function lineToHtml(line, styles, query) {
+  const text = line.text;
+  const runs = line.runs || [];
+  const cuts = [0, text.length];
+  for (let i = 0; i < runs.length; i += 2) cuts.push(runs[i]);
+  const marks = [];
+  if (query) {
+    const lower = text.toLowerCase();
+    for (let at = lower.indexOf(query); at !== -1; at = lower.indexOf(query, at + query.length)) {
+      marks.push(at, at + query.length);
+      cuts.push(at, at + query.length);
+    }
+  }
+  const points = Array.from(new Set(cuts)).sort((a, b) => a - b);
+
+  let html = '';
+  let run = -2;
+  let mark = 0;
+  for (let k = 0; k < points.length - 1; k++) {
+    const start = points[k];
+    while (run + 2 < runs.length && runs[run + 2] <= start) run += 2;
+    while (mark < marks.length && marks[mark + 1] <= start) mark += 2;
+    const css = run >= 0 ? styles[runs[run + 1]].css : '';
+    const marked = mark < marks.length && marks[mark] <= start;
+    let segment = escapeHtml(text.slice(start, points[k + 1]));
+    if (css) segment = `<span style="${css}">${segment}</span>`;
+    if (marked) segment = `<mark>${segment}</mark>`;
+    html += segment;
+  }
+  return html;
+}
+
+/**
+ * Convert a complete ANSI text to HTML, one line per text line
+ * @param {string} text - Text with escape sequences
+ * @returns {string} HTML
+ */
+function ansiToHtml(text) {
+  if (!text || typeof text !== 'string') return '';
+  const decoder = new AnsiDecoder();
+  const lines = decoder.write(text).concat(decoder.end());
+  return lines.map(line => lineToHtml(line, decoder.styles)).join('\n');
+}
+
+module.exports = { AnsiDecoder, lineToHtml, ansiToHtml, MAX_LINE_LENGTH };
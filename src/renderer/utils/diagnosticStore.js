@@ -0,0 +1,404 @@
+/**
+ * Columnar store of diagnostics
+ *
+ * A parsed diagnostic is a tree of small objects carrying the same rule,
+ * severity, function and file strings over and over; at a million findings
+ * that is gigabytes of heap. Here every field is a column instead: strings
+ * are interned into per-field tables and rows hold table ids, numbers live
+ * in typed arrays. A diagnostic object is only built when something needs
+ * one (a rendered row, a hover), and filtering, counting and sorting work
+ * on the columns and on Uint32Array lists of row indices.
+ */
+
+/** Severity order for sorting; unknown severities come last */
+const SEVERITY_RANK = { ERROR: 0, WARNING: 1, INFO: 2 };
+
+/** Initial row capacity when the size is not known up front */
+const INITIAL_CAPACITY = 1024;
+
+/** Uint32 columns, grown together */
+const NUMERIC_COLUMNS = ['rule', 'func', 'file', 'message', 'tool', 'startLine', 'startColumn', 'endLine', 'endColumn'];
+
+/** Fields stored in columns; anything else is kept per row in `extras` */
+const LOCATION_FIELDS = new Set(['file', 'function', 'startLine', 'startColumn', 'endLine', 'endColumn']);
+const TOP_FIELDS = new Set(['id', 'ruleId', 'severity', 'location', 'details', 'tool']);
+
+/**
+ * @param {string} filePath - Reported or local file path
+ * @returns {string} Path with forward slashes; WSL mounts become drive
+ *   paths and drive paths are lowercased, as Windows ignores case
+ */
+function normalizeFilePath(filePath) {
+  let normalized = String(filePath).replace(/\\/g, '/').replace(/^\.\//, '');
+  const wsl = normalized.match(/^\/mnt\/([a-zA-Z])(\/.*)?$/);
+  if (wsl) normalized = `${wsl[1]}:${wsl[2] || '/'}`;
+  return /^[a-zA-Z]:/.test(normalized) ? normalized.toLowerCase() : normalized;
+}
+
+/**
+ * Predicate telling whether a reported file is a given local file. Relative
+ * reported paths (SARIF URIs without a base) match by suffix.
+ * @param {string} filePath - Local file path
+ * @returns {Function} (reportedPath) => boolean
+ */
+function fileMatcher(filePath) {
+  const target = normalizeFilePath(filePath);
+  return (reported) => {
+    if (!reported) return false;
+    const normalized = normalizeFilePath(reported);
+    if (normalized === target) return true;
+    const relative = !normalized.startsWith('/') && !/^[a-z]:/.test(normalized);
+    return relative && target.endsWith(`/${normalized}`);
+  };
+}
+
+/**
+ * Interned strings of one field
+ */
+class StringTable {
+  constructor() {
+    this.values = [''];
+    this.ids = new Map([['', 0]]);
+    this.rankCache = null;
+  }
+
+  /**
+   * @param {string} value - String to intern; null and undefined become ''
+   * @returns {number} Id
+   */
+  intern(value) {
+    const key = value == null ? '' : String(value);
+    let id = this.ids.get(key);
+    if (id === undefined) {
+      id = this.values.length;
+      this.values.push(key);
+      this.ids.set(key, id);
+      this.rankCache = null;
+    }
+    return id;
+  }
+
+  /**
+   * @returns {Uint32Array} Sort position of every id
+   */
+  ranks() {
+    if (!this.rankCache) {
+      const order = this.values.map((value, id) => id).sort((a, b) => {
+        const x = this.values[a];
+        const y = this.values[b];
+        return x < y ? -1 : x > y ? 1 : 0;
+      });
+      this.rankCache = new Uint32Array(order.length);
+      order.forEach((id, rank) => { this.rankCache[id] = rank; });
+    }
+    return this.rankCache;
+  }
+
+  /**
+   * @returns {number} Approximate bytes held
+   */
+  estimateBytes() {
+    let chars = 0;
+    for (const value of this.values) chars += value.length;
+    // The array and the map share each string; add per-entry overhead
+    return chars * 2 + this.values.length * 48;
+  }
+}
+
+class DiagnosticStore {
+  /**
+   * @param {number} [capacity] - Rows to allocate up front
+   */
+  constructor(capacity = INITIAL_CAPACITY) {
+    this.length = 0;
+    this.capacity = Math.max(1, capacity);
+    this.tables = {
+      rule: new StringTable(),
+      severity: new StringTable(),
+      func: new StringTable(),
+      file: new StringTable(),
+      message: new StringTable(),
+      tool: new StringTable()
+    };
+    /** @type {Array<string>} Diagnostic ids, unique per row */
+    this.ids = [];
+    this.idIndex = null;
+    this.severity = new Uint8Array(this.capacity);
+    for (const name of NUMERIC_COLUMNS) this[name] = new Uint32Array(this.capacity);
+    /** @type {Map<number, Object>} Row -> { top, location, details } fields without a column */
+    this.extras = new Map();
+  }
+
+  /**
+   * @param {Array<Object>} diagnostics - Parsed diagnostics
+   * @returns {DiagnosticStore} Store holding them
+   */
+  static from(diagnostics) {
+    const store = new DiagnosticStore(diagnostics.length);
+    for (const diag of diagnostics) store.add(diag);
+    return store;
+  }
+
+  /**
+   * @param {number} needed - Rows required
+   * @private
+   */
+  grow(needed) {
+    if (needed <= this.capacity) return;
+    let capacity = this.capacity * 2;
+    while (capacity < needed) capacity *= 2;
+    const severity = new Uint8Array(capacity);
+    severity.set(this.severity);
+    this.severity = severity;
+    for (const name of NUMERIC_COLUMNS) {
+      const column = new Uint32Array(capacity);
+      column.set(this[name]);
+      this[name] = column;
+    }
+    this.capacity = capacity;
+  }
+
+  /**
+   * Append a diagnostic
+   * @param {Object} diag - { id, ruleId, severity, location, details }
+   * @returns {number} Row index
+   */
+  add(diag) {
+    const row = this.length;
+    this.grow(row + 1);
+    const location = diag.location || {};
+    const details = diag.details || {};
+
+    this.ids.push(diag.id == null ? `diag-${row + 1}` : String(diag.id));
+    this.rule[row] = this.tables.rule.intern(diag.ruleId);
+    // Severity ids fit a byte: there are only a handful of levels
+    this.severity[row] = Math.min(255, this.tables.severity.intern(diag.severity));
+    this.func[row] = this.tables.func.intern(location.function);
+    this.file[row] = this.tables.file.intern(location.file);
+    this.message[row] = this.tables.message.intern(details.message);
+    this.tool[row] = this.tables.tool.intern(diag.tool);
+    this.startLine[row] = location.startLine || 0;
+    this.startColumn[row] = location.startColumn || 0;
+    this.endLine[row] = location.endLine || 0;
+    this.endColumn[row] = location.endColumn || 0;
+
+    const extra = this.collectExtras(diag, location, details);
+    if (extra) this.extras.set(row, extra);
+    if (this.idIndex) this.idIndex.set(this.ids[row], row);
+    this.length++;
+    return row;
+  }
+
+  /**
+   * Fields of a diagnostic that have no column, e.g. variableAliasing
+   * @returns {Object|null} { top, location, details }, null when there are none
+   * @private
+   */
+  collectExtras(diag, location, details) {
+    let extra = null;
+    const keep = (part, key, value) => {
+      extra = extra || { top: {}, location: {}, details: {} };
+      extra[part][key] = value;
+    };
+    for (const key of Object.keys(diag)) {
+      if (!TOP_FIELDS.has(key)) keep('top', key, diag[key]);
+    }
+    for (const key of Object.keys(location)) {
+      if (!LOCATION_FIELDS.has(key)) keep('location', key, location[key]);
+    }
+    for (const key of Object.keys(details)) {
+      if (key !== 'message') keep('details', key, details[key]);
+    }
+    return extra;
+  }
+
+  /**
+   * Build the object form of a row
+   * @param {number} row - Row index
+   * @returns {Object} Diagnostic
+   */
+  get(row) {
+    const extra = this.extras.get(row);
+    const diag = {
+      id: this.ids[row],
+      ruleId: this.tables.rule.values[this.rule[row]],
+      severity: this.severityAt(row),
+      location: {
+        file: this.tables.file.values[this.file[row]],
+        function: this.tables.func.values[this.func[row]],
+        startLine: this.startLine[row],
+        startColumn: this.startColumn[row],
+        endLine: this.endLine[row],
+        endColumn: this.endColumn[row]
+      },
+      details: { message: this.tables.message.values[this.message[row]] }
+    };
+    if (this.tool[row]) diag.tool = this.tables.tool.values[this.tool[row]];
+    if (extra) {
+      Object.assign(diag, extra.top);
+      Object.assign(diag.location, extra.location);
+      Object.assign(diag.details, extra.details);
+    }
+    return diag;
+  }
+
+  /**
+   * @param {number} row - Row index
+   * @returns {string} Severity of a row
+   */
+  severityAt(row) {
+    return this.tables.severity.values[this.severity[row]];
+  }
+
+  /**
+   * String field of a row without building the diagnostic
+   * @param {string} column - 'rule', 'func', 'file', 'message' or 'tool'
+   * @param {number} row - Row index
+   * @returns {string} Value
+   */
+  textAt(column, row) {
+    return this.tables[column].values[this[column][row]];
+  }
+
+  /**
+   * @param {Uint32Array|Array<number>} rows - Row indices
+   * @returns {Array<Object>} Diagnostics of those rows
+   */
+  getAll(rows) {
+    const result = new Array(rows.length);
+    for (let i = 0; i < rows.length; i++) result[i] = this.get(rows[i]);
+    return result;
+  }
+
+  /**
+   * @param {string} id - Diagnostic id
+   * @returns {number} Row index, or -1
+   */
+  indexOf(id) {
+    if (!this.idIndex) {
+      this.idIndex = new Map();
+      this.ids.forEach((value, row) => this.idIndex.set(value, row));
+    }
+    const row = this.idIndex.get(id);
+    return row === undefined ? -1 : row;
+  }
+
+  /**
+   * @param {string} column - 'rule', 'func', 'file', 'message' or 'tool'
+   * @param {Function} predicate - (value) => boolean, called once per distinct value
+   * @returns {Uint8Array} 1 for every table id whose value passes
+   */
+  mask(column, predicate) {
+    const values = this.tables[column].values;
+    const mask = new Uint8Array(values.length);
+    for (let id = 0; id < values.length; id++) mask[id] = predicate(values[id]) ? 1 : 0;
+    return mask;
+  }
+
+  /**
+   * @param {Function} predicate - (filePath) => boolean, called once per distinct file
+   * @returns {Uint8Array} 1 for every file id whose path passes
+   */
+  fileMask(predicate) {
+    return this.mask('file', predicate);
+  }
+
+  /**
+   * Rows matching a severity and, optionally, a start line and a set of files
+   * @param {string} [severity] - 'ALL' or omitted for every severity
+   * @param {number} [line] - Only rows starting on this line
+   * @param {Uint8Array} [files] - Only rows whose file id is set, from fileMask
+   * @returns {Uint32Array} Row indices in report order
+   */
+  select(severity, line, files) {
+    const wanted = severity && severity !== 'ALL' ? this.tables.severity.ids.get(severity) : -1;
+    if (wanted === undefined) return new Uint32Array(0);
+    const rows = new Uint32Array(this.length);
+    let count = 0;
+    for (let row = 0; row < this.length; row++) {
+      if (wanted !== -1 && this.severity[row] !== wanted) continue;
+      if (line !== undefined && this.startLine[row] !== line) continue;
+      if (files && !files[this.file[row]]) continue;
+      rows[count++] = row;
+    }
+    return rows.slice(0, count);
+  }
+
+  /**
+   * @param {Uint32Array} rows - Row indices
+   * @returns {Object} Severity -> number of rows
+   */
+  countBySeverity(rows) {
+    const counts = new Uint32Array(this.tables.severity.values.length);
+    for (let i = 0; i < rows.length; i++) counts[this.severity[rows[i]]]++;
+    const result = {};
+    counts.forEach((count, id) => {
+      if (count > 0) result[this.tables.severity.values[id]] = count;
+    });
+    return result;
+  }
+
+  /**
+   * @param {Uint32Array} rows - Row indices
+   * @returns {number} Distinct rule ids among the rows
+   */
+  countRules(rows) {
+    const seen = new Uint8Array(this.tables.rule.values.length);
+    let distinct = 0;
+    for (let i = 0; i < rows.length; i++) {
+      const rule = this.rule[rows[i]];
+      if (!seen[rule]) {
+        seen[rule] = 1;
+        distinct++;
+      }
+    }
+    return distinct;
+  }
+
+  /**
+   * Sort rows; ties keep report order
+   * @param {Uint32Array} rows - Row indices
+   * @param {string} order - 'report', 'severity', 'location' or 'rule'
+   * @returns {Uint32Array} Sorted copy
+   */
+  sort(rows, order) {
+    const sorted = rows.slice();
+    if (order === 'report') return sorted;
+
+    const severityRank = new Uint8Array(this.tables.severity.values.length);
+    this.tables.severity.values.forEach((value, id) => {
+      severityRank[id] = value in SEVERITY_RANK ? SEVERITY_RANK[value] : 255;
+    });
+    const fileRank = this.tables.file.ranks();
+    const ruleRank = this.tables.rule.ranks();
+    const byLocation = (a, b) => (fileRank[this.file[a]] - fileRank[this.file[b]]) ||
+      (this.startLine[a] - this.startLine[b]) || (this.startColumn[a] - this.startColumn[b]);
+
+    let compare;
+    if (order === 'severity') {
+      compare = (a, b) => (severityRank[this.severity[a]] - severityRank[this.severity[b]]) || byLocation(a, b);
+    } else if (order === 'rule') {
+      compare = (a, b) => (ruleRank[this.rule[a]] - ruleRank[this.rule[b]]) || byLocation(a, b);
+    } else if (order === 'location') {
+      compare = byLocation;
+    } else {
+      throw new Error(`Unknown sort order: ${order}`);
+    }
+    return sorted.sort((a, b) => compare(a, b) || a - b);
+  }
+
+  /**
+   * @returns {number} Approximate bytes held by the store
+   */
+  estimateBytes() {
+    let bytes = this.severity.byteLength;
+    for (const name of NUMERIC_COLUMNS) bytes += this[name].byteLength;
+    for (const table of Object.values(this.tables)) bytes += table.estimateBytes();
+    for (const id of this.ids) bytes += id.length * 2 + 16;
+    // Extras are ordinary objects; count them like the JSON they came from
+    for (const extra of this.extras.values()) bytes += JSON.stringify(extra).length * 2;
+    return bytes;
+  }
+}
+
+module.exports = { DiagnosticStore, StringTable, fileMatcher };
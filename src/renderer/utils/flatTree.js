@@ -0,0 +1,128 @@
+/**
+ * Flattened view of a nested file tree
+ *
+ * The tree from 'get-file-tree' is kept as is; what is visible is a flat
+ * list of rows (node and depth in two parallel arrays) derived from the
+ * set of expanded directory paths. Expanding or collapsing walks only the
+ * directory's visible descendants and splices them in or out; the splice
+ * copies the visible rows once (a flat array move, no tree walk), so the
+ * cost grows with the visible rows, never with collapsed subtrees. Expansion
+ * is keyed by path and therefore survives a refresh that replaces the tree.
+ */
+
+class FlatTree {
+  constructor() {
+    /** @type {Array<Object>} Top-level nodes { name, path, type, children } */
+    this.roots = [];
+    /** @type {Set<string>} Paths of expanded directories */
+    this.expanded = new Set();
+    /** @type {Array<Object>} Visible nodes in display order */
+    this.nodes = [];
+    /** @type {Array<number>} Depth of each visible node */
+    this.depths = [];
+  }
+
+  /**
+   * Replace the tree, keeping expanded directories expanded
+   * @param {Array<Object>} tree - Top-level nodes
+   */
+  setTree(tree) {
+    this.roots = tree || [];
+    this.nodes = [];
+    this.depths = [];
+    this.appendVisible(this.roots, 0, this.nodes, this.depths);
+  }
+
+  /**
+   * @returns {number} Number of visible rows
+   */
+  get rowCount() {
+    return this.nodes.length;
+  }
+
+  /**
+   * @param {Object} node - Tree node
+   * @returns {boolean} Whether the node is an expanded directory
+   */
+  isExpanded(node) {
+    return node.type === 'directory' && this.expanded.has(node.path);
+  }
+
+  /**
+   * Append the visible rows of a list of siblings
+   * @param {Array<Object>} children - Sibling nodes
+   * @param {number} depth - Their depth
+   * @param {Array<Object>} nodes - Output nodes
+   * @param {Array<number>} depths - Output depths
+   * @private
+   */
+  appendVisible(children, depth, nodes, depths) {
+    for (const node of children) {
+      nodes.push(node);
+      depths.push(depth);
+      if (this.isExpanded(node) && node.children) {
+        this.appendVisible(node.children, depth + 1, nodes, depths);
+      }
+    }
+  }
+
+  /**
+   * Number of visible descendants below a row
+   * @param {number} index - Row index
+   * @returns {number} Row count
+   * @private
+   */
+  visibleDescendants(index) {
+    const depth = this.depths[index];
+    let end = index + 1;
+    while (end < this.depths.length && this.depths[end] > depth) end++;
+    return end - index - 1;
+  }
+
+  /**
+   * Expand the directory at a row
+   * @param {number} index - Row index
+   * @returns {boolean} Whether rows changed
+   */
+  expand(index) {
+    const node = this.nodes[index];
+    if (!node || node.type !== 'directory' || this.isExpanded(node)) return false;
+    this.expanded.add(node.path);
+
+    const nodes = [];
+    const depths = [];
+    this.appendVisible(node.children || [], this.depths[index] + 1, nodes, depths);
+    // concat rather than splice(...rows): a spread of 100k+ arguments overflows the stack
+    this.nodes = this.nodes.slice(0, index + 1).concat(nodes, this.nodes.slice(index + 1));
+    this.depths = this.depths.slice(0, index + 1).concat(depths, this.depths.slice(index + 1));
+    return true;
+  }
+
+  /**
+   * Collapse the directory at a row; nested directories keep their state
+   * @param {number} index - Row index
+   * @returns {boolean} Whether rows changed
+   */
+  collapse(index) {
+    const node = this.nodes[index];
+    if (!node || !this.isExpanded(node)) return false;
+    const count = this.visibleDescendants(index);
+    this.expanded.delete(node.path);
+    this.nodes.splice(index + 1, count);
+    this.depths.splice(index + 1, count);
+    return true;
+  }
+
+  /**
+   * Expand or collapse the directory at a row
+   * @param {number} index - Row index
+   * @returns {boolean} Whether rows changed
+   */
+  toggle(index) {
+    const node = this.nodes[index];
+    if (!node) return false;
+    return this.isExpanded(node) ? this.collapse(index) : this.expand(index);
+  }
+}
+
+module.exports = { FlatTree };
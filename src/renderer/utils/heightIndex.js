@@ -0,0 +1,86 @@
+/**
+ * Height Index - Offsets of variable-height rows
+ *
+ * Virtualized lists whose rows differ in height (e.g. diagnostics with an
+ * explanation attached) need the offset of a row and the row at an
+ * offset. Heights start at an estimate and are corrected as rows are
+ * measured; a Fenwick tree keeps both lookups and every correction at
+ * O(log n), so a list of a million rows scrolls as cheaply as ten.
+ */
+
+class HeightIndex {
+  /**
+   * @param {number} count - Number of rows
+   * @param {number} estimate - Height assumed for rows not measured yet
+   */
+  constructor(count, estimate) {
+    this.count = count;
+    this.heights = new Float64Array(count).fill(estimate);
+    this.tree = new Float64Array(count + 1);
+    this.total = count * estimate;
+    // Linear build: every node passes its sum on to its parent
+    for (let i = 1; i <= count; i++) {
+      this.tree[i] += estimate;
+      const parent = i + (i & -i);
+      if (parent <= count) this.tree[parent] += this.tree[i];
+    }
+  }
+
+  /**
+   * @param {number} index - Row index
+   * @returns {number} Current height of the row
+   */
+  heightOf(index) {
+    return this.heights[index];
+  }
+
+  /**
+   * Record the measured height of a row
+   * @param {number} index - Row index
+   * @param {number} height - Height in px
+   * @returns {number} Change from the previous height
+   */
+  set(index, height) {
+    const delta = height - this.heights[index];
+    if (delta === 0) return 0;
+    this.heights[index] = height;
+    this.total += delta;
+    for (let i = index + 1; i <= this.count; i += i & -i) {
+      this.tree[i] += delta;
+    }
+    return delta;
+  }
+
+  /**
+   * @param {number} index - Row index
+   * @returns {number} Sum of the heights of the rows before it
+   */
+  offsetOf(index) {
+    let offset = 0;
+    for (let i = Math.min(index, this.count); i > 0; i -= i & -i) {
+      offset += this.tree[i];
+    }
+    return offset;
+  }
+
+  /**
+   * @param {number} offset - Offset from the top of the list in px
+   * @returns {number} Row covering the offset, clamped to the last row
+   */
+  indexAt(offset) {
+    let index = 0;
+    let remaining = offset;
+    let step = 1;
+    while (step * 2 <= this.count) step *= 2;
+    for (; step > 0; step >>= 1) {
+      const next = index + step;
+      if (next <= this.count && this.tree[next] <= remaining) {
+        index = next;
+        remaining -= this.tree[next];
+      }
+    }
+    return Math.max(0, Math.min(index, this.count - 1));
+  }
+}
+
+module.exports = { HeightIndex };
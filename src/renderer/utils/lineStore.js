@@ -0,0 +1,97 @@
+/**
+ * Paged ring of output lines
+ *
+ * Lines are appended to fixed-size pages; once the store holds more than
+ * its capacity the oldest page is dropped as a whole, so memory stays
+ * bounded however long a run is and nothing is ever copied. Lines are
+ * addressed by absolute number (counting dropped ones), which stays valid
+ * for search results while the ring moves on.
+ */
+
+/** Lines kept by default */
+const DEFAULT_CAPACITY = 1000000;
+
+/** Lines per page */
+const PAGE_SIZE = 4096;
+
+class LineStore {
+  /**
+   * @param {Object} [options] - { capacity, pageSize }
+   */
+  constructor(options = {}) {
+    this.capacity = options.capacity || DEFAULT_CAPACITY;
+    this.pageSize = options.pageSize || PAGE_SIZE;
+    this.clear();
+  }
+
+  clear() {
+    /** @type {Array<Array<Object>>} Pages, oldest first; all but the last are full */
+    this.pages = [[]];
+    /** Number of lines dropped from the front */
+    this.dropped = 0;
+    this.length = 0;
+  }
+
+  /**
+   * @returns {number} Absolute number of the oldest line kept
+   */
+  get first() {
+    return this.dropped;
+  }
+
+  /**
+   * @returns {number} Absolute number after the newest line
+   */
+  get end() {
+    return this.dropped + this.length;
+  }
+
+  /**
+   * @param {Array<Object>} lines - Lines to append
+   */
+  push(lines) {
+    for (const line of lines) {
+      let page = this.pages[this.pages.length - 1];
+      if (page.length === this.pageSize) {
+        page = [];
+        this.pages.push(page);
+      }
+      page.push(line);
+      this.length++;
+    }
+    while (this.length - this.pages[0].length >= this.capacity) {
+      const oldest = this.pages.shift();
+      this.dropped += oldest.length;
+      this.length -= oldest.length;
+    }
+  }
+
+  /**
+   * @param {number} lineNumber - Absolute line number
+   * @returns {Object|undefined} Line, or undefined when dropped or not yet written
+   */
+  get(lineNumber) {
+    const index = lineNumber - this.dropped;
+    if (index < 0 || index >= this.length) return undefined;
+    return this.pages[Math.floor(index / this.pageSize)][index % this.pageSize];
+  }
+
+  /**
+   * Find lines containing a term
+   * @param {string} query - Lower-case term
+   * @param {number} from - First absolute line number to scan
+   * @param {number} to - Absolute line number to stop before
+   * @returns {Array<number>} Absolute numbers of matching lines
+   */
+  search(query, from, to) {
+    const matches = [];
+    const start = Math.max(from, this.first);
+    const stop = Math.min(to, this.end);
+    for (let n = start; n < stop; n++) {
+      if (this.get(n).text.toLowerCase().includes(query)) matches.push(n);
+    }
+    return matches;
+  }
+}
+
+module.exports = { LineStore };
@@ -0,0 +1,21 @@
+/**
+ * Renderer side of the application logger. Entries stay in the renderer's
+ * ring buffer and are forwarded in batches to the main process, which
+ * writes them to the log file next to its own.
+ */
+const { logger, createForwardSink, getLogger } = require('../../main/utils/logger');
+
+let forwardSink = null;
+if (typeof window !== 'undefined' && window.ipcRenderer) {
+  forwardSink = createForwardSink(entries => window.ipcRenderer.send('log-entries', entries));
+  logger.addSink(forwardSink);
+}
+
+/**
+ * Send pending renderer entries to the main process now
+ */
+function flushToMain() {
+  if (forwardSink) forwardSink.flush();
+}
+
+module.exports = { logger, getLogger, flushToMain };
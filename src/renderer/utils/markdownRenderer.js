@@ -0,0 +1,434 @@
+/**
+ * Markdown renderer for assistant replies.
+ *
+ * The text is parsed line by line into block events so a reply can be
+ * rendered incrementally while it is being typed or streamed: completed
+ * lines are appended to the DOM once, code blocks are highlighted once when
+ * their closing fence arrives, and only the unfinished last line is
+ * re-rendered on each animation frame.
+ */
+
+const { applySyntaxHighlight } = require('./syntaxHighlighter');
+
+const FENCE = '```';
+const OPEN_FENCE_REGEX = /^```(\w+)?\s*$/;
+const HEADING_REGEX = /^(#{1,3}) (.+)$/;
+const BULLET_REGEX = /^[-*] (.+)$/;
+const ORDERED_REGEX = /^\d+\. (.+)$/;
+
+const HEADING_STYLES = {
+  1: 'margin:16px 0 12px 0; font-size:20px; font-weight:600; color:#f0f6fc;',
+  2: 'margin:14px 0 10px 0; font-size:18px; font-weight:600; color:#f0f6fc;',
+  3: 'margin:12px 0 8px 0; font-size:16px; font-weight:600; color:#f0f6fc;'
+};
+const LIST_STYLE = 'margin:8px 0; padding-left:0;';
+const CODE_PRE_STYLE = 'background:#0d1117; padding:12px; border-radius:6px; overflow-x:auto;';
+const CODE_STYLE = "font-family:Consolas,Monaco,'Courier New',monospace; font-size:13px; color:#c9d1d9;";
+
+/**
+ * Escape HTML special characters
+ * @param {string} text - Raw text
+ * @returns {string} Escaped text
+ */
+function escapeHtml(text) {
+  return text.replace(/&/g, '&amp;')
+             .replace(/</g, '&lt;')
+             .replace(/>/g, '&gt;');
+}
+
+/**
+ * Render inline markup (code spans, bold, italic) for a single line
+ * @param {string} text - Raw line text
+ * @returns {string} HTML string
+ */
+function renderInline(text) {
+  let html = escapeHtml(text);
+
+  // Inline code (`code`)
+  html = html.replace(/`([^`]+)`/g, '<code style="background:#21262d; padding:2px 6px; border-radius:3px; font-family:Consolas,Monaco,monospace; font-size:13px; color:#f0f6fc;">$1</code>');
+
+  // Bold (**text** or __text__)
+  html = html.replace(/\*\*([^*]+)\*\*/g, '<strong>$1</strong>');
+  html = html.replace(/__([^_]+)__/g, '<strong>$1</strong>');
+
+  // Italic (*text* or _text_)
+  html = html.replace(/\*([^*]+)\*/g, '<em>$1</em>');
+  html = html.replace(/_([^_]+)_/g, '<em>$1</em>');
+
+  return html;
+}
+
+/**
+ * Render a finished code block with language label and Copy/Replace actions
+ * @param {string} code - Code block content
+ * @param {string} lang - Language tag from the opening fence
+ * @returns {string} HTML string
+ */
+function renderCodeBlock(code, lang) {
+  lang = (lang || '').toLowerCase();
+
+  // Store original code in base64 to avoid any escaping issues
+  const base64Code = btoa(unescape(encodeURIComponent(code)));
+
+  // Apply syntax highlighting for C/C++ code
+  let displayCode;
+  if (lang === 'c' || lang === 'cpp' || lang === 'c++') {
+    displayCode = applySyntaxHighlight(code, lang === 'c' ? 'C' : 'C++');
+  } else {
+    displayCode = escapeHtml(code);
+  }
+
+  const langLabel = lang ? `<span style="position:absolute; top:8px; left:12px; font-size:10px; color:#7d8590; text-transform:uppercase; font-weight:600;">${lang}</span>` : '';
+
+  return `<div style="position:relative; margin:8px 0;">
+          ${langLabel}
+          <div style="position:absolute; top:8px; right:8px; display:flex; gap:6px;">
+            <button class="code-copy-btn" data-code-b64="${base64Code}" style="padding:4px 8px; background:#21262d; border:1px solid #30363d; color:#f0f6fc; border-radius:4px; cursor:pointer; font-size:11px;">Copy</button>
+            <button class="code-replace-btn" data-code-b64="${base64Code}" style="padding:4px 8px; background:#238636; border:1px solid #2ea043; color:#fff; border-radius:4px; cursor:pointer; font-size:11px;">Replace</button>
+          </div>
+          <pre style="${CODE_PRE_STYLE} padding-top:${lang ? '28px' : '12px'};"><code style="${CODE_STYLE}">${displayCode}</code></pre>
+        </div>`;
+}
+
+/**
+ * Render the HTML of a non-list, non-code block event
+ * @param {Object} event - Block event from MarkdownStreamParser
+ * @returns {string} HTML string
+ */
+function renderBlock(event) {
+  switch (event.type) {
+    case 'heading':
+      return `<h${event.level} style="${HEADING_STYLES[event.level]}">${event.html}</h${event.level}>`;
+    case 'break':
+      return '<br><br>';
+    case 'line':
+      return event.html + '\n';
+    default:
+      return '';
+  }
+}
+
+/**
+ * Render a list item
+ * @param {Object} event - 'listItem' event
+ * @returns {string} HTML string
+ */
+function renderListItem(event) {
+  const style = event.ordered ? 'margin-left:20px; list-style-type:decimal;' : 'margin-left:20px;';
+  return `<li style="${style}">${event.html}</li>`;
+}
+
+/**
+ * Line-oriented markdown parser that can be fed text in arbitrary chunks.
+ * Emits block events for every completed line:
+ *   { type: 'heading', level, html }
+ *   { type: 'listItem', ordered, html }
+ *   { type: 'line', html }
+ *   { type: 'break' }
+ *   { type: 'codeStart', lang }
+ *   { type: 'codeLine', text }
+ *   { type: 'codeEnd', lang, code }
+ */
+class MarkdownStreamParser {
+  constructor() {
+    this.buffer = '';
+    this.inCode = false;
+    this.codeLang = '';
+    this.codeLines = [];
+    this.started = false;
+    this.pendingBreak = false;
+  }
+
+  /**
+   * Feed more text
+   * @param {string} chunk - Text to append
+   * @returns {Array<Object>} Events for the lines completed by this chunk
+   */
+  push(chunk) {
+    const events = [];
+    this.buffer += chunk;
+
+    let newline = this.buffer.indexOf('\n');
+    if (newline === -1) return events;
+
+    let start = 0;
+    while (newline !== -1) {
+      this.parseLine(this.buffer.slice(start, newline), events);
+      start = newline + 1;
+      newline = this.buffer.indexOf('\n', start);
+    }
+    this.buffer = this.buffer.slice(start);
+    return events;
+  }
+
+  /**
+   * Flush the unfinished last line and close an unterminated code block
+   * @returns {Array<Object>} Remaining events
+   */
+  finish() {
+    const events = [];
+    if (this.buffer) {
+      this.parseLine(this.buffer, events);
+      this.buffer = '';
+    }
+    if (this.inCode) {
+      this.closeCode(events);
+    }
+    return events;
+  }
+
+  /**
+   * @returns {Object} The unfinished last line { text, inCode }
+   */
+  getTail() {
+    return { text: this.buffer, inCode: this.inCode };
+  }
+
+  /**
+   * Parse one complete line
+   * @param {string} line - Line without its newline
+   * @param {Array<Object>} events - Output event list
+   * @private
+   */
+  parseLine(line, events) {
+    if (line.endsWith('\r')) line = line.slice(0, -1);
+
+    if (this.inCode) {
+      const fence = line.indexOf(FENCE);
+      if (fence === -1) {
+        this.codeLines.push(line);
+        events.push({ type: 'codeLine', text: line });
+        return;
+      }
+      if (fence > 0) {
+        this.codeLines.push(line.slice(0, fence));
+        events.push({ type: 'codeLine', text: line.slice(0, fence) });
+      }
+      this.closeCode(events);
+      const rest = line.slice(fence + FENCE.length);
+      if (rest.trim()) this.parseLine(rest, events);
+      return;
+    }
+
+    // Leading blank lines are dropped; runs of blank lines collapse into one break
+    if (!line.trim()) {
+      if (this.started) this.pendingBreak = true;
+      return;
+    }
+    if (this.pendingBreak) {
+      events.push({ type: 'break' });
+      this.pendingBreak = false;
+    }
+    this.started = true;
+
+    const fence = line.match(OPEN_FENCE_REGEX);
+    if (fence) {
+      this.inCode = true;
+      this.codeLang = fence[1] || '';
+      this.codeLines = [];
+      events.push({ type: 'codeStart', lang: this.codeLang });
+      return;
+    }
+
+    const heading = line.match(HEADING_REGEX);
+    if (heading) {
+      events.push({ type: 'heading', level: heading[1].length, html: renderInline(heading[2]) });
+      return;
+    }
+
+    const bullet = line.match(BULLET_REGEX);
+    if (bullet) {
+      events.push({ type: 'listItem', ordered: false, html: renderInline(bullet[1]) });
+      return;
+    }
+
+    const ordered = line.match(ORDERED_REGEX);
+    if (ordered) {
+      events.push({ type: 'listItem', ordered: true, html: renderInline(ordered[1]) });
+      return;
+    }
+
+    events.push({ type: 'line', html: renderInline(line) });
+  }
+
+  /**
+   * @param {Array<Object>} events - Output event list
+   * @private
+   */
+  closeCode(events) {
+    events.push({ type: 'codeEnd', lang: this.codeLang, code: this.codeLines.join('\n').trim() });
+    this.inCode = false;
+    this.codeLang = '';
+    this.codeLines = [];
+  }
+}
+
+/**
+ * Render a complete markdown text to an HTML string
+ * @param {string} text - Markdown text
+ * @returns {string} HTML string
+ */
+function renderMarkdown(text) {
+  const parser = new MarkdownStreamParser();
+  const events = parser.push((text || '').trim());
+  events.push(...parser.finish());
+
+  let html = '';
+  let listOpen = false;
+  for (const event of events) {
+    if (event.type === 'listItem') {
+      if (!listOpen) html += `<ul style="${LIST_STYLE}">`;
+      listOpen = true;
+      html += renderListItem(event);
+      continue;
+    }
+    if (listOpen) {
+      html += '</ul>';
+      listOpen = false;
+    }
+    if (event.type === 'codeEnd') {
+      html += renderCodeBlock(event.code, event.lang);
+    } else {
+      html += renderBlock(event);
+    }
+  }
+  if (listOpen) html += '</ul>';
+  return html;
+}
+
+/**
+ * Renders markdown into an element as text arrives.
+ * Writes are buffered and applied at most once per animation frame.
+ */
+class IncrementalMarkdownRenderer {
+  /**
+   * @param {HTMLElement} element - Target element (message bubble)
+   * @param {Object} options - { onFlush: called after each DOM update }
+   */
+  constructor(element, options = {}) {
+    this.element = element;
+    this.onFlush = options.onFlush || null;
+    this.parser = new MarkdownStreamParser();
+    this.pending = '';
+    this.frame = null;
+    this.currentList = null;
+    this.openCode = null;
+    this.tail = document.createElement('span');
+    this.element.innerHTML = '';
+  }
+
+  /**
+   * Queue text for rendering on the next animation frame
+   * @param {string} chunk - Text to append
+   */
+  write(chunk) {
+    this.pending += chunk;
+    if (this.frame === null) {
+      this.frame = requestAnimationFrame(() => {
+        this.frame = null;
+        this.flush();
+      });
+    }
+  }
+
+  /**
+   * Apply all queued text to the DOM now
+   */
+  flush() {
+    if (this.frame !== null) {
+      cancelAnimationFrame(this.frame);
+      this.frame = null;
+    }
+    if (this.pending) {
+      const chunk = this.pending;
+      this.pending = '';
+      this.apply(this.parser.push(chunk));
+    }
+    this.renderTail();
+    if (this.onFlush) this.onFlush();
+  }
+
+  /**
+   * Flush everything, including the unfinished last line
+   */
+  end() {
+    this.flush();
+    this.apply(this.parser.finish());
+    this.tail.remove();
+    if (this.onFlush) this.onFlush();
+  }
+
+  /**
+   * Append block events to the DOM
+   * @param {Array<Object>} events - Events from MarkdownStreamParser
+   * @private
+   */
+  apply(events) {
+    if (events.length === 0) return;
+    this.tail.remove();
+
+    for (const event of events) {
+      if (event.type === 'listItem') {
+        if (!this.currentList) {
+          this.currentList = document.createElement('ul');
+          this.currentList.style.cssText = LIST_STYLE;
+          this.element.appendChild(this.currentList);
+        }
+        this.currentList.insertAdjacentHTML('beforeend', renderListItem(event));
+        continue;
+      }
+      this.currentList = null;
+
+      if (event.type === 'codeStart') {
+        // Plain text while the block streams in; highlighted once when it closes
+        const pre = document.createElement('pre');
+        pre.style.cssText = CODE_PRE_STYLE;
+        const code = document.createElement('code');
+        code.style.cssText = CODE_STYLE;
+        pre.appendChild(code);
+        this.element.appendChild(pre);
+        this.openCode = { pre, code, lineCount: 0 };
+      } else if (event.type === 'codeLine') {
+        if (this.openCode) {
+          const prefix = this.openCode.lineCount++ > 0 ? '\n' : '';
+          this.openCode.code.appendChild(document.createTextNode(prefix + event.text));
+        }
+      } else if (event.type === 'codeEnd') {
+        if (this.openCode) {
+          this.openCode.pre.insertAdjacentHTML('afterend', renderCodeBlock(event.code, event.lang));
+          this.openCode.pre.remove();
+          this.openCode = null;
+        }
+      } else {
+        this.element.insertAdjacentHTML('beforeend', renderBlock(event));
+      }
+    }
+  }
+
+  /**
+   * Re-render only the unfinished last line
+   * @private
+   */
+  renderTail() {
+    const { text, inCode } = this.parser.getTail();
+    if (!text) {
+      this.tail.remove();
+      return;
+    }
+    if (inCode && this.openCode) {
+      this.tail.textContent = (this.openCode.lineCount > 0 ? '\n' : '') + text;
+      if (this.tail.parentNode !== this.openCode.code) this.openCode.code.appendChild(this.tail);
+    } else {
+      this.tail.innerHTML = renderInline(text);
+      if (this.tail.parentNode !== this.element) this.element.appendChild(this.tail);
+    }
+  }
+}
+
+module.exports = {
+  renderMarkdown,
+  renderInline,
+  renderCodeBlock,
+  MarkdownStreamParser,
+  IncrementalMarkdownRenderer
+};
@@ -0,0 +1,260 @@
+/**
+ * Renderer responsiveness monitor
+ *
+ * Observes long tasks (main thread blocked for more than 50 ms) and event
+ * timing (input to next paint) with PerformanceObserver. Managers mark
+ * their expensive operations with measure() or instrument(); a long task
+ * is attributed to the marked operation it overlaps most, so the report
+ * says "renderDiagnostics blocked 180 ms" rather than just "a long task".
+ * Input-to-paint latencies feed a rolling histogram that can be exported
+ * and compared between releases.
+ */
+
+const { getLogger } = require('./logger');
+
+const log = getLogger('perf');
+
+/** A task longer than this blocks input (the long task threshold) */
+const FRAME_BUDGET_MS = 50;
+
+/** Long tasks from this duration on are logged as warnings */
+const SLOW_TASK_MS = 200;
+
+/** Histogram bucket upper bounds for input-to-paint latency, in ms */
+const LATENCY_BUCKETS = [16, 32, 50, 100, 200, 300, 500, 1000, Infinity];
+
+/** Input latencies kept in the rolling window */
+const LATENCY_WINDOW = 1000;
+
+/** Recent marked operations kept for attribution */
+const OPERATION_WINDOW = 200;
+
+/** Long tasks within this period count toward the status indicator */
+const RECENT_WINDOW_MS = 10000;
+
+/**
+ * Rolling histogram of latencies
+ */
+class LatencyHistogram {
+  /**
+   * @param {number} windowSize - Samples kept
+   */
+  constructor(windowSize = LATENCY_WINDOW) {
+    this.samples = new Float64Array(windowSize);
+    this.next = 0;
+    this.count = 0;
+  }
+
+  /**
+   * @param {number} ms - Latency sample
+   */
+  add(ms) {
+    this.samples[this.next] = ms;
+    this.next = (this.next + 1) % this.samples.length;
+    if (this.count < this.samples.length) this.count++;
+  }
+
+  /**
+   * @returns {Object} { count, buckets: [{ le, count }], p50, p75, p95, p99, max }
+   */
+  summary() {
+    const values = Array.from(this.samples.subarray(0, this.count)).sort((a, b) => a - b);
+    const buckets = LATENCY_BUCKETS.map(le => ({ le: le === Infinity ? '+Inf' : le, count: 0 }));
+    for (const value of values) {
+      buckets[LATENCY_BUCKETS.findIndex(le => value <= le)].count++;
+    }
+    const percentile = (p) => values.length === 0 ? null : values[Math.min(values.length - 1, Math.ceil(p * values.length) - 1)];
+    return {
+      count: values.length,
+      buckets,
+      p50: percentile(0.5),
+      p75: percentile(0.75),
+      p95: percentile(0.95),
+      p99: percentile(0.99),
+      max: values.length ? values[values.length - 1] : null
+    };
+  }
+
+  clear() {
+    this.next = 0;
+    this.count = 0;
+  }
+}
+
+/**
+ * Long task and input latency monitor
+ */
+class PerfMonitor {
+  /**
+   * @param {Object} options - { now } clock, replaceable in tests
+   */
+  constructor(options = {}) {
+    this.now = options.now || (() => performance.now());
+    /** Ring of recent operations { name, start, end } */
+    this.operations = new Array(OPERATION_WINDOW);
+    this.operationIndex = 0;
+    this.latency = new LatencyHistogram();
+    /** @type {Map<string, Object>} attribution -> { count, totalMs, maxMs } */
+    this.longTasks = new Map();
+    /** Recent long tasks { time, duration, name } for the status indicator */
+    this.recent = [];
+    this.observers = [];
+    this.startedAt = Date.now();
+  }
+
+  /**
+   * Start observing; does nothing where PerformanceObserver is unavailable
+   */
+  start() {
+    if (typeof PerformanceObserver === 'undefined' || this.observers.length > 0) return;
+    const observe = (options, handler) => {
+      try {
+        const observer = new PerformanceObserver(list => list.getEntries().forEach(handler));
+        observer.observe(options);
+        this.observers.push(observer);
+      } catch (error) {
+        log.debug(() => `Performance entry type ${options.type} not supported`);
+      }
+    };
+    observe({ type: 'longtask', buffered: true }, entry => this.recordLongTask(entry.startTime, entry.duration));
+    observe({ type: 'event', durationThreshold: 16, buffered: true }, (entry) => {
+      // Only discrete user input; duration runs from the input to the next paint
+      if (entry.interactionId) this.latency.add(entry.duration);
+    });
+  }
+
+  stop() {
+    this.observers.forEach(observer => observer.disconnect());
+    this.observers = [];
+  }
+
+  /**
+   * Run a synchronous operation and remember when it ran
+   * @param {string} name - Operation name, e.g. 'diagnostics.renderDiagnostics'
+   * @param {Function} fn - Operation
+   * @returns {*} The operation's result
+   */
+  measure(name, fn) {
+    const start = this.now();
+    try {
+      return fn();
+    } finally {
+      this.operations[this.operationIndex] = { name, start, end: this.now() };
+      this.operationIndex = (this.operationIndex + 1) % OPERATION_WINDOW;
+    }
+  }
+
+  /**
+   * Wrap methods so every call is measured. For async methods only the
+   * synchronous part is timed, which is the part that can block input.
+   * @param {Object} target - Object or prototype owning the methods
+   * @param {Array<string>} methods - Method names
+   * @param {string} prefix - Name prefix, e.g. 'diagnostics'
+   */
+  instrument(target, methods, prefix) {
+    const monitor = this;
+    for (const method of methods) {
+      const original = target[method];
+      if (typeof original !== 'function') continue;
+      const name = `${prefix}.${method}`;
+      target[method] = function (...args) {
+        return monitor.measure(name, () => original.apply(this, args));
+      };
+    }
+  }
+
+  /**
+   * Attribute a long task to the operation it overlaps most
+   * @param {number} startTime - Task start (performance timeline)
+   * @param {number} duration - Task duration in ms
+   * @returns {string} Attribution
+   */
+  attribute(startTime, duration) {
+    const end = startTime + duration;
+    let best = null;
+    let bestOverlap = 0;
+    for (const operation of this.operations) {
+      if (!operation) continue;
+      const overlap = Math.min(end, operation.end) - Math.max(startTime, operation.start);
+      // On ties the later-starting (innermost) operation is more specific
+      if (overlap > bestOverlap || (overlap > 0 && overlap === bestOverlap && operation.start > best.start)) {
+        best = operation;
+        bestOverlap = overlap;
+      }
+    }
+    return best ? best.name : 'unattributed';
+  }
+
+  /**
+   * Record a long task
+   * @param {number} startTime - Task start (performance timeline)
+   * @param {number} duration - Task duration in ms
+   */
+  recordLongTask(startTime, duration) {
+    const name = this.attribute(startTime, duration);
+    let stats = this.longTasks.get(name);
+    if (!stats) {
+      stats = { count: 0, totalMs: 0, maxMs: 0 };
+      this.longTasks.set(name, stats);
+    }
+    stats.count++;
+    stats.totalMs += duration;
+    stats.maxMs = Math.max(stats.maxMs, duration);
+    this.recent.push({ time: Date.now(), duration, name });
+    if (this.recent.length > OPERATION_WINDOW) this.recent.shift();
+    if (duration >= SLOW_TASK_MS) log.warn(`Long task ${Math.round(duration)} ms in ${name}`);
+    else log.debug(() => `Long task ${Math.round(duration)} ms in ${name}`);
+  }
+
+  /**
+   * Jank over the last few seconds, for the status bar
+   * @returns {Object} { level: 'ok'|'warn'|'bad', longTasks, blockingMs, worst, p75 }
+   */
+  getStatus() {
+    const cutoff = Date.now() - RECENT_WINDOW_MS;
+    while (this.recent.length > 0 && this.recent[0].time < cutoff) this.recent.shift();
+
+    let blockingMs = 0;
+    let worst = null;
+    for (const task of this.recent) {
+      blockingMs += task.duration - FRAME_BUDGET_MS;
+      if (!worst || task.duration > worst.duration) worst = task;
+    }
+    const level = blockingMs === 0 ? 'ok' : blockingMs < 300 ? 'warn' : 'bad';
+    return { level, longTasks: this.recent.length, blockingMs: Math.round(blockingMs), worst, p75: this.latency.summary().p75 };
+  }
+
+  /**
+   * Report for comparing releases
+   * @param {Object} meta - Extra fields such as the application version
+   * @returns {Object} Report
+   */
+  getReport(meta = {}) {
+    const longTasks = Array.from(this.longTasks, ([name, stats]) => ({
+      name,
+      count: stats.count,
+      totalMs: Math.round(stats.totalMs),
+      maxMs: Math.round(stats.maxMs)
+    })).sort((a, b) => b.totalMs - a.totalMs);
+    return {
+      ...meta,
+      exportedAt: new Date().toISOString(),
+      sessionSeconds: Math.round((Date.now() - this.startedAt) / 1000),
+      frameBudgetMs: FRAME_BUDGET_MS,
+      inputToPaint: this.latency.summary(),
+      longTasks
+    };
+  }
+
+  reset() {
+    this.latency.clear();
+    this.longTasks.clear();
+    this.recent = [];
+    this.startedAt = Date.now();
+  }
+}
+
+/** Monitor shared by the managers of this window */
+const perfMonitor = new PerfMonitor();
+
+module.exports = { PerfMonitor, LatencyHistogram, perfMonitor, FRAME_BUDGET_MS };
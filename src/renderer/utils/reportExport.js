@@ -0,0 +1,267 @@
+/**
+ * Streaming report export
+ *
+ * Writers are generator functions over a DiagnosticStore: they read the
+ * columns of one row at a time and yield small pieces of text, so no
+ * diagnostic objects are built and no whole report ever exists as one
+ * string. streamReport() joins the pieces into fixed-size chunks and waits
+ * for each chunk to be written before producing the next, which bounds
+ * memory by the chunk size and lets the page paint between chunks.
+ *
+ * Formats: HTML page, CSV, JUnit XML (one test case per diagnostic, one
+ * suite per file) and SARIF 2.1.0.
+ */
+
+/** Characters per chunk handed to the writer */
+const CHUNK_SIZE = 512 * 1024;
+
+const SARIF_SCHEMA = 'https://json.schemastore.org/sarif-2.1.0.json';
+
+/** Diagnostics severity -> SARIF level */
+const LEVEL_BY_SEVERITY = { ERROR: 'error', WARNING: 'warning', INFO: 'note' };
+
+/** Severities reported as JUnit failures; the rest are passing cases */
+const FAILING_SEVERITIES = new Set(['ERROR', 'WARNING']);
+
+const CSV_COLUMNS = ['severity', 'rule', 'file', 'line', 'column', 'end_line', 'end_column', 'function', 'message', 'tool'];
+
+/** Characters XML 1.0 does not allow, even escaped */
+const XML_INVALID = /[\u0000-\u0008\u000B\u000C\u000E-\u001F\uFFFE\uFFFF]/g;
+
+/**
+ * @param {string} text - Text
+ * @returns {string} Text safe in XML/HTML content and attributes
+ */
+function escapeXml(text) {
+  return String(text).replace(XML_INVALID, '').replace(/[&<>"']/g, c => (
+    { '&': '&amp;', '<': '&lt;', '>': '&gt;', '"': '&quot;', '\'': '&#39;' }[c]
+  ));
+}
+
+/**
+ * @param {string|number} value - Cell value
+ * @returns {string} RFC 4180 field
+ */
+function csvField(value) {
+  const text = String(value);
+  return /[",\r\n]/.test(text) ? `"${text.replace(/"/g, '""')}"` : text;
+}
+
+/**
+ * @param {string} file - Local path as stored in diagnostics
+ * @returns {string} SARIF artifact URI; relative paths stay relative
+ */
+function pathToUri(file) {
+  const normalized = file.replace(/\\/g, '/');
+  const encoded = encodeURI(normalized).replace(/[?#]/g, encodeURIComponent);
+  if (normalized.startsWith('/')) return `file://${encoded}`;
+  if (/^[A-Za-z]:\//.test(normalized)) return `file:///${encoded}`;
+  return encoded;
+}
+
+/**
+ * @param {DiagnosticStore} store - Diagnostics
+ * @param {number} row - Row index
+ * @returns {string} file:line:column
+ */
+function locationText(store, row) {
+  return `${store.textAt('file', row)}:${store.startLine[row]}:${store.startColumn[row]}`;
+}
+
+/**
+ * @param {Object} context - { store, rows, progress }
+ */
+function* csvReport({ store, rows, progress }) {
+  yield `${CSV_COLUMNS.join(',')}\r\n`;
+  for (let i = 0; i < rows.length; i++) {
+    const row = rows[i];
+    yield [
+      store.severityAt(row), store.textAt('rule', row), store.textAt('file', row),
+      store.startLine[row], store.startColumn[row], store.endLine[row], store.endColumn[row],
+      store.textAt('func', row), store.textAt('message', row), store.textAt('tool', row)
+    ].map(csvField).join(',') + '\r\n';
+    progress.rows = i + 1;
+  }
+}
+
+/**
+ * @param {Object} context - { store, rows, meta, rules, progress }
+ */
+function* htmlReport({ store, rows, meta, rules, progress }) {
+  const title = `CTrace report${meta && meta.inputFile ? ` - ${meta.inputFile}` : ''}`;
+  const counts = store.countBySeverity(rows);
+  yield `<!DOCTYPE html>
+<html lang="en">
+<head>
+<meta charset="utf-8">
+<title>${escapeXml(title)}</title>
+<style>
+body { font-family: -apple-system, "Segoe UI", sans-serif; margin: 24px; color: #1f2328; }
+table { border-collapse: collapse; width: 100%; font-size: 13px; }
+th, td { border-bottom: 1px solid #d0d7de; padding: 4px 8px; text-align: left; vertical-align: top; }
+th { background: #f6f8fa; position: sticky; top: 0; }
+.ERROR { color: #cf222e; } .WARNING { color: #bc4c00; } .INFO { color: #0969da; }
+.summary span { margin-right: 16px; }
+</style>
+</head>
+<body>
+<h1>${escapeXml(title)}</h1>
+<p class="summary"><span>${rows.length} diagnostics</span>${Object.entries(counts).map(([severity, count]) => `<span class="${escapeXml(severity)}">${count} ${escapeXml(severity)}</span>`).join('')}${meta && meta.tool ? `<span>Tool: ${escapeXml(meta.tool)}</span>` : ''}</p>
+<table>
+<thead><tr><th>Severity</th><th>Rule</th><th>Location</th><th>Function</th><th>Message</th></tr></thead>
+<tbody>
+`;
+  for (let i = 0; i < rows.length; i++) {
+    const row = rows[i];
+    const severity = store.severityAt(row);
+    const ruleId = store.textAt('rule', row);
+    const rule = rules[ruleId];
+    const ruleCell = rule && /^https?:\/\//i.test(rule.helpUri || '') ? `<a href="${escapeXml(rule.helpUri)}">${escapeXml(ruleId)}</a>` : escapeXml(ruleId);
+    yield `<tr><td class="${escapeXml(severity)}">${escapeXml(severity)}</td><td>${ruleCell}</td>` +
+      `<td>${escapeXml(locationText(store, row))}</td><td>${escapeXml(store.textAt('func', row))}</td>` +
+      `<td>${escapeXml(store.textAt('message', row))}</td></tr>\n`;
+    progress.rows = i + 1;
+  }
+  yield '</tbody>\n</table>\n</body>\n</html>\n';
+}
+
+/**
+ * @param {Object} context - { store, rows, meta, progress }
+ */
+function* junitReport({ store, rows, meta, progress }) {
+  // Suites are per file, so rows are taken grouped by location
+  const sorted = store.sort(rows, 'location');
+  let failures = 0;
+  for (let i = 0; i < sorted.length; i++) {
+    if (FAILING_SEVERITIES.has(store.severityAt(sorted[i]))) failures++;
+  }
+  const name = (meta && meta.tool) || 'ctrace';
+  yield '<?xml version="1.0" encoding="UTF-8"?>\n';
+  yield `<testsuites name="${escapeXml(name)}" tests="${sorted.length}" failures="${failures}">\n`;
+
+  let i = 0;
+  while (i < sorted.length) {
+    const fileId = store.file[sorted[i]];
+    let end = i;
+    let suiteFailures = 0;
+    while (end < sorted.length && store.file[sorted[end]] === fileId) {
+      if (FAILING_SEVERITIES.has(store.severityAt(sorted[end]))) suiteFailures++;
+      end++;
+    }
+    const file = store.textAt('file', sorted[i]) || '(no file)';
+    yield `  <testsuite name="${escapeXml(file)}" tests="${end - i}" failures="${suiteFailures}">\n`;
+    for (; i < end; i++) {
+      const row = sorted[i];
+      const severity = store.severityAt(row);
+      const ruleId = store.textAt('rule', row);
+      const message = store.textAt('message', row);
+      const func = store.textAt('func', row);
+      yield `    <testcase classname="${escapeXml(ruleId)}" name="${escapeXml(`${locationText(store, row)}${func ? ` in ${func}` : ''}`)}">`;
+      if (FAILING_SEVERITIES.has(severity)) {
+        yield `<failure type="${escapeXml(severity)}" message="${escapeXml(message)}">${escapeXml(`${severity} ${ruleId}: ${message}`)}</failure>`;
+      } else {
+        yield `<system-out>${escapeXml(`${severity} ${ruleId}: ${message}`)}</system-out>`;
+      }
+      yield '</testcase>\n';
+      progress.rows = i + 1;
+    }
+    yield '  </testsuite>\n';
+  }
+  yield '</testsuites>\n';
+}
+
+/**
+ * @param {Object} context - { store, rows, meta, rules, progress }
+ */
+function* sarifReport({ store, rows, meta, rules, progress }) {
+  // Rules used by the exported rows, in rule table order
+  const used = new Uint8Array(store.tables.rule.values.length);
+  for (let i = 0; i < rows.length; i++) used[store.rule[rows[i]]] = 1;
+  const ruleIds = store.tables.rule.values.filter((id, index) => used[index] && id);
+  const ruleIndex = new Map(ruleIds.map((id, index) => [id, index]));
+  const ruleDescriptors = ruleIds.map((id) => {
+    const rule = rules[id] || {};
+    const descriptor = { id };
+    if (rule.name) descriptor.name = rule.name;
+    if (rule.shortDescription) descriptor.shortDescription = { text: rule.shortDescription };
+    if (rule.fullDescription) descriptor.fullDescription = { text: rule.fullDescription };
+    if (rule.helpUri) descriptor.helpUri = rule.helpUri;
+    if (rule.defaultLevel) descriptor.defaultConfiguration = { level: rule.defaultLevel };
+    return descriptor;
+  });
+  const driver = { name: (meta && meta.tool) || 'ctrace', rules: ruleDescriptors };
+
+  yield `{"$schema":${JSON.stringify(SARIF_SCHEMA)},"version":"2.1.0","runs":[{"tool":{"driver":${JSON.stringify(driver)}},"results":[`;
+  for (let i = 0; i < rows.length; i++) {
+    const row = rows[i];
+    const ruleId = store.textAt('rule', row);
+    const file = store.textAt('file', row);
+    const func = store.textAt('func', row);
+    const region = {};
+    if (store.startLine[row]) region.startLine = store.startLine[row];
+    if (store.startColumn[row]) region.startColumn = store.startColumn[row];
+    if (store.endLine[row]) region.endLine = store.endLine[row];
+    if (store.endColumn[row]) region.endColumn = store.endColumn[row];
+    const location = {};
+    if (file) location.physicalLocation = { artifactLocation: { uri: pathToUri(file) }, region };
+    if (func) location.logicalLocations = [{ name: func, kind: 'function' }];
+
+    const result = {
+      ruleId,
+      level: LEVEL_BY_SEVERITY[store.severityAt(row)] || 'warning',
+      message: { text: store.textAt('message', row) }
+    };
+    if (ruleIndex.has(ruleId)) result.ruleIndex = ruleIndex.get(ruleId);
+    if (location.physicalLocation || location.logicalLocations) result.locations = [location];
+    yield (i > 0 ? ',' : '') + JSON.stringify(result);
+    progress.rows = i + 1;
+  }
+  yield ']}]}\n';
+}
+
+/** Writer of each export format */
+const EXPORT_FORMATS = {
+  html: htmlReport,
+  csv: csvReport,
+  junit: junitReport,
+  sarif: sarifReport
+};
+
+/**
+ * Write a report chunk by chunk
+ * @param {string} format - Key of EXPORT_FORMATS
+ * @param {Object} source - { store, rows, meta, rules }
+ * @param {Function} write - async (chunk) => void; the next chunk is built once it resolves
+ * @param {Object} [options]
+ * @param {number} [options.chunkSize] - Characters per chunk
+ * @param {Function} [options.onProgress] - (rowsWritten, totalRows) => void, once per chunk
+ * @returns {Promise<Object>} { rows, chars }
+ */
+async function streamReport(format, source, write, { chunkSize = CHUNK_SIZE, onProgress } = {}) {
+  const writer = EXPORT_FORMATS[format];
+  if (!writer) throw new Error(`Unknown export format: ${format}`);
+  const progress = { rows: 0 };
+  const context = { meta: null, rules: {}, ...source, progress };
+
+  let parts = [];
+  let pending = 0;
+  let chars = 0;
+  const flush = async () => {
+    const chunk = parts.join('');
+    parts = [];
+    pending = 0;
+    chars += chunk.length;
+    await write(chunk);
+    if (onProgress) onProgress(progress.rows, source.rows.length);
+  };
+
+  for (const piece of writer(context)) {
+    parts.push(piece);
+    pending += piece.length;
+    if (pending >= chunkSize) await flush();
+  }
+  if (pending > 0) await flush();
+  return { rows: progress.rows, chars };
+}
+
+module.exports = { EXPORT_FORMATS, streamReport, escapeXml, csvField, pathToUri };
@@ -53,133 +53,210 @@ function escapeHtml(text) {
 }
 
 /**
- * Tokenize C/C++ code for highlighting
- * @param {string} code - The code to tokenize
+ * Lexer states carried across line boundaries.
+ * States are short strings so that convergence checks are a cheap `===`.
+ * Raw strings append their delimiter ('r' + delim) and continued string
+ * literals append their quote character ('s' + quote).
+ */
+const LINE_STATE_NORMAL = '';
+const LINE_STATE_BLOCK_COMMENT = 'c';
+const LINE_STATE_PREPROCESSOR = 'p';
+
+const RAW_STRING_PREFIX = /^(?:u8|[uUL])?R$/;
+const OPERATOR_CHARS = '+-*/%=<>!&|^~?:';
+
+function isDigitCode(c) {
+  return c >= 48 && c <= 57;
+}
+
+function isIdentStartCode(c) {
+  return (c >= 65 && c <= 90) || (c >= 97 && c <= 122) || c === 95;
+}
+
+function isIdentPartCode(c) {
+  return isIdentStartCode(c) || isDigitCode(c);
+}
+
+function isSpaceCode(c) {
+  return c === 32 || c === 9 || c === 13 || c === 11 || c === 12;
+}
+
+function isNumberPartCode(c) {
+  // [\d.xXa-fA-F]
+  return isDigitCode(c) || c === 46 || c === 120 || c === 88 ||
+    (c >= 97 && c <= 102) || (c >= 65 && c <= 70);
+}
+
+/**
+ * Check whether a line ends with a backslash continuation (ignoring a trailing CR)
+ * @param {string} line - Line text
+ * @returns {boolean}
+ */
+function endsWithContinuation(line) {
+  let end = line.length - 1;
+  if (end >= 0 && line.charCodeAt(end) === 13) end--;
+  return end >= 0 && line.charCodeAt(end) === 92;
+}
+
+/**
+ * Scan a quoted literal body starting after the opening quote
+ * @param {string} line - Line text
+ * @param {number} start - Index of the first character after the quote
+ * @param {string} quote - Quote character
+ * @returns {{end: number, open: boolean}} End index (exclusive) and whether it continues on the next line
+ */
+function scanQuoted(line, start, quote) {
+  let i = start;
+  while (i < line.length) {
+    const ch = line[i];
+    if (ch === '\\') {
+      if (i + 1 >= line.length || (i + 2 === line.length && line.charCodeAt(i + 1) === 13)) {
+        return { end: line.length, open: true };
+      }
+      i += 2;
+    } else if (ch === quote) {
+      return { end: i + 1, open: false };
+    } else {
+      i++;
+    }
+  }
+  // Unterminated literal ends at the line break
+  return { end: line.length, open: false };
+}
+
+/**
+ * Tokenize a single line of C/C++ code starting from a given lexer state
+ * @param {string} line - Line text without the trailing newline
+ * @param {string} state - Lexer state at the start of the line
  * @param {Object} langConfig - Language configuration
- * @returns {Array} - Array of tokens with type and value
+ * @returns {{tokens: Array, state: string}} Tokens and the lexer state at the end of the line
  */
-function tokenizeCpp(code, langConfig) {
+function tokenizeLine(line, state, langConfig) {
   const tokens = [];
+  const len = line.length;
   let i = 0;
-  
-  while (i < code.length) {
-    const char = code[i];
-    
+  let inDirective = state === LINE_STATE_PREPROCESSOR;
+
+  // Resume constructs left open by the previous line
+  if (state === LINE_STATE_BLOCK_COMMENT) {
+    const end = line.indexOf('*/');
+    if (end === -1) {
+      if (len > 0) tokens.push({ type: 'comment', value: line });
+      return { tokens, state: LINE_STATE_BLOCK_COMMENT };
+    }
+    tokens.push({ type: 'comment', value: line.slice(0, end + 2) });
+    i = end + 2;
+  } else if (state.charAt(0) === 'r') {
+    const terminator = ')' + state.slice(1) + '"';
+    const end = line.indexOf(terminator);
+    if (end === -1) {
+      if (len > 0) tokens.push({ type: 'string', value: line });
+      return { tokens, state };
+    }
+    tokens.push({ type: 'string', value: line.slice(0, end + terminator.length) });
+    i = end + terminator.length;
+  } else if (state.charAt(0) === 's') {
+    const scan = scanQuoted(line, 0, state.charAt(1));
+    if (scan.end > 0) tokens.push({ type: 'string', value: line.slice(0, scan.end) });
+    if (scan.open) return { tokens, state };
+    i = scan.end;
+  }
+
+  while (i < len) {
+    const ch = line[i];
+    const code = line.charCodeAt(i);
+
     // Single-line comment
-    if (code.substr(i, 2) === '//') {
-      let comment = '//';
-      i += 2;
-      while (i < code.length && code[i] !== '\n') {
-        comment += code[i];
-        i++;
-      }
-      tokens.push({ type: 'comment', value: comment });
-      continue;
+    if (ch === '/' && line[i + 1] === '/') {
+      tokens.push({ type: 'comment', value: line.slice(i) });
+      i = len;
+      break;
     }
-    
+
     // Multi-line comment
-    if (code.substr(i, 2) === '/*') {
-      let comment = '/*';
-      i += 2;
-      while (i < code.length && code.substr(i, 2) !== '*/') {
-        comment += code[i];
-        i++;
+    if (ch === '/' && line[i + 1] === '*') {
+      const end = line.indexOf('*/', i + 2);
+      if (end === -1) {
+        tokens.push({ type: 'comment', value: line.slice(i) });
+        return { tokens, state: LINE_STATE_BLOCK_COMMENT };
       }
-      if (code.substr(i, 2) === '*/') {
-        comment += '*/';
-        i += 2;
-      }
-      tokens.push({ type: 'comment', value: comment });
+      tokens.push({ type: 'comment', value: line.slice(i, end + 2) });
+      i = end + 2;
       continue;
     }
-    
+
     // String literals
-    if (char === '"' || char === "'") {
-      const quote = char;
-      let str = quote;
-      i++;
-      while (i < code.length) {
-        if (code[i] === '\\' && i + 1 < code.length) {
-          str += code[i] + code[i + 1];
-          i += 2;
-        } else if (code[i] === quote) {
-          str += quote;
-          i++;
-          break;
-        } else {
-          str += code[i];
-          i++;
-        }
-      }
-      tokens.push({ type: 'string', value: str });
+    if (ch === '"' || ch === "'") {
+      const scan = scanQuoted(line, i + 1, ch);
+      tokens.push({ type: 'string', value: line.slice(i, scan.end) });
+      if (scan.open) return { tokens, state: 's' + ch };
+      i = scan.end;
       continue;
     }
-    
-    // Preprocessor directives
-    if (char === '#') {
-      let directive = '#';
-      i++;
-      while (i < code.length && /[a-zA-Z_]/.test(code[i])) {
-        directive += code[i];
-        i++;
-      }
+
+    // Preprocessor directives (inside a directive body '#' is the stringize operator)
+    if (ch === '#' && !inDirective) {
+      let j = i + 1;
+      while (j < len && (isIdentStartCode(line.charCodeAt(j)))) j++;
+      const directive = line.slice(i, j);
       tokens.push({ type: 'preprocessor', value: directive });
-      
+      i = j;
+      inDirective = true;
+
       // For #include, capture the file path
       if (directive.includes('include')) {
-        while (i < code.length && /\s/.test(code[i])) {
-          tokens.push({ type: 'whitespace', value: code[i] });
-          i++;
-        }
-        if (i < code.length && (code[i] === '<' || code[i] === '"')) {
-          const endChar = code[i] === '<' ? '>' : '"';
-          let path = code[i];
-          i++;
-          while (i < code.length && code[i] !== endChar && code[i] !== '\n') {
-            path += code[i];
-            i++;
-          }
-          if (i < code.length && code[i] === endChar) {
-            path += code[i];
-            i++;
-          }
-          tokens.push({ type: 'string', value: path });
+        const wsStart = i;
+        while (i < len && isSpaceCode(line.charCodeAt(i))) i++;
+        if (i > wsStart) tokens.push({ type: 'whitespace', value: line.slice(wsStart, i) });
+        if (i < len && (line[i] === '<' || line[i] === '"')) {
+          const endChar = line[i] === '<' ? '>' : '"';
+          const end = line.indexOf(endChar, i + 1);
+          const pathEnd = end === -1 ? len : end + 1;
+          tokens.push({ type: 'string', value: line.slice(i, pathEnd) });
+          i = pathEnd;
         }
       }
       continue;
     }
-    
+
     // Numbers
-    if (/\d/.test(char) || (char === '.' && i + 1 < code.length && /\d/.test(code[i + 1]))) {
-      let num = char;
-      i++;
-      while (i < code.length && /[\d.xXa-fA-F]/.test(code[i])) {
-        num += code[i];
-        i++;
-      }
+    if (isDigitCode(code) || (ch === '.' && isDigitCode(line.charCodeAt(i + 1)))) {
+      let j = i + 1;
+      while (j < len && isNumberPartCode(line.charCodeAt(j))) j++;
       // Check for number suffixes
-      if (i < code.length && /[fFlLuU]/.test(code[i])) {
-        num += code[i];
-        i++;
-      }
-      tokens.push({ type: 'number', value: num });
+      if (j < len && 'fFlLuU'.includes(line[j])) j++;
+      tokens.push({ type: 'number', value: line.slice(i, j) });
+      i = j;
       continue;
     }
-    
+
     // Identifiers, keywords, types
-    if (/[a-zA-Z_]/.test(char)) {
-      let word = '';
-      while (i < code.length && /[a-zA-Z0-9_]/.test(code[i])) {
-        word += code[i];
-        i++;
+    if (isIdentStartCode(code)) {
+      let j = i + 1;
+      while (j < len && isIdentPartCode(line.charCodeAt(j))) j++;
+      const word = line.slice(i, j);
+
+      // Raw string literal: R"delim( ... )delim"
+      if (line[j] === '"' && RAW_STRING_PREFIX.test(word)) {
+        const open = line.indexOf('(', j + 1);
+        if (open !== -1 && open - j - 1 <= 16) {
+          const terminator = ')' + line.slice(j + 1, open) + '"';
+          const end = line.indexOf(terminator, open + 1);
+          if (end === -1) {
+            tokens.push({ type: 'string', value: line.slice(i) });
+            return { tokens, state: 'r' + line.slice(j + 1, open) };
+          }
+          tokens.push({ type: 'string', value: line.slice(i, end + terminator.length) });
+          i = end + terminator.length;
+          continue;
+        }
       }
-      
+
       // Skip whitespace to check for function call
-      let j = i;
-      while (j < code.length && /\s/.test(code[j])) j++;
-      
-      const isFunction = code[j] === '(';
-      
+      let k = j;
+      while (k < len && isSpaceCode(line.charCodeAt(k))) k++;
+      const isFunction = line[k] === '(';
+
       if (langConfig.keywords.has(word)) {
         tokens.push({ type: 'keyword', value: word });
       } else if (langConfig.types.has(word)) {
@@ -191,21 +268,51 @@ function tokenizeCpp(code, langConfig) {
       } else {
         tokens.push({ type: 'identifier', value: word });
       }
+      i = j;
       continue;
     }
-    
+
     // Operators
-    if ('+-*/%=<>!&|^~?:'.includes(char)) {
-      tokens.push({ type: 'operator', value: char });
+    if (OPERATOR_CHARS.includes(ch)) {
+      tokens.push({ type: 'operator', value: ch });
       i++;
       continue;
     }
-    
-    // Everything else
-    tokens.push({ type: 'plain', value: char });
+
+    // Everything else, with runs of whitespace merged into one token
+    if (isSpaceCode(code)) {
+      let j = i + 1;
+      while (j < len && isSpaceCode(line.charCodeAt(j))) j++;
+      tokens.push({ type: 'whitespace', value: line.slice(i, j) });
+      i = j;
+      continue;
+    }
+    tokens.push({ type: 'plain', value: ch });
     i++;
   }
-  
+
+  const continues = inDirective && endsWithContinuation(line);
+  return { tokens, state: continues ? LINE_STATE_PREPROCESSOR : LINE_STATE_NORMAL };
+}
+
+/**
+ * Tokenize C/C++ code for highlighting
+ * @param {string} code - The code to tokenize
+ * @param {Object} langConfig - Language configuration
+ * @returns {Array} - Array of tokens with type and value
+ */
+function tokenizeCpp(code, langConfig) {
+  const tokens = [];
+  const lines = code.split('\n');
+  let state = LINE_STATE_NORMAL;
+
+  for (let i = 0; i < lines.length; i++) {
+    if (i > 0) tokens.push({ type: 'plain', value: '\n' });
+    const result = tokenizeLine(lines[i], state, langConfig);
+    for (const token of result.tokens) tokens.push(token);
+    state = result.state;
+  }
+
   return tokens;
 }
 
@@ -272,6 +379,169 @@ function shouldHighlight(fileType) {
   return getLanguageConfig(fileType) !== null;
 }
 
+/**
+ * Replace a range of an array in place without spreading huge argument lists
+ * @param {Array} array - Target array
+ * @param {number} start - Start index
+ * @param {number} deleteCount - Number of items to remove
+ * @param {Array} items - Items to insert
+ * @returns {Array} The updated array (may be a new instance for large inserts)
+ */
+function spliceLarge(array, start, deleteCount, items) {
+  if (items.length < 8192) {
+    array.splice(start, deleteCount, ...items);
+    return array;
+  }
+  return array.slice(0, start).concat(items, array.slice(start + deleteCount));
+}
+
+/**
+ * Incremental, line-based highlighter.
+ *
+ * Keeps the lexer state at every line boundary and the rendered HTML of every
+ * line. After an edit only the changed lines are re-tokenized, and tokenizing
+ * continues past them only until the end state matches the state previously
+ * recorded for the next line (e.g. an unterminated comment keeps going until
+ * the old and new states agree again).
+ */
+class IncrementalHighlighter {
+  /**
+   * @param {string} fileType - The file type used to pick the language configuration
+   */
+  constructor(fileType) {
+    this.fileType = fileType;
+    this.langConfig = getLanguageConfig(fileType);
+    this.reset();
+  }
+
+  /**
+   * Drop all cached lines and states
+   */
+  reset() {
+    this.lines = [];
+    this.lineStates = [LINE_STATE_NORMAL]; // start state of line i; last entry is the end state
+    this.lineHtml = [];
+    this.lastUpdate = { firstLine: 0, retokenizedLines: 0 };
+  }
+
+  /**
+   * Switch language; clears the cache when the configuration changes
+   * @param {string} fileType - The new file type
+   */
+  setFileType(fileType) {
+    if (fileType === this.fileType) return;
+    this.fileType = fileType;
+    this.langConfig = getLanguageConfig(fileType);
+    this.reset();
+  }
+
+  /**
+   * Bring the cache in sync with the given document text.
+   * Finds the changed line range by comparing the common prefix and suffix.
+   * @param {string} code - Full document text
+   * @returns {Object} Stats of this update { firstLine, retokenizedLines }
+   */
+  update(code) {
+    const newLines = (code || '').split('\n');
+    const oldLines = this.lines;
+
+    let start = 0;
+    const max = Math.min(oldLines.length, newLines.length);
+    while (start < max && oldLines[start] === newLines[start]) start++;
+
+    let oldEnd = oldLines.length;
+    let newEnd = newLines.length;
+    while (oldEnd > start && newEnd > start && oldLines[oldEnd - 1] === newLines[newEnd - 1]) {
+      oldEnd--;
+      newEnd--;
+    }
+
+    if (start === oldEnd && start === newEnd) {
+      this.lastUpdate = { firstLine: start, retokenizedLines: 0 };
+      return this.lastUpdate;
+    }
+
+    return this.applyLineEdit(start, oldEnd - start, newLines.slice(start, newEnd));
+  }
+
+  /**
+   * Replace whole lines and re-tokenize until the lexer state converges
+   * @param {number} startLine - First replaced line (0-based)
+   * @param {number} deleteCount - Number of lines removed
+   * @param {Array<string>} insertedLines - Lines inserted in their place
+   * @returns {Object} Stats of this update { firstLine, retokenizedLines }
+   */
+  applyLineEdit(startLine, deleteCount, insertedLines) {
+    const startState = this.lineStates[startLine];
+    const placeholders = new Array(insertedLines.length).fill(null);
+
+    this.lines = spliceLarge(this.lines, startLine, deleteCount, insertedLines);
+    this.lineHtml = spliceLarge(this.lineHtml, startLine, deleteCount, placeholders);
+    this.lineStates = spliceLarge(this.lineStates, startLine, deleteCount, placeholders);
+    if (insertedLines.length > 0) this.lineStates[startLine] = startState;
+
+    const editEnd = startLine + insertedLines.length;
+    const lineCount = this.lines.length;
+    let state = startState;
+    let i = startLine;
+
+    while (i < lineCount) {
+      // Past the edit, stop as soon as the incoming state matches the cached one
+      if (i >= editEnd && this.lineHtml[i] !== null && this.lineStates[i] === state) break;
+      this.lineStates[i] = state;
+      state = this.renderLine(i, state);
+      i++;
+    }
+    if (i === lineCount) this.lineStates[lineCount] = state;
+
+    this.lastUpdate = { firstLine: startLine, retokenizedLines: i - startLine };
+    return this.lastUpdate;
+  }
+
+  /**
+   * Tokenize one line, cache its HTML and return the end state
+   * @param {number} index - Line index
+   * @param {string} state - Start state
+   * @returns {string} End state
+   * @private
+   */
+  renderLine(index, state) {
+    const line = this.lines[index];
+    if (!this.langConfig) {
+      this.lineHtml[index] = escapeHtml(line);
+      return LINE_STATE_NORMAL;
+    }
+    const result = tokenizeLine(line, state, this.langConfig);
+    this.lineHtml[index] = tokensToHtml(result.tokens, this.langConfig);
+    return result.state;
+  }
+
+  /**
+   * @returns {number} Number of cached lines
+   */
+  getLineCount() {
+    return this.lines.length;
+  }
+
+  /**
+   * Get highlighted HTML for a range of lines
+   * @param {number} startLine - First line (0-based, inclusive)
+   * @param {number} endLine - Last line (exclusive)
+   * @returns {Array<string>} HTML per line
+   */
+  getLinesHtml(startLine, endLine) {
+    return this.lineHtml.slice(Math.max(0, startLine), Math.min(this.lineHtml.length, endLine));
+  }
+
+  /**
+   * Get highlighted HTML for the whole document
+   * @returns {string} HTML string
+   */
+  getHtml() {
+    return this.lineHtml.join('\n');
+  }
+}
+
 // Export for use in other modules
 if (typeof module !== 'undefined' && module.exports) {
   module.exports = {
@@ -280,7 +550,9 @@ if (typeof module !== 'undefined' && module.exports) {
     shouldHighlight,
     escapeHtml,
     tokenizeCpp,
-    tokensToHtml
+    tokenizeLine,
+    tokensToHtml,
+    IncrementalHighlighter
   };
 }
 
@@ -292,6 +564,8 @@ if (typeof window !== 'undefined') {
     shouldHighlight,
     escapeHtml,
     tokenizeCpp,
-    tokensToHtml
+    tokenizeLine,
+    tokensToHtml,
+    IncrementalHighlighter
   };
 }
@@ -0,0 +1,187 @@
+/**
+ * Frame-budgeted cooperative task scheduler
+ *
+ * Large UI updates are written as generator functions that yield between
+ * chunks of work. The scheduler runs chunks until the slice budget is
+ * spent, then gives the thread back (scheduler.postTask where available,
+ * requestIdleCallback for background work, a timeout otherwise) so input
+ * and paint can happen between slices.
+ *
+ * Jobs have a key: scheduling a job under a key that is still running
+ * cancels the old one, so only the latest editor decorations or search
+ * result set is ever built. Higher priorities run first and a slice ends
+ * early when the browser reports pending input.
+ */
+
+const { getLogger } = require('./logger');
+const { perfMonitor } = require('./perfMonitor');
+
+const log = getLogger('scheduler');
+
+/** Priorities, most urgent first (the scheduler.postTask names) */
+const PRIORITIES = ['user-blocking', 'user-visible', 'background'];
+
+/** Work per slice, half a 60 Hz frame so rendering still fits */
+const SLICE_MS = 8;
+
+/**
+ * Default way of giving the thread back before the next slice
+ * @param {string} priority - Priority of the job that runs next
+ * @param {Function} callback - Receives the time budget of the slice
+ */
+function postSlice(priority, callback) {
+  if (typeof scheduler !== 'undefined' && scheduler.postTask) {
+    scheduler.postTask(() => callback(SLICE_MS), { priority });
+  } else if (priority === 'background' && typeof requestIdleCallback === 'function') {
+    requestIdleCallback(deadline => callback(Math.max(1, Math.min(SLICE_MS, deadline.timeRemaining()))), { timeout: 1000 });
+  } else {
+    setTimeout(() => callback(SLICE_MS), 0);
+  }
+}
+
+/**
+ * @returns {boolean} Whether the browser has input waiting
+ */
+function inputPending() {
+  return typeof navigator !== 'undefined' && !!navigator.scheduling &&
+    typeof navigator.scheduling.isInputPending === 'function' && navigator.scheduling.isInputPending();
+}
+
+class TaskScheduler {
+  /**
+   * @param {Object} options - { now, post, inputPending } replaceable in tests
+   */
+  constructor(options = {}) {
+    this.now = options.now || (() => performance.now());
+    this.post = options.post || postSlice;
+    this.inputPending = options.inputPending || inputPending;
+    /** @type {Map<string, Object>} key -> job, in scheduling order */
+    this.jobs = new Map();
+    this.posted = false;
+  }
+
+  /**
+   * Schedule a job, cancelling any unfinished job with the same key
+   * @param {string} key - Job identity, e.g. 'diagnostics.decorations'
+   * @param {Function} task - Generator function called with the job; it
+   *   yields between chunks and may not run to the end
+   * @param {Object} [options] - { priority: 'user-blocking'|'user-visible'|'background' }
+   * @returns {Object} Job { key, priority, cancelled, cancel(), promise }
+   *   where promise resolves to { status: 'done'|'cancelled'|'failed', value, error }
+   */
+  schedule(key, task, options = {}) {
+    this.cancel(key);
+
+    const priority = PRIORITIES.includes(options.priority) ? options.priority : 'user-visible';
+    const job = { key, priority, cancelled: false, iterator: null, resolve: null };
+    job.promise = new Promise(resolve => { job.resolve = resolve; });
+    job.cancel = () => this.cancel(key, job);
+    job.iterator = task(job);
+
+    this.jobs.set(key, job);
+    this.requestSlice();
+    return job;
+  }
+
+  /**
+   * Cancel the job scheduled under a key
+   * @param {string} key - Job key
+   * @param {Object} [job] - Only cancel this particular job
+   * @returns {boolean} Whether a job was cancelled
+   */
+  cancel(key, job = this.jobs.get(key)) {
+    if (!job || this.jobs.get(key) !== job) return false;
+    this.jobs.delete(key);
+    job.cancelled = true;
+    try {
+      job.iterator.return();
+    } catch (error) {
+      log.debug(() => `Cleanup of ${key} failed: ${error.message}`);
+    }
+    job.resolve({ status: 'cancelled' });
+    return true;
+  }
+
+  /**
+   * @param {string} key - Job key
+   * @returns {boolean} Whether a job is pending under the key
+   */
+  isPending(key) {
+    return this.jobs.has(key);
+  }
+
+  /**
+   * Most urgent job, oldest first within a priority
+   * @returns {Object|null} Job
+   * @private
+   */
+  nextJob() {
+    let best = null;
+    for (const job of this.jobs.values()) {
+      if (!best || PRIORITIES.indexOf(job.priority) < PRIORITIES.indexOf(best.priority)) best = job;
+    }
+    return best;
+  }
+
+  /**
+   * Post the next slice unless one is already pending
+   * @private
+   */
+  requestSlice() {
+    if (this.posted) return;
+    const job = this.nextJob();
+    if (!job) return;
+    this.posted = true;
+    this.post(job.priority, budget => {
+      this.posted = false;
+      this.runSlice(budget);
+    });
+  }
+
+  /**
+   * Run jobs until the budget is spent or input arrives
+   * @param {number} [budget] - Milliseconds available
+   */
+  runSlice(budget = SLICE_MS) {
+    const start = this.now();
+    // Re-pick after every chunk so newly scheduled urgent work goes first
+    for (let job = this.nextJob(); job; job = this.nextJob()) {
+      perfMonitor.measure(`scheduler.${job.key}`, () => this.step(job));
+      if (this.now() - start >= budget || this.inputPending()) break;
+    }
+    this.requestSlice();
+  }
+
+  /**
+   * Advance a job by one chunk
+   * @param {Object} job - Job
+   * @private
+   */
+  step(job) {
+    let result;
+    try {
+      result = job.iterator.next();
+    } catch (error) {
+      log.error(`Scheduled job ${job.key} failed`, error);
+      this.finish(job, { status: 'failed', error });
+      return;
+    }
+    if (!job.cancelled && result.done) {
+      this.finish(job, { status: 'done', value: result.value });
+    }
+  }
+
+  /**
+   * Remove a job that ended and settle its promise
+   * @private
+   */
+  finish(job, outcome) {
+    if (this.jobs.get(job.key) === job) this.jobs.delete(job.key);
+    job.resolve(outcome);
+  }
+}
+
+/** Scheduler shared by the managers of this window */
+const taskScheduler = new TaskScheduler();
+
+module.exports = { TaskScheduler, taskScheduler, PRIORITIES, SLICE_MS };
@@ -0,0 +1,58 @@
+/**
+ * @fileoverview Identifier tokens for retrieval
+ *
+ * Questions, function bodies and diagnostics are matched on the parts of
+ * the identifiers they contain. Used by the code index in the main
+ * process and by the results panel when it picks the diagnostics a chat
+ * question is about, so it depends on nothing but plain JavaScript.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+/** Language keywords and question words that carry no retrieval signal */
+const STOPWORDS = new Set([
+  'auto', 'break', 'case', 'char', 'const', 'continue', 'default', 'do', 'double', 'else', 'enum',
+  'extern', 'float', 'for', 'goto', 'if', 'inline', 'int', 'long', 'register', 'return', 'short',
+  'signed', 'sizeof', 'static', 'struct', 'switch', 'typedef', 'union', 'unsigned', 'void',
+  'volatile', 'while', 'bool', 'true', 'false', 'nullptr', 'null', 'class', 'public', 'private',
+  'protected', 'template', 'typename', 'namespace', 'using', 'new', 'delete', 'this', 'virtual',
+  'override', 'std', 'include', 'define', 'ifdef', 'ifndef', 'endif',
+  'the', 'an', 'is', 'are', 'be', 'it', 'in', 'on', 'of', 'to', 'and', 'or', 'with', 'what',
+  'why', 'how', 'does', 'can', 'my', 'me', 'this', 'that', 'there', 'here', 'function', 'code',
+  'please', 'explain', 'fix', 'about', 'from', 'at', 'by', 'as', 'we', 'you', 'should', 'would'
+]);
+
+const IDENTIFIER_REGEX = /[A-Za-z_][A-Za-z0-9_]*/g;
+const IDENTIFIER_PART_REGEX = /[A-Z]+(?![a-z])|[A-Z]?[a-z]+|[0-9]+/g;
+
+/**
+ * Split text into lowercase identifier tokens.
+ * `parseHttpHeader` and `parse_http_header` both yield parse, http, header
+ * plus the whole identifier.
+ * @param {string} text - Source text or question
+ * @param {Array<string>} [out] - Array to append to
+ * @returns {Array<string>} Tokens
+ */
+function splitIdentifiers(text, out = []) {
+  IDENTIFIER_REGEX.lastIndex = 0;
+  let match;
+  while ((match = IDENTIFIER_REGEX.exec(text)) !== null) {
+    const identifier = match[0];
+    const whole = identifier.toLowerCase();
+    const parts = identifier.match(IDENTIFIER_PART_REGEX) || [];
+    let partCount = 0;
+    for (const part of parts) {
+      const token = part.toLowerCase();
+      if (token.length < 2 || STOPWORDS.has(token)) continue;
+      out.push(token);
+      partCount++;
+    }
+    if ((partCount > 1 || parts.length > 1) && whole.length > 2 && !STOPWORDS.has(whole)) {
+      out.push(whole);
+    }
+  }
+  return out;
+}
+
+module.exports = { splitIdentifiers };
@@ -0,0 +1,295 @@
+/**
+ * @fileoverview SARIF merge: SARIF runs to results-panel diagnostics
+ *
+ * SARIF logs from ctrace (--sarif-format) and other analyzers are turned
+ * into the diagnostics shape the results panel already understands
+ * ({ id, ruleId, severity, location, details }). Any number of runs, from
+ * any number of documents, are merged into one result set: identical
+ * results reported by several runs or files are kept once, and rule
+ * metadata (descriptions, help links, default levels) is collected per
+ * rule id.
+ *
+ * Shared by the main process (SARIF files, headless runs) and the results
+ * panel, so it depends on nothing but plain JavaScript.
+ *
+ * @author CTrace GUI Team
+ * @version 1.0.0
+ */
+
+/** SARIF level -> diagnostics severity */
+const SEVERITY_BY_LEVEL = {
+  error: 'ERROR',
+  warning: 'WARNING',
+  note: 'INFO',
+  none: 'INFO'
+};
+
+/**
+ * @param {Object} message - SARIF message object
+ * @returns {string} Plain text of a message
+ */
+function messageText(message) {
+  if (!message) return '';
+  return message.text || message.markdown || '';
+}
+
+/**
+ * Turn an artifact URI into a path
+ * @param {string} uri - Artifact URI, absolute or relative
+ * @param {string} [baseUri] - Resolved uriBaseId, if any
+ * @returns {string} File path
+ */
+function uriToPath(uri, baseUri) {
+  let full = uri || '';
+  if (baseUri && !/^[a-z][a-z0-9+.-]*:/i.test(full)) {
+    full = baseUri.replace(/\/?$/, '/') + full;
+  }
+  if (full.startsWith('file://')) {
+    full = full.slice('file://'.length);
+    // file:///C:/x -> C:/x
+    if (/^\/[A-Za-z]:/.test(full)) full = full.slice(1);
+  }
+  try {
+    return decodeURIComponent(full);
+  } catch (e) {
+    return full;
+  }
+}
+
+/**
+ * Merges SARIF runs into one deduplicated set of diagnostics
+ */
+class SarifMerger {
+  /**
+   * @param {Object} [options]
+   * @param {Function} [options.onDiagnostic] - (diag) => void for each new diagnostic;
+   *   when given, diagnostics are handed over instead of kept for finish()
+   */
+  constructor({ onDiagnostic = null } = {}) {
+    /** @type {Map<string, Object>} Run key -> { tool, rules, baseUris, pending } */
+    this.runs = new Map();
+    /** @type {Map<string, Object>} Rule id -> rule metadata */
+    this.rules = new Map();
+    /** @type {Set<string>} Dedup keys of the diagnostics so far */
+    this.seen = new Set();
+    this.diagnostics = [];
+    this.onDiagnostic = onDiagnostic;
+    /** Distinct diagnostics so far */
+    this.count = 0;
+    this.functions = new Set();
+    this.tools = new Set();
+    this.inputFiles = [];
+    this.documents = 0;
+    this.totalResults = 0;
+    this.duplicates = 0;
+  }
+
+  /**
+   * @param {string} key - Run key, unique across documents
+   * @returns {Object} Run state
+   * @private
+   */
+  getRun(key) {
+    let run = this.runs.get(key);
+    if (!run) {
+      run = { tool: null, rules: [], baseUris: {}, pending: [] };
+      this.runs.set(key, run);
+    }
+    return run;
+  }
+
+  /**
+   * Record a run's tool and its rules
+   * @param {string} runKey - Run key
+   * @param {Object} tool - SARIF tool object
+   */
+  setTool(runKey, tool) {
+    const run = this.getRun(runKey);
+    const driver = (tool && tool.driver) || {};
+    run.tool = driver.name || 'unknown';
+    this.tools.add(run.tool);
+
+    const components = [driver].concat((tool && tool.extensions) || []);
+    for (const component of components) {
+      for (const rule of component.rules || []) {
+        run.rules.push(rule);
+        if (!rule.id || this.rules.has(rule.id)) continue;
+        this.rules.set(rule.id, {
+          id: rule.id,
+          name: rule.name || '',
+          shortDescription: messageText(rule.shortDescription),
+          fullDescription: messageText(rule.fullDescription),
+          helpUri: rule.helpUri || '',
+          defaultLevel: (rule.defaultConfiguration && rule.defaultConfiguration.level) || 'warning',
+          tool: run.tool
+        });
+      }
+    }
+
+    // Results that came before the tool in the document
+    const pending = run.pending;
+    run.pending = [];
+    pending.forEach(result => this.addResult(runKey, result));
+  }
+
+  /**
+   * @param {string} runKey - Run key
+   * @param {Object} baseIds - SARIF originalUriBaseIds
+   */
+  setBaseUris(runKey, baseIds) {
+    const run = this.getRun(runKey);
+    for (const [id, location] of Object.entries(baseIds || {})) {
+      if (location && location.uri) run.baseUris[id] = location.uri;
+    }
+  }
+
+  /**
+   * Add one result, unless an identical one is already known
+   * @param {string} runKey - Run key
+   * @param {Object} result - SARIF result
+   */
+  addResult(runKey, result) {
+    const run = this.getRun(runKey);
+    if (!run.tool) {
+      run.pending.push(result);
+      return;
+    }
+    this.totalResults++;
+    const diag = this.toDiagnostic(run, result);
+    const key = this.dedupKey(diag, result);
+    if (this.seen.has(key)) {
+      this.duplicates++;
+      return;
+    }
+    this.seen.add(key);
+    this.count++;
+    if (diag.location.function) this.functions.add(diag.location.function);
+    if (this.onDiagnostic) this.onDiagnostic(diag);
+    else this.diagnostics.push(diag);
+  }
+
+  /**
+   * Merge a parsed SARIF document
+   * @param {Object} log - SARIF log
+   * @param {string} [name] - File the log came from
+   */
+  addDocument(log, name) {
+    const prefix = this.beginDocument(name);
+    (log.runs || []).forEach((run, index) => {
+      const key = `${prefix}${index}`;
+      this.setBaseUris(key, run.originalUriBaseIds);
+      this.setTool(key, run.tool);
+      (run.results || []).forEach(result => this.addResult(key, result));
+    });
+  }
+
+  /**
+   * @param {string} [name] - File the next document comes from
+   * @returns {string} Prefix for its run keys
+   */
+  beginDocument(name) {
+    if (name) this.inputFiles.push(name);
+    this.documents++;
+    return `${this.documents}:`;
+  }
+
+  /**
+   * @param {Object} run - Run state
+   * @param {Object} result - SARIF result
+   * @returns {Object} Diagnostic in the ctrace shape
+   * @private
+   */
+  toDiagnostic(run, result) {
+    const indexedRule = result.rule && typeof result.rule.index === 'number' ? run.rules[result.rule.index]
+      : typeof result.ruleIndex === 'number' ? run.rules[result.ruleIndex] : null;
+    const ruleId = result.ruleId || (result.rule && result.rule.id) || (indexedRule && indexedRule.id) || 'unknown';
+    const rule = this.rules.get(ruleId);
+
+    const kind = result.kind || 'fail';
+    const level = kind === 'fail' ? result.level || (rule && rule.defaultLevel) || 'warning' : 'none';
+
+    let message = messageText(result.message);
+    if (!message && result.message && result.message.id) {
+      // Message given as a rule template with arguments
+      const runRule = indexedRule || run.rules.find(r => r.id === ruleId);
+      const template = runRule && runRule.messageStrings && runRule.messageStrings[result.message.id];
+      const args = result.message.arguments || [];
+      if (template) message = messageText(template).replace(/\{(\d+)\}/g, (m, n) => (args[n] !== undefined ? args[n] : m));
+    }
+
+    const location = (result.locations || [])[0] || {};
+    const physical = location.physicalLocation || {};
+    const artifact = physical.artifactLocation || {};
+    const region = physical.region || {};
+    const logical = (location.logicalLocations || [])[0] || {};
+
+    return {
+      id: `sarif-${this.count + 1}`,
+      ruleId,
+      severity: SEVERITY_BY_LEVEL[level] || 'WARNING',
+      location: {
+        file: artifact.uri ? uriToPath(artifact.uri, run.baseUris[artifact.uriBaseId]) : '',
+        function: logical.fullyQualifiedName || logical.name || '',
+        startLine: region.startLine || 0,
+        startColumn: region.startColumn || 0,
+        endLine: region.endLine || region.startLine || 0,
+        endColumn: region.endColumn || 0
+      },
+      details: { message },
+      tool: run.tool
+    };
+  }
+
+  /**
+   * Identity of a result across runs: its fingerprint when the tool
+   * provides one, otherwise rule, location and message
+   * @param {Object} diag - Converted diagnostic
+   * @param {Object} result - SARIF result
+   * @returns {string} Dedup key
+   * @private
+   */
+  dedupKey(diag, result) {
+    const fingerprints = result.fingerprints || result.partialFingerprints;
+    if (fingerprints) {
+      const names = Object.keys(fingerprints).sort();
+      if (names.length > 0) return `${diag.ruleId}\0${names[0]}=${fingerprints[names[0]]}`;
+    }
+    const loc = diag.location;
+    return [diag.ruleId, loc.file, loc.startLine, loc.startColumn, loc.endLine, loc.endColumn, diag.details.message].join('\0');
+  }
+
+  /**
+   * Complete the merge; results whose run never named its tool are kept
+   * @returns {Object} { meta, functions, diagnostics, rules }; diagnostics
+   *   is empty when they were handed to onDiagnostic
+   */
+  finish() {
+    for (const [key, run] of this.runs) {
+      if (run.pending.length > 0) this.setTool(key, null);
+    }
+    return {
+      meta: {
+        tool: Array.from(this.tools).join(', ') || 'SARIF',
+        mode: 'SARIF',
+        inputFile: this.inputFiles.length === 1 ? this.inputFiles[0] : `${this.inputFiles.length} SARIF files`,
+        runs: this.runs.size,
+        results: this.totalResults,
+        duplicates: this.duplicates,
+        diagnostics: this.count
+      },
+      functions: Array.from(this.functions),
+      diagnostics: this.diagnostics,
+      rules: Object.fromEntries(this.rules)
+    };
+  }
+}
+
+/**
+ * @param {Object} data - Parsed JSON
+ * @returns {boolean} Whether it is a SARIF log
+ */
+function isSarifLog(data) {
+  return !!data && Array.isArray(data.runs) && (typeof data.version === 'string' || typeof data.$schema === 'string');
+}
+
+module.exports = { SarifMerger, isSarifLog, uriToPath };
@@ -0,0 +1,42 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+
+const { AnsiDecoder, lineToHtml, ansiToHtml } = require('../src/renderer/utils/ansiDecoder');
+
+test('decodes colors incrementally across chunk and line boundaries', () => {
+  const decoder = new AnsiDecoder();
+  assert.deepStrictEqual(decoder.write('plain\n\x1b[1;3'), [{ text: 'plain', runs: null }]);
+
+  // The escape sequence completes in the next chunk and the style carries to the next line
+  const lines = decoder.write('1mbold red\nstill red\x1b[0m done\r');
+  assert.deepStrictEqual(lines.map(l => l.text), ['bold red']);
+  const red = lines[0].runs[1];
+  assert.strictEqual(decoder.styles[red].css, 'color:#ff7b72;font-weight:bold;');
+
+  const rest = decoder.write('\nprogress 10%\rprogress 100%\x1b[2K\x1b]0;title\x07\n');
+  assert.deepStrictEqual(rest, [
+    { text: 'still red done', runs: [0, red, 9, 0] },
+    { text: 'progress 100%', runs: null }
+  ]);
+  assert.deepStrictEqual(decoder.write('tail'), []);
+  assert.deepStrictEqual(decoder.end(), [{ text: 'tail', runs: null }]);
+});
+
+test('wraps very long lines and supports 256 and true colors', () => {
+  const decoder = new AnsiDecoder({ maxLineLength: 4 });
+  assert.deepStrictEqual(decoder.write('abcdefghij\n').map(l => l.text), ['abcd', 'efgh', 'ij']);
+
+  decoder.write('\x1b[38;5;196m');
+  const [line] = decoder.write('x\x1b[48;2;1;2;3my\n');
+  assert.strictEqual(decoder.styles[line.runs[1]].css, 'color:rgb(255,0,0);');
+  assert.strictEqual(decoder.styles[line.runs[3]].css, 'color:rgb(255,0,0);background:rgb(1,2,3);');
+});
+
+test('renders style runs and search marks as escaped HTML', () => {
+  const styles = [{ css: '' }, { css: 'color:red;' }];
+  assert.strictEqual(
+    lineToHtml({ text: 'Error <x> error', runs: [0, 1, 5, 0] }, styles, 'error'),
+    '<mark><span style="color:red;">Error</span></mark> &lt;x&gt; <mark>error</mark>'
+  );
+  assert.strictEqual(ansiToHtml('a\n\x1b[32mb\x1b[0m'), 'a\n<span style="color:#3fb950;">b</span>');
+});
@@ -0,0 +1,106 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const path = require('node:path');
+const os = require('node:os');
+const fs = require('node:fs');
+
+const { AnalysisCostModel, BatchPlanner, demultiplex, confirmedInputs } = require('../src/main/utils/batchPlanner');
+
+const KB = 1024;
+
+test('learns per-invocation overhead and analysis rate from timings', () => {
+  const model = new AnalysisCostModel({ overheadMs: 10, msPerKB: 10 });
+  // This machine: 400 ms to start, 0.5 ms per KB
+  for (let i = 0; i < 40; i++) {
+    const kb = (i % 5) * 50 + 1;
+    model.observe([{ path: `f${i}.c`, size: kb * KB }], 400 + 0.5 * kb);
+  }
+  assert.ok(Math.abs(model.overheadMs - 400) < 5, `overhead ${model.overheadMs}`);
+  assert.ok(Math.abs(model.msPerKB - 0.5) < 0.05, `rate ${model.msPerKB}`);
+});
+
+test('attributes batch time to files and prefers recorded times', () => {
+  const model = new AnalysisCostModel({ overheadMs: 100, msPerKB: 1 });
+  const files = [{ path: 'a.c', size: 30 * KB }, { path: 'b.c', size: 10 * KB }];
+  const times = model.observe(files, 100 + 40);
+  assert.ok(Math.abs(times[0] / times[1] - 3) < 1e-9);
+  assert.strictEqual(model.estimate(files[0]), times[0]);
+  // A changed file is priced by size again
+  assert.strictEqual(model.estimate({ path: 'a.c', size: 2 * KB }), 2 * model.msPerKB);
+});
+
+test('packs small files together and runs large files alone', () => {
+  const model = new AnalysisCostModel({ overheadMs: 200, msPerKB: 1 });
+  const files = [{ path: 'big.c', size: 5000 * KB }];
+  for (let i = 0; i < 100; i++) files.push({ path: `small${String(i).padStart(3, '0')}.c`, size: 2 * KB });
+  files.push({ path: 'odd,name.c', size: 1 * KB });
+
+  const planner = new BatchPlanner(files, model, { jobs: 2, maxFiles: 16 });
+  const batches = [];
+  let batch;
+  while ((batch = planner.next()) !== null) batches.push(batch);
+
+  assert.ok(batches.some(b => b.length === 1 && b[0].path === 'big.c'));
+  assert.ok(batches.every(b => b.length <= 16));
+  assert.ok(batches.length < 20, `${batches.length} invocations`);
+  // Paths with commas cannot share a comma-separated --input
+  assert.ok(batches.some(b => b.length === 1 && b[0].path === 'odd,name.c'));
+  const seen = batches.flat().map(f => f.path).sort();
+  assert.deepStrictEqual(seen, files.map(f => f.path).sort());
+});
+
+test('requeued and unbatched files run one at a time', () => {
+  const model = new AnalysisCostModel();
+  const files = ['a.c', 'b.c', 'c.c'].map(name => ({ path: name, size: KB }));
+  const planner = new BatchPlanner(files, model, { jobs: 1 });
+  const first = planner.next();
+  assert.strictEqual(first.length, 3);
+  planner.requeue(first);
+  planner.disableBatching();
+  assert.deepStrictEqual([planner.next(), planner.next(), planner.next(), planner.next()].map(b => b && b.length), [1, 1, 1, null]);
+});
+
+test('splits combined output back to its inputs', () => {
+  const inputs = [
+    { path: '/w/src/a.c', ctracePath: '/w/src/a.c' },
+    { path: '/w/lib/a.c', ctracePath: '/w/lib/a.c' },
+    { path: '/w/b.c', ctracePath: '/w/b.c' }
+  ];
+  const diag = (id, file, fn) => ({ id, location: { file, function: fn } });
+  const parts = demultiplex({
+    meta: { tool: 'ctrace' },
+    functions: ['main', 'helper', 'orphan', { name: 'libfn', file: 'lib/a.c', startLine: 1 }],
+    diagnostics: [diag('1', '/w/src/a.c', 'main'), diag('2', 'lib/a.c', 'libfn'), diag('3', 'b.c', 'helper'), diag('4', 'common.h', '')]
+  }, inputs);
+
+  assert.deepStrictEqual(parts.map(p => p.diagnostics.map(d => d.id)), [['1', '4'], ['2'], ['3']]);
+  assert.deepStrictEqual(parts.map(p => p.functions.map(fn => fn.name || fn)), [['main', 'orphan'], ['libfn'], ['helper']]);
+  assert.strictEqual(parts[2].meta.tool, 'ctrace');
+});
+
+test('keeps timings between runs', async () => {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-history-'));
+  try {
+    const file = path.join(dir, 'nested', 'history.json');
+    const model = new AnalysisCostModel();
+    await model.load(file);
+    model.observe([{ path: 'a.c', size: KB }], 300);
+    await model.save();
+
+    const restored = new AnalysisCostModel();
+    assert.strictEqual(await restored.load(file), 1);
+    assert.strictEqual(restored.estimate({ path: 'a.c', size: KB }), model.estimate({ path: 'a.c', size: KB }));
+    assert.strictEqual(restored.overheadMs, model.overheadMs);
+  } finally {
+    fs.rmSync(dir, { recursive: true, force: true });
+  }
+});
+
+test('confirms inputs named in meta or diagnostics only', () => {
+  const inputs = ['/w/a.c', '/w/b.c', '/w/c.c', '/w/d.c'].map(p => ({ path: p, ctracePath: p }));
+  const analysis = {
+    meta: { inputFile: '/w/a.c,/w/b.c' },
+    diagnostics: [{ location: { file: 'c.c' } }, { location: { file: 'other/d.c' } }]
+  };
+  assert.deepStrictEqual(confirmedInputs(analysis, inputs), [true, true, true, false]);
+});
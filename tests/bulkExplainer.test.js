@@ -0,0 +1,107 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+
+const {
+  BulkExplainer,
+  TokenBucket,
+  packBatches,
+  parseBatchReply,
+  parseRetryAfter
+} = require('../src/main/external_llm/BulkExplainer');
+
+function diagnostic(id, ruleId, severity, func) {
+  return { id, ruleId, severity, location: { function: func, startLine: 10 }, details: { message: `problem ${id}` } };
+}
+
+// Same shape as DiagnosticsManager.groupDiagnostics
+function group(diagnostics) {
+  const groups = {};
+  for (const diag of diagnostics) {
+    const rule = groups[diag.ruleId] || (groups[diag.ruleId] = { ruleId: diag.ruleId, severity: diag.severity, totalCount: 0, functions: {} });
+    (rule.functions[diag.location.function] = rule.functions[diag.location.function] || []).push(diag);
+    rule.totalCount++;
+  }
+  return groups;
+}
+
+function replyFor(prompt) {
+  const ids = Array.from(prompt.matchAll(/^### (\S+)$/gm), m => m[1]);
+  return ids.map(id => `### ${id}\nExplanation of ${id}.`).join('\n\n');
+}
+
+test('packBatches keeps rules apart, errors first, and respects the batch size', () => {
+  const diagnostics = [
+    diagnostic('i1', 'Recursion', 'INFO', 'walk'),
+    ...Array.from({ length: 7 }, (_, i) => diagnostic(`e${i}`, 'StackPointerEscape', 'ERROR', i < 4 ? 'main' : 'helper'))
+  ];
+  const batches = packBatches(group(diagnostics), { batchSize: 5 });
+
+  assert.deepStrictEqual(batches.map(b => [b.ruleId, b.items.map(i => i.id)]), [
+    ['StackPointerEscape', ['e0', 'e1', 'e2', 'e3', 'e4']],
+    ['StackPointerEscape', ['e5', 'e6']],
+    ['Recursion', ['i1']]
+  ]);
+  assert.strictEqual(batches[0].items[4].function, 'helper');
+});
+
+test('parseBatchReply maps sections to findings and falls back to the whole reply', () => {
+  const batch = { items: [{ id: 'd1' }, { id: 'd2' }] };
+  const parsed = parseBatchReply('Intro\n### d1\nFirst.\n\n### `d2`:\nSecond.', batch);
+  assert.deepStrictEqual(Array.from(parsed), [['d1', 'First.'], ['d2', 'Second.']]);
+  assert.deepStrictEqual(Array.from(parseBatchReply('No headings here.', batch)), [['d1', 'No headings here.'], ['d2', 'No headings here.']]);
+  assert.strictEqual(parseRetryAfter('2'), 2000);
+  assert.strictEqual(parseRetryAfter(undefined), null);
+});
+
+test('run retries 429s after retry-after, bounds concurrency and reports every finding', async () => {
+  const batches = packBatches(group(Array.from({ length: 12 }, (_, i) => diagnostic(`d${i}`, 'R', 'WARNING', 'f'))), { batchSize: 2 });
+  const sleeps = [];
+  let inFlight = 0;
+  let maxInFlight = 0;
+  let calls = 0;
+  const reported = [];
+
+  const explainer = new BulkExplainer({
+    concurrency: 3,
+    sleep: async (ms) => { sleeps.push(ms); },
+    send: async (prompt) => {
+      const call = ++calls;
+      inFlight++;
+      maxInFlight = Math.max(maxInFlight, inFlight);
+      await new Promise(resolve => setImmediate(resolve));
+      inFlight--;
+      if (call === 2) return { success: false, error: 'rate limited', status: 429, retryAfterMs: 1500 };
+      if (call === 4) return { success: false, error: 'bad request', status: 400 };
+      return { success: true, reply: replyFor(prompt) };
+    },
+    onResult: (results) => reported.push(...results)
+  });
+  const summary = await explainer.run(batches);
+
+  assert.strictEqual(maxInFlight, 3);
+  assert.strictEqual(summary.rateLimited, 1);
+  assert.strictEqual(summary.explained, 10);
+  assert.strictEqual(summary.failed, 2);
+  assert.ok(sleeps.some(ms => ms >= 1500 && ms < 2500));
+  assert.strictEqual(reported.length, 12);
+  assert.deepStrictEqual(reported.find(r => r.id === 'd0'), { id: 'd0', explanation: 'Explanation of d0.' });
+  assert.strictEqual(reported.filter(r => r.error === 'bad request').length, 2);
+});
+
+test('token bucket delays requests once the per-minute budget is spent', async () => {
+  const bucket = new TokenBucket(600);
+  const waits = [];
+  const sleep = async (ms) => {
+    waits.push(ms);
+    bucket.updatedAt -= ms;
+  };
+
+  await bucket.take(500, sleep);
+  assert.deepStrictEqual(waits, []);
+  await bucket.take(500, sleep);
+  assert.strictEqual(waits.length, 1);
+  assert.ok(waits[0] >= 39000 && waits[0] <= 40000);
+
+  bucket.pause(5000);
+  assert.strictEqual(bucket.tokens, 0);
+});
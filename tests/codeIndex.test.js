@@ -0,0 +1,126 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const path = require('node:path');
+const os = require('node:os');
+const fs = require('node:fs');
+
+const { CodeIndex, splitIdentifiers, extractFunctions } = require('../src/main/utils/codeIndex');
+
+const source = [
+  '#include <string.h>',
+  '#define CHECK(x) \\',
+  '  do { if (!(x)) return -1; } while (0)',
+  '',
+  '/* Parses one header line (name: value) */',
+  'static int parse_http_header(const char *line, struct header *out) {',
+  '  const char *colon = strchr(line, \':\');',
+  '  if (!colon) { return -1; }',
+  '  out->name_len = colon - line;',
+  '  return 0;',
+  '}',
+  '',
+  'struct header { int name_len; };',
+  '',
+  'namespace net {',
+  'class Socket {',
+  'public:',
+  '  int sendPacket(const char *buf) { return write_all(buf, "}"); }',
+  '};',
+  '}',
+  '',
+  'int main(void) {',
+  '  char stackBuffer[16];',
+  '  return parse_http_header(stackBuffer, 0);',
+  '}'
+].join('\n');
+
+test('splitIdentifiers splits snake_case and camelCase and keeps the whole identifier', () => {
+  assert.deepStrictEqual(splitIdentifiers('sendPacket(parse_http_header) if int x'), [
+    'send', 'packet', 'sendpacket', 'parse', 'http', 'header', 'parse_http_header'
+  ]);
+});
+
+test('extractFunctions finds definitions with their line ranges', () => {
+  const functions = extractFunctions(source).map(fn => [fn.name, fn.startLine, fn.endLine]);
+  assert.deepStrictEqual(functions, [
+    ['parse_http_header', 5, 11],
+    ['sendPacket', 17, 18],
+    ['main', 22, 25]
+  ]);
+});
+
+test('search ranks the function matching the question first', () => {
+  const index = new CodeIndex();
+  index.indexSource('/ws/http.c', source);
+  index.indexSource('/ws/other.c', 'void log_message(const char *msg) { puts(msg); }\nint header_count(void) { return 0; }');
+
+  const results = index.search('why does parseHttpHeader fail on a line without a colon?', 3);
+  assert.strictEqual(results[0].name, 'parse_http_header');
+  assert.strictEqual(results[0].file, '/ws/http.c');
+  assert.ok(results.every(r => r.name !== 'log_message'));
+});
+
+test('index updates incrementally when files change or disappear', () => {
+  const index = new CodeIndex();
+  index.indexSource('/ws/a.c', 'int alpha_value(void) { return 1; }');
+  index.indexSource('/ws/b.c', 'int beta_value(void) { return 2; }');
+  assert.strictEqual(index.search('alpha')[0].name, 'alpha_value');
+
+  index.indexSource('/ws/a.c', 'int gamma_value(void) { return 3; }');
+  assert.deepStrictEqual(index.search('alpha'), []);
+  assert.strictEqual(index.search('gamma')[0].name, 'gamma_value');
+
+  index.removeFile('/ws/b.c');
+  assert.deepStrictEqual(index.search('beta'), []);
+  assert.strictEqual(index.docs.size, 1);
+  assert.strictEqual(index.postings.has('beta'), false);
+});
+
+test('an update that finishes after a clear is dropped', async () => {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-index-'));
+  const file = path.join(dir, 'a.c');
+  fs.writeFileSync(file, 'int alpha_value(void) { return 1; }');
+
+  const index = new CodeIndex();
+  const update = index.updateFile(file);
+  index.clear();
+  await update;
+  assert.strictEqual(index.docs.size, 0);
+
+  await index.updateFile(file);
+  assert.strictEqual(index.search('alpha')[0].name, 'alpha_value');
+});
+
+test('buildContext packs diagnostics and function bodies within the budget', async () => {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-index-'));
+  const filler = Array.from({ length: 200 }, (_, i) => `  total += stack_item_${i};`).join('\n');
+  fs.writeFileSync(path.join(dir, 'http.c'), source);
+  fs.mkdirSync(path.join(dir, 'build'));
+  fs.writeFileSync(path.join(dir, 'build', 'skipped.c'), 'int parse_http_header_copy(void) { return 0; }');
+  fs.writeFileSync(path.join(dir, 'big.c'), `int sum_stack(void) {\n  int total = 0;\n${filler}\n  return total;\n}\n`);
+
+  try {
+    const index = new CodeIndex();
+    const stats = await index.build(dir);
+    assert.deepStrictEqual({ files: stats.files, functions: stats.functions }, { files: 2, functions: 4 });
+
+    const diagnostics = [
+      { ruleId: 'StackPointerEscape', severity: 'ERROR', location: { function: 'main', startLine: 23 }, details: { message: "[!!] stack pointer escape of variable 'stackBuffer'" } },
+      { ruleId: 'Recursion', severity: 'INFO', location: { function: 'unrelated', startLine: 1 }, details: { message: 'recursion detected' } }
+    ];
+    const context = await index.buildContext('is stackBuffer in main safe? also parse_http_header', {
+      tokenBudget: 400,
+      diagnostics,
+      diagnosticsFile: path.join(dir, 'http.c')
+    });
+
+    assert.match(context.text, /ctrace diagnostics for http\.c:\n- \[ERROR StackPointerEscape\] main:23 stack pointer escape/);
+    assert.doesNotMatch(context.text, /recursion detected/);
+    assert.match(context.text, /\/\/ http\.c:22-25 \(main\)/);
+    assert.ok(context.functions.length >= 1);
+    assert.ok(Math.ceil(context.text.length / 4) <= 400 + 16);
+    assert.doesNotMatch(context.text, /parse_http_header_copy/);
+  } finally {
+    fs.rmSync(dir, { recursive: true, force: true });
+  }
+});
@@ -0,0 +1,118 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const path = require('node:path');
+const Module = require('node:module');
+
+const ConversationManager = require('../src/main/external_llm/ConversationManager');
+
+function withModuleMocks(mocks, callback) {
+  const originalLoad = Module._load;
+  Module._load = function (request, parent, isMain) {
+    if (Object.prototype.hasOwnProperty.call(mocks, request)) {
+      return mocks[request];
+    }
+    return originalLoad.apply(this, arguments);
+  };
+  try {
+    return callback();
+  } finally {
+    Module._load = originalLoad;
+  }
+}
+
+test('buildContext replays recorded turns oldest first', () => {
+  const manager = new ConversationManager();
+  manager.recordTurn('ollama', 'first question', 'first answer');
+  manager.recordTurn('ollama', 'second question', 'second answer');
+
+  const context = manager.buildContext('ollama', 'Be brief.', {});
+  assert.strictEqual(context.systemPrompt, 'Be brief.');
+  assert.deepStrictEqual(context.history, [
+    { role: 'user', content: 'first question' },
+    { role: 'assistant', content: 'first answer' },
+    { role: 'user', content: 'second question' },
+    { role: 'assistant', content: 'second answer' }
+  ]);
+  assert.deepStrictEqual(manager.buildContext('external:openai', 'Be brief.', {}).history, []);
+});
+
+test('buildContext folds old turns into a summary once over budget', () => {
+  const manager = new ConversationManager();
+  const config = { historyTokenBudget: 100 };
+  const filler = 'x'.repeat(120);
+  for (let i = 0; i < 6; i++) {
+    manager.recordTurn('ollama', `Question ${i}? ${filler}`, `Answer ${i}. ${filler}`);
+  }
+
+  const context = manager.buildContext('ollama', 'System.', config);
+  // 60 tokens per turn: folding stops at the low-water mark but keeps the latest turn
+  assert.strictEqual(context.history.length, 2);
+  assert.match(context.history[0].content, /^Question 5\?/);
+  assert.match(context.systemPrompt, /^System\.\n\nSummary of earlier conversation:\n/);
+  assert.match(context.systemPrompt, /- User asked: Question 4\? Assistant: Answer 4\./);
+});
+
+test('prefix stays stable between folds so prompt caches can hit', () => {
+  const manager = new ConversationManager();
+  const config = { historyTokenBudget: 1000 };
+  manager.recordTurn('external:anthropic', 'a'.repeat(400), 'b'.repeat(400));
+
+  const before = manager.buildContext('external:anthropic', 'System.', config);
+  manager.recordTurn('external:anthropic', 'c'.repeat(400), 'd'.repeat(400));
+  const after = manager.buildContext('external:anthropic', 'System.', config);
+
+  assert.strictEqual(after.systemPrompt, before.systemPrompt);
+  assert.deepStrictEqual(after.history.slice(0, before.history.length), before.history);
+});
+
+test('clear forgets one conversation or all of them', () => {
+  const manager = new ConversationManager();
+  manager.recordTurn('ollama', 'q', 'a');
+  manager.recordTurn('external:groq', 'q', 'a');
+
+  manager.clear('ollama');
+  assert.strictEqual(manager.buildContext('ollama', '', {}).history.length, 0);
+  assert.strictEqual(manager.buildContext('external:groq', '', {}).history.length, 2);
+
+  manager.clear();
+  assert.strictEqual(manager.buildContext('external:groq', '', {}).history.length, 0);
+});
+
+test('assistant-chat sends earlier turns to external providers', async () => {
+  const handlers = new Map();
+  const calls = [];
+  const fakeProvider = {
+    validateConfig: () => ({ valid: true, errors: [] }),
+    chat: async (message, options) => {
+      calls.push({ message, options });
+      return { success: true, reply: `reply to ${message}` };
+    }
+  };
+
+  const modulePath = path.join(__dirname, '../src/main/ipc/assistantHandlers.js');
+  const { setupAssistantHandlers } = withModuleMocks({
+    electron: { ipcMain: { handle: (channel, listener) => handlers.set(channel, listener) } },
+    '../external_llm/ProviderRegistry': { createProvider: () => fakeProvider }
+  }, () => {
+    delete require.cache[modulePath];
+    return require(modulePath);
+  });
+
+  setupAssistantHandlers({});
+  const chat = handlers.get('assistant-chat');
+  const config = { providerId: 'anthropic', systemPrompt: 'Sys' };
+
+  await chat({}, { provider: 'external', message: 'one', config });
+  await chat({}, { provider: 'external', message: 'two', config });
+
+  assert.deepStrictEqual(calls[0].options.history, []);
+  assert.deepStrictEqual(calls[1].options.history, [
+    { role: 'user', content: 'one' },
+    { role: 'assistant', content: 'reply to one' }
+  ]);
+  assert.strictEqual(calls[1].options.cacheKey, 'ctrace-external:anthropic');
+
+  await handlers.get('assistant-clear-conversation')({}, { provider: 'external', config });
+  await chat({}, { provider: 'external', message: 'three', config });
+  assert.deepStrictEqual(calls[2].options.history, []);
+});
@@ -114,3 +114,31 @@ test('run-ctrace handler executes binary and returns output', async (t) => {
   platformMock.mock.restore();
 });
 
+
+test('runs leave no exit listeners behind', async (t) => {
+  const { runCtrace } = withModuleMocks({
+    electron: { ipcMain: { handle: () => {} } },
+    uuid: { v4: () => require('node:crypto').randomUUID() },
+    'child_process': { spawn: () => createChildProcess({ error: 'spawn failed' }) }
+  }, () => {
+    const modulePath = path.join(__dirname, '../src/main/ipc/ctraceHandlers.js');
+    delete require.cache[modulePath];
+    return require(modulePath);
+  });
+  t.mock.method(os, 'platform', () => 'linux');
+  const listeners = process.listenerCount('exit');
+
+  const accessMock = t.mock.method(fsPromises, 'access', async () => {
+    throw new Error('not found');
+  });
+  for (let i = 0; i < 3; i++) {
+    assert.strictEqual((await runCtrace([])).success, false);
+  }
+  accessMock.mock.restore();
+
+  t.mock.method(fsPromises, 'access', async () => {});
+  for (let i = 0; i < 3; i++) {
+    await assert.rejects(runCtrace([]), { success: false, error: 'Failed to start binary: spawn failed' });
+  }
+  assert.strictEqual(process.listenerCount('exit'), listeners);
+});
@@ -0,0 +1,100 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+
+const { DiagnosticStore, StringTable, fileMatcher } = require('../src/renderer/utils/diagnosticStore');
+
+function diag(id, ruleId, severity, file, line, column, extra = {}) {
+  return {
+    id,
+    ruleId,
+    severity,
+    location: { file, function: 'main', startLine: line, startColumn: column, endLine: line, endColumn: column + 4 },
+    details: { message: `${ruleId} message` },
+    ...extra
+  };
+}
+
+const sample = [
+  diag('d1', 'StackEscape', 'WARNING', 'b.c', 10, 2),
+  diag('d2', 'Recursion', 'ERROR', 'a.c', 30, 1),
+  diag('d3', 'StackEscape', 'INFO', 'a.c', 5, 7),
+  diag('d4', 'Alloca', 'ERROR', 'b.c', 10, 1)
+];
+
+test('interns strings and round-trips diagnostics', () => {
+  const withExtras = diag('d5', 'StackEscape', 'WARNING', 'a.c', 1, 1, { tool: 'ctrace', score: 3 });
+  withExtras.details.variableAliasing = ['p', 'q'];
+  withExtras.location.inlinedFrom = 'helper';
+
+  const store = DiagnosticStore.from(sample.concat([withExtras]));
+  assert.strictEqual(store.length, 5);
+  assert.deepStrictEqual(store.get(0), sample[0]);
+  assert.deepStrictEqual(store.get(4), withExtras);
+  // '' plus two distinct rules used three times
+  assert.strictEqual(store.tables.rule.values.length, 4);
+  assert.strictEqual(store.extras.size, 1);
+  assert.strictEqual(store.indexOf('d4'), 3);
+  assert.strictEqual(store.indexOf('missing'), -1);
+});
+
+test('grows past its initial capacity', () => {
+  const store = new DiagnosticStore(2);
+  for (let i = 0; i < 1000; i++) store.add(diag(`d${i}`, 'R', 'INFO', 'x.c', i + 1, 1));
+  assert.strictEqual(store.length, 1000);
+  assert.ok(store.capacity >= 1000);
+  assert.strictEqual(store.get(999).location.startLine, 1000);
+  assert.strictEqual(store.indexOf('d500'), 500);
+});
+
+test('filters, counts and sorts over the columns', () => {
+  const store = DiagnosticStore.from(sample);
+  const all = store.select('ALL');
+  assert.deepStrictEqual(Array.from(all), [0, 1, 2, 3]);
+  assert.deepStrictEqual(Array.from(store.select('ERROR')), [1, 3]);
+  assert.deepStrictEqual(Array.from(store.select('FATAL')), []);
+  assert.deepStrictEqual(Array.from(store.select('ALL', 10)), [0, 3]);
+
+  assert.deepStrictEqual(store.countBySeverity(all), { WARNING: 1, ERROR: 2, INFO: 1 });
+  assert.strictEqual(store.countRules(all), 3);
+  assert.strictEqual(store.countRules(store.select('ERROR')), 2);
+
+  assert.deepStrictEqual(Array.from(store.sort(all, 'report')), [0, 1, 2, 3]);
+  assert.deepStrictEqual(Array.from(store.sort(all, 'severity')), [1, 3, 0, 2]);
+  assert.deepStrictEqual(Array.from(store.sort(all, 'location')), [2, 1, 3, 0]);
+  assert.deepStrictEqual(Array.from(store.sort(all, 'rule')), [3, 1, 2, 0]);
+  assert.throws(() => store.sort(all, 'size'), /Unknown sort order/);
+});
+
+test('selects the rows of one file, however its path was reported', () => {
+  const store = DiagnosticStore.from([
+    diag('d1', 'StackEscape', 'WARNING', '/mnt/c/work/src/a.c', 3, 1),
+    diag('d2', 'StackEscape', 'WARNING', 'src/a.c', 3, 2),
+    diag('d3', 'StackEscape', 'WARNING', 'src/b.c', 3, 1),
+    diag('d4', 'StackEscape', 'WARNING', 'C:\\Work\\src\\a.c', 4, 1)
+  ]);
+  const files = store.fileMask(fileMatcher('C:\\work\\src\\a.c'));
+  assert.deepStrictEqual(Array.from(store.select('ALL', undefined, files)), [0, 1, 3]);
+  assert.deepStrictEqual(Array.from(store.select('ALL', 3, files)), [0, 1]);
+  assert.deepStrictEqual(Array.from(store.select('ALL', undefined, store.fileMask(fileMatcher('/home/me/lib/b.c')))), []);
+  assert.strictEqual(fileMatcher('/work/src/a.c')('src/a.c'), true);
+  assert.strictEqual(fileMatcher('/work/src/aa.c')('a.c'), false);
+});
+
+test('masks a column once per distinct value', () => {
+  const store = DiagnosticStore.from(sample);
+  const seen = [];
+  const rules = store.mask('rule', value => { seen.push(value); return value.startsWith('Stack'); });
+  assert.deepStrictEqual(seen, ['', 'StackEscape', 'Recursion', 'Alloca']);
+  assert.deepStrictEqual(Array.from(rules), [0, 1, 0, 0]);
+  assert.deepStrictEqual(sample.map((d, row) => rules[store.rule[row]]), [1, 0, 1, 0]);
+});
+
+test('string table ranks follow string order', () => {
+  const table = new StringTable();
+  const ids = ['pear', 'apple', 'fig'].map(value => table.intern(value));
+  assert.strictEqual(table.intern('apple'), ids[1]);
+  const ranks = table.ranks();
+  assert.ok(ranks[ids[1]] < ranks[ids[2]] && ranks[ids[2]] < ranks[ids[0]]);
+  table.intern('banana');
+  assert.strictEqual(table.ranks().length, 5);
+});
@@ -0,0 +1,66 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+
+const { FlatTree } = require('../src/renderer/utils/flatTree');
+
+function dir(path, children) {
+  return { name: path.split('/').pop(), path, type: 'directory', children };
+}
+
+function file(path) {
+  return { name: path.split('/').pop(), path, type: 'file' };
+}
+
+function sampleTree() {
+  return [
+    dir('/w/src', [
+      dir('/w/src/lib', [file('/w/src/lib/a.c'), file('/w/src/lib/b.c')]),
+      file('/w/src/main.c')
+    ]),
+    file('/w/README.md')
+  ];
+}
+
+const rows = (model) => model.nodes.map((node, i) => `${'  '.repeat(model.depths[i])}${node.name}`);
+
+test('expanding and collapsing splices only the affected rows', () => {
+  const model = new FlatTree();
+  model.setTree(sampleTree());
+  assert.deepStrictEqual(rows(model), ['src', 'README.md']);
+
+  assert.strictEqual(model.toggle(0), true);
+  assert.strictEqual(model.expand(1), true);
+  assert.deepStrictEqual(rows(model), ['src', '  lib', '    a.c', '    b.c', '  main.c', 'README.md']);
+
+  // Files do not expand
+  assert.strictEqual(model.toggle(2), false);
+
+  // Collapsing the parent hides the nested rows but remembers lib is open
+  model.collapse(0);
+  assert.deepStrictEqual(rows(model), ['src', 'README.md']);
+  model.expand(0);
+  assert.strictEqual(model.rowCount, 6);
+});
+
+test('expansion survives a refresh that replaces the tree', () => {
+  const model = new FlatTree();
+  model.setTree(sampleTree());
+  model.expand(0);
+
+  const refreshed = sampleTree();
+  refreshed[0].children.push(file('/w/src/new.c'));
+  model.setTree(refreshed);
+  assert.deepStrictEqual(rows(model), ['src', '  lib', '  main.c', '  new.c', 'README.md']);
+  assert.strictEqual(model.nodes[3], refreshed[0].children[2]);
+});
+
+test('expands a directory with many entries without argument spreading', () => {
+  const children = Array.from({ length: 200000 }, (_, i) => file(`/w/big/f${i}.c`));
+  const model = new FlatTree();
+  model.setTree([dir('/w/big', children), file('/w/z.c')]);
+  model.expand(0);
+  assert.strictEqual(model.rowCount, 200002);
+  assert.strictEqual(model.nodes[200001].name, 'z.c');
+  model.collapse(0);
+  assert.strictEqual(model.rowCount, 2);
+});
@@ -0,0 +1,93 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const path = require('node:path');
+const os = require('node:os');
+const fs = require('node:fs');
+const { execFileSync } = require('node:child_process');
+
+const { parseDiff, getChangedHunks, affectedTranslationUnits, HunkFilter } = require('../src/main/utils/gitDiff');
+
+test('parses changed new-side ranges from a zero-context diff', () => {
+  const diff = [
+    'diff --git a/src/a.c b/src/a.c',
+    '--- a/src/a.c',
+    '+++ b/src/a.c',
+    '@@ -3 +3 @@ int main(void)',
+    '@@ -10,2 +10,4 @@',
+    '@@ -20,3 +21,0 @@',
+    'diff --git a/"odd \\"name\\".c" b/"odd \\"name\\".c"',
+    '--- /dev/null',
+    '+++ "b/odd \\"name\\".c"',
+    '@@ -0,0 +1,2 @@'
+  ].join('\n');
+  assert.deepStrictEqual(Array.from(parseDiff(diff)), [
+    ['src/a.c', [{ start: 3, end: 3 }, { start: 10, end: 13 }, { start: 21, end: 22 }]],
+    ['odd "name".c', [{ start: 1, end: 2 }]]
+  ]);
+});
+
+test('collects hunks and affected translation units from a work tree', async (t) => {
+  try {
+    execFileSync('git', ['--version'], { stdio: 'ignore' });
+  } catch (error) {
+    t.skip('git is not installed');
+    return;
+  }
+  const root = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-diff-'));
+  try {
+    const git = (...args) => execFileSync('git', ['-c', 'user.name=t', '-c', 'user.email=t@t', ...args], { cwd: root, stdio: 'ignore' });
+    fs.mkdirSync(path.join(root, 'src'));
+    fs.writeFileSync(path.join(root, 'src', 'util.h'), 'int util(int x);\n');
+    fs.writeFileSync(path.join(root, 'src', 'util.c'), '#include "util.h"\nint util(int x)\n{\n  return x;\n}\n');
+    fs.writeFileSync(path.join(root, 'src', 'main.c'), '#include "util.h"\nint main(void)\n{\n  return util(1);\n}\n');
+    fs.writeFileSync(path.join(root, 'src', 'other.c'), 'int other(void)\n{\n  return 0;\n}\n');
+    git('init', '-q');
+    git('add', '.');
+    git('commit', '-q', '-m', 'base');
+
+    fs.writeFileSync(path.join(root, 'src', 'util.c'), '#include "util.h"\nint util(int x)\n{\n  return x + 1;\n}\n');
+    let hunks = await getChangedHunks(root, 'HEAD');
+    assert.deepStrictEqual(Array.from(hunks), [[path.join(root, 'src', 'util.c'), [{ start: 4, end: 4 }]]]);
+
+    const sources = ['main.c', 'other.c', 'util.c'].map(name => path.join(root, 'src', name));
+    assert.deepStrictEqual(await affectedTranslationUnits(hunks, sources), [sources[2]]);
+
+    fs.writeFileSync(path.join(root, 'src', 'util.h'), 'int util(int value);\n');
+    hunks = await getChangedHunks(root, 'HEAD');
+    assert.deepStrictEqual(await affectedTranslationUnits(hunks, sources), [sources[0], sources[2]]);
+
+    await assert.rejects(getChangedHunks(root, 'no-such-ref'), /git diff failed/);
+    await assert.rejects(getChangedHunks(root, '--output=x'), /Invalid ref/);
+  } finally {
+    fs.rmSync(root, { recursive: true, force: true });
+  }
+});
+
+test('keeps diagnostics in functions that overlap a changed hunk', async () => {
+  const root = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-hunks-'));
+  try {
+    const unit = path.join(root, 'a.c');
+    fs.writeFileSync(unit, [
+      'int f(void)', '{', '  return 0;', '}',
+      'int g(void)', '{', '  int x;', '  return x;', '}'
+    ].join('\n'));
+    const filter = new HunkFilter(new Map([[unit, [{ start: 7, end: 7 }]]]));
+    const diag = (id, fn, line, file = 'a.c') => ({ id, location: { file, function: fn, startLine: line, endLine: line } });
+
+    // Function ranges from the source: g spans lines 5-9
+    let kept = await filter.filter({
+      functions: ['f', 'g'],
+      diagnostics: [diag('in-f', 'f', 3), diag('in-g', 'g', 8), diag('no-fn', '', 7), diag('header', 'h', 1, 'util.h')]
+    }, unit);
+    assert.deepStrictEqual(kept.map(d => d.id), ['in-g', 'no-fn']);
+
+    // Ranges reported by ctrace take precedence over the source
+    kept = await filter.filter({
+      functions: [{ name: 'f', startLine: 1, endLine: 7 }],
+      diagnostics: [diag('in-f', 'f', 3)]
+    }, unit);
+    assert.deepStrictEqual(kept.map(d => d.id), ['in-f']);
+  } finally {
+    fs.rmSync(root, { recursive: true, force: true });
+  }
+});
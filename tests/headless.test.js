@@ -0,0 +1,220 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const path = require('node:path');
+const os = require('node:os');
+const fs = require('node:fs');
+
+const { parseHeadlessArgs, runBatch, runHeadless, exitCodeFor, DEFAULT_CTRACE_ARGS } = require('../src/main/headless');
+
+test('parses headless command lines', () => {
+  assert.strictEqual(parseHeadlessArgs(['electron', '.']), null);
+  assert.deepStrictEqual(
+    parseHeadlessArgs(['electron', '.', '--headless', '--analyze', 'src', '--jobs', '3', '--batch-size', '8', '--out', 'r.json', '--fail-on', 'warning', '--', '--verbose', '--out', 'x']),
+    { root: 'src', jobs: 3, batchSize: 8, out: 'r.json', failOn: 'warning', changedSince: null, ctraceArgs: ['--verbose', '--out', 'x'] }
+  );
+  assert.deepStrictEqual(parseHeadlessArgs(['app', '--headless', '--analyze', '.']).ctraceArgs, ['--invoke=ctrace_stack_analyzer', '--sarif-format']);
+  assert.deepStrictEqual(parseHeadlessArgs(['app', '--headless', '--analyze', '.', '--']).ctraceArgs, DEFAULT_CTRACE_ARGS);
+  assert.strictEqual(parseHeadlessArgs(['app', '--headless', '--analyze', '.', '--changed-since', 'origin/main']).changedSince, 'origin/main');
+  assert.match(parseHeadlessArgs(['app', '--headless', '--analyze', '.', '--changed-since']).error, /changed-since/);
+  assert.match(parseHeadlessArgs(['app', '--headless']).error, /--analyze/);
+  assert.match(parseHeadlessArgs(['app', '--headless', '--analyze', '.', '--jobs', '0']).error, /--jobs/);
+  assert.match(parseHeadlessArgs(['app', '--headless', '--analyze', '.', '--batch-size', 'x']).error, /--batch-size/);
+  assert.match(parseHeadlessArgs(['app', '--headless', '--analyze', '.', '--fail-on', 'info']).error, /fail-on/);
+});
+
+test('runs at most --jobs invocations at once', async () => {
+  const root = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-headless-'));
+  try {
+    for (let i = 0; i < 7; i++) fs.writeFileSync(path.join(root, `f${i}.c`), '');
+    let running = 0;
+    let peak = 0;
+    const runCtrace = async () => {
+      running++;
+      peak = Math.max(peak, running);
+      await new Promise(resolve => setTimeout(resolve, 5));
+      running--;
+      return { success: true, output: '{"diagnostics":[]}' };
+    };
+    const report = await runBatch({ root, jobs: 3, batchSize: 1, ctraceArgs: [] }, { runCtrace });
+    assert.strictEqual(report.summary.invocations, 7);
+    assert.strictEqual(peak, 3);
+  } finally {
+    fs.rmSync(root, { recursive: true, force: true });
+  }
+});
+
+test('analyzes translation units and builds the report', async () => {
+  const root = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-headless-'));
+  try {
+    fs.mkdirSync(path.join(root, 'lib'));
+    fs.mkdirSync(path.join(root, 'build'));
+    for (const name of ['main.c', 'lib/util.cpp', 'lib/util.h', 'lib/broken.cc', 'build/gen.c', 'notes.txt']) {
+      fs.writeFileSync(path.join(root, name), '');
+    }
+
+    const calls = [];
+    const runCtrace = async (args) => {
+      calls.push(args);
+      const input = args[0];
+      if (input.endsWith('broken.cc')) throw { success: false, error: 'Server error: boom' };
+      if (input.endsWith('util.cpp')) return { success: true, output: 'plain text' };
+      return {
+        success: true,
+        output: JSON.stringify({ meta: { tool: 'ctrace' }, diagnostics: [{ id: 'd1', severity: 'WARNING' }, { id: 'd2', severity: 'ERROR' }] })
+      };
+    };
+
+    const report = await runBatch({ root, jobs: 2, batchSize: 1, ctraceArgs: ['--verbose'] }, { runCtrace });
+    assert.deepStrictEqual(calls.map(args => args[1]), ['--verbose', '--verbose', '--verbose']);
+    assert.deepStrictEqual(report.files.map(f => [f.file, f.success]), [
+      [path.join('lib', 'broken.cc'), false],
+      [path.join('lib', 'util.cpp'), false],
+      ['main.c', true]
+    ]);
+    assert.strictEqual(report.files[0].error, 'Server error: boom');
+    assert.strictEqual(report.files[1].unparsed, true);
+    assert.strictEqual(report.files[1].output, 'plain text');
+    assert.match(report.files[1].error, /neither JSON nor SARIF/);
+    assert.deepStrictEqual(report.summary, { files: 3, invocations: 3, failed: 2, unparsed: 1, diagnostics: 2, bySeverity: { WARNING: 1, ERROR: 1 } });
+    assert.strictEqual(exitCodeFor(report, 'error'), 2);
+  } finally {
+    fs.rmSync(root, { recursive: true, force: true });
+  }
+});
+
+test('exit code reflects the fail-on level', () => {
+  const report = (bySeverity) => ({ summary: { failed: 0, bySeverity } });
+  assert.strictEqual(exitCodeFor(report({ WARNING: 2 }), 'error'), 0);
+  assert.strictEqual(exitCodeFor(report({ WARNING: 2 }), 'warning'), 1);
+  assert.strictEqual(exitCodeFor(report({ ERROR: 1 }), 'error'), 1);
+  assert.strictEqual(exitCodeFor(report({ ERROR: 1 }), 'never'), 0);
+});
+
+test('scopes analysis and diagnostics to the changes since a ref', async () => {
+  const root = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-headless-'));
+  try {
+    fs.writeFileSync(path.join(root, 'a.c'), 'int f(void)\n{\n  return 0;\n}\nint g(void)\n{\n  return 1;\n}\n');
+    fs.writeFileSync(path.join(root, 'b.c'), 'int h(void)\n{\n  return 2;\n}\n');
+
+    const analyzed = [];
+    const runCtrace = async (args) => {
+      analyzed.push(path.basename(args[0]));
+      return {
+        success: true,
+        output: JSON.stringify({
+          functions: ['f', 'g'],
+          diagnostics: [
+            { id: 'd1', severity: 'ERROR', location: { file: 'a.c', function: 'f', startLine: 3, endLine: 3 } },
+            { id: 'd2', severity: 'ERROR', location: { file: 'a.c', function: 'g', startLine: 7, endLine: 7 } }
+          ]
+        })
+      };
+    };
+    const getChangedHunks = async (dir, ref) => {
+      assert.strictEqual(ref, 'origin/main');
+      return new Map([[path.join(dir, 'a.c'), [{ start: 2, end: 2 }]]]);
+    };
+
+    const report = await runBatch({ root, jobs: 2, ctraceArgs: [], changedSince: 'origin/main' }, { runCtrace, getChangedHunks });
+    assert.deepStrictEqual(analyzed, ['a.c']);
+    assert.deepStrictEqual(report.scope, { changedSince: 'origin/main', changedFiles: 1, sources: 2 });
+    assert.deepStrictEqual(report.files[0].diagnostics.map(d => d.id), ['d1']);
+    assert.strictEqual(report.files[0].outsideChanges, 1);
+    assert.strictEqual(report.summary.diagnostics, 1);
+  } finally {
+    fs.rmSync(root, { recursive: true, force: true });
+  }
+});
+
+test('reports git failures as failures to determine the changes', async () => {
+  const root = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-headless-'));
+  try {
+    const getChangedHunks = async () => { throw new Error('not a git repository'); };
+    await assert.rejects(
+      runBatch({ root, jobs: 1, ctraceArgs: [], changedSince: 'origin/main' }, { runCtrace: async () => ({}), getChangedHunks }),
+      { message: 'Cannot determine changes since origin/main: not a git repository' }
+    );
+  } finally {
+    fs.rmSync(root, { recursive: true, force: true });
+  }
+});
+
+test('packs small files into one invocation and splits its output per file', async () => {
+  const root = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-headless-'));
+  try {
+    for (const name of ['a.c', 'b.c', 'c.c', 'bad.c']) fs.writeFileSync(path.join(root, name), 'int x;\n');
+
+    const calls = [];
+    const runCtrace = async (args) => {
+      const inputs = args[0].slice('--input='.length).split(',');
+      calls.push(inputs.map(input => path.basename(input)));
+      if (inputs.some(input => input.endsWith('bad.c'))) return { success: false, error: 'cannot parse bad.c' };
+      return {
+        success: true,
+        output: JSON.stringify({
+          diagnostics: inputs.map((input, i) => ({ id: `d${i}`, severity: 'WARNING', location: { file: input, startLine: 1 } }))
+        })
+      };
+    };
+
+    const report = await runBatch({ root, jobs: 1, batchSize: 8, ctraceArgs: [] }, { runCtrace });
+    // The failing batch is retried file by file
+    assert.strictEqual(calls[0].length, 4);
+    assert.deepStrictEqual(calls.slice(1).map(inputs => inputs.length), [1, 1, 1, 1]);
+    assert.deepStrictEqual(report.files.map(f => [f.file, f.success, (f.diagnostics || []).length]), [
+      ['a.c', true, 1], ['b.c', true, 1], ['bad.c', false, 0], ['c.c', true, 1]
+    ]);
+
+    calls.length = 0;
+    fs.rmSync(path.join(root, 'bad.c'));
+    const batched = await runBatch({ root, jobs: 1, batchSize: 8, ctraceArgs: [] }, { runCtrace });
+    assert.deepStrictEqual(calls.map(inputs => inputs.length), [3]);
+    assert.strictEqual(batched.summary.invocations, 1);
+    assert.deepStrictEqual(batched.files.map(f => [f.file, f.batchSize, f.diagnostics.length]), [['a.c', 3, 1], ['b.c', 3, 1], ['c.c', 3, 1]]);
+    assert.strictEqual(parseHeadlessArgs(['app', '--headless', '--analyze', root]).batchSize, 1);
+  } finally {
+    fs.rmSync(root, { recursive: true, force: true });
+  }
+});
+
+test('runs inputs missing from a batch output on their own', async () => {
+  const root = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-headless-'));
+  try {
+    for (const name of ['a.c', 'b.c', 'c.c']) fs.writeFileSync(path.join(root, name), 'int x;\n');
+
+    // A ctrace that only ever analyzes its first input
+    const calls = [];
+    const runCtrace = async (args) => {
+      const inputs = args[0].slice('--input='.length).split(',');
+      calls.push(inputs.length);
+      return {
+        success: true,
+        output: JSON.stringify({ diagnostics: [{ id: 'd', severity: 'WARNING', location: { file: inputs[0], startLine: 1 } }] })
+      };
+    };
+
+    const report = await runBatch({ root, jobs: 1, batchSize: 8, ctraceArgs: [] }, { runCtrace });
+    assert.deepStrictEqual(calls, [3, 1, 1]);
+    assert.deepStrictEqual(report.files.map(f => [f.file, f.diagnostics.length]), [['a.c', 1], ['b.c', 1], ['c.c', 1]]);
+  } finally {
+    fs.rmSync(root, { recursive: true, force: true });
+  }
+});
+
+test('fails the run when the report cannot be written', async () => {
+  const root = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-headless-'));
+  const stderr = process.stderr.write;
+  const written = [];
+  try {
+    fs.writeFileSync(path.join(root, 'main.c'), '');
+    const runCtrace = async () => ({ success: true, output: JSON.stringify({ meta: {}, diagnostics: [] }) });
+    process.stderr.write = (text) => { written.push(String(text)); return true; };
+    const code = await runHeadless({ root, jobs: 1, batchSize: 1, ctraceArgs: [], failOn: 'error', out: path.join(root, 'missing', 'report.json') }, runCtrace);
+    process.stderr.write = stderr;
+    assert.strictEqual(code, 2);
+    assert.ok(written.some(line => line.startsWith('Cannot write report to ')));
+  } finally {
+    process.stderr.write = stderr;
+    fs.rmSync(root, { recursive: true, force: true });
+  }
+});
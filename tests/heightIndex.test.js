@@ -0,0 +1,42 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+
+const { HeightIndex } = require('../src/renderer/utils/heightIndex');
+
+test('starts every row at the estimate', () => {
+  const index = new HeightIndex(5, 10);
+  assert.strictEqual(index.total, 50);
+  assert.deepStrictEqual([0, 1, 2, 3, 4, 5].map(i => index.offsetOf(i)), [0, 10, 20, 30, 40, 50]);
+  assert.strictEqual(index.indexAt(0), 0);
+  assert.strictEqual(index.indexAt(9.5), 0);
+  assert.strictEqual(index.indexAt(10), 1);
+  assert.strictEqual(index.indexAt(49), 4);
+  assert.strictEqual(index.indexAt(500), 4);
+});
+
+test('keeps offsets in step with measured heights', () => {
+  const count = 1000;
+  const index = new HeightIndex(count, 20);
+  const heights = new Array(count).fill(20);
+  for (let i = 0; i < count; i += 7) {
+    const height = 10 + (i % 13) * 5;
+    assert.strictEqual(index.set(i, height), height - heights[i]);
+    heights[i] = height;
+  }
+  let offset = 0;
+  for (let i = 0; i < count; i++) {
+    assert.strictEqual(index.offsetOf(i), offset);
+    assert.strictEqual(index.heightOf(i), heights[i]);
+    assert.strictEqual(index.indexAt(offset), i);
+    assert.strictEqual(index.indexAt(offset + heights[i] - 1), i);
+    offset += heights[i];
+  }
+  assert.strictEqual(index.total, offset);
+});
+
+test('handles an empty list', () => {
+  const index = new HeightIndex(0, 20);
+  assert.strictEqual(index.total, 0);
+  assert.strictEqual(index.offsetOf(0), 0);
+  assert.strictEqual(index.indexAt(100), 0);
+});
@@ -0,0 +1,67 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const path = require('node:path');
+const os = require('node:os');
+const fs = require('node:fs');
+
+const {
+  resolveCpuSettings,
+  toContextOptions,
+  buildTuningGrid,
+  runAutotune,
+  ProfileStore
+} = require('../src/main/utils/inferenceTuning');
+
+test('explicit config overrides the saved profile, which overrides defaults', () => {
+  assert.deepStrictEqual(resolveCpuSettings({}, null), { threads: 0, batchSize: 512, useMmap: true, useMlock: false, kvCacheType: 'f16' });
+
+  const profile = { settings: { threads: 6, batchSize: 256, kvCacheType: 'q8_0' } };
+  const settings = resolveCpuSettings({ cpuThreads: 8, useMlock: true }, profile);
+  assert.deepStrictEqual(settings, { threads: 8, batchSize: 256, useMmap: true, useMlock: true, kvCacheType: 'q8_0' });
+  assert.deepStrictEqual(toContextOptions(settings), {
+    batchSize: 256,
+    threads: 8,
+    experimentalKvCacheKeyType: 'q8_0',
+    experimentalKvCacheValueType: 'q8_0'
+  });
+});
+
+test('autotune benchmarks the grid, tries KV types on the winner and picks the fastest', async () => {
+  const grid = buildTuningGrid(8);
+  assert.deepStrictEqual(grid.map(s => `${s.threads}/${s.batchSize}`), ['8/256', '8/512', '4/256', '4/512', '2/256', '2/512']);
+
+  // Fake machine: 4 threads and batch 512 are fastest, q8_0 helps generation, q4_0 is unsupported
+  const benchmark = async (model, settings) => {
+    if (settings.kvCacheType === 'q4_0') throw new Error('unsupported KV type');
+    const threadPenalty = Math.abs(settings.threads - 4) + 1;
+    return {
+      settings,
+      promptTokensPerSecond: (settings.batchSize === 512 ? 200 : 150) / threadPenalty,
+      generationTokensPerSecond: (settings.kvCacheType === 'q8_0' ? 12 : 10) / threadPenalty
+    };
+  };
+  const progress = [];
+  const { best, results } = await runAutotune({}, { grid, benchmark, onProgress: p => progress.push(p.index) });
+
+  assert.deepStrictEqual(best.settings, { threads: 4, batchSize: 512, kvCacheType: 'q8_0' });
+  assert.strictEqual(results.length, 8);
+  assert.match(results[7].error, /unsupported/);
+  assert.deepStrictEqual(progress, [1, 2, 3, 4, 5, 6, 7, 8]);
+});
+
+test('profiles are saved per model file and dropped when the file changes', async () => {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-profiles-'));
+  const modelPath = path.join(dir, 'model.gguf');
+  const storePath = path.join(dir, 'profiles.json');
+  fs.writeFileSync(modelPath, 'gguf');
+  try {
+    await new ProfileStore(storePath).set(modelPath, { settings: { threads: 4 } });
+    assert.deepStrictEqual(await new ProfileStore(storePath).get(modelPath), { settings: { threads: 4 } });
+
+    fs.writeFileSync(modelPath, 'gguf v2, different size');
+    assert.strictEqual(await new ProfileStore(storePath).get(modelPath), null);
+    assert.strictEqual(await new ProfileStore(storePath).get(path.join(dir, 'missing.gguf')), null);
+  } finally {
+    fs.rmSync(dir, { recursive: true, force: true });
+  }
+});
@@ -0,0 +1,33 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+
+const { LineStore } = require('../src/renderer/utils/lineStore');
+
+const lines = (from, count) => Array.from({ length: count }, (_, i) => ({ text: `line ${from + i}`, runs: null }));
+
+test('drops whole pages once over capacity and keeps absolute numbering', () => {
+  const store = new LineStore({ capacity: 10, pageSize: 4 });
+  store.push(lines(0, 10));
+  assert.strictEqual(store.length, 10);
+  assert.strictEqual(store.first, 0);
+
+  store.push(lines(10, 5));
+  // 15 lines: the first full page is dropped, 11 remain
+  assert.strictEqual(store.first, 4);
+  assert.strictEqual(store.length, 11);
+  assert.strictEqual(store.get(3), undefined);
+  assert.strictEqual(store.get(4).text, 'line 4');
+  assert.strictEqual(store.get(14).text, 'line 14');
+  assert.strictEqual(store.get(15), undefined);
+});
+
+test('searches a range of absolute line numbers', () => {
+  const store = new LineStore({ capacity: 8, pageSize: 4 });
+  store.push(lines(0, 20));
+  assert.strictEqual(store.first, 12);
+  // Dropped lines are skipped
+  assert.deepStrictEqual(store.search('line 1', 0, store.end), [12, 13, 14, 15, 16, 17, 18, 19]);
+  assert.deepStrictEqual(store.search('line 19', store.first, 19), []);
+  store.clear();
+  assert.strictEqual(store.end, 0);
+});
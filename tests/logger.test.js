@@ -0,0 +1,78 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const path = require('node:path');
+const os = require('node:os');
+const fs = require('node:fs');
+
+const { Logger, RingBuffer, createFileSink, createForwardSink } = require('../src/main/utils/logger');
+
+test('ring buffer keeps the newest entries in order', () => {
+  const ring = new RingBuffer(3);
+  for (let i = 1; i <= 5; i++) ring.push(i);
+  assert.deepStrictEqual(ring.toArray(), [3, 4, 5]);
+  ring.clear();
+  assert.deepStrictEqual(ring.toArray(), []);
+});
+
+test('disabled levels are no-ops and lazy messages are not built', () => {
+  const logger = new Logger({ level: 'info' });
+  const log = logger.get('files');
+  let built = 0;
+  const message = () => { built++; return 'hex dump'; };
+
+  log.debug(message);
+  assert.strictEqual(built, 0);
+  assert.strictEqual(log.debug, logger.get('ctrace').debug);
+
+  logger.setLevel('trace', 'files');
+  log.debug(message);
+  logger.get('ctrace').debug(message);
+  log.warn('slow disk', { ms: 120 });
+  assert.strictEqual(built, 1);
+
+  const entries = logger.getEntries();
+  assert.deepStrictEqual(entries.map(e => [e.level, e.category, e.message]), [['debug', 'files', 'hex dump'], ['warn', 'files', 'slow disk']]);
+  assert.deepStrictEqual(logger.getEntries({ level: 'warn' }).map(e => e.message), ['slow disk']);
+  assert.deepStrictEqual(logger.getLevels(), { level: 'info', categories: { files: 'trace', ctrace: 'info' } });
+});
+
+test('file sink writes batches and rotates large files', async () => {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-log-'));
+  const filePath = path.join(dir, 'logs', 'app.log');
+  try {
+    const logger = new Logger();
+    const sink = createFileSink(filePath, { flushIntervalMs: 60000, maxBytes: 400 });
+    logger.addSink(sink);
+    const log = logger.get('ctrace');
+
+    log.info('first');
+    log.error('second', new Error('boom'));
+    assert.strictEqual(fs.existsSync(filePath), false);
+    await sink.flush();
+    const lines = fs.readFileSync(filePath, 'utf8').trim().split('\n');
+    assert.match(lines[0], /INFO  \[main:ctrace\] first$/);
+    assert.match(lines[1], /ERROR \[main:ctrace\] second Error: boom/);
+
+    log.info('x'.repeat(300));
+    await sink.flush();
+    assert.ok(fs.existsSync(filePath + '.1'));
+    assert.match(fs.readFileSync(filePath, 'utf8'), /^\S+ INFO  \[main:ctrace\] x{300}\n$/);
+  } finally {
+    fs.rmSync(dir, { recursive: true, force: true });
+  }
+});
+
+test('forward sink batches entries with data converted to text', async () => {
+  const batches = [];
+  const logger = new Logger({ process: 'renderer' });
+  logger.addSink(createForwardSink(entries => batches.push(entries), 10));
+  const log = logger.get('editor');
+
+  log.info('opened', { lines: 3 });
+  log.info('closed');
+  assert.strictEqual(batches.length, 0);
+  await new Promise(resolve => setTimeout(resolve, 30));
+
+  assert.strictEqual(batches.length, 1);
+  assert.deepStrictEqual(batches[0].map(e => [e.process, e.message, e.data]), [['renderer', 'opened', '{"lines":3}'], ['renderer', 'closed', undefined]]);
+});
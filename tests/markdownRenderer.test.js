@@ -0,0 +1,84 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const path = require('node:path');
+
+const modulePath = path.join(__dirname, '../src/renderer/utils/markdownRenderer.js');
+delete require.cache[modulePath];
+const { renderMarkdown, MarkdownStreamParser } = require(modulePath);
+
+const reply = [
+  '## Fix',
+  '',
+  'Use **bounds** checks:',
+  '- first `item`',
+  '- second',
+  '',
+  '```c',
+  'int main(void) {',
+  '  return 0;',
+  '}',
+  '```',
+  'Done.'
+].join('\n');
+
+function parseInChunks(text, size) {
+  const parser = new MarkdownStreamParser();
+  const events = [];
+  for (let i = 0; i < text.length; i += size) {
+    events.push(...parser.push(text.slice(i, i + size)));
+  }
+  events.push(...parser.finish());
+  return events;
+}
+
+test('MarkdownStreamParser emits block events for completed lines only', () => {
+  const parser = new MarkdownStreamParser();
+  assert.deepStrictEqual(parser.push('# Tit'), []);
+  assert.deepStrictEqual(parser.getTail(), { text: '# Tit', inCode: false });
+
+  const events = parser.push('le\nnext');
+  assert.strictEqual(events.length, 1);
+  assert.strictEqual(events[0].type, 'heading');
+  assert.strictEqual(events[0].level, 1);
+  assert.strictEqual(events[0].html, 'Title');
+  assert.deepStrictEqual(parser.getTail(), { text: 'next', inCode: false });
+});
+
+test('MarkdownStreamParser gives the same events regardless of chunking', () => {
+  const whole = parseInChunks(reply, reply.length);
+  assert.deepStrictEqual(parseInChunks(reply, 1), whole);
+  assert.deepStrictEqual(parseInChunks(reply, 7), whole);
+  assert.deepStrictEqual(whole.map((e) => e.type), [
+    'heading', 'break', 'line', 'listItem', 'listItem', 'break',
+    'codeStart', 'codeLine', 'codeLine', 'codeLine', 'codeEnd', 'line'
+  ]);
+});
+
+test('MarkdownStreamParser reports a code block once, with its full content', () => {
+  const events = parseInChunks(reply, 3);
+  const ends = events.filter((e) => e.type === 'codeEnd');
+  assert.deepStrictEqual(ends, [{ type: 'codeEnd', lang: 'c', code: 'int main(void) {\n  return 0;\n}' }]);
+});
+
+test('MarkdownStreamParser closes an unterminated code block on finish', () => {
+  const parser = new MarkdownStreamParser();
+  parser.push('```\nx < y');
+  assert.strictEqual(parser.getTail().inCode, true);
+  const events = parser.finish();
+  assert.deepStrictEqual(events.map((e) => e.type), ['codeLine', 'codeEnd']);
+  assert.strictEqual(events[1].code, 'x < y');
+});
+
+test('renderMarkdown escapes HTML and groups list items', () => {
+  const html = renderMarkdown('<b>hi</b>\n- a\n- *b*\ntext');
+  assert.ok(html.startsWith('&lt;b&gt;hi&lt;/b&gt;\n'));
+  assert.match(html, /<ul[^>]*><li[^>]*>a<\/li><li[^>]*><em>b<\/em><\/li><\/ul>text/);
+});
+
+test('renderMarkdown highlights C code blocks and keeps the raw code for actions', () => {
+  const html = renderMarkdown(reply);
+  assert.match(html, /class="code-copy-btn"/);
+  assert.match(html, /<span style="[^"]*">int<\/span>/);
+  const b64 = html.match(/data-code-b64="([^"]+)"/)[1];
+  assert.strictEqual(Buffer.from(b64, 'base64').toString('utf8'), 'int main(void) {\n  return 0;\n}');
+});
@@ -0,0 +1,112 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const path = require('node:path');
+const http = require('node:http');
+const Module = require('node:module');
+
+function withModuleMocks(mocks, callback) {
+  const originalLoad = Module._load;
+  Module._load = function (request, parent, isMain) {
+    if (Object.prototype.hasOwnProperty.call(mocks, request)) {
+      return mocks[request];
+    }
+    return originalLoad.apply(this, arguments);
+  };
+  try {
+    return callback();
+  } finally {
+    Module._load = originalLoad;
+  }
+}
+
+function loadHandlers() {
+  const handlers = new Map();
+  const modulePath = path.join(__dirname, '../src/main/ipc/assistantHandlers.js');
+  const { setupAssistantHandlers } = withModuleMocks({
+    electron: { ipcMain: { handle: (channel, listener) => handlers.set(channel, listener) } }
+  }, () => {
+    delete require.cache[modulePath];
+    return require(modulePath);
+  });
+  setupAssistantHandlers({});
+  return handlers;
+}
+
+/**
+ * Minimal Ollama API: records requests and the client ports they came from
+ */
+async function startOllamaMock() {
+  const mock = { requests: [], ports: new Set(), loaded: [] };
+  mock.server = http.createServer((req, res) => {
+    let body = '';
+    req.on('data', chunk => { body += chunk; });
+    req.on('end', () => {
+      const payload = body ? JSON.parse(body) : null;
+      mock.requests.push({ method: req.method, url: req.url, payload });
+      mock.ports.add(req.socket.remotePort);
+      res.setHeader('Content-Type', 'application/json');
+      if (req.url === '/api/ps') {
+        res.end(JSON.stringify({ models: mock.loaded.map(name => ({ name })) }));
+      } else if (req.url === '/api/generate') {
+        mock.loaded.push(`${payload.model}:latest`);
+        res.end(JSON.stringify({ model: payload.model, done: true, done_reason: 'load' }));
+      } else if (req.url === '/api/chat') {
+        res.end(JSON.stringify({ message: { role: 'assistant', content: `${payload.model} says hi` } }));
+      } else if (req.url === '/api/tags') {
+        res.end(JSON.stringify({ models: [{ name: 'codellama:7b' }, { name: 'llama2:latest' }] }));
+      } else {
+        res.end(JSON.stringify({ version: '0.5.0' }));
+      }
+    });
+  });
+  await new Promise(resolve => mock.server.listen(0, '127.0.0.1', resolve));
+  mock.host = `http://127.0.0.1:${mock.server.address().port}`;
+  return mock;
+}
+
+async function stopOllamaMock(mock) {
+  mock.server.closeAllConnections();
+  await new Promise(resolve => mock.server.close(resolve));
+}
+
+test('ollama chat uses the configured model and keep_alive over one connection', async () => {
+  const mock = await startOllamaMock();
+  try {
+    const handlers = loadHandlers();
+    const config = { ollamaHost: mock.host, ollamaModel: 'codellama:7b', ollamaKeepAlive: '-1', autoContext: false, responseCache: false };
+
+    assert.deepStrictEqual(await handlers.get('assistant-ollama-health')({}, { config }), { success: true, version: '0.5.0' });
+    assert.deepStrictEqual((await handlers.get('assistant-ollama-models')({}, { config })).models, ['codellama:7b', 'llama2:latest']);
+    const result = await handlers.get('assistant-chat')({}, { provider: 'ollama', message: 'hello', config });
+
+    assert.deepStrictEqual(result, { success: true, reply: 'codellama:7b says hi' });
+    const chat = mock.requests.find(r => r.url === '/api/chat');
+    assert.strictEqual(chat.payload.model, 'codellama:7b');
+    assert.strictEqual(chat.payload.keep_alive, -1);
+    assert.strictEqual(mock.ports.size, 1);
+  } finally {
+    await stopOllamaMock(mock);
+  }
+});
+
+test('preload loads the model once and skips it when already resident', async () => {
+  const mock = await startOllamaMock();
+  try {
+    const handlers = loadHandlers();
+    const preload = handlers.get('assistant-ollama-preload');
+    const config = { ollamaHost: mock.host };
+
+    const [first, concurrent] = await Promise.all([preload({}, { config }), preload({}, { config })]);
+    assert.strictEqual(first.success, true);
+    assert.strictEqual(first.alreadyLoaded, false);
+    assert.strictEqual(concurrent, first);
+    const loads = mock.requests.filter(r => r.url === '/api/generate');
+    assert.deepStrictEqual(loads.map(r => r.payload), [{ model: 'llama2', keep_alive: '30m', stream: false }]);
+
+    const again = await preload({}, { config });
+    assert.strictEqual(again.alreadyLoaded, true);
+    assert.strictEqual(mock.requests.filter(r => r.url === '/api/generate').length, 1);
+  } finally {
+    await stopOllamaMock(mock);
+  }
+});
@@ -0,0 +1,88 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+
+const { OutputCoalescer } = require('../src/main/utils/outputCoalescer');
+
+function fakeTimers() {
+  const timers = new Map();
+  let nextId = 1;
+  return {
+    setTimer: (fn) => { timers.set(nextId, fn); return nextId++; },
+    clearTimer: (id) => timers.delete(id),
+    pending: () => timers.size,
+    fire: () => {
+      const due = Array.from(timers.values());
+      timers.clear();
+      due.forEach(fn => fn());
+    }
+  };
+}
+
+function createStream(options = {}) {
+  const timers = fakeTimers();
+  const sent = [];
+  const events = [];
+  const stream = new OutputCoalescer((text, meta) => sent.push([text, meta]), {
+    id: 7,
+    maxBatch: 10,
+    highWaterMark: 20,
+    lowWaterMark: 5,
+    onPause: () => events.push('pause'),
+    onResume: () => events.push('resume'),
+    setTimer: timers.setTimer,
+    clearTimer: timers.clearTimer,
+    ...options
+  });
+  return { stream, timers, sent, events };
+}
+
+test('coalesces writes into one batch per interval', () => {
+  const { stream, timers, sent } = createStream();
+  stream.write('ab');
+  stream.write('cd');
+  assert.strictEqual(sent.length, 0);
+  assert.strictEqual(timers.pending(), 1);
+
+  timers.fire();
+  assert.deepStrictEqual(sent, [['abcd', { stream: 7, seq: 1 }]]);
+
+  stream.write('e');
+  stream.end();
+  assert.deepStrictEqual(sent[1], ['e', { stream: 7, seq: 2 }]);
+  assert.strictEqual(timers.pending(), 0);
+  stream.write('ignored');
+  assert.strictEqual(sent.length, 2);
+});
+
+test('flushes at once when a batch reaches the size threshold', () => {
+  const { stream, timers, sent } = createStream();
+  stream.write('12345');
+  stream.write('67890');
+  assert.deepStrictEqual(sent.map(s => s[0]), ['1234567890']);
+  assert.strictEqual(timers.pending(), 0);
+});
+
+test('pauses above the high-water mark and resumes below the low-water mark', () => {
+  const { stream, sent, events } = createStream();
+  stream.write('x'.repeat(10));
+  stream.ack(10);
+  assert.strictEqual(stream.flowControl, true);
+
+  stream.write('x'.repeat(10));
+  stream.write('x'.repeat(10));
+  assert.deepStrictEqual(events, ['pause']);
+  assert.strictEqual(stream.unacked, 20);
+
+  stream.ack(10);
+  assert.deepStrictEqual(events, ['pause']);
+  stream.ack(10);
+  assert.deepStrictEqual(events, ['pause', 'resume']);
+  assert.strictEqual(sent.length, 3);
+});
+
+test('never pauses a renderer that does not acknowledge', () => {
+  const { stream, events } = createStream();
+  for (let i = 0; i < 10; i++) stream.write('x'.repeat(10));
+  assert.strictEqual(stream.unacked, 100);
+  assert.deepStrictEqual(events, []);
+});
@@ -0,0 +1,77 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+
+const { PerfMonitor, LatencyHistogram } = require('../src/renderer/utils/perfMonitor');
+
+/**
+ * Monitor with a manual clock
+ */
+function createMonitor() {
+  const clock = { time: 0 };
+  const monitor = new PerfMonitor({ now: () => clock.time });
+  return { monitor, clock };
+}
+
+test('long tasks are attributed to the innermost overlapping operation', () => {
+  const { monitor, clock } = createMonitor();
+  class Panel {
+    constructor() { this.rows = 3; }
+    render() {
+      clock.time += 10;
+      const html = this.renderRows();
+      clock.time += 5;
+      return html;
+    }
+    renderRows() {
+      clock.time += 120;
+      return `${this.rows} rows`;
+    }
+  }
+  monitor.instrument(Panel.prototype, ['render', 'renderRows', 'missing'], 'panel');
+
+  assert.strictEqual(new Panel().render(), '3 rows');
+  monitor.measure('tree.render', () => { clock.time += 60; });
+
+  assert.strictEqual(monitor.attribute(12, 115), 'panel.renderRows');
+  assert.strictEqual(monitor.attribute(0, 12), 'panel.render');
+  assert.strictEqual(monitor.attribute(136, 58), 'tree.render');
+  assert.strictEqual(monitor.attribute(1000, 80), 'unattributed');
+});
+
+test('histogram reports buckets and percentiles over a rolling window', () => {
+  const histogram = new LatencyHistogram(4);
+  [500, 10, 40, 120, 24].forEach(ms => histogram.add(ms));
+
+  const summary = histogram.summary();
+  assert.strictEqual(summary.count, 4);
+  assert.strictEqual(summary.max, 120);
+  assert.strictEqual(summary.p50, 24);
+  assert.strictEqual(summary.p99, 120);
+  const counts = Object.fromEntries(summary.buckets.map(b => [b.le, b.count]));
+  assert.deepStrictEqual(counts, { 16: 1, 32: 1, 50: 1, 100: 0, 200: 1, 300: 0, 500: 0, 1000: 0, '+Inf': 0 });
+});
+
+test('status and report summarize recent long tasks', () => {
+  const { monitor, clock } = createMonitor();
+  assert.strictEqual(monitor.getStatus().level, 'ok');
+
+  monitor.measure('diagnostics.renderDiagnostics', () => { clock.time += 300; });
+  monitor.recordLongTask(0, 300);
+  monitor.recordLongTask(400, 80);
+  monitor.recordLongTask(600, 90);
+  monitor.latency.add(40);
+
+  const status = monitor.getStatus();
+  assert.strictEqual(status.level, 'bad');
+  assert.strictEqual(status.longTasks, 3);
+  assert.strictEqual(status.blockingMs, 250 + 30 + 40);
+  assert.strictEqual(status.worst.name, 'diagnostics.renderDiagnostics');
+
+  const report = monitor.getReport({ appVersion: '1.0.0' });
+  assert.strictEqual(report.appVersion, '1.0.0');
+  assert.strictEqual(report.inputToPaint.count, 1);
+  assert.deepStrictEqual(report.longTasks, [
+    { name: 'diagnostics.renderDiagnostics', count: 1, totalMs: 300, maxMs: 300 },
+    { name: 'unattributed', count: 2, totalMs: 170, maxMs: 90 }
+  ]);
+});
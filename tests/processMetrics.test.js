@@ -0,0 +1,102 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const path = require('node:path');
+const os = require('node:os');
+const fs = require('node:fs');
+
+const { parseProcStat, parseStatusRss, ChildProcessTracker, HeapSnapshotWatcher } = require('../src/main/utils/processMetrics');
+
+function statLine(pid, name, state, utime, stime, rssPages) {
+  // Fields 4..13 and 16..23 are irrelevant here
+  const fields = [state, ...Array(10).fill('0'), utime, stime, ...Array(8).fill('0'), rssPages, '0'];
+  return `${pid} (${name}) ${fields.join(' ')}\n`;
+}
+
+test('parses /proc stat and status files', () => {
+  assert.deepStrictEqual(parseProcStat(statLine(42, 'ctrace (x)', 'R', 150, 50, 300)), {
+    name: 'ctrace (x)',
+    state: 'R',
+    cpuTicks: 200,
+    rssPages: 300
+  });
+  assert.strictEqual(parseProcStat('garbage'), null);
+  assert.strictEqual(parseStatusRss('Name:\tctrace\nVmRSS:\t   2048 kB\n'), 2048 * 1024);
+  assert.strictEqual(parseStatusRss('Name:\tkthreadd\n'), null);
+});
+
+test('tracker computes CPU from tick deltas and drops exited children', async () => {
+  const procRoot = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-proc-'));
+  const writeProc = (pid, ticks, state = 'S') => {
+    fs.mkdirSync(path.join(procRoot, String(pid)), { recursive: true });
+    fs.writeFileSync(path.join(procRoot, String(pid), 'stat'), statLine(pid, 'ctrace', state, ticks, 0, 10));
+    fs.writeFileSync(path.join(procRoot, String(pid), 'status'), 'VmRSS:\t1024 kB\n');
+  };
+  let now = 1000;
+  const tracker = new ChildProcessTracker({ procRoot, now: () => now });
+  try {
+    writeProc(100, 0);
+    writeProc(101, 0);
+    tracker.register(100, 'ctrace');
+    tracker.register(101, 'socat');
+    tracker.register(102, 'gone');
+
+    const first = await tracker.sample();
+    assert.deepStrictEqual(first.map(c => [c.pid, c.label, c.cpuPercent, c.rssBytes]), [[100, 'ctrace', null, 1048576], [101, 'socat', null, 1048576]]);
+    assert.strictEqual(tracker.children.has(102), false);
+
+    // 50 ticks = 500 ms of CPU over 1 s of wall time
+    now += 1000;
+    writeProc(100, 50);
+    writeProc(101, 0, 'Z');
+    const second = await tracker.sample();
+    assert.deepStrictEqual(second.map(c => [c.pid, c.cpuPercent, c.runningMs]), [[100, 50, 1000]]);
+    assert.deepStrictEqual(Array.from(tracker.children.keys()), [100]);
+  } finally {
+    fs.rmSync(procRoot, { recursive: true, force: true });
+  }
+});
+
+test('heap snapshot watcher captures once per crossing and keeps the newest files', async () => {
+  const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-heap-'));
+  let now = Date.UTC(2024, 0, 1);
+  const captured = [];
+  const watcher = new HeapSnapshotWatcher({
+    directory,
+    thresholdMb: 1000,
+    now: () => now,
+    capture: async (target, filePath) => {
+      captured.push(target);
+      fs.writeFileSync(filePath, '{}');
+    }
+  });
+  try {
+    assert.strictEqual((await watcher.check([{ key: 'main', memoryMb: 950, target: 'm' }])).length, 0);
+    assert.strictEqual((await watcher.check([{ key: 'main', memoryMb: 1200, target: 'm' }])).length, 1);
+
+    // Still above the limit, or back above it within the cooldown: no new file
+    now += 60 * 1000;
+    assert.strictEqual((await watcher.check([{ key: 'main', memoryMb: 1300, target: 'm' }])).length, 0);
+    await watcher.check([{ key: 'main', memoryMb: 800, target: 'm' }]);
+    assert.strictEqual((await watcher.check([{ key: 'main', memoryMb: 1100, target: 'm' }])).length, 0);
+
+    // Re-armed and past the cooldown
+    now += 10 * 60 * 1000;
+    await watcher.check([{ key: 'main', memoryMb: 800, target: 'm' }]);
+    const [snapshot] = await watcher.check([{ key: 'main', memoryMb: 1100, target: 'm' }]);
+    assert.match(snapshot.reason, /1100 MB >= 1000 MB/);
+    assert.deepStrictEqual(captured, ['m', 'm']);
+
+    watcher.setThreshold(0);
+    assert.strictEqual((await watcher.check([{ key: 'other', memoryMb: 5000, target: 'o' }])).length, 0);
+
+    for (let i = 0; i < 6; i++) {
+      now += 1000;
+      await watcher.take(`renderer-${i}`, 'r', 'manual');
+    }
+    assert.strictEqual(watcher.snapshots.length, 5);
+    assert.strictEqual(fs.readdirSync(directory).length, 5);
+    assert.strictEqual(watcher.snapshots[0].key, 'renderer-1');
+  } finally {
+    fs.rmSync(directory, { recursive: true, force: true });
+  }
+});
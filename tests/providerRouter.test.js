@@ -0,0 +1,143 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const http = require('node:http');
+
+const ProviderRouter = require('../src/main/external_llm/ProviderRouter');
+const providerRegistry = require('../src/main/external_llm/ProviderRegistry');
+
+/**
+ * OpenAI-compatible mock server that waits `delayMs` before responding
+ */
+async function startMockServer(name, delayMs) {
+  const server = {
+    requests: 0,
+    aborted: 0,
+    delayMs,
+    fail: false
+  };
+  server.http = http.createServer((req, res) => {
+    server.requests++;
+    let done = false;
+    req.resume();
+    const timer = setTimeout(() => {
+      done = true;
+      if (server.fail) {
+        res.writeHead(500, { 'Content-Type': 'application/json' });
+        res.end(JSON.stringify({ error: { message: `${name} failed` } }));
+        return;
+      }
+      res.writeHead(200, { 'Content-Type': 'application/json' });
+      res.end(JSON.stringify({ choices: [{ message: { content: `from ${name}` } }] }));
+    }, server.delayMs);
+    res.on('close', () => {
+      if (!done) {
+        server.aborted++;
+        clearTimeout(timer);
+      }
+    });
+  });
+  await new Promise(resolve => server.http.listen(0, '127.0.0.1', resolve));
+  server.candidate = {
+    id: 'generic',
+    config: { name, model: 'mock', endpoint: `http://127.0.0.1:${server.http.address().port}/v1/chat/completions` }
+  };
+  return server;
+}
+
+async function withServers(delays, callback) {
+  const servers = await Promise.all(delays.map((delay, i) => startMockServer(`server${i}`, delay)));
+  try {
+    await callback(servers);
+  } finally {
+    await Promise.all(servers.map(s => new Promise(resolve => {
+      s.http.closeAllConnections();
+      s.http.close(resolve);
+    })));
+  }
+}
+
+test('hedges to the secondary when the primary stalls and cancels the loser', async () => {
+  await withServers([1000, 20], async ([slow, fast]) => {
+    const router = new ProviderRouter(providerRegistry);
+    const started = Date.now();
+    const result = await router.chat([slow.candidate, fast.candidate], 'hi', {}, { hedgeDelayMs: 50 });
+
+    assert.strictEqual(result.success, true);
+    assert.strictEqual(result.reply, 'from server1');
+    assert.strictEqual(result.hedged, true);
+    assert.ok(Date.now() - started < 500);
+
+    await new Promise(resolve => setTimeout(resolve, 50));
+    assert.strictEqual(slow.aborted, 1);
+    assert.strictEqual(router.getStats(ProviderRouter.keyFor(slow.candidate)).hedges, 1);
+    assert.strictEqual(router.getStats(ProviderRouter.keyFor(fast.candidate)).wins, 1);
+  });
+});
+
+test('demotes a primary that always loses the hedge', async () => {
+  await withServers([400, 20], async ([slow, fast]) => {
+    const router = new ProviderRouter(providerRegistry);
+    const candidates = [slow.candidate, fast.candidate];
+    for (let i = 0; i < 5; i++) {
+      const result = await router.chat(candidates, 'hi', {}, { hedgeDelayMs: 30 });
+      assert.strictEqual(result.reply, 'from server1');
+    }
+    // The loser is recorded once its abort settles
+    await new Promise(resolve => setTimeout(resolve, 50));
+
+    const slowStats = router.getStats(ProviderRouter.keyFor(slow.candidate));
+    assert.strictEqual(slowStats.requests, 5);
+    assert.strictEqual(slowStats.censored, 5);
+    assert.strictEqual(slowStats.errors, 0);
+    assert.ok(slowStats.totalMs >= 40);
+    assert.deepStrictEqual(router.rank(candidates), [fast.candidate, slow.candidate]);
+
+    // Now routed to the faster provider first, without hedging
+    const result = await router.chat(candidates, 'hi', {}, { hedgeDelayMs: 1000 });
+    assert.strictEqual(result.reply, 'from server1');
+    assert.strictEqual(result.hedged, false);
+  });
+});
+
+test('does not hedge when the primary answers before the deadline', async () => {
+  await withServers([10, 10], async ([primary, secondary]) => {
+    const router = new ProviderRouter(providerRegistry);
+    const result = await router.chat([primary.candidate, secondary.candidate], 'hi', {}, { hedgeDelayMs: 500 });
+
+    assert.strictEqual(result.reply, 'from server0');
+    assert.strictEqual(result.hedged, false);
+    assert.strictEqual(secondary.requests, 0);
+    const stats = router.getStats(ProviderRouter.keyFor(primary.candidate));
+    assert.strictEqual(stats.requests, 1);
+    assert.ok(stats.ttftMs >= 10);
+  });
+});
+
+test('fails over immediately when the primary errors', async () => {
+  await withServers([5, 5], async ([broken, healthy]) => {
+    broken.fail = true;
+    const router = new ProviderRouter(providerRegistry);
+    const result = await router.chat([broken.candidate, healthy.candidate], 'hi', {}, { hedgeDelayMs: 5000 });
+
+    assert.strictEqual(result.reply, 'from server1');
+    assert.strictEqual(router.getStats(ProviderRouter.keyFor(broken.candidate)).errorRate, 1);
+  });
+});
+
+test('hedge deadline follows the primary latency percentile and routing prefers faster providers', () => {
+  const router = new ProviderRouter(providerRegistry);
+  const slow = { id: 'openai', config: { model: 'slow' } };
+  const fast = { id: 'groq', config: { model: 'fast' } };
+
+  assert.strictEqual(router.hedgeDelay(ProviderRouter.keyFor(slow), { hedgeDelayMs: 700 }), 700);
+  for (let i = 1; i <= 20; i++) {
+    router.record(ProviderRouter.keyFor(slow), { ttftMs: i * 100, totalMs: i * 100 + 500 });
+    router.record(ProviderRouter.keyFor(fast), { ttftMs: 50, totalMs: 200 });
+  }
+  assert.strictEqual(router.hedgeDelay(ProviderRouter.keyFor(slow), { hedgePercentile: 0.9 }), 1800);
+  assert.strictEqual(router.hedgeDelay(ProviderRouter.keyFor(fast)), 150);
+  assert.deepStrictEqual(router.rank([slow, fast]), [fast, slow]);
+
+  assert.deepStrictEqual(router.rank([fast, slow]), [fast, slow]);
+  assert.deepStrictEqual(router.rank([{ id: 'deepseek', config: {} }, fast]).map(c => c.id), ['deepseek', 'groq']);
+});
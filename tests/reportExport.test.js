@@ -0,0 +1,98 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+
+const { DiagnosticStore } = require('../src/renderer/utils/diagnosticStore');
+const { streamReport, pathToUri } = require('../src/renderer/utils/reportExport');
+const { SarifMerger } = require('../src/shared/sarifMerger');
+
+const diagnostics = [
+  {
+    id: 'd1', ruleId: 'StackBufferOverflow', severity: 'ERROR',
+    location: { file: '/src/main.c', function: 'main', startLine: 12, startColumn: 5, endLine: 12, endColumn: 20 },
+    details: { message: 'write of 8 bytes, "buf" holds 4 <unsafe> & wrong' }
+  },
+  {
+    id: 'd2', ruleId: 'UnusedValue', severity: 'INFO',
+    location: { file: '/src/util.c', function: 'helper', startLine: 3, startColumn: 1, endLine: 3, endColumn: 9 },
+    details: { message: 'value, never read\nsecond line' }
+  },
+  {
+    id: 'd3', ruleId: 'NullDeref', severity: 'WARNING',
+    location: { file: '/src/main.c', function: 'main', startLine: 4, startColumn: 2, endLine: 4, endColumn: 3 },
+    details: { message: 'maybe null' }
+  }
+];
+
+async function exportText(format, extra = {}) {
+  const store = DiagnosticStore.from(diagnostics);
+  const chunks = [];
+  const written = await streamReport(format, { store, rows: store.select('ALL'), ...extra }, async (chunk) => {
+    chunks.push(chunk);
+  }, { chunkSize: 64 });
+  assert.strictEqual(written.rows, diagnostics.length);
+  assert.ok(chunks.length > 1);
+  const text = chunks.join('');
+  assert.strictEqual(written.chars, text.length);
+  return text;
+}
+
+test('writes RFC 4180 CSV', async () => {
+  const lines = (await exportText('csv')).split('\r\n');
+  assert.strictEqual(lines[0], 'severity,rule,file,line,column,end_line,end_column,function,message,tool');
+  assert.strictEqual(lines[1], 'ERROR,StackBufferOverflow,/src/main.c,12,5,12,20,main,"write of 8 bytes, ""buf"" holds 4 <unsafe> & wrong",');
+  assert.strictEqual(lines[2], 'INFO,UnusedValue,/src/util.c,3,1,3,9,helper,"value, never read\nsecond line",');
+});
+
+test('writes an escaped HTML page', async () => {
+  const html = await exportText('html', {
+    meta: { tool: 'ctrace', inputFile: 'main.c' },
+    rules: { StackBufferOverflow: { helpUri: 'https://example.com/sbo' }, NullDeref: { helpUri: 'javascript:alert(1)' } }
+  });
+  assert.match(html, /<title>CTrace report - main\.c<\/title>/);
+  assert.match(html, /1 ERROR/);
+  assert.match(html, /holds 4 &lt;unsafe&gt; &amp; wrong/);
+  assert.match(html, /<a href="https:\/\/example\.com\/sbo">StackBufferOverflow<\/a>/);
+  assert.doesNotMatch(html, /javascript:/);
+  assert.ok(html.trimEnd().endsWith('</html>'));
+});
+
+test('writes JUnit XML with one suite per file', async () => {
+  const xml = await exportText('junit');
+  assert.match(xml, /<testsuites name="ctrace" tests="3" failures="2">/);
+  assert.match(xml, /<testsuite name="\/src\/main\.c" tests="2" failures="2">/);
+  assert.match(xml, /<testsuite name="\/src\/util\.c" tests="1" failures="0">/);
+  // Within a file, cases follow line order
+  assert.ok(xml.indexOf('/src/main.c:4:2') < xml.indexOf('/src/main.c:12:5'));
+  assert.match(xml, /<failure type="ERROR" message="write of 8 bytes, &quot;buf&quot; holds 4 &lt;unsafe&gt; &amp; wrong">/);
+  assert.match(xml, /<system-out>INFO UnusedValue: value, never read\nsecond line<\/system-out>/);
+});
+
+test('writes SARIF that imports back to the same diagnostics', async () => {
+  const sarif = await exportText('sarif', {
+    meta: { tool: 'ctrace' },
+    rules: { StackBufferOverflow: { id: 'StackBufferOverflow', shortDescription: 'Overflow', helpUri: 'https://example.com/sbo', defaultLevel: 'error' } }
+  });
+  const log = JSON.parse(sarif);
+  assert.strictEqual(log.version, '2.1.0');
+  assert.deepStrictEqual(log.runs[0].tool.driver.rules.map(rule => rule.id), ['StackBufferOverflow', 'UnusedValue', 'NullDeref']);
+
+  const merger = new SarifMerger();
+  merger.addDocument(log, 'export.sarif');
+  const imported = merger.finish();
+  assert.deepStrictEqual(
+    imported.diagnostics.map(({ ruleId, severity, location, details }) => ({ ruleId, severity, location, details })),
+    diagnostics.map(({ ruleId, severity, location, details }) => ({ ruleId, severity, location, details }))
+  );
+  assert.strictEqual(imported.rules.StackBufferOverflow.helpUri, 'https://example.com/sbo');
+});
+
+test('turns paths into SARIF URIs', () => {
+  assert.strictEqual(pathToUri('/src/my file#1.c'), 'file:///src/my%20file%231.c');
+  assert.strictEqual(pathToUri('C:\\work\\a.c'), 'file:///C:/work/a.c');
+  assert.strictEqual(pathToUri('src/a.c'), 'src/a.c');
+});
+
+test('rejects unknown formats', async () => {
+  const store = DiagnosticStore.from(diagnostics);
+  await assert.rejects(streamReport('pdf', { store, rows: store.select('ALL') }, async () => {}), /Unknown export format/);
+});
@@ -0,0 +1,187 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const path = require('node:path');
+const os = require('node:os');
+const fs = require('node:fs');
+const Module = require('node:module');
+
+const ResponseCache = require('../src/main/external_llm/ResponseCache');
+
+function withModuleMocks(mocks, callback) {
+  const originalLoad = Module._load;
+  Module._load = function (request, parent, isMain) {
+    if (Object.prototype.hasOwnProperty.call(mocks, request)) {
+      return mocks[request];
+    }
+    return originalLoad.apply(this, arguments);
+  };
+  try {
+    return callback();
+  } finally {
+    Module._load = originalLoad;
+  }
+}
+
+test('keyFor changes with every part of the request', () => {
+  const base = { provider: 'external:openai', model: 'gpt-4', systemPrompt: 'Sys', message: 'explain', context: [] };
+  const key = ResponseCache.keyFor(base);
+  assert.strictEqual(ResponseCache.keyFor({ ...base }), key);
+  for (const [field, value] of [['provider', 'ollama'], ['model', 'gpt-4o'], ['temperature', 0.2], ['maxTokens', 100], ['systemPrompt', 'Other'], ['message', 'why'], ['context', [{ role: 'user', content: 'x' }]]]) {
+    assert.notStrictEqual(ResponseCache.keyFor({ ...base, [field]: value }), key, field);
+  }
+});
+
+test('entries expire after the TTL and the least recently used are evicted', async () => {
+  const cache = new ResponseCache({ maxEntries: 2, ttlMs: 1000 });
+  cache.set('a', 'A');
+  cache.set('b', 'B');
+  cache.get('a');
+  cache.set('c', 'C');
+  assert.deepStrictEqual(Array.from(cache.entries.keys()), ['a', 'c']);
+
+  cache.entries.get('a').createdAt -= 2000;
+  assert.strictEqual(cache.get('a'), null);
+  assert.strictEqual(cache.get('c').reply, 'C');
+});
+
+test('run coalesces identical in-flight requests and caches only successes', async () => {
+  const cache = new ResponseCache();
+  let calls = 0;
+  let release;
+  const fetcher = () => {
+    calls++;
+    return new Promise(resolve => { release = resolve; });
+  };
+
+  const first = cache.run('k', fetcher);
+  const second = cache.run('k', fetcher);
+  release({ success: true, reply: 'answer' });
+  assert.deepStrictEqual(await Promise.all([first, second]), [
+    { success: true, reply: 'answer' },
+    { success: true, reply: 'answer' }
+  ]);
+  assert.deepStrictEqual(await cache.run('k', fetcher), { success: true, reply: 'answer', cached: true });
+  assert.strictEqual(calls, 1);
+
+  const failed = await cache.run('bad', async () => ({ success: false, error: 'boom' }));
+  assert.strictEqual(failed.success, false);
+  assert.strictEqual(cache.get('bad'), null);
+});
+
+test('save and load persist fresh entries', async () => {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-cache-'));
+  const filePath = path.join(dir, 'cache.json');
+  try {
+    const cache = new ResponseCache({ filePath });
+    cache.set('fresh', 'kept');
+    cache.entries.set('stale', { reply: 'dropped', createdAt: Date.now() - 10 * 60 * 60 * 1000 });
+    clearTimeout(cache.saveTimer);
+    cache.saveTimer = null;
+    await cache.save();
+
+    const restored = new ResponseCache();
+    assert.strictEqual(await restored.load(filePath), 1);
+    assert.strictEqual(restored.get('fresh').reply, 'kept');
+    assert.strictEqual(await new ResponseCache().load(path.join(dir, 'missing.json')), 0);
+  } finally {
+    fs.rmSync(dir, { recursive: true, force: true });
+  }
+});
+
+test('assistant-chat serves a repeated question with identical context from the cache', async () => {
+  const handlers = new Map();
+  let calls = 0;
+  const fakeProvider = {
+    validateConfig: () => ({ valid: true, errors: [] }),
+    chat: async (message) => {
+      calls++;
+      return { success: true, reply: `reply ${calls} to ${message}` };
+    }
+  };
+
+  const modulePath = path.join(__dirname, '../src/main/ipc/assistantHandlers.js');
+  const { setupAssistantHandlers } = withModuleMocks({
+    electron: { ipcMain: { handle: (channel, listener) => handlers.set(channel, listener) } },
+    '../external_llm/ProviderRegistry': { createProvider: () => fakeProvider }
+  }, () => {
+    delete require.cache[modulePath];
+    return require(modulePath);
+  });
+  setupAssistantHandlers({});
+
+  const chat = handlers.get('assistant-chat');
+  const clearConversation = handlers.get('assistant-clear-conversation');
+  const config = { providerId: 'openai', model: 'gpt-4', systemPrompt: 'Sys' };
+
+  const first = await chat({}, { provider: 'external', message: 'explain', config });
+  await clearConversation({}, { provider: 'external', config });
+  const second = await chat({}, { provider: 'external', message: 'explain', config });
+  assert.strictEqual(second.reply, first.reply);
+  assert.strictEqual(second.cached, true);
+  assert.strictEqual(calls, 1);
+
+  // Same question after an earlier turn has different context
+  const third = await chat({}, { provider: 'external', message: 'explain', config });
+  assert.strictEqual(third.cached, undefined);
+
+  await handlers.get('assistant-clear-response-cache')();
+  await clearConversation({}, { provider: 'external', config });
+  await chat({}, { provider: 'external', message: 'explain', config: { ...config, responseCache: false } });
+  assert.strictEqual(calls, 3);
+});
+
+function loadHandlers(createProvider) {
+  const handlers = new Map();
+  const modulePath = path.join(__dirname, '../src/main/ipc/assistantHandlers.js');
+  const { setupAssistantHandlers } = withModuleMocks({
+    electron: { ipcMain: { handle: (channel, listener) => handlers.set(channel, listener) } },
+    '../external_llm/ProviderRegistry': { createProvider }
+  }, () => {
+    delete require.cache[modulePath];
+    return require(modulePath);
+  });
+  setupAssistantHandlers({});
+  return handlers;
+}
+
+test('assistant-chat records a coalesced turn once', async () => {
+  const histories = [];
+  const handlers = loadHandlers(() => ({
+    validateConfig: () => ({ valid: true, errors: [] }),
+    chat: async (message, options) => {
+      histories.push(options.history);
+      await new Promise(resolve => setTimeout(resolve, 10));
+      return { success: true, reply: `reply to ${message}` };
+    }
+  }));
+  const chat = handlers.get('assistant-chat');
+  const config = { providerId: 'openai', model: 'gpt-4', systemPrompt: 'Sys' };
+
+  await Promise.all([1, 2, 3].map(() => chat({}, { provider: 'external', message: 'explain', config })));
+  await chat({}, { provider: 'external', message: 'next', config });
+  assert.strictEqual(histories.length, 2);
+  assert.deepStrictEqual(histories[1], [
+    { role: 'user', content: 'explain' },
+    { role: 'assistant', content: 'reply to explain' }
+  ]);
+});
+
+test('assistant-chat does not cache a reply from a fallback provider', async () => {
+  let calls = 0;
+  const handlers = loadHandlers((id) => ({
+    validateConfig: () => ({ valid: true, errors: [] }),
+    chat: async (message) => {
+      calls++;
+      return id === 'openai' ? { success: false, error: 'down' } : { success: true, reply: `${id}: ${message}` };
+    }
+  }));
+  const chat = handlers.get('assistant-chat');
+  const config = { providerId: 'openai', model: 'gpt-4', systemPrompt: 'Sys', fallbackProviders: [{ providerId: 'groq', model: 'llama' }] };
+
+  const first = await chat({}, { provider: 'external', message: 'explain', config });
+  assert.strictEqual(first.reply, 'groq: explain');
+  await handlers.get('assistant-clear-conversation')({}, { provider: 'external', config });
+  const second = await chat({}, { provider: 'external', message: 'explain', config });
+  assert.strictEqual(second.cached, undefined);
+  assert.strictEqual(calls, 4);
+});
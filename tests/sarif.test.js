@@ -0,0 +1,186 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const path = require('node:path');
+const os = require('node:os');
+const fs = require('node:fs');
+
+const { JsonPathStream } = require('../src/main/utils/jsonStream');
+const { readSarifFile } = require('../src/main/utils/sarif');
+const { SarifMerger, isSarifLog, uriToPath } = require('../src/shared/sarifMerger');
+
+function sarifLog(toolName, results, extra = {}) {
+  return {
+    version: '2.1.0',
+    runs: [{
+      ...extra,
+      tool: {
+        driver: {
+          name: toolName,
+          rules: [
+            { id: 'StackEscape', shortDescription: { text: 'Stack address escapes' }, helpUri: 'https://example.com/se', defaultConfiguration: { level: 'error' } },
+            { id: 'Recursion', messageStrings: { default: { text: 'Function {0} calls itself' } } }
+          ]
+        }
+      },
+      results
+    }]
+  };
+}
+
+function result(ruleId, line, text, more = {}) {
+  return {
+    ruleId,
+    message: { text },
+    locations: [{
+      physicalLocation: { artifactLocation: { uri: 'src/main.c', uriBaseId: 'SRCROOT' }, region: { startLine: line, startColumn: 3 } },
+      logicalLocations: [{ name: 'main' }]
+    }],
+    ...more
+  };
+}
+
+test('selects values at matching paths whatever the chunk boundaries', () => {
+  const text = JSON.stringify({
+    skip: { results: [1, 2], text: 'a "quoted" \\ string ]}' },
+    runs: [{ tool: { name: 'x' }, results: [{ a: 1 }, 'two', 3.5e2, null, [true, false], { 'k"ey': ['}'] }] }, { results: [] }]
+  }, null, 1);
+  const expected = [
+    [['runs', 0, 'tool'], { name: 'x' }],
+    [['runs', 0, 'results', 0], { a: 1 }],
+    [['runs', 0, 'results', 1], 'two'],
+    [['runs', 0, 'results', 2], 350],
+    [['runs', 0, 'results', 3], null],
+    [['runs', 0, 'results', 4], [true, false]],
+    [['runs', 0, 'results', 5], { 'k"ey': ['}'] }]
+  ];
+  for (const size of [1, 2, 3, 7, 64, text.length]) {
+    const seen = [];
+    const stream = new JsonPathStream([['runs', '*', 'tool'], ['runs', '*', 'results', '*']], (value, at) => seen.push([at, value]));
+    for (let i = 0; i < text.length; i += size) stream.write(text.slice(i, i + size));
+    stream.end();
+    assert.deepStrictEqual(seen, expected, `chunk size ${size}`);
+  }
+});
+
+test('rejects truncated and malformed documents', () => {
+  const truncated = new JsonPathStream([['a']], () => {});
+  truncated.write('{"a": [1, 2');
+  assert.throws(() => truncated.end(), /Unexpected end/);
+
+  const malformed = new JsonPathStream([['a']], () => {});
+  assert.throws(() => malformed.write('{"a": [1,, 2]}'), /Unexpected token/);
+});
+
+test('converts results and merges runs without duplicates', () => {
+  const merger = new SarifMerger();
+  merger.addDocument(sarifLog('ctrace', [
+    result('StackEscape', 10, 'variable \'buf\' escapes'),
+    { ruleIndex: 1, message: { id: 'default', arguments: ['fib'] }, locations: [] },
+    result('StackEscape', 10, 'variable \'buf\' escapes')
+  ], { originalUriBaseIds: { SRCROOT: { uri: 'file:///home/me/project/' } } }), 'a.sarif');
+  merger.addDocument(sarifLog('other', [
+    result('StackEscape', 10, 'variable \'buf\' escapes'),
+    result('Leak', 20, 'leak', { level: 'note', partialFingerprints: { hash: 'abc' } }),
+    result('Leak', 21, 'leak moved', { level: 'note', partialFingerprints: { hash: 'abc' } })
+  ], { originalUriBaseIds: { SRCROOT: { uri: 'file:///home/me/project/' } } }), 'b.sarif');
+
+  const merged = merger.finish();
+  assert.deepStrictEqual(merged.diagnostics.map(d => [d.ruleId, d.severity, d.location.startLine, d.details.message]), [
+    ['StackEscape', 'ERROR', 10, 'variable \'buf\' escapes'],
+    ['Recursion', 'WARNING', 0, 'Function fib calls itself'],
+    ['Leak', 'INFO', 20, 'leak']
+  ]);
+  assert.strictEqual(merged.diagnostics[0].location.file, '/home/me/project/src/main.c');
+  assert.strictEqual(merged.diagnostics[0].location.function, 'main');
+  assert.deepStrictEqual(merged.meta, {
+    tool: 'ctrace, other',
+    mode: 'SARIF',
+    inputFile: '2 SARIF files',
+    runs: 2,
+    results: 6,
+    duplicates: 3,
+    diagnostics: 3
+  });
+  assert.strictEqual(merged.rules.StackEscape.helpUri, 'https://example.com/se');
+  assert.strictEqual(merged.rules.StackEscape.tool, 'ctrace');
+  assert.deepStrictEqual(merged.functions, ['main']);
+});
+
+test('streams a SARIF file with results before the tool', async () => {
+  const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-sarif-'));
+  try {
+    const log = sarifLog('ctrace', [result('StackEscape', 1, 'x'), result('Recursion', 2, 'y')]);
+    const run = log.runs[0];
+    // Results first: their default level is resolved once the rules are known
+    const reordered = { version: log.version, runs: [{ results: run.results, tool: run.tool }] };
+    const filePath = path.join(directory, 'out.sarif');
+    fs.writeFileSync(filePath, '\uFEFF' + JSON.stringify(reordered));
+
+    const merger = new SarifMerger();
+    const progress = [];
+    await readSarifFile(filePath, merger, bytes => progress.push(bytes));
+    const merged = merger.finish();
+    assert.deepStrictEqual(merged.diagnostics.map(d => d.severity), ['ERROR', 'WARNING']);
+    assert.strictEqual(merged.meta.inputFile, filePath);
+    assert.ok(progress.length > 0);
+  } finally {
+    fs.rmSync(directory, { recursive: true, force: true });
+  }
+});
+
+test('hands diagnostics to a sink instead of keeping them', () => {
+  const received = [];
+  const merger = new SarifMerger({ onDiagnostic: diag => received.push(diag) });
+  merger.addDocument(sarifLog('ctrace', [
+    result('StackEscape', 10, 'x'),
+    result('StackEscape', 10, 'x'),
+    result('Recursion', 12, 'y')
+  ]));
+  const merged = merger.finish();
+  assert.deepStrictEqual(received.map(d => d.id), ['sarif-1', 'sarif-2']);
+  assert.deepStrictEqual(merged.diagnostics, []);
+  assert.strictEqual(merged.meta.diagnostics, 2);
+  assert.deepStrictEqual(merged.functions, ['main']);
+});
+
+test('recognizes SARIF logs and file URIs', () => {
+  assert.strictEqual(isSarifLog({ version: '2.1.0', runs: [] }), true);
+  assert.strictEqual(isSarifLog({ meta: {}, diagnostics: [] }), false);
+  assert.strictEqual(uriToPath('file:///C:/work/a%20b.c'), 'C:/work/a b.c');
+  assert.strictEqual(uriToPath('lib/x.c', 'file:///src'), '/src/lib/x.c');
+  assert.strictEqual(uriToPath('https://host/x.c', 'file:///src'), 'https://host/x.c');
+});
+
+test('import sends diagnostics in batches and the tail with the reply', async () => {
+  const Module = require('node:module');
+  const handlers = new Map();
+  const originalLoad = Module._load;
+  Module._load = function (request) {
+    if (request === 'electron') return { ipcMain: { handle: (channel, handler) => handlers.set(channel, handler) }, dialog: {} };
+    return originalLoad.apply(this, arguments);
+  };
+  try {
+    const modulePath = path.join(__dirname, '../src/main/ipc/sarifHandlers.js');
+    delete require.cache[modulePath];
+    require(modulePath).setupSarifHandlers(null);
+  } finally {
+    Module._load = originalLoad;
+  }
+
+  const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-sarif-'));
+  try {
+    const filePath = path.join(directory, 'big.sarif');
+    const results = Array.from({ length: 5003 }, (_, i) => result('StackEscape', i + 1, `finding ${i}`));
+    fs.writeFileSync(filePath, JSON.stringify(sarifLog('ctrace', results)));
+
+    const batches = [];
+    const sender = { send: (channel, data) => { if (channel === 'sarif-import-batch') batches.push(data.length); } };
+    const reply = await handlers.get('import-sarif')({ sender }, { filePaths: [filePath] });
+    assert.strictEqual(reply.success, true);
+    assert.deepStrictEqual(batches, [5000]);
+    assert.strictEqual(reply.diagnostics.length, 3);
+    assert.strictEqual(reply.meta.diagnostics, 5003);
+  } finally {
+    fs.rmSync(directory, { recursive: true, force: true });
+  }
+});
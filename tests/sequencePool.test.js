@@ -0,0 +1,72 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+
+const SequencePool = require('../src/main/utils/SequencePool');
+
+test('run hands out every sequence in parallel and queues the rest', async () => {
+  const pool = new SequencePool(['s1', 's2']);
+  const releases = [];
+  const used = [];
+  const task = (sequence) => new Promise(resolve => {
+    used.push(sequence);
+    releases.push(() => resolve(sequence));
+  });
+
+  const runs = [pool.run('chat', task), pool.run('chat', task), pool.run('chat', task)];
+  await new Promise(resolve => setImmediate(resolve));
+  assert.deepStrictEqual(pool.getStatus(), { size: 2, busy: 2, queued: 1 });
+  assert.strictEqual(new Set(used).size, 2);
+
+  releases.shift()();
+  await new Promise(resolve => setImmediate(resolve));
+  assert.strictEqual(used.length, 3);
+  releases.forEach(release => release());
+  await Promise.all(runs);
+  assert.deepStrictEqual(pool.getStatus(), { size: 2, busy: 0, queued: 0 });
+});
+
+test('waiting clients are served round-robin', async () => {
+  const pool = new SequencePool(['only']);
+  const order = [];
+  const first = await pool.acquire('bulk');
+
+  const waits = [];
+  for (let i = 0; i < 3; i++) {
+    waits.push(pool.acquire('bulk').then(sequence => { order.push(`bulk${i}`); pool.release(sequence); }));
+  }
+  waits.push(pool.acquire('chat').then(sequence => { order.push('chat'); pool.release(sequence); }));
+
+  pool.release(first);
+  await Promise.all(waits);
+  assert.deepStrictEqual(order, ['bulk0', 'chat', 'bulk1', 'bulk2']);
+});
+
+test('close rejects queued requests', async () => {
+  const pool = new SequencePool(['only']);
+  await pool.acquire('a');
+  const waiting = pool.acquire('b');
+  pool.close();
+  await assert.rejects(waiting, /unloaded/);
+  await assert.rejects(pool.acquire('c'), /closed/);
+});
+
+test('owners get back the sequence holding their state', async () => {
+  const pool = new SequencePool(['s1', 's2', 's3']);
+  const used = (owner) => pool.run('chat', async (sequence, { previousOwner }) => ({ sequence, previousOwner }), owner);
+
+  const a = await used('a');
+  const b = await used('b');
+  assert.notStrictEqual(b.sequence, a.sequence);
+  assert.deepStrictEqual(await used('a'), { sequence: a.sequence, previousOwner: 'a' });
+
+  // Unowned work takes the sequence nobody holds state in
+  const bulk = await pool.run('bulk', async sequence => sequence);
+  assert.ok(![a.sequence, b.sequence].includes(bulk));
+
+  // With every sequence owned, a new owner takes over the least recently used one
+  const c = await used('c');
+  assert.strictEqual(c.previousOwner, null);
+  const d = await used('d');
+  assert.strictEqual(d.previousOwner, 'b');
+  assert.strictEqual(d.sequence, b.sequence);
+});
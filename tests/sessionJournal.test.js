@@ -0,0 +1,144 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const path = require('node:path');
+const os = require('node:os');
+const fs = require('node:fs');
+
+const { SessionJournal, applyRecord, emptySession } = require('../src/main/utils/sessionJournal');
+
+function tempDir() {
+  return fs.mkdtempSync(path.join(os.tmpdir(), 'ctrace-session-'));
+}
+
+const RECORDS = [
+  { type: 'workspace', path: '/work' },
+  { type: 'open', key: 'a', filePath: '/work/a.c', fileName: 'a.c', fileInfo: {} },
+  { type: 'open', key: 'b', filePath: '/work/b.c', fileName: 'b.c', fileInfo: {} },
+  { type: 'active', key: 'b' },
+  { type: 'view', key: 'b', viewState: { cursorState: [{ position: { lineNumber: 12, column: 3 } }] } },
+  { type: 'edit', key: 'a', content: 'int main(void) { return 1; }\n' },
+  { type: 'diagnostics', filePath: '/work/b.c', output: '{"diagnostics":[]}', at: 1 }
+];
+
+test('replays records into tabs, view states, edits and diagnostics', () => {
+  const state = RECORDS.reduce(applyRecord, emptySession());
+  assert.strictEqual(state.workspace, '/work');
+  assert.deepStrictEqual(state.tabs.map(tab => tab.key), ['a', 'b']);
+  assert.strictEqual(state.activeKey, 'b');
+  assert.strictEqual(state.tabs[0].modified, true);
+  assert.strictEqual(state.tabs[0].content, RECORDS[5].content);
+  assert.strictEqual(state.tabs[1].viewState.cursorState[0].position.lineNumber, 12);
+  assert.deepStrictEqual(state.diagnostics['/work/b.c'], { at: 1 });
+
+  applyRecord(state, { type: 'saved', key: 'a' });
+  applyRecord(state, { type: 'close', key: 'b' });
+  assert.deepStrictEqual(state.tabs.map(tab => [tab.key, tab.modified, tab.content]), [['a', false, null]]);
+  assert.strictEqual(state.activeKey, null);
+});
+
+test('replaying records twice gives the same session', () => {
+  const once = RECORDS.reduce(applyRecord, emptySession());
+  const twice = RECORDS.reduce(applyRecord, RECORDS.reduce(applyRecord, emptySession()));
+  assert.deepStrictEqual(twice, once);
+});
+
+test('keeps the diagnostics of the most recently analyzed files only', () => {
+  const state = emptySession();
+  for (let i = 0; i < 25; i++) applyRecord(state, { type: 'diagnostics', filePath: `/f${i}.c`, output: '{}' });
+  applyRecord(state, { type: 'diagnostics', filePath: '/f5.c', output: '{}' });
+  const files = Object.keys(state.diagnostics);
+  assert.strictEqual(files.length, 20);
+  assert.ok(!files.includes('/f0.c'));
+  assert.strictEqual(files[files.length - 1], '/f5.c');
+});
+
+test('restores appended records after a restart and compacts only when asked', async () => {
+  const dir = tempDir();
+  const first = new SessionJournal(dir);
+  await first.restore();
+  await first.append(RECORDS.slice(0, 4));
+  await first.append(RECORDS.slice(4));
+  await first.close();
+  const journalSize = fs.statSync(first.journalPath).size;
+  assert.ok(journalSize > 0);
+
+  const second = new SessionJournal(dir);
+  const session = await second.restore();
+  assert.deepStrictEqual(session, RECORDS.reduce(applyRecord, emptySession()));
+  assert.strictEqual(fs.statSync(second.journalPath).size, journalSize);
+  assert.ok(!fs.existsSync(second.snapshotPath));
+
+  await second.compact();
+  assert.strictEqual(fs.statSync(second.journalPath).size, 0);
+  assert.deepStrictEqual(JSON.parse(fs.readFileSync(second.snapshotPath, 'utf8')), session);
+  await second.close();
+});
+
+test('keeps diagnostics output out of the journal and the restored session', async () => {
+  const dir = tempDir();
+  const journal = new SessionJournal(dir);
+  await journal.restore();
+  const output = JSON.stringify({ diagnostics: [{ message: 'x'.repeat(10000) }] });
+  await journal.append([{ type: 'diagnostics', filePath: '/work/a.c', output, at: 2 }]);
+  await journal.close();
+  assert.ok(fs.statSync(journal.journalPath).size < 200);
+
+  const restored = new SessionJournal(dir);
+  const session = await restored.restore();
+  assert.deepStrictEqual(session.diagnostics, { '/work/a.c': { at: 2 } });
+  assert.strictEqual(await restored.loadDiagnostics('/work/a.c'), output);
+  assert.strictEqual(await restored.loadDiagnostics('/work/b.c'), null);
+  await restored.close();
+});
+
+test('compaction removes the diagnostics of files no longer kept', async () => {
+  const journal = new SessionJournal(tempDir());
+  await journal.restore();
+  for (let i = 0; i < 22; i++) {
+    await journal.append([{ type: 'diagnostics', filePath: `/f${i}.c`, output: `{"n":${i}}` }]);
+  }
+  assert.strictEqual(fs.readdirSync(journal.diagnosticsDir).length, 22);
+  await journal.compact();
+  assert.strictEqual(fs.readdirSync(journal.diagnosticsDir).length, 20);
+  assert.strictEqual(await journal.loadDiagnostics('/f0.c'), null);
+  assert.strictEqual(await journal.loadDiagnostics('/f21.c'), '{"n":21}');
+  await journal.close();
+});
+
+test('ignores a torn last line left by a crash', async () => {
+  const dir = tempDir();
+  const journal = new SessionJournal(dir);
+  await journal.restore();
+  await journal.append(RECORDS.slice(0, 3));
+  await journal.close();
+  fs.appendFileSync(journal.journalPath, '{"type":"close","ke');
+
+  const reopened = new SessionJournal(dir);
+  const session = await reopened.restore();
+  assert.deepStrictEqual(session.tabs.map(tab => tab.key), ['a', 'b']);
+
+  // Records appended after the torn line survive the next restart
+  await reopened.append([{ type: 'active', key: 'a' }]);
+  await reopened.close();
+  assert.strictEqual((await new SessionJournal(dir).restore()).activeKey, 'a');
+});
+
+test('compacts once the journal grows past its limit', async () => {
+  const dir = tempDir();
+  const journal = new SessionJournal(dir, { compactBytes: 4096 });
+  await journal.restore();
+  await journal.append([{ type: 'open', key: 'a', filePath: '/a.c', fileName: 'a.c' }]);
+  for (let i = 0; i < 50; i++) {
+    await journal.append([{ type: 'edit', key: 'a', content: `edit ${i} `.repeat(20) }]);
+  }
+  assert.ok(fs.statSync(journal.journalPath).size <= 4096);
+  await journal.close();
+
+  const session = await new SessionJournal(dir).restore();
+  assert.strictEqual(session.tabs[0].content, 'edit 49 '.repeat(20));
+});
+
+test('starts empty without a snapshot or journal', async () => {
+  const session = await new SessionJournal(path.join(tempDir(), 'missing')).restore();
+  assert.deepStrictEqual(session, emptySession());
+});
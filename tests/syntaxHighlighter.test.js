@@ -0,0 +1,90 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const path = require('node:path');
+
+const modulePath = path.join(__dirname, '../src/renderer/utils/syntaxHighlighter.js');
+delete require.cache[modulePath];
+const {
+  applySyntaxHighlight,
+  tokenizeCpp,
+  IncrementalHighlighter
+} = require(modulePath);
+
+const sample = [
+  '#include <stdio.h>',
+  '#define MAX(a, b) \\',
+  '  ((a) > (b) ? (a) : (b))',
+  '/* block',
+  '   comment */',
+  'const char *raw = R"x(line one',
+  'line two)x";',
+  'int main(void) {',
+  '  printf("%d\\n", MAX(1, 2)); // done',
+  '  return 0;',
+  '}'
+].join('\n');
+
+test('tokenizeCpp keeps block comments and raw strings across lines', () => {
+  const tokens = tokenizeCpp(sample, { keywords: new Set(['int', 'return', 'const', 'char', 'void']), types: new Set() });
+  const comments = tokens.filter((t) => t.type === 'comment').map((t) => t.value);
+  assert.deepStrictEqual(comments, ['/* block', '   comment */', '// done']);
+  const strings = tokens.filter((t) => t.type === 'string').map((t) => t.value);
+  assert.ok(strings.includes('R"x(line one'));
+  assert.ok(strings.includes('line two)x"'));
+  assert.strictEqual(tokens.map((t) => t.value).join(''), sample);
+});
+
+test('IncrementalHighlighter output matches a full highlight', () => {
+  const highlighter = new IncrementalHighlighter('C');
+  highlighter.update(sample);
+  assert.strictEqual(highlighter.getHtml(), applySyntaxHighlight(sample, 'C'));
+  assert.strictEqual(highlighter.getLineCount(), sample.split('\n').length);
+});
+
+test('IncrementalHighlighter re-tokenizes only the edited line when state is unchanged', () => {
+  const lines = [];
+  for (let i = 0; i < 1000; i++) lines.push(`int value${i} = ${i};`);
+  const highlighter = new IncrementalHighlighter('C');
+  highlighter.update(lines.join('\n'));
+
+  lines[500] = 'int value500 = 42;';
+  const stats = highlighter.update(lines.join('\n'));
+  assert.deepStrictEqual(stats, { firstLine: 500, retokenizedLines: 1 });
+  assert.strictEqual(highlighter.getHtml(), applySyntaxHighlight(lines.join('\n'), 'C'));
+});
+
+test('IncrementalHighlighter propagates an opened comment until the state converges', () => {
+  const lines = [];
+  for (let i = 0; i < 100; i++) lines.push(`int v${i};`);
+  lines[60] = '/* existing */';
+  const highlighter = new IncrementalHighlighter('C++');
+  highlighter.update(lines.join('\n'));
+
+  lines[10] = '/* opened';
+  lines[20] = 'closed */';
+  let stats = highlighter.update(lines.join('\n'));
+  // Lines 10..20 change together in one diff, the rest keeps its cached state
+  assert.strictEqual(stats.firstLine, 10);
+  assert.strictEqual(stats.retokenizedLines, 11);
+  assert.strictEqual(highlighter.getHtml(), applySyntaxHighlight(lines.join('\n'), 'C++'));
+
+  lines[20] = 'int v20;';
+  stats = highlighter.update(lines.join('\n'));
+  // Removing the terminator leaves the comment open down to the next '*/' on line 60
+  assert.strictEqual(stats.firstLine, 20);
+  assert.strictEqual(stats.retokenizedLines, 41);
+  assert.strictEqual(highlighter.getHtml(), applySyntaxHighlight(lines.join('\n'), 'C++'));
+});
+
+test('IncrementalHighlighter handles inserted and deleted lines', () => {
+  const highlighter = new IncrementalHighlighter('C');
+  highlighter.update(sample);
+
+  const inserted = sample.replace('int main', 'static int helper;\nint main');
+  highlighter.update(inserted);
+  assert.strictEqual(highlighter.getHtml(), applySyntaxHighlight(inserted, 'C'));
+
+  const removed = inserted.split('\n').slice(0, 3).concat(inserted.split('\n').slice(7)).join('\n');
+  highlighter.update(removed);
+  assert.strictEqual(highlighter.getHtml(), applySyntaxHighlight(removed, 'C'));
+});
@@ -0,0 +1,108 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+
+const { TaskScheduler } = require('../src/renderer/utils/taskScheduler');
+
+/**
+ * Scheduler with a manual clock and slice queue
+ */
+function createScheduler() {
+  const clock = { time: 0 };
+  const posted = [];
+  const scheduler = new TaskScheduler({
+    now: () => clock.time,
+    post: (priority, callback) => posted.push({ priority, callback }),
+    inputPending: () => clock.input === true
+  });
+  const runNextSlice = () => posted.shift().callback(8);
+  return { scheduler, clock, posted, runNextSlice };
+}
+
+test('runs chunks until the slice budget is spent, then yields', async () => {
+  const { scheduler, clock, posted, runNextSlice } = createScheduler();
+  const done = [];
+  const job = scheduler.schedule('list', function* () {
+    for (let i = 0; i < 5; i++) {
+      done.push(i);
+      clock.time += 3;
+      yield;
+    }
+    return 'finished';
+  });
+
+  assert.strictEqual(posted.length, 1);
+  runNextSlice();
+  // 3 ms chunks: the third crosses 8 ms
+  assert.deepStrictEqual(done, [0, 1, 2]);
+  assert.strictEqual(posted.length, 1);
+
+  clock.input = true;
+  runNextSlice();
+  assert.deepStrictEqual(done, [0, 1, 2, 3]);
+
+  clock.input = false;
+  runNextSlice();
+  assert.deepStrictEqual(await job.promise, { status: 'done', value: 'finished' });
+  assert.strictEqual(posted.length, 0);
+  assert.strictEqual(scheduler.isPending('list'), false);
+});
+
+test('a job scheduled under the same key supersedes the running one', async () => {
+  const { scheduler, clock, runNextSlice } = createScheduler();
+  let cleanedUp = false;
+  const first = scheduler.schedule('search.results', function* () {
+    try {
+      for (;;) {
+        clock.time += 5;
+        yield;
+      }
+    } finally {
+      cleanedUp = true;
+    }
+  });
+  runNextSlice();
+
+  const second = scheduler.schedule('search.results', function* () {
+    yield;
+  });
+  assert.deepStrictEqual(await first.promise, { status: 'cancelled' });
+  assert.strictEqual(first.cancelled, true);
+  assert.strictEqual(cleanedUp, true);
+
+  runNextSlice();
+  assert.strictEqual((await second.promise).status, 'done');
+
+  const third = scheduler.schedule('other', function* () { yield; });
+  assert.strictEqual(scheduler.cancel('other'), true);
+  assert.strictEqual(scheduler.cancel('other'), false);
+  assert.deepStrictEqual(await third.promise, { status: 'cancelled' });
+});
+
+test('urgent work preempts background work between chunks', async () => {
+  const { scheduler, clock, posted, runNextSlice } = createScheduler();
+  const order = [];
+  scheduler.schedule('index', function* () {
+    for (let i = 0; i < 3; i++) {
+      order.push(`index${i}`);
+      if (i === 0) {
+        scheduler.schedule('input', function* () {
+          order.push('input');
+        }, { priority: 'user-blocking' });
+      }
+      yield;
+    }
+  }, { priority: 'background' });
+  assert.strictEqual(posted[0].priority, 'background');
+
+  runNextSlice();
+  assert.deepStrictEqual(order, ['index0', 'input', 'index1', 'index2']);
+
+  const failing = scheduler.schedule('broken', function* () {
+    clock.time += 1;
+    throw new Error('boom');
+  });
+  runNextSlice();
+  const outcome = await failing.promise;
+  assert.strictEqual(outcome.status, 'failed');
+  assert.strictEqual(outcome.error.message, 'boom');
+});